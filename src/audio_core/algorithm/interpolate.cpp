@@ -22,8 +22,16 @@ static double Lanczos(std::size_t a, double x) {
 }
 
 std::vector<s16> Interpolate(InterpolationState& state, std::vector<s16> input, double ratio) {
+    std::vector<s16> output;
+    Interpolate(state, input, ratio, output);
+    return output;
+}
+
+void Interpolate(InterpolationState& state, std::vector<s16>& input, double ratio,
+                 std::vector<s16>& output) {
+    output.clear();
     if (input.size() < 2)
-        return {};
+        return;
 
     if (ratio <= 0) {
         LOG_CRITICAL(Audio, "Nonsensical interpolation ratio {}", ratio);
@@ -40,7 +48,6 @@ std::vector<s16> Interpolate(InterpolationState& state, std::vector<s16> input,
     constexpr std::size_t taps = InterpolationState::lanczos_taps;
     const std::size_t num_frames = input.size() / 2;
 
-    std::vector<s16> output;
     output.reserve(static_cast<std::size_t>(input.size() / ratio + 4));
 
     double& pos = state.position;
@@ -65,8 +72,6 @@ std::vector<s16> Interpolate(InterpolationState& state, std::vector<s16> input,
         }
         pos -= 1.0;
     }
-
-    return output;
 }
 
 } // namespace AudioCore
@@ -29,6 +29,13 @@ struct InterpolationState {
 /// @returns Output signal.
 std::vector<s16> Interpolate(InterpolationState& state, std::vector<s16> input, double ratio);
 
+/// Interpolates input signal into output, reusing the storage of output.
+/// @param input The signal to interpolate, it is low-pass filtered in place.
+/// @param ratio Interpolation ratio.
+/// @param output Receives the output signal, its previous contents are discarded.
+void Interpolate(InterpolationState& state, std::vector<s16>& input, double ratio,
+                 std::vector<s16>& output);
+
 /// Interpolates input signal to produce output signal.
 /// @param input The signal to interpolate.
 /// @param input_rate The sample rate of input.
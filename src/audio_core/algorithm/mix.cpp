@@ -0,0 +1,56 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#ifdef ARCHITECTURE_x86_64
+#include <emmintrin.h>
+#endif
+
+#include "audio_core/algorithm/mix.h"
+
+namespace AudioCore {
+
+void MixSamples(float* bus, const s16* samples, std::size_t count, float volume) {
+    std::size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    // SSE2 is part of the x86-64 baseline, eight samples are mixed per iteration
+    const __m128 vol = _mm_set1_ps(volume);
+    for (; i + 8 <= count; i += 8) {
+        const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+        // Sign extend to 32 bits by placing each sample in the high half and shifting it back
+        const __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(packed, packed), 16);
+        const __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(packed, packed), 16);
+        const __m128 mixed_low =
+            _mm_add_ps(_mm_loadu_ps(bus + i), _mm_mul_ps(_mm_cvtepi32_ps(low), vol));
+        const __m128 mixed_high =
+            _mm_add_ps(_mm_loadu_ps(bus + i + 4), _mm_mul_ps(_mm_cvtepi32_ps(high), vol));
+        _mm_storeu_ps(bus + i, mixed_low);
+        _mm_storeu_ps(bus + i + 4, mixed_high);
+    }
+#endif
+    for (; i < count; ++i) {
+        bus[i] += static_cast<float>(samples[i]) * volume;
+    }
+}
+
+void SaturateToS16(s16* output, const float* bus, std::size_t count) {
+    std::size_t i = 0;
+#ifdef ARCHITECTURE_x86_64
+    // Samples are clamped before the conversion, out of range floats convert to INT_MIN
+    const __m128 min = _mm_set1_ps(-32768.0f);
+    const __m128 max = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        const __m128 low = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(bus + i), min), max);
+        const __m128 high = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(bus + i + 4), min), max);
+        const __m128i packed = _mm_packs_epi32(_mm_cvttps_epi32(low), _mm_cvttps_epi32(high));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), packed);
+    }
+#endif
+    for (; i < count; ++i) {
+        output[i] = static_cast<s16>(std::clamp(bus[i], -32768.0f, 32767.0f));
+    }
+}
+
+} // namespace AudioCore
@@ -0,0 +1,25 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/// Accumulates PCM16 samples into a float mix bus.
+/// @param bus The mix bus, bus[i] += samples[i] * volume.
+/// @param samples The samples to mix.
+/// @param count Number of samples, interleaved channels count as separate samples.
+/// @param volume Volume applied to the samples.
+void MixSamples(float* bus, const s16* samples, std::size_t count, float volume);
+
+/// Converts a float mix bus to PCM16, saturating out of range samples.
+/// @param output Where the converted samples are written.
+/// @param bus The mix bus to convert.
+/// @param count Number of samples, interleaved channels count as separate samples.
+void SaturateToS16(s16* output, const float* bus, std::size_t count);
+
+} // namespace AudioCore
@@ -0,0 +1,215 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#define _USE_MATH_DEFINES
+
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+
+#ifdef ARCHITECTURE_x86_64
+#include <xmmintrin.h>
+#endif
+
+#include "audio_core/algorithm/resampler.h"
+#include "common/logging/log.h"
+
+namespace AudioCore {
+
+namespace {
+
+constexpr std::size_t NumTaps = Resampler::NumTaps;
+constexpr std::size_t NumPhases = Resampler::NumPhases;
+constexpr u32 PhaseBits = 7;
+static_assert(NumPhases == 1U << PhaseBits);
+static_assert(NumTaps % 4 == 0, "The filter loop processes four taps at a time");
+
+/// Bits of the fractional position interpolating between two phases
+constexpr u32 InterpolationBits = 32 - PhaseBits;
+
+/// Frames of silence the buffers start with, so the first output frame is centered on the first
+/// input frame
+constexpr std::size_t InitialFrames = NumTaps / 2 - 1;
+
+/// Kaiser window shape, about 80 dB of stopband attenuation
+constexpr double KaiserBeta = 8.0;
+
+/// Cutoffs are rounded to this many steps, bounding the number of banks
+constexpr double CutoffSteps = 64.0;
+
+/// Moves the cutoff below the Nyquist frequency, so the transition band doesn't alias
+constexpr double CutoffScale = 0.9;
+
+/// Zeroth order modified Bessel function of the first kind
+double BesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; term > sum * 1e-12; ++k) {
+        const double factor = x / (2.0 * k);
+        term *= factor * factor;
+        sum += term;
+    }
+    return sum;
+}
+
+s16 ToS16(float value) {
+    return static_cast<s16>(std::lrint(std::clamp(value, -32768.0f, 32767.0f)));
+}
+
+/// Weights NumTaps frames of both channels with coefficients interpolated between two phases.
+void Filter(const float* phase0, const float* phase1, float t, const float* left,
+            const float* right, float& out_left, float& out_right) {
+#ifdef ARCHITECTURE_x86_64
+    const __m128 factor = _mm_set1_ps(t);
+    __m128 sum_left = _mm_setzero_ps();
+    __m128 sum_right = _mm_setzero_ps();
+    for (std::size_t k = 0; k < NumTaps; k += 4) {
+        const __m128 a = _mm_loadu_ps(phase0 + k);
+        const __m128 b = _mm_loadu_ps(phase1 + k);
+        const __m128 coefficients = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), factor));
+        sum_left = _mm_add_ps(sum_left, _mm_mul_ps(coefficients, _mm_loadu_ps(left + k)));
+        sum_right = _mm_add_ps(sum_right, _mm_mul_ps(coefficients, _mm_loadu_ps(right + k)));
+    }
+    // Horizontal sums of both channels, the left one ends up in lane 0 and the right one in lane 1
+    __m128 sums = _mm_add_ps(_mm_unpacklo_ps(sum_left, sum_right),
+                             _mm_unpackhi_ps(sum_left, sum_right));
+    sums = _mm_add_ps(sums, _mm_movehl_ps(sums, sums));
+    out_left = _mm_cvtss_f32(sums);
+    out_right = _mm_cvtss_f32(_mm_shuffle_ps(sums, sums, _MM_SHUFFLE(1, 1, 1, 1)));
+#else
+    float sum_left = 0.0f;
+    float sum_right = 0.0f;
+    for (std::size_t k = 0; k < NumTaps; ++k) {
+        const float coefficient = phase0[k] + (phase1[k] - phase0[k]) * t;
+        sum_left += coefficient * left[k];
+        sum_right += coefficient * right[k];
+    }
+    out_left = sum_left;
+    out_right = sum_right;
+#endif
+}
+
+} // Anonymous namespace
+
+struct Resampler::CoefficientBank {
+    /// NumPhases + 1 rows of NumTaps coefficients, the extra row lets the last phase interpolate
+    /// towards the next input frame
+    std::vector<float> coefficients;
+};
+
+Resampler::Resampler() {
+    SetRatio(1.0);
+    Reset();
+}
+
+Resampler::~Resampler() = default;
+
+void Resampler::SetRatio(double new_ratio) {
+    if (new_ratio <= 0) {
+        LOG_CRITICAL(Audio, "Nonsensical resampling ratio {}", new_ratio);
+        new_ratio = 1.0;
+    }
+    if (new_ratio == ratio) {
+        return;
+    }
+    ratio = new_ratio;
+    step = static_cast<u64>(std::llround(ratio * 4294967296.0));
+    bank = GetBank(ratio);
+}
+
+void Resampler::Reset() {
+    left.assign(InitialFrames, 0.0f);
+    right.assign(InitialFrames, 0.0f);
+    position = 0;
+}
+
+void Resampler::Process(const s16* input, std::size_t num_frames, std::vector<s16>& output) {
+    const std::size_t buffered = left.size();
+    left.resize(buffered + num_frames);
+    right.resize(buffered + num_frames);
+    for (std::size_t i = 0; i < num_frames; ++i) {
+        left[buffered + i] = input[i * 2 + 0];
+        right[buffered + i] = input[i * 2 + 1];
+    }
+
+    const std::size_t total = left.size();
+    if (total >= NumTaps) {
+        const u64 end = static_cast<u64>(total - NumTaps + 1) << 32;
+        if (position < end) {
+            output.reserve(output.size() + ((end - position) / step + 1) * 2);
+        }
+    }
+
+    const float* const coefficients = bank->coefficients.data();
+    constexpr float interpolation_scale = 1.0f / (1U << InterpolationBits);
+    while ((position >> 32) + NumTaps <= total) {
+        const std::size_t index = static_cast<std::size_t>(position >> 32);
+        const u32 fraction = static_cast<u32>(position);
+        const float* const phase = coefficients + (fraction >> InterpolationBits) * NumTaps;
+        const float t = (fraction & ((1U << InterpolationBits) - 1)) * interpolation_scale;
+
+        float out_left;
+        float out_right;
+        Filter(phase, phase + NumTaps, t, left.data() + index, right.data() + index, out_left,
+               out_right);
+        output.push_back(ToS16(out_left));
+        output.push_back(ToS16(out_right));
+
+        position += step;
+    }
+
+    // Keep the frames still needed by the next output frames, at most NumTaps - 1 of them
+    const std::size_t consumed = std::min(static_cast<std::size_t>(position >> 32), total);
+    left.erase(left.begin(), left.begin() + consumed);
+    right.erase(right.begin(), right.begin() + consumed);
+    position -= static_cast<u64>(consumed) << 32;
+}
+
+std::shared_ptr<const Resampler::CoefficientBank> Resampler::GetBank(double ratio) {
+    const double cutoff_step = std::round(std::min(1.0, 1.0 / ratio) * CutoffSteps);
+    const u32 key = static_cast<u32>(std::max(cutoff_step, 1.0));
+
+    // Banks are shared between the renderer instances, which mix on their own threads
+    static std::mutex mutex;
+    static std::unordered_map<u32, std::shared_ptr<const CoefficientBank>> banks;
+    std::lock_guard lock{mutex};
+    if (const auto it = banks.find(key); it != banks.end()) {
+        return it->second;
+    }
+
+    const double cutoff = key / CutoffSteps * CutoffScale;
+    const double window_scale = 1.0 / BesselI0(KaiserBeta);
+    constexpr double half_width = NumTaps / 2;
+
+    auto bank = std::make_shared<CoefficientBank>();
+    bank->coefficients.resize((NumPhases + 1) * NumTaps);
+    for (std::size_t phase = 0; phase <= NumPhases; ++phase) {
+        float* const row = bank->coefficients.data() + phase * NumTaps;
+        const double fraction = static_cast<double>(phase) / NumPhases;
+        double sum = 0.0;
+        for (std::size_t k = 0; k < NumTaps; ++k) {
+            // Distance of the tap to the output frame, in input frames
+            const double x = static_cast<double>(k) - InitialFrames - fraction;
+            const double px = M_PI * cutoff * x;
+            const double sinc = x == 0.0 ? 1.0 : std::sin(px) / px;
+            const double w = x / half_width;
+            const double window =
+                std::abs(w) < 1.0 ? BesselI0(KaiserBeta * std::sqrt(1.0 - w * w)) * window_scale
+                                  : 0.0;
+            const double coefficient = cutoff * sinc * window;
+            row[k] = static_cast<float>(coefficient);
+            sum += coefficient;
+        }
+        // Normalize each phase to unity gain, so constant signals don't ripple
+        for (std::size_t k = 0; k < NumTaps; ++k) {
+            row[k] = static_cast<float>(row[k] / sum);
+        }
+    }
+
+    banks.emplace(key, bank);
+    return bank;
+}
+
+} // namespace AudioCore
@@ -0,0 +1,62 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/**
+ * Streaming polyphase resampler for interleaved stereo PCM16. Output samples are filtered with a
+ * Kaiser windowed-sinc kernel whose coefficients are precomputed for a fixed number of phases and
+ * linearly interpolated between them. The kernel cutoff follows the ratio, so downsampling is
+ * anti-aliased without a separate low-pass filter. Coefficient banks are shared between the
+ * resamplers using the same cutoff, and the tail of the input is kept between calls, so the
+ * signal can be processed in arbitrarily sized blocks.
+ */
+class Resampler {
+public:
+    /// Number of input frames weighted for each output frame
+    static constexpr std::size_t NumTaps = 32;
+    /// Number of precomputed kernel phases between two input frames
+    static constexpr std::size_t NumPhases = 128;
+
+    Resampler();
+    ~Resampler();
+
+    /// Sets the resampling ratio, the input rate divided by the output rate.
+    /// ratio > 1.0 results in fewer output samples.
+    /// ratio < 1.0 results in more output samples.
+    void SetRatio(double ratio);
+
+    /// Discards the buffered input and restarts from silence, the ratio is kept.
+    void Reset();
+
+    /// Resamples input frames, appending the output frames that can be produced to output.
+    /// @param input Interleaved stereo samples.
+    /// @param num_frames Number of stereo frames in input.
+    /// @param output Receives interleaved stereo samples, its storage is reused.
+    void Process(const s16* input, std::size_t num_frames, std::vector<s16>& output);
+
+private:
+    struct CoefficientBank;
+
+    /// Returns the shared coefficient bank for a ratio, creating it on first use.
+    static std::shared_ptr<const CoefficientBank> GetBank(double ratio);
+
+    std::shared_ptr<const CoefficientBank> bank;
+    double ratio = 0.0;
+    u64 step = 0;     ///< Input frames per output frame, 32.32 fixed point
+    u64 position = 0; ///< Position of the next output frame in the buffers, 32.32 fixed point
+
+    /// Buffered input frames, split by channel
+    std::vector<float> left;
+    std::vector<float> right;
+};
+
+} // namespace AudioCore
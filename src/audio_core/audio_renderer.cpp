@@ -2,12 +2,17 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
-#include "audio_core/algorithm/interpolate.h"
+#include <cstring>
+#include <memory>
+
+#include "audio_core/algorithm/mix.h"
+#include "audio_core/algorithm/resampler.h"
 #include "audio_core/audio_out.h"
 #include "audio_core/audio_renderer.h"
 #include "audio_core/codec.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/core.h"
 #include "core/hle/kernel/writable_event.h"
 #include "core/memory.h"
@@ -16,6 +21,36 @@ namespace AudioCore {
 
 constexpr u32 STREAM_SAMPLE_RATE{48000};
 constexpr u32 STREAM_NUM_CHANNELS{2};
+constexpr std::size_t BUFFER_SIZE{512};
+
+/// Calls func with a host pointer and a size for each page of a guest memory range. Returns false,
+/// stopping early, when part of the range is not mapped.
+template <typename Func>
+static bool ForEachGuestPage(VAddr addr, std::size_t size, Func&& func) {
+    while (size > 0) {
+        const std::size_t page_size{
+            std::min<std::size_t>(Memory::PAGE_SIZE - (addr & Memory::PAGE_MASK), size)};
+        const u8* const pointer{Memory::GetPointer(addr)};
+        if (pointer == nullptr) {
+            return false;
+        }
+        func(pointer, page_size);
+        addr += page_size;
+        size -= page_size;
+    }
+    return true;
+}
+
+/// Returns true when a copy of guest memory still matches it.
+static bool IsSameGuestData(VAddr addr, const std::vector<u8>& copy) {
+    const u8* copied{copy.data()};
+    bool is_same{true};
+    const bool is_mapped{ForEachGuestPage(addr, copy.size(), [&](const u8* data, std::size_t n) {
+        is_same = is_same && std::memcmp(data, copied, n) == 0;
+        copied += n;
+    })};
+    return is_mapped && is_same;
+}
 
 class AudioRenderer::VoiceState {
 public:
@@ -35,19 +70,44 @@ public:
         return info;
     }
 
+    /// Sets the guest memory copies the voice reads from, replacing the previous ones.
+    void SetVoiceData(const VoiceData& data) {
+        voice_data = data;
+    }
+
     void SetWaveIndex(std::size_t index);
-    std::vector<s16> DequeueSamples(std::size_t sample_count);
+
+    /// Dequeues up to sample_count stereo frames without copying them. Returns the number of
+    /// samples dequeued, out_samples points to them until the next call.
+    std::size_t DequeueSamples(std::size_t sample_count, const s16*& out_samples);
+
     void UpdateState();
     void RefreshBuffer();
 
 private:
+    /// Decoded ADPCM wave buffer, with what is needed to tell whether it can be replayed
+    struct ADPCMCache {
+        WaveDataPtr data; ///< Looping wave buffer the samples were decoded from
+        Codec::ADPCM_Coeff coeffs{};
+        Codec::ADPCMState start_state{};
+        Codec::ADPCMState end_state{};
+        std::vector<s16> samples;
+    };
+
+    /// Decodes the copy of an ADPCM wave buffer, returns the decoded samples.
+    const std::vector<s16>& DecodeADPCM(const WaveBuffer& wave_buffer, const WaveDataPtr& data);
+
     bool is_in_use{};
     bool is_refresh_pending{};
     std::size_t wave_index{};
     std::size_t offset{};
     Codec::ADPCMState adpcm_state{};
-    InterpolationState interp_state{};
-    std::vector<s16> samples;
+    ADPCMCache adpcm_cache;
+    VoiceData voice_data;
+    Resampler resampler;
+    std::vector<s16> samples;         ///< Stereo samples at the stream rate being played
+    std::vector<s16> decode_buffer;   ///< PCM16 wave buffer samples before upmixing
+    std::vector<s16> resample_buffer; ///< Resampler output, swapped with samples
     VoiceOutStatus out_status{};
     VoiceInfo info{};
 };
@@ -76,7 +136,9 @@ AudioRenderer::AudioRenderer(Core::Timing::CoreTiming& core_timing, AudioRendere
                              Kernel::SharedPtr<Kernel::WritableEvent> buffer_event,
                              std::size_t instance_number)
     : worker_params{params}, buffer_event{buffer_event}, voices(params.voice_count),
-      effects(params.effect_count) {
+      effects(params.effect_count), submitted_wave_data(params.voice_count),
+      mix_bus(BUFFER_SIZE * STREAM_NUM_CHANNELS),
+      voice_out_status(params.voice_count) {
 
     audio_out = std::make_unique<AudioCore::AudioOut>();
     stream = audio_out->OpenStream(core_timing, STREAM_SAMPLE_RATE, STREAM_NUM_CHANNELS,
@@ -84,12 +146,22 @@ AudioRenderer::AudioRenderer(Core::Timing::CoreTiming& core_timing, AudioRendere
                                    [=]() { buffer_event->Signal(); });
     audio_out->StartStream(stream);
 
-    QueueMixedBuffer(0);
-    QueueMixedBuffer(1);
-    QueueMixedBuffer(2);
+    for (Buffer::Tag tag = 0; tag < 3; ++tag) {
+        audio_out->QueueBuffer(stream, tag, MixBuffer());
+    }
+
+    render_thread = std::thread(&AudioRenderer::RenderThread, this);
 }
 
-AudioRenderer::~AudioRenderer() = default;
+AudioRenderer::~AudioRenderer() {
+    {
+        std::lock_guard lock{render_mutex};
+        quit = true;
+    }
+    render_cv.notify_one();
+    render_thread.join();
+    stream->LogSinkStats();
+}
 
 u32 AudioRenderer::GetSampleRate() const {
     return worker_params.sample_rate;
@@ -124,12 +196,16 @@ std::vector<u8> AudioRenderer::UpdateAudioRenderer(const std::vector<u8>& input_
                 input_params.data() + sizeof(UpdateDataHeader) + config.behavior_size,
                 memory_pool_count * sizeof(MemoryPoolInfo));
 
-    // Copy VoiceInfo structs
-    std::size_t voice_offset{sizeof(UpdateDataHeader) + config.behavior_size +
-                             config.memory_pools_size + config.voice_resource_size};
-    for (auto& voice : voices) {
-        std::memcpy(&voice.GetInfo(), input_params.data() + voice_offset, sizeof(VoiceInfo));
-        voice_offset += sizeof(VoiceInfo);
+    // Copy VoiceInfo structs, they are applied to the voices on the render thread
+    auto snapshot{std::make_unique<ParameterSnapshot>()};
+    snapshot->voices.resize(worker_params.voice_count);
+    const std::size_t voice_offset{sizeof(UpdateDataHeader) + config.behavior_size +
+                                   config.memory_pools_size + config.voice_resource_size};
+    std::memcpy(snapshot->voices.data(), input_params.data() + voice_offset,
+                snapshot->voices.size() * sizeof(VoiceInfo));
+    snapshot->voice_data.resize(worker_params.voice_count);
+    for (std::size_t index = 0; index < snapshot->voices.size(); ++index) {
+        CopyVoiceData(index, snapshot->voices[index], snapshot->voice_data[index]);
     }
 
     std::size_t effect_offset{sizeof(UpdateDataHeader) + config.behavior_size +
@@ -150,23 +226,18 @@ std::vector<u8> AudioRenderer::UpdateAudioRenderer(const std::vector<u8>& input_
         }
     }
 
-    // Update voices
-    for (auto& voice : voices) {
-        voice.UpdateState();
-        if (!voice.GetInfo().is_in_use) {
-            continue;
-        }
-        if (voice.GetInfo().is_new) {
-            voice.SetWaveIndex(voice.GetInfo().wave_buffer_head);
-        }
-    }
-
     for (auto& effect : effects) {
         effect.UpdateState();
     }
 
-    // Release previous buffers and queue next ones for playback
-    ReleaseAndQueueBuffers();
+    // Have the released buffers mixed with the new parameters
+    snapshot->released_tags = audio_out->GetTagsAndReleaseBuffers(stream, 2);
+    {
+        // Push under the lock, the render thread checks the queue before sleeping
+        std::lock_guard lock{render_mutex};
+        snapshots.Push(std::move(snapshot));
+    }
+    render_cv.notify_one();
 
     // Copy output header
     UpdateDataHeader response_data{worker_params};
@@ -182,12 +253,12 @@ std::vector<u8> AudioRenderer::UpdateAudioRenderer(const std::vector<u8>& input_
     std::memcpy(output_params.data() + sizeof(UpdateDataHeader), memory_pool.data(),
                 response_data.memory_pools_size);
 
-    // Copy output voice status
-    std::size_t voice_out_status_offset{sizeof(UpdateDataHeader) + response_data.memory_pools_size};
-    for (const auto& voice : voices) {
-        std::memcpy(output_params.data() + voice_out_status_offset, &voice.GetOutStatus(),
-                    sizeof(VoiceOutStatus));
-        voice_out_status_offset += sizeof(VoiceOutStatus);
+    // Copy output voice status, as last published by the render thread
+    {
+        std::lock_guard lock{status_mutex};
+        std::memcpy(output_params.data() + sizeof(UpdateDataHeader) +
+                        response_data.memory_pools_size,
+                    voice_out_status.data(), voice_out_status.size() * sizeof(VoiceOutStatus));
     }
 
     std::size_t effect_out_status_offset{
@@ -206,9 +277,10 @@ void AudioRenderer::VoiceState::SetWaveIndex(std::size_t index) {
     is_refresh_pending = true;
 }
 
-std::vector<s16> AudioRenderer::VoiceState::DequeueSamples(std::size_t sample_count) {
+std::size_t AudioRenderer::VoiceState::DequeueSamples(std::size_t sample_count,
+                                                      const s16*& out_samples) {
     if (!IsPlaying()) {
-        return {};
+        return 0;
     }
 
     if (is_refresh_pending) {
@@ -242,7 +314,8 @@ std::vector<s16> AudioRenderer::VoiceState::DequeueSamples(std::size_t sample_co
         }
     }
 
-    return {samples.begin() + dequeue_offset, samples.begin() + dequeue_offset + size};
+    out_samples = samples.data() + dequeue_offset;
+    return size;
 }
 
 void AudioRenderer::VoiceState::UpdateState() {
@@ -252,45 +325,84 @@ void AudioRenderer::VoiceState::UpdateState() {
         wave_index = 0;
         offset = 0;
         out_status = {};
+        resampler.Reset();
     }
     is_in_use = info.is_in_use;
 }
 
+const std::vector<s16>& AudioRenderer::VoiceState::DecodeADPCM(const WaveBuffer& wave_buffer,
+                                                               const WaveDataPtr& data) {
+    const auto& coeffs{voice_data.coeffs};
+
+    // Looping wave buffers usually replay unchanged data. Their last decode is reused when the
+    // data, the coefficients and the predictor state it started from all match.
+    const auto& cache{adpcm_cache};
+    if (wave_buffer.is_looping && cache.data == data && cache.coeffs == coeffs &&
+        cache.start_state.yn1 == adpcm_state.yn1 && cache.start_state.yn2 == adpcm_state.yn2) {
+        adpcm_state = cache.end_state;
+        return cache.samples;
+    }
+
+    const std::size_t size{data->data.size() / Codec::ADPCM_FRAME_SIZE * Codec::ADPCM_FRAME_SIZE};
+    adpcm_cache.start_state = adpcm_state;
+    adpcm_cache.samples.resize(Codec::GetADPCMSampleCount(size));
+    Codec::DecodeADPCM(data->data.data(), size, coeffs, adpcm_state, adpcm_cache.samples.data());
+
+    adpcm_cache.data = wave_buffer.is_looping ? data : nullptr;
+    adpcm_cache.coeffs = coeffs;
+    adpcm_cache.end_state = adpcm_state;
+    return adpcm_cache.samples;
+}
+
 void AudioRenderer::VoiceState::RefreshBuffer() {
-    std::vector<s16> new_samples(info.wave_buffer[wave_index].buffer_sz / sizeof(s16));
-    Memory::ReadBlock(info.wave_buffer[wave_index].buffer_addr, new_samples.data(),
-                      info.wave_buffer[wave_index].buffer_sz);
+    // The sample buffers are resized without shrinking, so their storage is reused across refreshes
+    const auto& wave_buffer{info.wave_buffer[wave_index]};
+    const WaveDataPtr& data{voice_data.wave_buffers[wave_index]};
+    const std::vector<s16>* decoded{&decode_buffer};
 
-    switch (static_cast<Codec::PcmFormat>(info.sample_format)) {
-    case Codec::PcmFormat::Int16: {
-        // PCM16 is played as-is
-        break;
-    }
-    case Codec::PcmFormat::Adpcm: {
-        // Decode ADPCM to PCM16
-        Codec::ADPCM_Coeff coeffs;
-        Memory::ReadBlock(info.additional_params_addr, coeffs.data(), sizeof(Codec::ADPCM_Coeff));
-        new_samples = Codec::DecodeADPCM(reinterpret_cast<u8*>(new_samples.data()),
-                                         new_samples.size() * sizeof(s16), coeffs, adpcm_state);
-        break;
-    }
-    default:
-        UNIMPLEMENTED_MSG("Unimplemented sample_format={}", info.sample_format);
-        break;
+    if (!data) {
+        // The guest update didn't submit data for this wave buffer
+        decode_buffer.clear();
+    } else {
+        switch (static_cast<Codec::PcmFormat>(info.sample_format)) {
+        case Codec::PcmFormat::Int16: {
+            // PCM16 is played as-is
+            decode_buffer.resize(data->data.size() / sizeof(s16));
+            std::memcpy(decode_buffer.data(), data->data.data(),
+                        decode_buffer.size() * sizeof(s16));
+            break;
+        }
+        case Codec::PcmFormat::Adpcm: {
+            // Decode ADPCM to PCM16
+            decoded = &DecodeADPCM(wave_buffer, data);
+            break;
+        }
+        default:
+            UNIMPLEMENTED_MSG("Unimplemented sample_format={}", info.sample_format);
+            decode_buffer.clear();
+            break;
+        }
     }
 
     switch (info.channel_count) {
     case 1:
         // 1 channel is upsampled to 2 channel
-        samples.resize(new_samples.size() * 2);
-        for (std::size_t index = 0; index < new_samples.size(); ++index) {
-            samples[index * 2] = new_samples[index];
-            samples[index * 2 + 1] = new_samples[index];
+        samples.resize(decoded->size() * 2);
+        for (std::size_t index = 0; index < decoded->size(); ++index) {
+            samples[index * 2] = (*decoded)[index];
+            samples[index * 2 + 1] = (*decoded)[index];
         }
         break;
     case 2: {
-        // 2 channel is played as is
-        samples = std::move(new_samples);
+        // 2 channel is played as is. Decodes that aren't kept for a replay are swapped in instead
+        // of copied.
+        if (decoded == &decode_buffer) {
+            std::swap(samples, decode_buffer);
+        } else if (decoded == &adpcm_cache.samples && !adpcm_cache.data) {
+            std::swap(samples, adpcm_cache.samples);
+        } else {
+            samples.assign(decoded->begin(), decoded->end());
+        }
         break;
     }
     default:
@@ -298,10 +410,12 @@ void AudioRenderer::VoiceState::RefreshBuffer() {
         break;
     }
 
-    // Only interpolate when necessary, expensive.
+    // Only resample when necessary, the resampler keeps the tail of the previous wave buffer
     if (GetInfo().sample_rate != STREAM_SAMPLE_RATE) {
-        samples = Interpolate(interp_state, std::move(samples), GetInfo().sample_rate,
-                              STREAM_SAMPLE_RATE);
+        resampler.SetRatio(static_cast<double>(GetInfo().sample_rate) / STREAM_SAMPLE_RATE);
+        resample_buffer.clear();
+        resampler.Process(samples.data(), samples.size() / 2, resample_buffer);
+        std::swap(samples, resample_buffer);
     }
 
     is_refresh_pending = false;
@@ -324,13 +438,43 @@ void AudioRenderer::EffectState::UpdateState() {
     }
 }
 
-static constexpr s16 ClampToS16(s32 value) {
-    return static_cast<s16>(std::clamp(value, -32768, 32767));
+void AudioRenderer::CopyVoiceData(std::size_t voice_index, const VoiceInfo& info,
+                                  VoiceData& voice_data) {
+    // Only playing voices read guest memory until the next update
+    if (!info.is_in_use || info.play_state != PlayState::Started) {
+        return;
+    }
+    if (static_cast<Codec::PcmFormat>(info.sample_format) == Codec::PcmFormat::Adpcm) {
+        Memory::ReadBlock(info.additional_params_addr, voice_data.coeffs.data(),
+                          sizeof(Codec::ADPCM_Coeff));
+    }
+
+    auto& submitted{submitted_wave_data[voice_index]};
+    for (std::size_t index = 0; index < info.wave_buffer.size(); ++index) {
+        const auto& wave_buffer{info.wave_buffer[index]};
+        if (wave_buffer.buffer_sz == 0) {
+            continue;
+        }
+        // Wave buffers stay submitted over many updates. Buffers the guest marks as sent keep
+        // their copy, the others are compared against it in case they were written to.
+        WaveDataPtr& copy{submitted[index]};
+        const bool is_same_buffer{copy && copy->address == wave_buffer.buffer_addr &&
+                                  copy->data.size() == wave_buffer.buffer_sz};
+        if (!is_same_buffer ||
+            (wave_buffer.sent_to_server == 0 && !IsSameGuestData(copy->address, copy->data))) {
+            auto new_copy{std::make_shared<WaveData>()};
+            new_copy->address = wave_buffer.buffer_addr;
+            new_copy->data.resize(wave_buffer.buffer_sz);
+            Memory::ReadBlock(new_copy->address, new_copy->data.data(), new_copy->data.size());
+            copy = std::move(new_copy);
+        }
+        voice_data.wave_buffers[index] = copy;
+    }
 }
 
-void AudioRenderer::QueueMixedBuffer(Buffer::Tag tag) {
-    constexpr std::size_t BUFFER_SIZE{512};
-    std::vector<s16> buffer(BUFFER_SIZE * stream->GetNumChannels());
+std::vector<s16> AudioRenderer::MixBuffer() {
+    // Voices are accumulated in float and saturated once, so loud voices don't clip the others
+    std::fill(mix_bus.begin(), mix_bus.end(), 0.0f);
 
     for (auto& voice : voices) {
         if (!voice.IsPlaying()) {
@@ -338,30 +482,63 @@ void AudioRenderer::QueueMixedBuffer(Buffer::Tag tag) {
         }
 
         std::size_t offset{};
-        s64 samples_remaining{BUFFER_SIZE};
+        std::size_t samples_remaining{BUFFER_SIZE};
         while (samples_remaining > 0) {
-            const std::vector<s16> samples{voice.DequeueSamples(samples_remaining)};
+            const s16* samples{};
+            const std::size_t size{voice.DequeueSamples(samples_remaining, samples)};
 
-            if (samples.empty()) {
+            if (size == 0) {
                 break;
             }
 
-            samples_remaining -= samples.size() / stream->GetNumChannels();
+            samples_remaining -= size / STREAM_NUM_CHANNELS;
 
-            for (const auto& sample : samples) {
-                const s32 buffer_sample{buffer[offset]};
-                buffer[offset++] =
-                    ClampToS16(buffer_sample + static_cast<s32>(sample * voice.GetInfo().volume));
-            }
+            MixSamples(mix_bus.data() + offset, samples, size, voice.GetInfo().volume);
+            offset += size;
+        }
+    }
+
+    std::vector<s16> buffer(mix_bus.size());
+    SaturateToS16(buffer.data(), mix_bus.data(), buffer.size());
+    return buffer;
+}
+
+void AudioRenderer::ProcessSnapshot(const ParameterSnapshot& snapshot) {
+    for (std::size_t index = 0; index < voices.size(); ++index) {
+        auto& voice{voices[index]};
+        voice.GetInfo() = snapshot.voices[index];
+        voice.SetVoiceData(snapshot.voice_data[index]);
+        voice.UpdateState();
+        if (voice.GetInfo().is_in_use && voice.GetInfo().is_new) {
+            voice.SetWaveIndex(voice.GetInfo().wave_buffer_head);
         }
     }
-    audio_out->QueueBuffer(stream, tag, std::move(buffer));
+
+    for (const auto tag : snapshot.released_tags) {
+        audio_out->QueueBuffer(stream, tag, MixBuffer());
+    }
+
+    std::lock_guard lock{status_mutex};
+    for (std::size_t index = 0; index < voices.size(); ++index) {
+        voice_out_status[index] = voices[index].GetOutStatus();
+    }
 }
 
-void AudioRenderer::ReleaseAndQueueBuffers() {
-    const auto released_buffers{audio_out->GetTagsAndReleaseBuffers(stream, 2)};
-    for (const auto& tag : released_buffers) {
-        QueueMixedBuffer(tag);
+void AudioRenderer::RenderThread() {
+    Common::SetCurrentThreadName("yuzu:AudioRenderer");
+
+    while (true) {
+        {
+            std::unique_lock lock{render_mutex};
+            render_cv.wait(lock, [this] { return !snapshots.Empty() || quit; });
+            if (snapshots.Empty()) {
+                // Quitting with no pending snapshot
+                return;
+            }
+        }
+        std::unique_ptr<const ParameterSnapshot> snapshot;
+        snapshots.Pop(snapshot);
+        ProcessSnapshot(*snapshot);
     }
 }
 
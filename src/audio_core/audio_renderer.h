@@ -5,13 +5,18 @@
 #pragma once
 
 #include <array>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
+#include "audio_core/codec.h"
 #include "audio_core/stream.h"
 #include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/swap.h"
+#include "common/threadsafe_queue.h"
 #include "core/hle/kernel/object.h"
 
 namespace Core::Timing {
@@ -215,6 +220,13 @@ struct UpdateDataHeader {
 };
 static_assert(sizeof(UpdateDataHeader) == 0x40, "UpdateDataHeader has wrong size");
 
+/**
+ * Audio renderer of an audren:u instance. Voices are mixed on a dedicated render thread, so the
+ * DSP work doesn't take time from the emulated CPU: each guest update hands an immutable snapshot
+ * of the voice parameters, the wave buffer data and the tags of the released buffers to the render
+ * thread, which never reads guest memory. Each buffer is queued into the stream as soon as it's
+ * mixed, and the stream signals the guest event when they are released as before.
+ */
 class AudioRenderer {
 public:
     AudioRenderer(Core::Timing::CoreTiming& core_timing, AudioRendererParameter params,
@@ -223,8 +235,6 @@ public:
     ~AudioRenderer();
 
     std::vector<u8> UpdateAudioRenderer(const std::vector<u8>& input_params);
-    void QueueMixedBuffer(Buffer::Tag tag);
-    void ReleaseAndQueueBuffers();
     u32 GetSampleRate() const;
     u32 GetSampleCount() const;
     u32 GetMixBufferCount() const;
@@ -234,12 +244,56 @@ private:
     class EffectState;
     class VoiceState;
 
+    /// Data of a wave buffer, copied from guest memory. Shared by the snapshots of the updates
+    /// the guest keeps the buffer submitted in.
+    struct WaveData {
+        VAddr address{};
+        std::vector<u8> data;
+    };
+    using WaveDataPtr = std::shared_ptr<const WaveData>;
+
+    /// Guest memory a voice reads, copied for the render thread.
+    struct VoiceData {
+        std::array<WaveDataPtr, 4> wave_buffers; ///< Null for the buffers that won't be played
+        Codec::ADPCM_Coeff coeffs{};
+    };
+
+    /// Guest parameters of an update, handed to the render thread.
+    struct ParameterSnapshot {
+        std::vector<VoiceInfo> voices;
+        std::vector<VoiceData> voice_data;
+        std::vector<Buffer::Tag> released_tags; ///< Buffers to mix with these parameters
+    };
+
+    /// Copies the guest memory a voice may read until the next update, reusing the copies of the
+    /// wave buffers that are still submitted.
+    void CopyVoiceData(std::size_t voice_index, const VoiceInfo& info, VoiceData& voice_data);
+
+    /// Mixes the playing voices into a new buffer, render thread only after construction.
+    std::vector<s16> MixBuffer();
+
+    /// Applies a parameter snapshot to the voices, mixes its released buffers and queues them.
+    void ProcessSnapshot(const ParameterSnapshot& snapshot);
+
+    void RenderThread();
+
     AudioRendererParameter worker_params;
     Kernel::SharedPtr<Kernel::WritableEvent> buffer_event;
-    std::vector<VoiceState> voices;
-    std::vector<EffectState> effects;
+    std::vector<VoiceState> voices;   ///< Render thread only
+    std::vector<EffectState> effects; ///< Guest thread only
+    std::vector<std::array<WaveDataPtr, 4>> submitted_wave_data; ///< Guest thread only
+    std::vector<float> mix_bus;       ///< Accumulates the voices of a buffer, allocated once
     std::unique_ptr<AudioOut> audio_out;
     AudioCore::StreamPtr stream;
+
+    std::mutex status_mutex;
+    std::vector<VoiceOutStatus> voice_out_status; ///< Published by the render thread
+
+    Common::SPSCQueue<std::unique_ptr<const ParameterSnapshot>> snapshots;
+    std::mutex render_mutex;
+    std::condition_variable render_cv;
+    bool quit = false; ///< Stops the render thread once the snapshots are processed
+    std::thread render_thread;
 };
 
 } // namespace AudioCore
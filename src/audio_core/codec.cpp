@@ -8,28 +8,23 @@
 
 namespace AudioCore::Codec {
 
-std::vector<s16> DecodeADPCM(const u8* const data, std::size_t size, const ADPCM_Coeff& coeff,
-                             ADPCMState& state) {
+void DecodeADPCM(const u8* data, std::size_t size, const ADPCM_Coeff& coeff, ADPCMState& state,
+                 s16* output) {
     // GC-ADPCM with scale factor and variable coefficients.
     // Frames are 8 bytes long containing 14 samples each.
     // Samples are 4 bits (one nibble) long.
+    // The prediction of each sample depends on the previous two, so frames are decoded serially.
+    // Whole frames are decoded at once, without checking the output bounds per sample.
 
-    constexpr std::size_t FRAME_LEN = 8;
-    constexpr std::size_t SAMPLES_PER_FRAME = 14;
     constexpr std::array<int, 16> SIGNED_NIBBLES = {
         {0, 1, 2, 3, 4, 5, 6, 7, -8, -7, -6, -5, -4, -3, -2, -1}};
 
-    const std::size_t sample_count = (size / FRAME_LEN) * SAMPLES_PER_FRAME;
-    const std::size_t ret_size =
-        sample_count % 2 == 0 ? sample_count : sample_count + 1; // Ensure multiple of two.
-    std::vector<s16> ret(ret_size);
-
     int yn1 = state.yn1, yn2 = state.yn2;
 
-    const std::size_t NUM_FRAMES =
-        (sample_count + (SAMPLES_PER_FRAME - 1)) / SAMPLES_PER_FRAME; // Round up.
-    for (std::size_t framei = 0; framei < NUM_FRAMES; framei++) {
-        const int frame_header = data[framei * FRAME_LEN];
+    const std::size_t num_frames = size / ADPCM_FRAME_SIZE;
+    for (std::size_t framei = 0; framei < num_frames; framei++) {
+        const u8* const frame = data + framei * ADPCM_FRAME_SIZE;
+        const int frame_header = frame[0];
         const int scale = 1 << (frame_header & 0xF);
         const int idx = (frame_header >> 4) & 0x7;
 
@@ -53,24 +48,24 @@ std::vector<s16> DecodeADPCM(const u8* const data, std::size_t size, const ADPCM
             return static_cast<s16>(val);
         };
 
-        std::size_t outputi = framei * SAMPLES_PER_FRAME;
-        std::size_t datai = framei * FRAME_LEN + 1;
-        for (std::size_t i = 0; i < SAMPLES_PER_FRAME && outputi < sample_count; i += 2) {
-            const s16 sample1 = decode_sample(SIGNED_NIBBLES[data[datai] >> 4]);
-            ret[outputi] = sample1;
-            outputi++;
-
-            const s16 sample2 = decode_sample(SIGNED_NIBBLES[data[datai] & 0xF]);
-            ret[outputi] = sample2;
-            outputi++;
-
-            datai++;
+        for (std::size_t datai = 1; datai < ADPCM_FRAME_SIZE; datai++) {
+            output[0] = decode_sample(SIGNED_NIBBLES[frame[datai] >> 4]);
+            output[1] = decode_sample(SIGNED_NIBBLES[frame[datai] & 0xF]);
+            output += 2;
         }
     }
 
     state.yn1 = static_cast<s16>(yn1);
     state.yn2 = static_cast<s16>(yn2);
+}
 
+std::vector<s16> DecodeADPCM(const u8* const data, std::size_t size, const ADPCM_Coeff& coeff,
+                             ADPCMState& state) {
+    const std::size_t sample_count = GetADPCMSampleCount(size);
+    const std::size_t ret_size =
+        sample_count % 2 == 0 ? sample_count : sample_count + 1; // Ensure multiple of two.
+    std::vector<s16> ret(ret_size);
+    DecodeADPCM(data, size, coeff, state, ret.data());
     return ret;
 }
 
@@ -31,6 +31,28 @@ struct ADPCMState {
 
 using ADPCM_Coeff = std::array<s16, 16>;
 
+/// ADPCM frames are 8 bytes long, a header byte followed by 14 samples of 4 bits each.
+constexpr std::size_t ADPCM_FRAME_SIZE = 8;
+constexpr std::size_t ADPCM_SAMPLES_PER_FRAME = 14;
+
+/// Returns the number of samples decoded from size bytes of ADPCM data, a trailing partial frame
+/// is not decoded.
+constexpr std::size_t GetADPCMSampleCount(std::size_t size) {
+    return size / ADPCM_FRAME_SIZE * ADPCM_SAMPLES_PER_FRAME;
+}
+
+/**
+ * Decodes ADPCM data into a caller provided buffer. Large buffers can be decoded in several calls,
+ * as long as the splits are on frame boundaries.
+ * @param data Pointer to buffer that contains ADPCM data to decode
+ * @param size Size of buffer in bytes
+ * @param coeff ADPCM coefficients
+ * @param state ADPCM state, this is updated with new state
+ * @param output Receives GetADPCMSampleCount(size) decoded signed PCM16 samples
+ */
+void DecodeADPCM(const u8* data, std::size_t size, const ADPCM_Coeff& coeff, ADPCMState& state,
+                 s16* output);
+
 /**
  * @param data Pointer to buffer that contains ADPCM data to decode
  * @param size Size of buffer in bytes
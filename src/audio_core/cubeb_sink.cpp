@@ -3,13 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
-#include <atomic>
-#include <cstring>
+#include <memory>
 #include "audio_core/cubeb_sink.h"
+#include "audio_core/sink_buffer.h"
 #include "audio_core/stream.h"
-#include "audio_core/time_stretch.h"
 #include "common/logging/log.h"
-#include "common/ring_buffer.h"
 #include "core/settings.h"
 
 #ifdef _WIN32
@@ -22,8 +20,7 @@ class CubebSinkStream final : public SinkStream {
 public:
     CubebSinkStream(cubeb* ctx, u32 sample_rate, u32 num_channels_, cubeb_devid output_device,
                     const std::string& name)
-        : ctx{ctx}, num_channels{std::min(num_channels_, 2u)}, time_stretch{sample_rate,
-                                                                            num_channels} {
+        : ctx{ctx}, num_channels{std::min(num_channels_, 2u)} {
 
         cubeb_stream_params params{};
         params.rate = sample_rate;
@@ -35,9 +32,11 @@ public:
         if (cubeb_get_min_latency(ctx, &params, &minimum_latency) != CUBEB_OK) {
             LOG_CRITICAL(Audio_Sink, "Error getting minimum latency");
         }
+        const u32 latency{std::max(512u, minimum_latency)};
+        buffer = std::make_unique<SinkBuffer>(sample_rate, num_channels, latency);
 
         if (cubeb_stream_init(ctx, &stream_backend, name.c_str(), nullptr, nullptr, output_device,
-                              &params, std::max(512u, minimum_latency),
+                              &params, latency,
                               &CubebSinkStream::DataCallback, &CubebSinkStream::StateCallback,
                               this) != CUBEB_OK) {
             LOG_CRITICAL(Audio_Sink, "Error initializing cubeb stream");
@@ -62,32 +61,24 @@ public:
         cubeb_stream_destroy(stream_backend);
     }
 
-    void EnqueueSamples(u32 source_num_channels, const std::vector<s16>& samples) override {
-        if (source_num_channels > num_channels) {
-            // Downsample 6 channels to 2
-            std::vector<s16> buf;
-            buf.reserve(samples.size() * num_channels / source_num_channels);
-            for (std::size_t i = 0; i < samples.size(); i += source_num_channels) {
-                for (std::size_t ch = 0; ch < num_channels; ch++) {
-                    buf.push_back(samples[i + ch]);
-                }
-            }
-            queue.Push(buf);
-            return;
-        }
-
-        queue.Push(samples);
+    void EnqueueSamples(u32 source_num_channels, const s16* samples,
+                        std::size_t sample_count) override {
+        buffer->Push(source_num_channels, samples, sample_count);
     }
 
     std::size_t SamplesInQueue(u32 channel_count) const override {
         if (!ctx)
             return 0;
 
-        return queue.Size() / channel_count;
+        return buffer->QueuedFrames() * num_channels / channel_count;
     }
 
     void Flush() override {
-        should_flush = true;
+        buffer->Flush();
+    }
+
+    SinkStats GetStats() const override {
+        return buffer->GetStats();
     }
 
     u32 GetNumChannels() const {
@@ -101,10 +92,7 @@ private:
     cubeb_stream* stream_backend{};
     u32 num_channels{};
 
-    Common::RingBuffer<s16, 0x10000> queue;
-    std::array<s16, 2> last_frame{};
-    std::atomic<bool> should_flush{};
-    TimeStretcher time_stretch;
+    std::unique_ptr<SinkBuffer> buffer;
 
     static long DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
                              void* output_buffer, long num_frames);
@@ -169,42 +157,13 @@ SinkStream& CubebSink::AcquireSinkStream(u32 sample_rate, u32 num_channels,
 long CubebSinkStream::DataCallback(cubeb_stream* stream, void* user_data, const void* input_buffer,
                                    void* output_buffer, long num_frames) {
     CubebSinkStream* impl = static_cast<CubebSinkStream*>(user_data);
-    u8* buffer = reinterpret_cast<u8*>(output_buffer);
 
     if (!impl) {
         return {};
     }
 
-    const std::size_t num_channels = impl->GetNumChannels();
-    const std::size_t samples_to_write = num_channels * num_frames;
-    std::size_t samples_written;
-
-    if (Settings::values.enable_audio_stretching) {
-        const std::vector<s16> in{impl->queue.Pop()};
-        const std::size_t num_in{in.size() / num_channels};
-        s16* const out{reinterpret_cast<s16*>(buffer)};
-        const std::size_t out_frames =
-            impl->time_stretch.Process(in.data(), num_in, out, num_frames);
-        samples_written = out_frames * num_channels;
-
-        if (impl->should_flush) {
-            impl->time_stretch.Flush();
-            impl->should_flush = false;
-        }
-    } else {
-        samples_written = impl->queue.Pop(buffer, samples_to_write);
-    }
-
-    if (samples_written >= num_channels) {
-        std::memcpy(&impl->last_frame[0], buffer + (samples_written - num_channels) * sizeof(s16),
-                    num_channels * sizeof(s16));
-    }
-
-    // Fill the rest of the frames with last_frame
-    for (std::size_t i = samples_written; i < samples_to_write; i += num_channels) {
-        std::memcpy(buffer + i * sizeof(s16), &impl->last_frame[0], num_channels * sizeof(s16));
-    }
-
+    impl->buffer->Pop(static_cast<s16*>(output_buffer), static_cast<std::size_t>(num_frames),
+                      Settings::values.enable_audio_stretching);
     return num_frames;
 }
 
@@ -4,30 +4,69 @@
 
 #pragma once
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 #include "audio_core/sink.h"
+#include "audio_core/sink_buffer.h"
 
 namespace AudioCore {
 
+/**
+ * Sink discarding the samples. They still go through a SinkBuffer, played as soon as they are
+ * queued, so the null sink reports the same statistics and costs as the real ones.
+ */
 class NullSink final : public Sink {
 public:
     explicit NullSink(std::string_view) {}
     ~NullSink() override = default;
 
-    SinkStream& AcquireSinkStream(u32 /*sample_rate*/, u32 /*num_channels*/,
+    SinkStream& AcquireSinkStream(u32 sample_rate, u32 num_channels,
                                   const std::string& /*name*/) override {
-        return null_sink_stream;
+        sink_streams.push_back(std::make_unique<NullSinkStreamImpl>(sample_rate, num_channels));
+        return *sink_streams.back();
     }
 
 private:
     struct NullSinkStreamImpl final : SinkStream {
-        void EnqueueSamples(u32 /*num_channels*/, const std::vector<s16>& /*samples*/) override {}
+        /// Smallest number of frames played at once, matching the renderer's buffers
+        static constexpr u32 MinLatency = 512;
+
+        NullSinkStreamImpl(u32 sample_rate, u32 num_channels_)
+            : num_channels{std::min(num_channels_, 2u)}, buffer{sample_rate, num_channels,
+                                                               MinLatency} {}
+
+        void EnqueueSamples(u32 source_num_channels, const s16* samples,
+                            std::size_t sample_count) override {
+            buffer.Push(source_num_channels, samples, sample_count);
+
+            const std::size_t num_frames = buffer.QueuedFrames();
+            if (num_frames == 0) {
+                return;
+            }
+            output.resize(num_frames * num_channels);
+            buffer.Pop(output.data(), num_frames, false);
+        }
 
         std::size_t SamplesInQueue(u32 /*num_channels*/) const override {
-            return 0;
+            return buffer.QueuedFrames();
         }
 
-        void Flush() override {}
-    } null_sink_stream;
+        void Flush() override {
+            buffer.Flush();
+        }
+
+        SinkStats GetStats() const override {
+            return buffer.GetStats();
+        }
+
+        const u32 num_channels;
+        SinkBuffer buffer;
+        std::vector<s16> output; ///< Discarded samples
+    };
+
+    std::vector<std::unique_ptr<NullSinkStreamImpl>> sink_streams;
 };
 
 } // namespace AudioCore
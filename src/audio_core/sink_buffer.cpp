@@ -0,0 +1,178 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "audio_core/sink_buffer.h"
+#include "common/assert.h"
+#include "common/logging/log.h"
+
+namespace AudioCore {
+
+namespace {
+
+/// Frames fed to the time stretcher at once
+constexpr std::size_t StretchChunkFrames = 1024;
+
+/// Playing this many seconds without an underrun lowers the target queue depth
+constexpr u32 RelaxSeconds = 5;
+
+/// Smoothing of the tempo changes, applied once per output callback
+constexpr double TempoSmoothing = 0.1;
+
+} // Anonymous namespace
+
+SinkBuffer::SinkBuffer(u32 sample_rate, u32 num_channels, u32 min_latency)
+    : sample_rate{sample_rate}, num_channels{num_channels},
+      min_target_frames{std::max(min_latency * 2, sample_rate / 100)},
+      max_target_frames{std::max(min_target_frames, sample_rate / 4)},
+      time_stretch{sample_rate, num_channels}, stretch_input(StretchChunkFrames * num_channels) {
+    ASSERT(num_channels == 1 || num_channels == 2);
+    target_frames = min_target_frames;
+}
+
+SinkBuffer::~SinkBuffer() {
+    const SinkStats stats{GetStats()};
+    LOG_DEBUG(Audio_Sink, "{} underruns, {} stretched frames, {} target frames", stats.underruns,
+              stats.stretched_frames, stats.target_frames);
+}
+
+void SinkBuffer::Push(u32 source_num_channels, const s16* samples, std::size_t sample_count) {
+    // Only whole frames are queued, a split frame would swap the channels of the following ones
+    const std::size_t free_frames{(queue.Capacity() - queue.Size()) / num_channels};
+    const std::size_t num_frames{std::min(sample_count / source_num_channels, free_frames)};
+    if (num_frames == 0) {
+        return;
+    }
+    is_flushed = false;
+
+    if (source_num_channels == num_channels) {
+        queue.Push(samples, num_frames * num_channels);
+        return;
+    }
+
+    // Drop the extra channels, e.g. downsample 6 channels to 2, through a small staging buffer
+    std::array<s16, 512> staging;
+    const std::size_t frames_per_push{staging.size() / num_channels};
+    for (std::size_t frame = 0; frame < num_frames; frame += frames_per_push) {
+        const std::size_t count{std::min(frames_per_push, num_frames - frame)};
+        for (std::size_t i = 0; i < count; ++i) {
+            const s16* const source{samples + (frame + i) * source_num_channels};
+            std::copy_n(source, num_channels, staging.data() + i * num_channels);
+        }
+        queue.Push(staging.data(), count * num_channels);
+    }
+}
+
+void SinkBuffer::Flush() {
+    is_flushed = true;
+}
+
+void SinkBuffer::Pop(s16* output, std::size_t num_frames, bool allow_stretching) {
+    const std::size_t queued{QueuedFrames()};
+    queued_frames = static_cast<u32>(queued);
+    UpdateTarget(queued, num_frames);
+
+    const u32 target{target_frames};
+    const bool is_drifting{queued > target * 2 || queued * 2 < target};
+    const bool is_settled{queued * 4 >= target * 3 && queued * 2 <= target * 3};
+
+    std::size_t frames_written{};
+    if (is_stretching || (allow_stretching && is_drifting && !is_flushed)) {
+        frames_written = PopStretched(output, num_frames, queued, allow_stretching && !is_settled);
+    }
+    if (!is_stretching && frames_written < num_frames) {
+        const std::size_t samples_popped{queue.Pop(output + frames_written * num_channels,
+                                                   (num_frames - frames_written) * num_channels)};
+        frames_written += samples_popped / num_channels;
+    }
+
+    if (frames_written > 0) {
+        std::memcpy(last_frame.data(), output + (frames_written - 1) * num_channels,
+                    num_channels * sizeof(s16));
+    }
+
+    // Fill the rest of the frames with last_frame
+    for (std::size_t frame = frames_written; frame < num_frames; ++frame) {
+        std::memcpy(output + frame * num_channels, last_frame.data(), num_channels * sizeof(s16));
+    }
+}
+
+SinkStats SinkBuffer::GetStats() const {
+    SinkStats stats;
+    stats.underruns = underruns;
+    stats.stretched_frames = stretched_frames;
+    stats.queued_frames = queued_frames;
+    stats.target_frames = target_frames;
+    return stats;
+}
+
+void SinkBuffer::UpdateTarget(std::size_t queued, std::size_t num_frames) {
+    const u32 step{min_target_frames / 2};
+    u32 target{target_frames};
+    if (queued < num_frames && !is_flushed) {
+        ++underruns;
+        frames_since_underrun = 0;
+        target = std::min(target + step, max_target_frames);
+    } else {
+        frames_since_underrun += num_frames;
+        if (frames_since_underrun >= sample_rate * RelaxSeconds) {
+            frames_since_underrun = 0;
+            target = std::max(target - std::min(target, step), min_target_frames);
+        }
+    }
+    if (target != target_frames) {
+        LOG_DEBUG(Audio_Sink, "Target latency changed to {} frames", target);
+        target_frames = target;
+    }
+}
+
+std::size_t SinkBuffer::PopStretched(s16* output, std::size_t num_frames, std::size_t queued,
+                                     bool keep_stretching) {
+    if (!keep_stretching) {
+        // Play what was already stretched, then pass the queue through again. The input still
+        // buffered in the time stretcher is dropped.
+        const std::size_t frames_written{time_stretch.ReceiveSamples(output, num_frames)};
+        stretched_frames += frames_written;
+        if (frames_written < num_frames) {
+            time_stretch.Clear();
+            tempo = 1.0;
+            is_stretching = false;
+        }
+        return frames_written;
+    }
+    is_stretching = true;
+
+    // Above the target the queue is played faster, below it slower
+    const double target_tempo{
+        std::clamp(static_cast<double>(queued) / std::max<u32>(target_frames, 1), 0.5, 2.0)};
+    tempo += (target_tempo - tempo) * TempoSmoothing;
+    time_stretch.SetTempo(tempo);
+
+    const std::size_t chunk_frames{std::clamp<std::size_t>(
+        static_cast<std::size_t>(std::ceil(num_frames * tempo)), 1, StretchChunkFrames)};
+    while (time_stretch.GetOutputFrames() < num_frames) {
+        const std::size_t samples_popped{
+            queue.Pop(stretch_input.data(), chunk_frames * num_channels)};
+        if (samples_popped == 0) {
+            break;
+        }
+        time_stretch.PutSamples(stretch_input.data(), samples_popped / num_channels);
+    }
+    if (is_flushed && !is_stretch_flushed) {
+        // Nothing else is coming, push the input held by the time stretcher out
+        time_stretch.Flush();
+        is_stretch_flushed = true;
+    } else if (!is_flushed) {
+        is_stretch_flushed = false;
+    }
+
+    const std::size_t frames_written{time_stretch.ReceiveSamples(output, num_frames)};
+    stretched_frames += frames_written;
+    return frames_written;
+}
+
+} // namespace AudioCore
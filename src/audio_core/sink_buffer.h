@@ -0,0 +1,80 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "audio_core/sink_stream.h"
+#include "audio_core/time_stretch.h"
+#include "common/common_types.h"
+#include "common/ring_buffer.h"
+
+namespace AudioCore {
+
+/**
+ * Queues samples between the emulation, which produces them, and the audio callback of a sink,
+ * which consumes them. The buffer adapts the queue depth it aims for: underruns raise it and it
+ * is lowered again after playing long enough without one. Time stretching only runs while the
+ * queue drifts away from that target, samples are passed through untouched otherwise.
+ */
+class SinkBuffer {
+public:
+    /// @param sample_rate Sample rate of the stream.
+    /// @param num_channels Number of channels played, one or two.
+    /// @param min_latency Smallest number of frames requested by the sink at once.
+    SinkBuffer(u32 sample_rate, u32 num_channels, u32 min_latency);
+    ~SinkBuffer();
+
+    /// Queues interleaved samples, channels past the played ones are dropped. Producer only.
+    void Push(u32 source_num_channels, const s16* samples, std::size_t sample_count);
+
+    /// Tells that no samples are queued until playback resumes, so running dry is not an underrun.
+    void Flush();
+
+    /// Writes num_frames frames to output, the last frame is repeated when the queue runs dry.
+    /// Consumer only.
+    void Pop(s16* output, std::size_t num_frames, bool allow_stretching);
+
+    std::size_t QueuedFrames() const {
+        return queue.Size() / num_channels;
+    }
+
+    SinkStats GetStats() const;
+
+private:
+    /// Updates the target queue depth from the frames queued when the sink asks for num_frames.
+    void UpdateTarget(std::size_t queued, std::size_t num_frames);
+
+    /// Plays queued frames through the time stretcher, returns the number of frames written.
+    std::size_t PopStretched(s16* output, std::size_t num_frames, std::size_t queued,
+                             bool keep_stretching);
+
+    const u32 sample_rate;
+    const u32 num_channels;
+    const u32 min_target_frames;
+    const u32 max_target_frames;
+
+    Common::RingBuffer<s16, 0x10000> queue;
+    TimeStretcher time_stretch;
+    std::vector<s16> stretch_input; ///< Frames moved from the queue to the time stretcher
+    std::array<s16, 2> last_frame{};
+
+    // Consumer state
+    bool is_stretching = false;
+    bool is_stretch_flushed = false;
+    double tempo = 1.0;
+    u64 frames_since_underrun = 0;
+
+    std::atomic_bool is_flushed{true};
+    std::atomic<u64> underruns{};
+    std::atomic<u64> stretched_frames{};
+    std::atomic<u32> queued_frames{};
+    std::atomic<u32> target_frames{};
+};
+
+} // namespace AudioCore
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -11,6 +12,14 @@
 
 namespace AudioCore {
 
+/// Playback counters of a sink stream
+struct SinkStats {
+    u64 underruns{};        ///< Times the output ran out of samples while playing
+    u64 stretched_frames{}; ///< Frames played while time stretching
+    u32 queued_frames{};    ///< Frames queued at the last output callback
+    u32 target_frames{};    ///< Queue depth the stream aims for
+};
+
 /**
  * Accepts samples in stereo signed PCM16 format to be output. Sinks *do not* handle resampling and
  * expect the correct sample rate. They are dumb outputs.
@@ -23,12 +32,22 @@ public:
      * Feed stereo samples to sink.
      * @param num_channels Number of channels used.
      * @param samples Samples in interleaved stereo PCM16 format.
+     * @param sample_count Number of samples, a multiple of num_channels.
      */
-    virtual void EnqueueSamples(u32 num_channels, const std::vector<s16>& samples) = 0;
+    virtual void EnqueueSamples(u32 num_channels, const s16* samples, std::size_t sample_count) = 0;
+
+    void EnqueueSamples(u32 num_channels, const std::vector<s16>& samples) {
+        EnqueueSamples(num_channels, samples.data(), samples.size());
+    }
 
     virtual std::size_t SamplesInQueue(u32 num_channels) const = 0;
 
     virtual void Flush() = 0;
+
+    /// Returns the playback counters, sinks that don't play anything report zeroes.
+    virtual SinkStats GetStats() const {
+        return {};
+    }
 };
 
 using SinkStreamPtr = std::unique_ptr<SinkStream>;
@@ -42,12 +42,15 @@ Stream::Stream(Core::Timing::CoreTiming& core_timing, u32 sample_rate, Format fo
 }
 
 void Stream::Play() {
+    std::lock_guard lock{mutex};
     state = State::Playing;
     PlayNextBuffer();
 }
 
 void Stream::Stop() {
+    std::lock_guard lock{mutex};
     state = State::Stopped;
+    LogSinkStats();
     UNIMPLEMENTED();
 }
 
@@ -59,6 +62,12 @@ Stream::State Stream::GetState() const {
     return state;
 }
 
+void Stream::LogSinkStats() const {
+    const SinkStats stats{sink_stream.GetStats()};
+    LOG_INFO(Audio, "Stream {}: {} underruns, {} stretched frames, target depth {} frames",
+             name, stats.underruns, stats.stretched_frames, stats.target_frames);
+}
+
 s64 Stream::GetBufferReleaseCycles(const Buffer& buffer) const {
     const std::size_t num_samples{buffer.GetSamples().size() / GetNumChannels()};
     const auto us =
@@ -103,12 +112,14 @@ void Stream::PlayNextBuffer() {
 
     VolumeAdjustSamples(active_buffer->GetSamples(), game_volume);
 
-    sink_stream.EnqueueSamples(GetNumChannels(), active_buffer->GetSamples());
+    const auto& samples{active_buffer->GetSamples()};
+    sink_stream.EnqueueSamples(GetNumChannels(), samples.data(), samples.size());
 
     core_timing.ScheduleEvent(GetBufferReleaseCycles(*active_buffer), release_event, {});
 }
 
 void Stream::ReleaseActiveBuffer() {
+    std::lock_guard lock{mutex};
     ASSERT(active_buffer);
     released_buffers.push(std::move(active_buffer));
     release_callback();
@@ -116,6 +127,7 @@ void Stream::ReleaseActiveBuffer() {
 }
 
 bool Stream::QueueBuffer(BufferPtr&& buffer) {
+    std::lock_guard lock{mutex};
     if (queued_buffers.size() < MaxAudioBufferCount) {
         queued_buffers.push(std::move(buffer));
         PlayNextBuffer();
@@ -130,6 +142,7 @@ bool Stream::ContainsBuffer(Buffer::Tag tag) const {
 }
 
 std::vector<Buffer::Tag> Stream::GetTagsAndReleaseBuffers(std::size_t max_count) {
+    std::lock_guard lock{mutex};
     std::vector<Buffer::Tag> tags;
     for (std::size_t count = 0; count < max_count && !released_buffers.empty(); ++count) {
         tags.push_back(released_buffers.front()->GetTag());
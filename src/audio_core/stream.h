@@ -6,6 +6,7 @@
 
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 #include <queue>
@@ -52,7 +53,8 @@ public:
     /// Stops the audio stream
     void Stop();
 
-    /// Queues a buffer into the audio stream, returns true on success
+    /// Queues a buffer into the audio stream, returns true on success. Can be called from any
+    /// thread, e.g. by a renderer mixing its buffers off the emulated CPU.
     bool QueueBuffer(BufferPtr&& buffer);
 
     /// Returns true if the audio stream contains a buffer with the specified tag
@@ -74,6 +76,7 @@ public:
 
     /// Returns the number of queued buffers
     std::size_t GetQueueSize() const {
+        std::lock_guard lock{mutex};
         return queued_buffers.size();
     }
 
@@ -88,8 +91,12 @@ public:
     /// Get the state
     State GetState() const;
 
+    /// Logs the playback counters of the sink stream, called when the stream ends
+    void LogSinkStats() const;
+
 private:
-    /// Plays the next queued buffer in the audio stream, starting playback if necessary
+    /// Plays the next queued buffer in the audio stream, starting playback if necessary. Has to be
+    /// called with the mutex held.
     void PlayNextBuffer();
 
     /// Releases the actively playing buffer, signalling that it has been completed
@@ -104,6 +111,7 @@ private:
     ReleaseCallback release_callback;         ///< Buffer release callback for the stream
     State state{State::Stopped};              ///< Playback state of the stream
     Core::Timing::EventType* release_event{}; ///< Core timing release event for the stream
+    mutable std::mutex mutex;                 ///< Guards the buffers and the playback state
     BufferPtr active_buffer;                  ///< Actively playing buffer in the stream
     std::queue<BufferPtr> queued_buffers;     ///< Buffers queued to be played in the stream
     std::queue<BufferPtr> released_buffers;   ///< Buffers recently released from the stream
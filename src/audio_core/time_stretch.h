@@ -14,21 +14,28 @@ class TimeStretcher {
 public:
     TimeStretcher(u32 sample_rate, u32 channel_count);
 
+    /// Sets the speed the input is played at, above 1.0 the input is consumed faster than it is
+    /// played. The pitch is kept.
+    void SetTempo(double tempo);
+
     /// @param in       Input sample buffer
     /// @param num_in   Number of input frames in `in`
+    void PutSamples(const s16* in, std::size_t num_in);
+
     /// @param out      Output sample buffer
-    /// @param num_out  Desired number of output frames in `out`
+    /// @param num_out  Maximum number of output frames in `out`
     /// @returns Actual number of frames written to `out`
-    std::size_t Process(const s16* in, std::size_t num_in, s16* out, std::size_t num_out);
+    std::size_t ReceiveSamples(s16* out, std::size_t num_out);
+
+    /// Returns the number of stretched frames ready to be received
+    std::size_t GetOutputFrames() const;
 
     void Clear();
 
     void Flush();
 
 private:
-    u32 m_sample_rate;
     soundtouch::SoundTouch m_sound_touch;
-    double m_stretch_ratio = 1.0;
 };
 
 } // namespace AudioCore
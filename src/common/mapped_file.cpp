@@ -0,0 +1,119 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "common/logging/log.h"
+#include "common/mapped_file.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include "common/string_util.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Common {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+    const HANDLE file =
+        CreateFileW(UTF8ToUTF16W(path).c_str(), GENERIC_READ,
+                    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING,
+                    FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return;
+    }
+    LARGE_INTEGER file_size{};
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        mapping_handle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    // The mapping keeps the file open
+    CloseHandle(file);
+    if (mapping_handle == nullptr) {
+        return;
+    }
+    data = static_cast<u8*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (data == nullptr) {
+        LOG_WARNING(Common_Filesystem, "Failed to map {}: {}", path, GetLastErrorMsg());
+        CloseHandle(mapping_handle);
+        mapping_handle = nullptr;
+        return;
+    }
+    size = static_cast<std::size_t>(file_size.QuadPart);
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        UnmapViewOfFile(data);
+        CloseHandle(mapping_handle);
+    }
+}
+
+void MappedFile::Advise(std::size_t offset, std::size_t length, Access access) const {
+    // Windows only takes prefetch requests, which need Windows 8, the hints are ignored
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+    struct stat file_stat {};
+    if (fstat(fd, &file_stat) == 0 && file_stat.st_size > 0) {
+        void* const mapping = mmap(nullptr, static_cast<std::size_t>(file_stat.st_size), PROT_READ,
+                                   MAP_SHARED, fd, 0);
+        if (mapping != MAP_FAILED) {
+            data = static_cast<u8*>(mapping);
+            size = static_cast<std::size_t>(file_stat.st_size);
+        } else {
+            LOG_WARNING(Common_Filesystem, "Failed to map {}: {}", path, GetLastErrorMsg());
+        }
+    }
+    // The mapping keeps the file open
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data != nullptr) {
+        munmap(data, size);
+    }
+}
+
+void MappedFile::Advise(std::size_t offset, std::size_t length, Access access) const {
+    if (data == nullptr || offset >= size || length == 0) {
+        return;
+    }
+    // madvise takes page aligned addresses
+    static const std::size_t page_size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    const std::size_t begin = offset & ~(page_size - 1);
+    const std::size_t end = std::min(offset + length, size);
+
+    int advice = MADV_NORMAL;
+    switch (access) {
+    case Access::Normal:
+        advice = MADV_NORMAL;
+        break;
+    case Access::Sequential:
+        advice = MADV_SEQUENTIAL;
+        break;
+    case Access::Random:
+        advice = MADV_RANDOM;
+        break;
+    case Access::WillNeed:
+        advice = MADV_WILLNEED;
+        break;
+    }
+    madvise(data + begin, end - begin, advice);
+}
+
+#endif
+
+} // namespace Common
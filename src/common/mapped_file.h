@@ -0,0 +1,56 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+
+namespace Common {
+
+// A read-only memory mapping of a whole file. Its pages are loaded by the OS on demand, so reads
+// don't go through a system call each and can be done from several threads at once. The file
+// must not be truncated while it's mapped, reading pages past its new end faults, so only files
+// which aren't modified in place (e.g. game images) should be mapped.
+class MappedFile : NonCopyable {
+public:
+    // Access patterns a range of the file can be hinted with.
+    enum class Access {
+        Normal,
+        Sequential,
+        Random,
+        WillNeed,
+    };
+
+    // Maps the file at path, IsOpen returns false when it can't be mapped (e.g. it's empty).
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    bool IsOpen() const {
+        return data != nullptr;
+    }
+
+    const u8* Data() const {
+        return data;
+    }
+
+    std::size_t Size() const {
+        return size;
+    }
+
+    // Hints the OS about how a range of the file is going to be accessed.
+    void Advise(std::size_t offset, std::size_t length, Access access) const;
+
+private:
+    u8* data = nullptr;
+    std::size_t size = 0;
+#ifdef _WIN32
+    void* mapping_handle = nullptr;
+#endif
+};
+
+} // namespace Common
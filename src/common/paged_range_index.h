@@ -0,0 +1,318 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Reusable storage for the results of range queries that have to be copied out, e.g. because the
+ * index is modified while they are walked. The results borrow the storage while they are alive
+ * and give it back afterwards, results of nested queries get storage of their own.
+ */
+template <typename T>
+class QueryBuffer {
+public:
+    class Results {
+    public:
+        template <typename Range>
+        Results(QueryBuffer& buffer_, const Range& range)
+            : buffer{buffer_}, values{std::move(buffer_.storage)} {
+            values.assign(range.begin(), range.end());
+        }
+
+        ~Results() {
+            // Drop the references to the values, but keep the largest storage around
+            values.clear();
+            if (values.capacity() > buffer.storage.capacity()) {
+                buffer.storage = std::move(values);
+            }
+        }
+
+        Results(const Results&) = delete;
+        Results& operator=(const Results&) = delete;
+
+        std::vector<T>& operator*() {
+            return values;
+        }
+
+        std::vector<T>* operator->() {
+            return &values;
+        }
+
+    private:
+        QueryBuffer& buffer;
+        std::vector<T> values;
+    };
+
+private:
+    std::vector<T> storage;
+};
+
+/**
+ * A PagedRangeIndex stores values associated to half-open address ranges and answers which of them
+ * overlap a given range. It has the following characteristics:
+ * - entries are bucketed by pages of 2^PageBits bytes, each entry is stored in every page it spans
+ * - range queries are iterator based and report every overlapping value exactly once, without
+ *   allocating or marking the stored values
+ * - buckets left empty by a removal are erased, so the index doesn't grow as addresses churn
+ * Values are compared with operator== on removal, multiple values may share the same range.
+ */
+template <typename T, std::size_t PageBits>
+class PagedRangeIndex {
+    struct Entry {
+        u64 start;
+        u64 end;
+        T value;
+    };
+
+    using Bucket = std::vector<Entry>;
+    using BucketMap = std::unordered_map<u64, Bucket>;
+
+public:
+    using value_type = T;
+    using reference = const T&;
+    using pointer = const T*;
+    using size_type = std::size_t;
+
+    static constexpr u64 PAGE_BITS = PageBits;
+    static constexpr u64 PAGE_SIZE = 1ULL << PageBits;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using pointer = const T*;
+        using reference = const T&;
+        using difference_type = std::ptrdiff_t;
+
+        const_iterator() = default;
+
+        friend bool operator==(const const_iterator& lhs, const const_iterator& rhs) {
+            return lhs.bucket == rhs.bucket && lhs.position == rhs.position;
+        }
+
+        friend bool operator!=(const const_iterator& lhs, const const_iterator& rhs) {
+            return !operator==(lhs, rhs);
+        }
+
+        reference operator*() const {
+            return (*bucket)[position].value;
+        }
+
+        pointer operator->() const {
+            return &(*bucket)[position].value;
+        }
+
+        /// Returns the range the current value was registered with
+        std::pair<u64, u64> GetRange() const {
+            const Entry& entry = (*bucket)[position];
+            return {entry.start, entry.end};
+        }
+
+        const_iterator& operator++() {
+            ++position;
+            Settle();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const const_iterator v{*this};
+            ++(*this);
+            return v;
+        }
+
+    private:
+        friend class PagedRangeIndex;
+
+        const_iterator(const BucketMap& buckets, u64 start, u64 end)
+            : buckets{&buckets}, query_start{start}, query_end{end}, first_page{start >> PageBits},
+              last_page{(end - 1) >> PageBits} {
+            // Walk the bucket map instead of every page when the query is larger than the index
+            walk_map = last_page - first_page >= static_cast<u64>(buckets.size());
+            if (walk_map) {
+                map_it = buckets.begin();
+            } else {
+                page = first_page;
+            }
+            NextBucket();
+            Settle();
+        }
+
+        /// Points to the next non-empty bucket inside the query, or to the end
+        void NextBucket() {
+            position = 0;
+            bucket = nullptr;
+            if (walk_map) {
+                for (; map_it != buckets->end(); ++map_it) {
+                    if (map_it->first < first_page || map_it->first > last_page ||
+                        map_it->second.empty()) {
+                        continue;
+                    }
+                    bucket_page = map_it->first;
+                    bucket = &map_it->second;
+                    ++map_it;
+                    return;
+                }
+                return;
+            }
+            for (; page <= last_page && page >= first_page; ++page) {
+                const auto it = buckets->find(page);
+                if (it == buckets->end() || it->second.empty()) {
+                    continue;
+                }
+                bucket_page = page++;
+                bucket = &it->second;
+                return;
+            }
+        }
+
+        /// Skips entries that don't overlap or that have already been reported by a lower page
+        void Settle() {
+            while (bucket) {
+                for (; position < bucket->size(); ++position) {
+                    const Entry& entry = (*bucket)[position];
+                    if (entry.start >= query_end || entry.end <= query_start) {
+                        continue;
+                    }
+                    if (std::max(entry.start >> PageBits, first_page) == bucket_page) {
+                        return;
+                    }
+                }
+                NextBucket();
+            }
+        }
+
+        const BucketMap* buckets{};
+        typename BucketMap::const_iterator map_it{};
+        const Bucket* bucket{};
+        std::size_t position{};
+        u64 query_start{};
+        u64 query_end{};
+        u64 first_page{};
+        u64 last_page{};
+        u64 page{};
+        u64 bucket_page{};
+        bool walk_map{};
+    };
+
+    /// Iterable range of values returned by a query
+    class Range {
+    public:
+        const_iterator begin() const {
+            return first;
+        }
+
+        const_iterator end() const {
+            return {};
+        }
+
+        bool empty() const {
+            return first == const_iterator{};
+        }
+
+    private:
+        friend class PagedRangeIndex;
+
+        explicit Range(const_iterator first) : first{first} {}
+
+        const_iterator first;
+    };
+
+    /// Registers a value in the [start, end) range. Empty ranges are ignored.
+    void Insert(u64 start, u64 end, const T& value) {
+        if (start >= end) {
+            return;
+        }
+        for (u64 page = start >> PageBits; page <= (end - 1) >> PageBits; ++page) {
+            buckets[page].push_back({start, end, value});
+        }
+        ++num_values;
+    }
+
+    /// Removes a value previously registered with the same range. Returns true when found.
+    bool Erase(u64 start, u64 end, const T& value) {
+        if (start >= end) {
+            return false;
+        }
+        bool found = false;
+        for (u64 page = start >> PageBits; page <= (end - 1) >> PageBits; ++page) {
+            const auto it = buckets.find(page);
+            if (it == buckets.end()) {
+                continue;
+            }
+            Bucket& bucket = it->second;
+            const auto entry = std::find_if(bucket.begin(), bucket.end(), [&](const Entry& e) {
+                return e.start == start && e.end == end && e.value == value;
+            });
+            if (entry == bucket.end()) {
+                continue;
+            }
+            if (entry != std::prev(bucket.end())) {
+                *entry = std::move(bucket.back());
+            }
+            bucket.pop_back();
+            if (bucket.empty()) {
+                buckets.erase(it);
+            }
+            found = true;
+        }
+        if (found) {
+            --num_values;
+        }
+        return found;
+    }
+
+    /// Returns the values overlapping [start, end), each one once and in no particular order.
+    Range Query(u64 start, u64 end) const {
+        if (start >= end) {
+            return Range{const_iterator{}};
+        }
+        return Range{const_iterator{buckets, start, end}};
+    }
+
+    /// Copies the values overlapping [start, end) to the storage of a reusable buffer.
+    typename QueryBuffer<T>::Results Collect(QueryBuffer<T>& buffer, u64 start, u64 end) const {
+        return typename QueryBuffer<T>::Results{buffer, Query(start, end)};
+    }
+
+    /// Returns all the values in the index
+    Range All() const {
+        return Range{const_iterator{buckets, 0, ~0ULL}};
+    }
+
+    /// Removes all the values
+    void Clear() {
+        buckets.clear();
+        num_values = 0;
+    }
+
+    size_type Size() const {
+        return num_values;
+    }
+
+    /// Returns the number of pages holding at least one value
+    size_type NumPages() const {
+        return buckets.size();
+    }
+
+    bool Empty() const {
+        return num_values == 0;
+    }
+
+private:
+    BucketMap buckets;
+    size_type num_values{};
+};
+
+} // namespace Common
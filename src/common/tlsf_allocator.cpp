@@ -0,0 +1,231 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/bit_util.h"
+#include "common/tlsf_allocator.h"
+
+namespace Common {
+
+TLSFAllocator::TLSFAllocator(u64 size_) : size{AlignDown(size_, Granularity)} {
+    ASSERT(size >= Granularity);
+    free_lists.fill(InvalidBlock);
+
+    const u32 index = CreateNode();
+    blocks[index] = {0, size, InvalidBlock, InvalidBlock, InvalidBlock, InvalidBlock, true};
+    InsertFreeBlock(index);
+}
+
+TLSFAllocator::~TLSFAllocator() = default;
+
+std::optional<TLSFAllocator::Allocation> TLSFAllocator::Allocate(u64 alloc_size, u64 alignment) {
+    ASSERT_MSG(alignment == 0 || (alignment & (alignment - 1)) == 0,
+               "Alignment={} is not a power of two", alignment);
+    alloc_size = AlignUp(std::max<u64>(alloc_size, 1), Granularity);
+    alignment = std::max(alignment, Granularity);
+
+    // Blocks always start at a multiple of the granularity, so a larger alignment may require to
+    // skip up to alignment - Granularity bytes at the beginning of the block
+    const u64 padding = alignment - Granularity;
+    if (alloc_size > size || padding > size - alloc_size) {
+        return std::nullopt;
+    }
+    u32 index = FindFreeBlock(alloc_size + padding);
+    if (index == InvalidBlock) {
+        return std::nullopt;
+    }
+    RemoveFreeBlock(index);
+
+    const u64 gap = AlignUp(blocks[index].offset, alignment) - blocks[index].offset;
+    if (gap != 0) {
+        const u32 front = SplitFront(index, gap);
+        InsertFreeBlock(front);
+    }
+    if (blocks[index].size - alloc_size >= Granularity) {
+        // The block is split again, the allocation takes its front and the back stays free
+        const u32 allocated = SplitFront(index, alloc_size);
+        InsertFreeBlock(index);
+        index = allocated;
+    }
+
+    Block& block = blocks[index];
+    block.is_free = false;
+    used_bytes += block.size;
+    ++num_allocations;
+    return Allocation{block.offset, index};
+}
+
+void TLSFAllocator::Free(u32 handle) {
+    ASSERT(handle < blocks.size() && !blocks[handle].is_free);
+    u32 index = handle;
+    blocks[index].is_free = true;
+    used_bytes -= blocks[index].size;
+    --num_allocations;
+
+    const u32 next = blocks[index].next_physical;
+    if (next != InvalidBlock && blocks[next].is_free) {
+        RemoveFreeBlock(next);
+        MergeNext(index);
+    }
+    const u32 prev = blocks[index].prev_physical;
+    if (prev != InvalidBlock && blocks[prev].is_free) {
+        RemoveFreeBlock(prev);
+        MergeNext(prev);
+        index = prev;
+    }
+    InsertFreeBlock(index);
+}
+
+TLSFAllocator::Stats TLSFAllocator::GetStats() const {
+    Stats stats;
+    stats.size = size;
+    stats.used_bytes = used_bytes;
+    stats.num_allocations = num_allocations;
+    stats.num_free_blocks = blocks.size() - unused_nodes.size() - num_allocations;
+
+    if (first_level_bitmap != 0) {
+        // Only the largest non-empty size class can hold the largest block
+        const u32 first = MostSignificantBit64(first_level_bitmap);
+        const u32 second = MostSignificantBit32(second_level_bitmaps[first]);
+        for (u32 index = free_lists[first * SecondLevelCount + second]; index != InvalidBlock;
+             index = blocks[index].next_free) {
+            stats.largest_free_block = std::max(stats.largest_free_block, blocks[index].size);
+        }
+    }
+    return stats;
+}
+
+TLSFAllocator::Mapping TLSFAllocator::MapInsert(u64 block_size) {
+    const u32 first = MostSignificantBit64(block_size);
+    const u32 second =
+        static_cast<u32>(block_size >> (first - SecondLevelBits)) & (SecondLevelCount - 1);
+    return {first, second};
+}
+
+TLSFAllocator::Mapping TLSFAllocator::MapSearch(u64 block_size) {
+    // Round up to the next size class, so any block in the class is large enough
+    const u32 first = MostSignificantBit64(block_size);
+    const u64 round = (1ULL << (first - SecondLevelBits)) - 1;
+    return MapInsert(block_size + round);
+}
+
+u32 TLSFAllocator::FindFreeBlock(u64 block_size) const {
+    const Mapping mapping = MapSearch(block_size);
+    if (mapping.first < FirstLevelCount) {
+        u32 first = mapping.first;
+        u32 second_bitmap = second_level_bitmaps[first] & (~0U << mapping.second);
+        if (second_bitmap == 0) {
+            // Nothing in this class, take the smallest class of the next non-empty first level
+            const u64 first_bitmap =
+                first + 1 < FirstLevelCount ? first_level_bitmap & (~0ULL << (first + 1)) : 0;
+            first = first_bitmap != 0 ? CountTrailingZeroes64(first_bitmap) : FirstLevelCount;
+            second_bitmap = first_bitmap != 0 ? second_level_bitmaps[first] : 0;
+        }
+        if (second_bitmap != 0) {
+            const u32 second = CountTrailingZeroes32(second_bitmap);
+            return free_lists[first * SecondLevelCount + second];
+        }
+    }
+
+    // Rounding up skips the class of the requested size, where a block may still fit. Walking it
+    // is only needed when larger classes are empty, e.g. to allocate a whole free address space.
+    const Mapping exact = MapInsert(block_size);
+    for (u32 index = free_lists[exact.first * SecondLevelCount + exact.second];
+         index != InvalidBlock; index = blocks[index].next_free) {
+        if (blocks[index].size >= block_size) {
+            return index;
+        }
+    }
+    return InvalidBlock;
+}
+
+void TLSFAllocator::InsertFreeBlock(u32 index) {
+    Block& block = blocks[index];
+    const Mapping mapping = MapInsert(block.size);
+    u32& head = free_lists[mapping.first * SecondLevelCount + mapping.second];
+
+    block.is_free = true;
+    block.prev_free = InvalidBlock;
+    block.next_free = head;
+    if (head != InvalidBlock) {
+        blocks[head].prev_free = index;
+    }
+    head = index;
+
+    first_level_bitmap |= 1ULL << mapping.first;
+    second_level_bitmaps[mapping.first] |= 1U << mapping.second;
+}
+
+void TLSFAllocator::RemoveFreeBlock(u32 index) {
+    Block& block = blocks[index];
+    const Mapping mapping = MapInsert(block.size);
+    u32& head = free_lists[mapping.first * SecondLevelCount + mapping.second];
+
+    if (block.prev_free != InvalidBlock) {
+        blocks[block.prev_free].next_free = block.next_free;
+    } else {
+        head = block.next_free;
+    }
+    if (block.next_free != InvalidBlock) {
+        blocks[block.next_free].prev_free = block.prev_free;
+    }
+    block.prev_free = InvalidBlock;
+    block.next_free = InvalidBlock;
+
+    if (head == InvalidBlock) {
+        second_level_bitmaps[mapping.first] &= ~(1U << mapping.second);
+        if (second_level_bitmaps[mapping.first] == 0) {
+            first_level_bitmap &= ~(1ULL << mapping.first);
+        }
+    }
+}
+
+u32 TLSFAllocator::SplitFront(u32 index, u64 front_size) {
+    // Creating a node may reallocate the block storage, don't hold references across it
+    const u32 front = CreateNode();
+    Block& block = blocks[index];
+    ASSERT(front_size < block.size);
+
+    blocks[front] = {block.offset, front_size, block.prev_physical, index,
+                     InvalidBlock, InvalidBlock, block.is_free};
+    if (block.prev_physical != InvalidBlock) {
+        blocks[block.prev_physical].next_physical = front;
+    }
+    block.prev_physical = front;
+    block.offset += front_size;
+    block.size -= front_size;
+    return front;
+}
+
+void TLSFAllocator::MergeNext(u32 index) {
+    Block& block = blocks[index];
+    const u32 next = block.next_physical;
+    const Block& next_block = blocks[next];
+
+    block.size += next_block.size;
+    block.next_physical = next_block.next_physical;
+    if (block.next_physical != InvalidBlock) {
+        blocks[block.next_physical].prev_physical = index;
+    }
+    ReleaseNode(next);
+}
+
+u32 TLSFAllocator::CreateNode() {
+    if (!unused_nodes.empty()) {
+        const u32 index = unused_nodes.back();
+        unused_nodes.pop_back();
+        return index;
+    }
+    blocks.emplace_back();
+    return static_cast<u32>(blocks.size() - 1);
+}
+
+void TLSFAllocator::ReleaseNode(u32 index) {
+    unused_nodes.push_back(index);
+}
+
+} // namespace Common
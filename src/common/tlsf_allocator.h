@@ -0,0 +1,135 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * A two-level segregated fit allocator. It hands out ranges of an abstract address space of a
+ * fixed size and only does the bookkeeping, the memory itself is owned by the caller. It has the
+ * following characteristics:
+ * - allocation and deallocation are O(1), free blocks are found through two levels of bitmaps
+ * - freed blocks are merged with their free neighbours immediately
+ * - block nodes are recycled, so a steady stream of allocations and deallocations doesn't allocate
+ * - sizes are rounded up to Granularity bytes and alignments must be powers of two
+ */
+class TLSFAllocator {
+public:
+    /// Smallest block size and alignment handed out by the allocator
+    static constexpr u64 Granularity = 256;
+
+    struct Allocation {
+        u64 offset; ///< Offset of the allocation in the address space
+        u32 handle; ///< Identifies the allocation when freeing it
+    };
+
+    struct Stats {
+        u64 size{};               ///< Size of the address space
+        u64 used_bytes{};         ///< Bytes handed out, including the rounding to the granularity
+        u64 largest_free_block{}; ///< Largest block that can be allocated without alignment
+        std::size_t num_allocations{};
+        std::size_t num_free_blocks{};
+
+        /// Returns the fraction of free memory that is not part of the largest free block
+        double Fragmentation() const {
+            const u64 free_bytes = size - used_bytes;
+            if (free_bytes == 0) {
+                return 0.0;
+            }
+            return 1.0 - static_cast<double>(largest_free_block) / static_cast<double>(free_bytes);
+        }
+    };
+
+    explicit TLSFAllocator(u64 size);
+    ~TLSFAllocator();
+
+    /// Allocates a range of at least size bytes. Returns an empty optional when it doesn't fit.
+    std::optional<Allocation> Allocate(u64 size, u64 alignment);
+
+    /// Releases an allocation by its handle.
+    void Free(u32 handle);
+
+    /// Returns true when nothing is allocated.
+    bool IsEmpty() const {
+        return num_allocations == 0;
+    }
+
+    u64 GetSize() const {
+        return size;
+    }
+
+    u64 GetUsedBytes() const {
+        return used_bytes;
+    }
+
+    std::size_t GetNumAllocations() const {
+        return num_allocations;
+    }
+
+    /// Returns the allocation statistics, it walks the free lists of the largest size class.
+    Stats GetStats() const;
+
+private:
+    static constexpr u32 SecondLevelBits = 4;
+    static constexpr u32 SecondLevelCount = 1U << SecondLevelBits;
+    static constexpr u32 FirstLevelCount = 64;
+    static constexpr u32 InvalidBlock = 0xFFFFFFFF;
+
+    struct Block {
+        u64 offset;
+        u64 size;
+        u32 prev_physical; ///< Block right before this one in the address space
+        u32 next_physical; ///< Block right after this one in the address space
+        u32 prev_free;     ///< Previous block in the same free list
+        u32 next_free;     ///< Next block in the same free list
+        bool is_free;
+    };
+
+    struct Mapping {
+        u32 first;
+        u32 second;
+    };
+
+    /// Returns the size class of a block of the given size.
+    static Mapping MapInsert(u64 size);
+
+    /// Returns the smallest size class where every block fits the given size.
+    static Mapping MapSearch(u64 size);
+
+    /// Returns a free block that fits the given size, or InvalidBlock when none does.
+    u32 FindFreeBlock(u64 size) const;
+
+    void InsertFreeBlock(u32 index);
+    void RemoveFreeBlock(u32 index);
+
+    /// Splits the first size bytes of a block into a new block placed before it.
+    u32 SplitFront(u32 index, u64 size);
+
+    /// Merges a block with the block physically following it, which is released.
+    void MergeNext(u32 index);
+
+    u32 CreateNode();
+    void ReleaseNode(u32 index);
+
+    u64 size;
+    u64 used_bytes = 0;
+    std::size_t num_allocations = 0;
+
+    u64 first_level_bitmap = 0;
+    std::array<u32, FirstLevelCount> second_level_bitmaps{};
+    std::array<u32, FirstLevelCount * SecondLevelCount> free_lists;
+
+    std::vector<Block> blocks;
+    std::vector<u32> unused_nodes;
+};
+
+} // namespace Common
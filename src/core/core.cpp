@@ -239,6 +239,29 @@ struct System::Impl {
         return status;
     }
 
+    ResultStatus LoadGPUReplay(System& system, Frontend::EmuWindow& emu_window) {
+        ResultStatus init_result{Init(system, emu_window)};
+        if (init_result != ResultStatus::Success) {
+            LOG_CRITICAL(Core, "Failed to initialize system (Error {})!",
+                         static_cast<int>(init_result));
+            Shutdown();
+            return init_result;
+        }
+
+        // The replay maps the recorded guest memory in this process, nothing runs on the CPU
+        auto replay_process =
+            Kernel::Process::Create(system, "gpu-replay", Kernel::Process::ProcessType::Userland);
+        kernel.MakeCurrentProcess(replay_process.get());
+        gpu_core->Start();
+
+        perf_stats = std::make_unique<PerfStats>(0);
+        GetAndResetPerfStats();
+        perf_stats->BeginSystemFrame();
+
+        status = ResultStatus::Success;
+        return status;
+    }
+
     void Shutdown() {
         // Log last frame performance stats if game was loded
         if (perf_stats) {
@@ -401,6 +424,10 @@ System::ResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::st
     return impl->Load(*this, emu_window, filepath);
 }
 
+System::ResultStatus System::LoadGPUReplay(Frontend::EmuWindow& emu_window) {
+    return impl->LoadGPUReplay(*this, emu_window);
+}
+
 bool System::IsPoweredOn() const {
     return impl->is_powered_on;
 }
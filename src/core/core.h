@@ -169,6 +169,14 @@ public:
      */
     ResultStatus Load(Frontend::EmuWindow& emu_window, const std::string& filepath);
 
+    /**
+     * Bring up the emulated system to replay a GPU recording, without an application. An empty
+     * process is made current to back the recorded guest memory and the GPU is started.
+     * @param emu_window Reference to the host-system window used for video output.
+     * @returns ResultStatus code, indicating if the operation succeeded.
+     */
+    ResultStatus LoadGPUReplay(Frontend::EmuWindow& emu_window);
+
     /**
      * Indicates if the emulated system is powered on (all subsystems initialized and able to run an
      * application).
@@ -0,0 +1,235 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <wmmintrin.h>
+#include "common/swap.h"
+#include "common/x64/cpu_detect.h"
+#include "core/crypto/aes_ni.h"
+
+// Compile the kernels for AES-NI without requiring it from the rest of the build, they are only
+// called after checking the host supports it
+#if defined(__GNUC__) || defined(__clang__)
+#define AESNI_TARGET __attribute__((target("aes")))
+#else
+#define AESNI_TARGET
+#endif
+
+namespace Core::Crypto::AESNI {
+
+namespace {
+
+constexpr std::size_t BlockSize = 0x10;
+constexpr std::size_t PipelineBlocks = 8;
+
+template <int rcon>
+AESNI_TARGET __m128i ExpandRound(__m128i key) {
+    const __m128i assist = _mm_shuffle_epi32(_mm_aeskeygenassist_si128(key, rcon), 0xFF);
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, assist);
+}
+
+AESNI_TARGET void LoadKeys(const u8* schedule, __m128i* keys) {
+    for (std::size_t round = 0; round <= NumRounds; ++round) {
+        const u8* const round_key = schedule + round * BlockSize;
+        keys[round] = _mm_load_si128(reinterpret_cast<const __m128i*>(round_key));
+    }
+}
+
+template <std::size_t count>
+AESNI_TARGET void EncryptBlocks(const __m128i* keys, __m128i* blocks) {
+    for (std::size_t i = 0; i < count; ++i) {
+        blocks[i] = _mm_xor_si128(blocks[i], keys[0]);
+    }
+    for (std::size_t round = 1; round < NumRounds; ++round) {
+        for (std::size_t i = 0; i < count; ++i) {
+            blocks[i] = _mm_aesenc_si128(blocks[i], keys[round]);
+        }
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        blocks[i] = _mm_aesenclast_si128(blocks[i], keys[NumRounds]);
+    }
+}
+
+template <std::size_t count>
+AESNI_TARGET void DecryptBlocks(const __m128i* keys, __m128i* blocks) {
+    for (std::size_t i = 0; i < count; ++i) {
+        blocks[i] = _mm_xor_si128(blocks[i], keys[0]);
+    }
+    for (std::size_t round = 1; round < NumRounds; ++round) {
+        for (std::size_t i = 0; i < count; ++i) {
+            blocks[i] = _mm_aesdec_si128(blocks[i], keys[round]);
+        }
+    }
+    for (std::size_t i = 0; i < count; ++i) {
+        blocks[i] = _mm_aesdeclast_si128(blocks[i], keys[NumRounds]);
+    }
+}
+
+__m128i Load(const u8* data) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+}
+
+void Store(u8* data, __m128i value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(data), value);
+}
+
+/// 128-bit big-endian counter kept in native integers
+struct Counter {
+    explicit Counter(const u8* data) {
+        std::memcpy(&high, data, sizeof(high));
+        std::memcpy(&low, data + sizeof(high), sizeof(low));
+        high = Common::swap64(high);
+        low = Common::swap64(low);
+    }
+
+    void Store(u8* data) const {
+        const u64 swapped_high = Common::swap64(high);
+        const u64 swapped_low = Common::swap64(low);
+        std::memcpy(data, &swapped_high, sizeof(swapped_high));
+        std::memcpy(data + sizeof(swapped_high), &swapped_low, sizeof(swapped_low));
+    }
+
+    /// Returns the current counter block and advances the counter.
+    __m128i Next() {
+        const __m128i block = _mm_set_epi64x(static_cast<s64>(Common::swap64(low)),
+                                             static_cast<s64>(Common::swap64(high)));
+        if (++low == 0) {
+            ++high;
+        }
+        return block;
+    }
+
+    u64 high;
+    u64 low;
+};
+
+/// Multiplies an XTS tweak by the primitive element of GF(2^128), shifting the 128-bit little
+/// endian value left by one and reducing it by x^128 + x^7 + x^2 + x + 1.
+__m128i MultiplyTweak(__m128i tweak) {
+    // Carries of each 32-bit lane, moved to the lane above and the top one wrapped as 0x87
+    const __m128i carries = _mm_and_si128(_mm_srai_epi32(tweak, 31), _mm_set_epi32(0x87, 1, 1, 1));
+    return _mm_xor_si128(_mm_slli_epi32(tweak, 1), _mm_shuffle_epi32(carries, 0x93));
+}
+
+template <bool encrypt>
+AESNI_TARGET void XTSBlocks(const __m128i* keys, __m128i tweak, const u8* src, u8* dest,
+                            std::size_t size) {
+    std::size_t offset = 0;
+    for (; offset + PipelineBlocks * BlockSize <= size; offset += PipelineBlocks * BlockSize) {
+        __m128i tweaks[PipelineBlocks];
+        __m128i blocks[PipelineBlocks];
+        for (std::size_t i = 0; i < PipelineBlocks; ++i) {
+            tweaks[i] = tweak;
+            tweak = MultiplyTweak(tweak);
+            blocks[i] = _mm_xor_si128(Load(src + offset + i * BlockSize), tweaks[i]);
+        }
+        if constexpr (encrypt) {
+            EncryptBlocks<PipelineBlocks>(keys, blocks);
+        } else {
+            DecryptBlocks<PipelineBlocks>(keys, blocks);
+        }
+        for (std::size_t i = 0; i < PipelineBlocks; ++i) {
+            Store(dest + offset + i * BlockSize, _mm_xor_si128(blocks[i], tweaks[i]));
+        }
+    }
+    for (; offset < size; offset += BlockSize) {
+        __m128i block = _mm_xor_si128(Load(src + offset), tweak);
+        if constexpr (encrypt) {
+            EncryptBlocks<1>(keys, &block);
+        } else {
+            DecryptBlocks<1>(keys, &block);
+        }
+        Store(dest + offset, _mm_xor_si128(block, tweak));
+        tweak = MultiplyTweak(tweak);
+    }
+}
+
+} // Anonymous namespace
+
+bool IsSupported() {
+    return Common::GetCPUCaps().aes;
+}
+
+AESNI_TARGET void ExpandKey(const u8* key, KeySchedule& schedule) {
+    __m128i keys[NumRounds + 1];
+    keys[0] = Load(key);
+    keys[1] = ExpandRound<0x01>(keys[0]);
+    keys[2] = ExpandRound<0x02>(keys[1]);
+    keys[3] = ExpandRound<0x04>(keys[2]);
+    keys[4] = ExpandRound<0x08>(keys[3]);
+    keys[5] = ExpandRound<0x10>(keys[4]);
+    keys[6] = ExpandRound<0x20>(keys[5]);
+    keys[7] = ExpandRound<0x40>(keys[6]);
+    keys[8] = ExpandRound<0x80>(keys[7]);
+    keys[9] = ExpandRound<0x1B>(keys[8]);
+    keys[10] = ExpandRound<0x36>(keys[9]);
+
+    // The equivalent inverse cipher uses the round keys in reverse, with InvMixColumns applied to
+    // all but the first and last
+    for (std::size_t round = 0; round <= NumRounds; ++round) {
+        __m128i inverse = keys[NumRounds - round];
+        if (round != 0 && round != NumRounds) {
+            inverse = _mm_aesimc_si128(inverse);
+        }
+        Store(schedule.encrypt.data() + round * BlockSize, keys[round]);
+        Store(schedule.decrypt.data() + round * BlockSize, inverse);
+    }
+}
+
+AESNI_TARGET void CTRTranscode(const KeySchedule& key, u8* counter_data, const u8* src, u8* dest,
+                               std::size_t size) {
+    __m128i keys[NumRounds + 1];
+    LoadKeys(key.encrypt.data(), keys);
+    Counter counter(counter_data);
+
+    std::size_t offset = 0;
+    for (; offset + PipelineBlocks * BlockSize <= size; offset += PipelineBlocks * BlockSize) {
+        __m128i blocks[PipelineBlocks];
+        for (std::size_t i = 0; i < PipelineBlocks; ++i) {
+            blocks[i] = counter.Next();
+        }
+        EncryptBlocks<PipelineBlocks>(keys, blocks);
+        for (std::size_t i = 0; i < PipelineBlocks; ++i) {
+            const std::size_t position = offset + i * BlockSize;
+            Store(dest + position, _mm_xor_si128(blocks[i], Load(src + position)));
+        }
+    }
+    for (; offset + BlockSize <= size; offset += BlockSize) {
+        __m128i block = counter.Next();
+        EncryptBlocks<1>(keys, &block);
+        Store(dest + offset, _mm_xor_si128(block, Load(src + offset)));
+    }
+    if (offset < size) {
+        __m128i block = counter.Next();
+        EncryptBlocks<1>(keys, &block);
+        alignas(16) std::array<u8, BlockSize> keystream;
+        Store(keystream.data(), block);
+        for (std::size_t i = 0; offset + i < size; ++i) {
+            dest[offset + i] = src[offset + i] ^ keystream[i];
+        }
+    }
+    counter.Store(counter_data);
+}
+
+AESNI_TARGET void XTSTranscode(const KeySchedule& data_key, const KeySchedule& tweak_key,
+                               const u8* tweak_data, const u8* src, u8* dest, std::size_t size,
+                               bool encrypt) {
+    __m128i keys[NumRounds + 1];
+    LoadKeys(tweak_key.encrypt.data(), keys);
+    __m128i tweak = Load(tweak_data);
+    EncryptBlocks<1>(keys, &tweak);
+
+    if (encrypt) {
+        LoadKeys(data_key.encrypt.data(), keys);
+        XTSBlocks<true>(keys, tweak, src, dest, size);
+    } else {
+        LoadKeys(data_key.decrypt.data(), keys);
+        XTSBlocks<false>(keys, tweak, src, dest, size);
+    }
+}
+
+} // namespace Core::Crypto::AESNI
@@ -0,0 +1,45 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include "common/common_types.h"
+
+// AES-128 kernels using the AES-NI instructions of x86-64 hosts. They process eight blocks at a
+// time, which keeps the pipelined AES units busy, and are used by AESCipher for CTR and XTS when
+// the host supports them.
+namespace Core::Crypto::AESNI {
+
+constexpr std::size_t NumRounds = 10;
+
+/// Expanded AES-128 round keys
+struct KeySchedule {
+    alignas(16) std::array<u8, (NumRounds + 1) * 0x10> encrypt;
+    alignas(16) std::array<u8, (NumRounds + 1) * 0x10> decrypt;
+};
+
+/// Returns true when the host supports the AES-NI instructions.
+bool IsSupported();
+
+/// Expands a 16 byte key into the encryption and decryption round keys.
+void ExpandKey(const u8* key, KeySchedule& schedule);
+
+/**
+ * Encrypts or decrypts, which is the same operation, size bytes in CTR mode.
+ * @param counter 16 byte big-endian counter, advanced past every block used. The keystream of a
+ *                trailing partial block is discarded.
+ */
+void CTRTranscode(const KeySchedule& key, u8* counter, const u8* src, u8* dest, std::size_t size);
+
+/**
+ * Encrypts or decrypts a single XTS data unit.
+ * @param tweak 16 byte tweak of the data unit, encrypted with tweak_key.
+ * @param size Size of the data unit, must be a multiple of 16 bytes.
+ */
+void XTSTranscode(const KeySchedule& data_key, const KeySchedule& tweak_key, const u8* tweak,
+                  const u8* src, u8* dest, std::size_t size, bool encrypt);
+
+} // namespace Core::Crypto::AESNI
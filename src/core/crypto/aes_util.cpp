@@ -2,11 +2,22 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <thread>
 #include <mbedtls/cipher.h>
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "core/crypto/aes_util.h"
 #include "core/crypto/key_manager.h"
+#ifdef ARCHITECTURE_x86_64
+#include "core/crypto/aes_ni.h"
+#endif
 
 namespace Core::Crypto {
 namespace {
@@ -18,6 +29,137 @@ std::vector<u8> CalculateNintendoTweak(std::size_t sector_id) {
     }
     return out;
 }
+
+#ifdef ARCHITECTURE_x86_64
+// Transcodes at least this large are split into batches decrypted on several threads
+constexpr std::size_t ParallelThreshold = 0x100000;
+constexpr std::size_t MinBatchSize = 0x40000;
+
+std::array<u8, 0x10> CalculateNintendoTweakArray(std::size_t sector_id) {
+    std::array<u8, 0x10> out{};
+    for (std::size_t i = 0xF; i <= 0xF; --i) {
+        out[i] = sector_id & 0xFF;
+        sector_id >>= 8;
+    }
+    return out;
+}
+
+// Adds to a 128-bit big-endian CTR counter
+void AdvanceCounter(std::array<u8, 0x10>& counter, u64 blocks) {
+    for (std::size_t i = 0xF; i <= 0xF && blocks != 0; --i) {
+        const u64 sum = counter[i] + (blocks & 0xFF);
+        counter[i] = static_cast<u8>(sum);
+        blocks = (blocks >> 8) + (sum >> 8);
+    }
+}
+
+// Runs the batches of large transcodes on a few worker threads, the calling thread takes part.
+// When another transcode is already using the workers, the batches run on the calling thread.
+class TranscodeWorkers {
+public:
+    TranscodeWorkers() {
+        const std::size_t num_threads = std::max(std::thread::hardware_concurrency() / 2, 1U);
+        for (std::size_t i = 0; i < num_threads; ++i) {
+            threads.emplace_back(&TranscodeWorkers::WorkerThread, this);
+        }
+    }
+
+    ~TranscodeWorkers() {
+        {
+            std::lock_guard lock{mutex};
+            stop = true;
+        }
+        work_cv.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    static TranscodeWorkers& Instance() {
+        static TranscodeWorkers instance;
+        return instance;
+    }
+
+    std::size_t NumBatches(std::size_t size) const {
+        return std::clamp<std::size_t>(size / MinBatchSize, 1, threads.size() + 1);
+    }
+
+    void Run(std::size_t num_batches, const std::function<void(std::size_t)>& batch) {
+        std::unique_lock run_lock{run_mutex, std::try_to_lock};
+        if (!run_lock) {
+            for (std::size_t index = 0; index < num_batches; ++index) {
+                batch(index);
+            }
+            return;
+        }
+        {
+            std::lock_guard lock{mutex};
+            job = &batch;
+            next_batch = 0;
+            total_batches = num_batches;
+            pending_batches = num_batches;
+            ++generation;
+        }
+        work_cv.notify_all();
+        RunBatches();
+
+        std::unique_lock lock{mutex};
+        done_cv.wait(lock, [this] { return pending_batches == 0; });
+        job = nullptr;
+    }
+
+private:
+    void RunBatches() {
+        while (true) {
+            const std::function<void(std::size_t)>* batch;
+            std::size_t index;
+            {
+                std::lock_guard lock{mutex};
+                if (!job || next_batch == total_batches) {
+                    return;
+                }
+                batch = job;
+                index = next_batch++;
+            }
+            (*batch)(index);
+
+            std::lock_guard lock{mutex};
+            if (--pending_batches == 0) {
+                done_cv.notify_all();
+            }
+        }
+    }
+
+    void WorkerThread() {
+        Common::SetCurrentThreadName("yuzu:Crypto");
+        u64 seen_generation = 0;
+        while (true) {
+            {
+                std::unique_lock lock{mutex};
+                work_cv.wait(lock, [&] { return stop || generation != seen_generation; });
+                if (stop) {
+                    return;
+                }
+                seen_generation = generation;
+            }
+            RunBatches();
+        }
+    }
+
+    std::vector<std::thread> threads;
+    std::mutex run_mutex;
+
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    const std::function<void(std::size_t)>* job = nullptr;
+    std::size_t next_batch = 0;
+    std::size_t total_batches = 0;
+    std::size_t pending_batches = 0;
+    u64 generation = 0;
+    bool stop = false;
+};
+#endif
 } // Anonymous namespace
 
 static_assert(static_cast<std::size_t>(Mode::CTR) ==
@@ -34,10 +176,19 @@ static_assert(static_cast<std::size_t>(Mode::XTS) ==
 struct CipherContext {
     mbedtls_cipher_context_t encryption_context;
     mbedtls_cipher_context_t decryption_context;
+
+#ifdef ARCHITECTURE_x86_64
+    // When the host supports AES-NI, CTR and XTS are done by its kernels instead of mbedtls
+    bool use_aes_ni = false;
+    Mode mode{};
+    AESNI::KeySchedule key{};
+    AESNI::KeySchedule tweak_key{};
+    std::array<u8, 0x10> iv{};
+#endif
 };
 
 template <typename Key, std::size_t KeySize>
-Crypto::AESCipher<Key, KeySize>::AESCipher(Key key, Mode mode)
+Crypto::AESCipher<Key, KeySize>::AESCipher(Key key, Mode mode, bool allow_aes_ni)
     : ctx(std::make_unique<CipherContext>()) {
     mbedtls_cipher_init(&ctx->encryption_context);
     mbedtls_cipher_init(&ctx->decryption_context);
@@ -55,6 +206,20 @@ Crypto::AESCipher<Key, KeySize>::AESCipher(Key key, Mode mode)
     ASSERT(
         !mbedtls_cipher_setkey(&ctx->decryption_context, key.data(), KeySize * 8, MBEDTLS_DECRYPT));
     //"Failed to set key on mbedtls ciphers.");
+
+#ifdef ARCHITECTURE_x86_64
+    // The kernels implement AES-128, XTS uses two of its keys
+    const bool is_ctr = mode == Mode::CTR && KeySize == 0x10;
+    const bool is_xts = mode == Mode::XTS && KeySize == 0x20;
+    if ((is_ctr || is_xts) && allow_aes_ni && AESNI::IsSupported()) {
+        ctx->use_aes_ni = true;
+        ctx->mode = mode;
+        AESNI::ExpandKey(key.data(), ctx->key);
+        if (is_xts) {
+            AESNI::ExpandKey(key.data() + 0x10, ctx->tweak_key);
+        }
+    }
+#endif
 }
 
 template <typename Key, std::size_t KeySize>
@@ -68,10 +233,46 @@ void AESCipher<Key, KeySize>::SetIV(std::vector<u8> iv) {
     ASSERT_MSG((mbedtls_cipher_set_iv(&ctx->encryption_context, iv.data(), iv.size()) ||
                 mbedtls_cipher_set_iv(&ctx->decryption_context, iv.data(), iv.size())) == 0,
                "Failed to set IV on mbedtls ciphers.");
+#ifdef ARCHITECTURE_x86_64
+    const std::size_t length = std::min(iv.size(), ctx->iv.size());
+    ctx->iv.fill(0);
+    std::memcpy(ctx->iv.data(), iv.data(), length);
+#endif
 }
 
 template <typename Key, std::size_t KeySize>
 void AESCipher<Key, KeySize>::Transcode(const u8* src, std::size_t size, u8* dest, Op op) const {
+#ifdef ARCHITECTURE_x86_64
+    if (ctx->use_aes_ni && ctx->mode == Mode::CTR) {
+        if (size < ParallelThreshold) {
+            AESNI::CTRTranscode(ctx->key, ctx->iv.data(), src, dest, size);
+            return;
+        }
+        // Every batch starts from its own counter, the shared one is advanced past all of them
+        auto& workers = TranscodeWorkers::Instance();
+        const std::size_t num_blocks = (size + 0xF) / 0x10;
+        const std::size_t num_batches = workers.NumBatches(size);
+        const std::size_t batch_blocks = (num_blocks + num_batches - 1) / num_batches;
+        workers.Run(num_batches, [&](std::size_t index) {
+            const std::size_t offset = index * batch_blocks * 0x10;
+            if (offset >= size) {
+                return;
+            }
+            auto counter = ctx->iv;
+            AdvanceCounter(counter, index * batch_blocks);
+            const std::size_t length = std::min(batch_blocks * 0x10, size - offset);
+            AESNI::CTRTranscode(ctx->key, counter.data(), src + offset, dest + offset, length);
+        });
+        AdvanceCounter(ctx->iv, num_blocks);
+        return;
+    }
+    if (ctx->use_aes_ni && ctx->mode == Mode::XTS && size >= 0x10 && size % 0x10 == 0) {
+        AESNI::XTSTranscode(ctx->key, ctx->tweak_key, ctx->iv.data(), src, dest, size,
+                            op == Op::Encrypt);
+        return;
+    }
+#endif
+
     auto* const context = op == Op::Encrypt ? &ctx->encryption_context : &ctx->decryption_context;
 
     mbedtls_cipher_reset(context);
@@ -118,6 +319,33 @@ void AESCipher<Key, KeySize>::XTSTranscode(const u8* src, std::size_t size, u8*
                                            std::size_t sector_id, std::size_t sector_size, Op op) {
     ASSERT_MSG(size % sector_size == 0, "XTS decryption size must be a multiple of sector size.");
 
+#ifdef ARCHITECTURE_x86_64
+    if (ctx->use_aes_ni && sector_size >= 0x10 && sector_size % 0x10 == 0) {
+        const std::size_t num_sectors = size / sector_size;
+        const auto transcode_sectors = [&](std::size_t first, std::size_t last) {
+            for (std::size_t sector = first; sector < last; ++sector) {
+                const auto tweak = CalculateNintendoTweakArray(sector_id + sector);
+                const std::size_t offset = sector * sector_size;
+                AESNI::XTSTranscode(ctx->key, ctx->tweak_key, tweak.data(), src + offset,
+                                    dest + offset, sector_size, op == Op::Encrypt);
+            }
+        };
+        if (size < ParallelThreshold || num_sectors == 1) {
+            transcode_sectors(0, num_sectors);
+            return;
+        }
+        auto& workers = TranscodeWorkers::Instance();
+        const std::size_t num_batches = std::min(workers.NumBatches(size), num_sectors);
+        const std::size_t batch_sectors = (num_sectors + num_batches - 1) / num_batches;
+        workers.Run(num_batches, [&](std::size_t index) {
+            const std::size_t first = index * batch_sectors;
+            transcode_sectors(std::min(first, num_sectors),
+                              std::min(first + batch_sectors, num_sectors));
+        });
+        return;
+    }
+#endif
+
     for (std::size_t i = 0; i < size; i += sector_size) {
         SetIV(CalculateNintendoTweak(sector_id++));
         Transcode<u8, u8>(src + i, sector_size, dest + i, op);
@@ -31,7 +31,8 @@ class AESCipher {
     static_assert(KeySize == 0x10 || KeySize == 0x20, "KeySize must be 128 or 256.");
 
 public:
-    AESCipher(Key key, Mode mode);
+    /// allow_aes_ni set to false keeps the cipher on mbedtls on hosts supporting AES-NI.
+    AESCipher(Key key, Mode mode, bool allow_aes_ni = true);
 
     ~AESCipher();
 
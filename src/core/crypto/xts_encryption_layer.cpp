@@ -21,10 +21,17 @@ std::size_t XTSEncryptionLayer::Read(u8* data, std::size_t length, std::size_t o
     const auto sector_offset = offset & 0x3FFF;
     if (sector_offset == 0) {
         if (length % XTS_SECTOR_SIZE == 0) {
-            std::vector<u8> raw = base->ReadBytes(length, offset);
-            cipher.XTSTranscode(raw.data(), raw.size(), data, offset / XTS_SECTOR_SIZE,
+            // Decrypt in place, the sectors of large reads are decrypted on several threads
+            const std::size_t read = base->Read(data, length, offset);
+            const std::size_t sectors_size = read - read % XTS_SECTOR_SIZE;
+            cipher.XTSTranscode(data, sectors_size, data, offset / XTS_SECTOR_SIZE,
                                 XTS_SECTOR_SIZE, Op::Decrypt);
-            return raw.size();
+            if (sectors_size != read) {
+                // The trailing partial sector is decrypted through a padded copy
+                return sectors_size + Read(data + sectors_size, read - sectors_size,
+                                           offset + sectors_size);
+            }
+            return read;
         }
         if (length > XTS_SECTOR_SIZE) {
             const auto rem = length % XTS_SECTOR_SIZE;
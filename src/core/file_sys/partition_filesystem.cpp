@@ -46,13 +46,16 @@ PartitionFilesystem::PartitionFilesystem(std::shared_ptr<VfsFile> file) {
     std::size_t metadata_size =
         sizeof(Header) + (pfs_header.num_entries * entry_size) + pfs_header.strtab_size;
 
-    // Actually read in now...
-    std::vector<u8> file_data = file->ReadBytes(metadata_size);
-    const std::size_t total_size = file_data.size();
-
-    if (total_size != metadata_size) {
-        status = Loader::ResultStatus::ErrorIncorrectPFSFileSize;
-        return;
+    // Actually read in now, memory backed files are parsed in place
+    const u8* file_data = file->GetMappedSpan(0, metadata_size);
+    std::vector<u8> buffer;
+    if (file_data == nullptr) {
+        buffer = file->ReadBytes(metadata_size);
+        if (buffer.size() != metadata_size) {
+            status = Loader::ResultStatus::ErrorIncorrectPFSFileSize;
+            return;
+        }
+        file_data = buffer.data();
     }
 
     std::size_t entries_offset = sizeof(Header);
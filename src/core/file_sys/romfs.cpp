@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <cstring>
+
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/file_sys/fsmitm_romfsbuild.h"
@@ -50,21 +52,45 @@ struct FileEntry {
 };
 static_assert(sizeof(FileEntry) == 0x20, "FileEntry has incorrect size.");
 
+// Directory or file metadata table, parsed in place when the file is memory backed
+struct MetadataTable {
+    MetadataTable(const VirtualFile& file, const TableLocation& location)
+        : offset{location.offset}, size{location.size},
+          data{file->GetMappedSpan(location.offset, location.size)} {}
+
+    u64 offset;
+    u64 size;
+    const u8* data; ///< Null when the table has to be read from the file
+};
+
 template <typename Entry>
-static std::pair<Entry, std::string> GetEntry(const VirtualFile& file, std::size_t offset) {
+static std::pair<Entry, std::string> GetEntry(const VirtualFile& file, const MetadataTable& table,
+                                              std::size_t offset) {
     Entry entry{};
-    if (file->ReadObject(&entry, offset) != sizeof(Entry))
+    if (table.data != nullptr) {
+        if (offset > table.size || table.size - offset < sizeof(Entry))
+            return {};
+        std::memcpy(&entry, table.data + offset, sizeof(Entry));
+        const std::size_t name_offset = offset + sizeof(Entry);
+        if (table.size - name_offset < entry.name_length)
+            return {};
+        const auto* const name = reinterpret_cast<const char*>(table.data + name_offset);
+        return {entry, std::string(name, entry.name_length)};
+    }
+
+    if (file->ReadObject(&entry, table.offset + offset) != sizeof(Entry))
         return {};
     std::string string(entry.name_length, '\0');
-    if (file->ReadArray(&string[0], string.size(), offset + sizeof(Entry)) != string.size())
+    if (file->ReadArray(&string[0], string.size(), table.offset + offset + sizeof(Entry)) !=
+        string.size())
         return {};
     return {entry, string};
 }
 
-void ProcessFile(VirtualFile file, std::size_t file_offset, std::size_t data_offset,
+void ProcessFile(VirtualFile file, const MetadataTable& file_table, std::size_t data_offset,
                  u32 this_file_offset, std::shared_ptr<VectorVfsDirectory> parent) {
     while (true) {
-        auto entry = GetEntry<FileEntry>(file, file_offset + this_file_offset);
+        auto entry = GetEntry<FileEntry>(file, file_table, this_file_offset);
 
         parent->AddFile(std::make_shared<OffsetVfsFile>(
             file, entry.first.size, entry.first.offset + data_offset, entry.second));
@@ -76,20 +102,21 @@ void ProcessFile(VirtualFile file, std::size_t file_offset, std::size_t data_off
     }
 }
 
-void ProcessDirectory(VirtualFile file, std::size_t dir_offset, std::size_t file_offset,
-                      std::size_t data_offset, u32 this_dir_offset,
-                      std::shared_ptr<VectorVfsDirectory> parent) {
+void ProcessDirectory(VirtualFile file, const MetadataTable& dir_table,
+                      const MetadataTable& file_table, std::size_t data_offset,
+                      u32 this_dir_offset, std::shared_ptr<VectorVfsDirectory> parent) {
     while (true) {
-        auto entry = GetEntry<DirectoryEntry>(file, dir_offset + this_dir_offset);
+        // DirectoryEntry starts after the parent offset, which isn't needed
+        auto entry = GetEntry<DirectoryEntry>(file, dir_table, this_dir_offset + 4);
         auto current = std::make_shared<VectorVfsDirectory>(
             std::vector<VirtualFile>{}, std::vector<VirtualDir>{}, entry.second);
 
         if (entry.first.child_file != ROMFS_ENTRY_EMPTY) {
-            ProcessFile(file, file_offset, data_offset, entry.first.child_file, current);
+            ProcessFile(file, file_table, data_offset, entry.first.child_file, current);
         }
 
         if (entry.first.child_dir != ROMFS_ENTRY_EMPTY) {
-            ProcessDirectory(file, dir_offset, file_offset, data_offset, entry.first.child_dir,
+            ProcessDirectory(file, dir_table, file_table, data_offset, entry.first.child_dir,
                              current);
         }
 
@@ -108,14 +135,14 @@ VirtualDir ExtractRomFS(VirtualFile file, RomFSExtractionType type) {
     if (header.header_size != sizeof(RomFSHeader))
         return nullptr;
 
-    const u64 file_offset = header.file_meta.offset;
-    const u64 dir_offset = header.directory_meta.offset + 4;
+    const MetadataTable file_table(file, header.file_meta);
+    const MetadataTable dir_table(file, header.directory_meta);
 
     auto root =
         std::make_shared<VectorVfsDirectory>(std::vector<VirtualFile>{}, std::vector<VirtualDir>{},
                                              file->GetName(), file->GetContainingDirectory());
 
-    ProcessDirectory(file, dir_offset, file_offset, header.data_offset, 0, root);
+    ProcessDirectory(file, dir_table, file_table, header.data_offset, 0, root);
 
     VirtualDir out = std::move(root);
 
@@ -187,6 +187,10 @@ std::vector<u8> VfsFile::ReadAllBytes() const {
     return ReadBytes(GetSize());
 }
 
+const u8* VfsFile::GetMappedSpan(std::size_t offset, std::size_t size) const {
+    return nullptr;
+}
+
 bool VfsFile::WriteByte(u8 data, std::size_t offset) {
     return Write(&data, 1, offset) == 1;
 }
@@ -113,6 +113,12 @@ public:
     // 0)'
     virtual std::vector<u8> ReadAllBytes() const;
 
+    // Returns a pointer to size bytes of the file starting at offset, without copying them, or
+    // nullptr when the file isn't backed by memory or the range doesn't fit. The pointer stays
+    // valid as long as the file is alive and it must not be written to. Files are only backed by
+    // memory when they aren't expected to change, e.g. game images.
+    virtual const u8* GetMappedSpan(std::size_t offset, std::size_t size) const;
+
     // Reads an array of type T, size number_elements starting at offset.
     // Returns the number of bytes (sizeof(T)*number_elements) read successfully.
     template <typename T>
@@ -0,0 +1,228 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "common/assert.h"
+#include "core/file_sys/vfs_cached.h"
+
+namespace FileSys {
+
+CachedVfsFile::CachedVfsFile(VirtualFile file_, std::size_t block_size_, std::size_t cache_size,
+                             std::size_t read_ahead_blocks_)
+    : file(std::move(file_)), block_size(block_size_),
+      blocks_per_shard(std::max<std::size_t>(cache_size / block_size_ / NumShards, 1)),
+      read_ahead_blocks(read_ahead_blocks_) {
+    ASSERT(block_size > 0);
+}
+
+CachedVfsFile::~CachedVfsFile() = default;
+
+std::string CachedVfsFile::GetName() const {
+    return file->GetName();
+}
+
+std::size_t CachedVfsFile::GetSize() const {
+    return file->GetSize();
+}
+
+bool CachedVfsFile::Resize(std::size_t new_size) {
+    // The last block may change size, drop everything rather than tracking it
+    Clear();
+    return file->Resize(new_size);
+}
+
+std::shared_ptr<VfsDirectory> CachedVfsFile::GetContainingDirectory() const {
+    return file->GetContainingDirectory();
+}
+
+bool CachedVfsFile::IsWritable() const {
+    return file->IsWritable();
+}
+
+bool CachedVfsFile::IsReadable() const {
+    return file->IsReadable();
+}
+
+std::size_t CachedVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    const std::size_t file_size = file->GetSize();
+    if (offset >= file_size) {
+        return 0;
+    }
+    length = std::min(length, file_size - offset);
+    if (length == 0) {
+        return 0;
+    }
+    if (const u8* const mapped = file->GetMappedSpan(offset, length)) {
+        // Memory backed files are already as fast as the cache
+        std::memcpy(data, mapped, length);
+        return length;
+    }
+
+    const bool is_sequential = sequential_offset.exchange(offset + length) == offset;
+    const std::size_t first = offset / block_size;
+    const std::size_t last = (offset + length - 1) / block_size;
+    if (last - first + 1 > blocks_per_shard) {
+        // Large reads are passed through, caching them would evict the blocks of smaller reads
+        ++bypassed_reads;
+        return file->Read(data, length, offset);
+    }
+    const std::size_t num_file_blocks = (file_size + block_size - 1) / block_size;
+
+    std::vector<u8> fetched;
+    std::size_t block = first;
+    while (block <= last) {
+        const std::size_t block_begin = std::max(block * block_size, offset);
+        const std::size_t block_end = std::min((block + 1) * block_size, offset + length);
+        if (ReadCachedBlock(block, data + (block_begin - offset), block_end - block_begin,
+                            block_begin - block * block_size)) {
+            ++hits;
+            ++block;
+            continue;
+        }
+
+        // Read the run of missing blocks at once, sequential reads also fetch the blocks after it
+        std::size_t requested_end = block + 1;
+        while (requested_end <= last && !IsBlockCached(requested_end)) {
+            ++requested_end;
+        }
+        std::size_t fetch_end = requested_end;
+        if (is_sequential && requested_end > last) {
+            const std::size_t ahead_end = std::min(requested_end + read_ahead_blocks,
+                                                   num_file_blocks);
+            while (fetch_end < ahead_end && !IsBlockCached(fetch_end)) {
+                ++fetch_end;
+            }
+        }
+        misses += requested_end - block;
+        read_ahead += fetch_end - requested_end;
+
+        const std::size_t fetch_offset = block * block_size;
+        fetched.resize(std::min(fetch_end * block_size, file_size) - fetch_offset);
+        const std::size_t fetched_length = file->Read(fetched.data(), fetched.size(), fetch_offset);
+        for (std::size_t index = block; index < fetch_end; ++index) {
+            const std::size_t position = (index - block) * block_size;
+            const std::size_t expected = std::min(block_size, file_size - index * block_size);
+            if (position + expected > fetched_length) {
+                break;
+            }
+            InsertBlock(index, fetched.data() + position, expected);
+        }
+
+        const std::size_t copy_begin = std::max(fetch_offset, offset);
+        const std::size_t copy_end =
+            std::min({requested_end * block_size, offset + length, fetch_offset + fetched_length});
+        if (copy_end <= copy_begin) {
+            return copy_begin - offset;
+        }
+        std::memcpy(data + (copy_begin - offset), fetched.data() + (copy_begin - fetch_offset),
+                    copy_end - copy_begin);
+        if (copy_end < std::min(requested_end * block_size, offset + length)) {
+            // The wrapped file returned less than requested
+            return copy_end - offset;
+        }
+        block = requested_end;
+    }
+    return length;
+}
+
+std::size_t CachedVfsFile::Write(const u8* data, std::size_t length, std::size_t offset) {
+    if (offset + length > file->GetSize()) {
+        // Writing past the end resizes the file
+        Clear();
+    } else {
+        InvalidateBlocks(offset, length);
+    }
+    return file->Write(data, length, offset);
+}
+
+const u8* CachedVfsFile::GetMappedSpan(std::size_t offset, std::size_t size) const {
+    return file->GetMappedSpan(offset, size);
+}
+
+bool CachedVfsFile::Rename(std::string_view name) {
+    return file->Rename(name);
+}
+
+CachedVfsFile::Stats CachedVfsFile::GetStats() const {
+    return {hits, misses, read_ahead, bypassed_reads};
+}
+
+bool CachedVfsFile::ReadCachedBlock(std::size_t block, u8* data, std::size_t length,
+                                    std::size_t block_offset) const {
+    Shard& shard = GetShard(block);
+    std::lock_guard lock{shard.mutex};
+    const auto it = shard.lookup.find(block);
+    if (it == shard.lookup.end()) {
+        return false;
+    }
+    const std::vector<u8>& contents = it->second->second;
+    if (block_offset + length > contents.size()) {
+        return false;
+    }
+    std::memcpy(data, contents.data() + block_offset, length);
+    shard.blocks.splice(shard.blocks.begin(), shard.blocks, it->second);
+    return true;
+}
+
+bool CachedVfsFile::IsBlockCached(std::size_t block) const {
+    Shard& shard = GetShard(block);
+    std::lock_guard lock{shard.mutex};
+    return shard.lookup.count(block) != 0;
+}
+
+void CachedVfsFile::InsertBlock(std::size_t block, const u8* data, std::size_t length) const {
+    Shard& shard = GetShard(block);
+    std::lock_guard lock{shard.mutex};
+    const auto it = shard.lookup.find(block);
+    if (it != shard.lookup.end()) {
+        // Another thread fetched it meanwhile
+        shard.blocks.splice(shard.blocks.begin(), shard.blocks, it->second);
+        return;
+    }
+    if (shard.blocks.size() >= blocks_per_shard) {
+        // Recycle the storage of the least recently used block
+        shard.lookup.erase(shard.blocks.back().first);
+        shard.blocks.splice(shard.blocks.begin(), shard.blocks, std::prev(shard.blocks.end()));
+        shard.blocks.front().first = block;
+    } else {
+        shard.blocks.emplace_front(block, std::vector<u8>{});
+    }
+    shard.blocks.front().second.assign(data, data + length);
+    shard.lookup.emplace(block, shard.blocks.begin());
+}
+
+void CachedVfsFile::InvalidateBlocks(std::size_t offset, std::size_t length) {
+    if (length == 0) {
+        return;
+    }
+    const std::size_t first = offset / block_size;
+    const std::size_t last = (offset + length - 1) / block_size;
+    if (last - first + 1 > blocks_per_shard * NumShards) {
+        Clear();
+        return;
+    }
+    for (std::size_t block = first; block <= last; ++block) {
+        Shard& shard = GetShard(block);
+        std::lock_guard lock{shard.mutex};
+        const auto it = shard.lookup.find(block);
+        if (it != shard.lookup.end()) {
+            shard.blocks.erase(it->second);
+            shard.lookup.erase(it);
+        }
+    }
+}
+
+void CachedVfsFile::Clear() {
+    for (Shard& shard : shards) {
+        std::lock_guard lock{shard.mutex};
+        shard.blocks.clear();
+        shard.lookup.clear();
+    }
+}
+
+} // namespace FileSys
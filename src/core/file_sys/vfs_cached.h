@@ -0,0 +1,101 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "core/file_sys/vfs.h"
+
+namespace FileSys {
+
+// An implementation of VfsFile that caches the reads of another VfsFile in aligned blocks.
+// Reads touching cached blocks are served from memory and the missing blocks are read in one
+// request to the wrapped file, fetching a few more blocks ahead when the file is read
+// sequentially. This turns small and repeated reads of an expensive file, such as a decryption
+// layer, into a few large aligned reads.
+// Writes go through to the wrapped file and drop the cached blocks they overlap.
+class CachedVfsFile : public VfsFile {
+public:
+    static constexpr std::size_t DefaultBlockSize = 0x10000;
+    static constexpr std::size_t DefaultCacheSize = 0x1000000;
+    static constexpr std::size_t DefaultReadAheadBlocks = 4;
+
+    struct Stats {
+        u64 hits;              ///< Blocks read from the cache
+        u64 misses;            ///< Blocks read from the wrapped file for a request
+        u64 read_ahead_blocks; ///< Blocks read from the wrapped file ahead of a request
+        u64 bypassed_reads;    ///< Reads too large to be cached
+    };
+
+    explicit CachedVfsFile(VirtualFile file, std::size_t block_size = DefaultBlockSize,
+                           std::size_t cache_size = DefaultCacheSize,
+                           std::size_t read_ahead_blocks = DefaultReadAheadBlocks);
+    ~CachedVfsFile() override;
+
+    std::string GetName() const override;
+    std::size_t GetSize() const override;
+    bool Resize(std::size_t new_size) override;
+    std::shared_ptr<VfsDirectory> GetContainingDirectory() const override;
+    bool IsWritable() const override;
+    bool IsReadable() const override;
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
+    std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    const u8* GetMappedSpan(std::size_t offset, std::size_t size) const override;
+    bool Rename(std::string_view name) override;
+
+    Stats GetStats() const;
+
+private:
+    // Blocks are spread over shards by index, each with its own lock and LRU list, so reads of
+    // different blocks from several threads rarely contend.
+    static constexpr std::size_t NumShards = 8;
+
+    using BlockList = std::list<std::pair<std::size_t, std::vector<u8>>>;
+
+    struct Shard {
+        std::mutex mutex;
+        BlockList blocks; ///< Most recently used first
+        std::unordered_map<std::size_t, BlockList::iterator> lookup;
+    };
+
+    Shard& GetShard(std::size_t block) const {
+        return shards[block % NumShards];
+    }
+
+    // Copies length bytes at block_offset of a cached block. Returns false when it's not cached.
+    bool ReadCachedBlock(std::size_t block, u8* data, std::size_t length,
+                         std::size_t block_offset) const;
+
+    bool IsBlockCached(std::size_t block) const;
+
+    // Caches a block, evicting the least recently used block of its shard when it's full.
+    void InsertBlock(std::size_t block, const u8* data, std::size_t length) const;
+
+    void InvalidateBlocks(std::size_t offset, std::size_t length);
+
+    void Clear();
+
+    VirtualFile file;
+    const std::size_t block_size;
+    const std::size_t blocks_per_shard;
+    const std::size_t read_ahead_blocks;
+
+    mutable std::array<Shard, NumShards> shards;
+    mutable std::atomic<std::size_t> sequential_offset{0};
+
+    mutable std::atomic<u64> hits{0};
+    mutable std::atomic<u64> misses{0};
+    mutable std::atomic<u64> read_ahead{0};
+    mutable std::atomic<u64> bypassed_reads{0};
+};
+
+} // namespace FileSys
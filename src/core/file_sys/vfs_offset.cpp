@@ -72,6 +72,13 @@ std::vector<u8> OffsetVfsFile::ReadAllBytes() const {
     return file->ReadBytes(size, offset);
 }
 
+const u8* OffsetVfsFile::GetMappedSpan(std::size_t r_offset, std::size_t r_size) const {
+    if (r_offset > size || r_size > size - r_offset)
+        return nullptr;
+
+    return file->GetMappedSpan(offset + r_offset, r_size);
+}
+
 bool OffsetVfsFile::WriteByte(u8 data, std::size_t r_offset) {
     if (r_offset < size)
         return file->WriteByte(data, offset + r_offset);
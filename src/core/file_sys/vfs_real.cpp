@@ -4,16 +4,25 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <cstring>
 #include <iterator>
 #include <utility>
 #include "common/assert.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
+#include "common/mapped_file.h"
 #include "core/file_sys/vfs_real.h"
 
 namespace FileSys {
 
+// Files opened read-only from this size up are mapped in memory. They are expected to be game
+// images which aren't truncated while they are in use, reading a mapping past the end of its file
+// faults.
+constexpr std::size_t MinMappedFileSize = 0x100000;
+// Mapped ranges from this size up are prefetched when they are requested
+constexpr std::size_t MinPrefetchSize = 0x10000;
+
 static std::string ModeFlagsToString(Mode mode) {
     std::string mode_str;
 
@@ -66,10 +75,14 @@ VfsEntryType RealVfsFilesystem::GetEntryType(std::string_view path_) const {
 
 VirtualFile RealVfsFilesystem::OpenFile(std::string_view path_, Mode perms) {
     const auto path = FileUtil::SanitizePath(path_, FileUtil::DirectorySeparator::PlatformDefault);
+    std::lock_guard lock{cache_mutex};
     if (cache.find(path) != cache.end()) {
         auto weak = cache[path];
         if (!weak.expired()) {
-            return std::shared_ptr<RealVfsFile>(new RealVfsFile(*this, weak.lock(), path, perms));
+            auto backing = weak.lock();
+            auto mapping = OpenMapping(path, perms, backing->GetSize());
+            return std::shared_ptr<RealVfsFile>(
+                new RealVfsFile(*this, std::move(backing), std::move(mapping), path, perms));
         }
     }
 
@@ -78,9 +91,11 @@ VirtualFile RealVfsFilesystem::OpenFile(std::string_view path_, Mode perms) {
 
     auto backing = std::make_shared<FileUtil::IOFile>(path, ModeFlagsToString(perms).c_str());
     cache[path] = backing;
+    auto mapping = OpenMapping(path, perms, backing->GetSize());
 
     // Cannot use make_shared as RealVfsFile constructor is private
-    return std::shared_ptr<RealVfsFile>(new RealVfsFile(*this, backing, path, perms));
+    return std::shared_ptr<RealVfsFile>(
+        new RealVfsFile(*this, std::move(backing), std::move(mapping), path, perms));
 }
 
 VirtualFile RealVfsFilesystem::CreateFile(std::string_view path_, Mode perms) {
@@ -116,13 +131,17 @@ VirtualFile RealVfsFilesystem::MoveFile(std::string_view old_path_, std::string_
         FileUtil::IsDirectory(old_path) || !FileUtil::Rename(old_path, new_path))
         return nullptr;
 
-    if (cache.find(old_path) != cache.end()) {
-        auto cached = cache[old_path];
-        if (!cached.expired()) {
-            auto file = cached.lock();
-            file->Open(new_path, "r+b");
-            cache.erase(old_path);
-            cache[new_path] = file;
+    {
+        std::lock_guard lock{cache_mutex};
+        EraseMappings(old_path);
+        if (cache.find(old_path) != cache.end()) {
+            auto cached = cache[old_path];
+            if (!cached.expired()) {
+                auto file = cached.lock();
+                file->Open(new_path, "r+b");
+                cache.erase(old_path);
+                cache[new_path] = file;
+            }
         }
     }
     return OpenFile(new_path, Mode::ReadWrite);
@@ -130,10 +149,14 @@ VirtualFile RealVfsFilesystem::MoveFile(std::string_view old_path_, std::string_
 
 bool RealVfsFilesystem::DeleteFile(std::string_view path_) {
     const auto path = FileUtil::SanitizePath(path_, FileUtil::DirectorySeparator::PlatformDefault);
-    if (cache.find(path) != cache.end()) {
-        if (!cache[path].expired())
-            cache[path].lock()->Close();
-        cache.erase(path);
+    {
+        std::lock_guard lock{cache_mutex};
+        EraseMappings(path);
+        if (cache.find(path) != cache.end()) {
+            if (!cache[path].expired())
+                cache[path].lock()->Close();
+            cache.erase(path);
+        }
     }
     return FileUtil::Delete(path);
 }
@@ -179,6 +202,8 @@ VirtualDir RealVfsFilesystem::MoveDirectory(std::string_view old_path_,
         FileUtil::IsDirectory(old_path) || !FileUtil::Rename(old_path, new_path))
         return nullptr;
 
+    std::unique_lock lock{cache_mutex};
+    EraseMappings(old_path);
     for (auto& kv : cache) {
         // Path in cache starts with old_path
         if (kv.first.rfind(old_path, 0) == 0) {
@@ -196,12 +221,15 @@ VirtualDir RealVfsFilesystem::MoveDirectory(std::string_view old_path_,
             }
         }
     }
+    lock.unlock();
 
     return OpenDirectory(new_path, Mode::ReadWrite);
 }
 
 bool RealVfsFilesystem::DeleteDirectory(std::string_view path_) {
     const auto path = FileUtil::SanitizePath(path_, FileUtil::DirectorySeparator::PlatformDefault);
+    std::unique_lock lock{cache_mutex};
+    EraseMappings(path);
     for (auto& kv : cache) {
         // Path in cache starts with old_path
         if (kv.first.rfind(path, 0) == 0) {
@@ -210,12 +238,52 @@ bool RealVfsFilesystem::DeleteDirectory(std::string_view path_) {
             cache.erase(kv.first);
         }
     }
+    lock.unlock();
     return FileUtil::DeleteDirRecursively(path);
 }
 
+std::shared_ptr<Common::MappedFile> RealVfsFilesystem::OpenMapping(const std::string& path,
+                                                                    Mode perms, std::size_t size) {
+    // Writable files may be resized, which would leave the mapping pointing past their end, so
+    // they aren't mapped and their old mapping isn't handed out anymore
+    if (perms != Mode::Read || size < MinMappedFileSize) {
+        mapped_cache.erase(path);
+        return nullptr;
+    }
+
+    const auto it = mapped_cache.find(path);
+    if (it != mapped_cache.end()) {
+        // Files resized since they were mapped are mapped again
+        auto mapping = it->second.lock();
+        if (mapping != nullptr && mapping->Size() == size)
+            return mapping;
+    }
+
+    auto mapping = std::make_shared<Common::MappedFile>(path);
+    if (!mapping->IsOpen()) {
+        mapped_cache.erase(path);
+        return nullptr;
+    }
+    // Game images are mostly read in small scattered pieces, large spans prefetch their range
+    mapping->Advise(0, mapping->Size(), Common::MappedFile::Access::Random);
+    mapped_cache[path] = mapping;
+    return mapping;
+}
+
+void RealVfsFilesystem::EraseMappings(const std::string& path) {
+    for (auto it = mapped_cache.begin(); it != mapped_cache.end();) {
+        // Path in cache starts with path
+        if (it->first.rfind(path, 0) == 0)
+            it = mapped_cache.erase(it);
+        else
+            ++it;
+    }
+}
+
 RealVfsFile::RealVfsFile(RealVfsFilesystem& base_, std::shared_ptr<FileUtil::IOFile> backing_,
-                         const std::string& path_, Mode perms_)
-    : base(base_), backing(std::move(backing_)), path(path_),
+                         std::shared_ptr<Common::MappedFile> mapping_, const std::string& path_,
+                         Mode perms_)
+    : base(base_), backing(std::move(backing_)), mapping(std::move(mapping_)), path(path_),
       parent_path(FileUtil::GetParentPath(path_)),
       path_components(FileUtil::SplitPathComponents(path_)),
       parent_components(FileUtil::SliceVector(path_components, 0, path_components.size() - 1)),
@@ -248,6 +316,10 @@ bool RealVfsFile::IsReadable() const {
 }
 
 std::size_t RealVfsFile::Read(u8* data, std::size_t length, std::size_t offset) const {
+    if (const u8* const mapped = GetMappedRange(offset, length)) {
+        std::memcpy(data, mapped, length);
+        return length;
+    }
     if (!backing->Seek(offset, SEEK_SET))
         return 0;
     return backing->ReadBytes(data, length);
@@ -259,6 +331,20 @@ std::size_t RealVfsFile::Write(const u8* data, std::size_t length, std::size_t o
     return backing->WriteBytes(data, length);
 }
 
+const u8* RealVfsFile::GetMappedSpan(std::size_t offset, std::size_t size) const {
+    const u8* const mapped = GetMappedRange(offset, size);
+    if (mapped != nullptr && size >= MinPrefetchSize)
+        mapping->Advise(offset, size, Common::MappedFile::Access::WillNeed);
+    return mapped;
+}
+
+const u8* RealVfsFile::GetMappedRange(std::size_t offset, std::size_t size) const {
+    if (mapping == nullptr || offset > mapping->Size() || size > mapping->Size() - offset)
+        return nullptr;
+
+    return mapping->Data() + offset;
+}
+
 bool RealVfsFile::Rename(std::string_view name) {
     return base.MoveFile(path, parent_path + DIR_SEP + std::string(name)) != nullptr;
 }
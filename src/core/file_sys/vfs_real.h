@@ -4,11 +4,16 @@
 
 #pragma once
 
+#include <mutex>
 #include <string_view>
 #include <boost/container/flat_map.hpp>
 #include "core/file_sys/mode.h"
 #include "core/file_sys/vfs.h"
 
+namespace Common {
+class MappedFile;
+}
+
 namespace FileUtil {
 class IOFile;
 }
@@ -36,7 +41,17 @@ public:
     bool DeleteDirectory(std::string_view path) override;
 
 private:
+    // Maps large files opened read-only, e.g. game images. Returns null for other files.
+    std::shared_ptr<Common::MappedFile> OpenMapping(const std::string& path, Mode perms,
+                                                    std::size_t size);
+
+    // Forgets the mappings of the files under path, they are no longer reused.
+    void EraseMappings(const std::string& path);
+
+    // Guards the caches, so files can be opened from several threads
+    std::mutex cache_mutex;
     boost::container::flat_map<std::string, std::weak_ptr<FileUtil::IOFile>> cache;
+    boost::container::flat_map<std::string, std::weak_ptr<Common::MappedFile>> mapped_cache;
 };
 
 // An implmentation of VfsFile that represents a file on the user's computer.
@@ -55,16 +70,22 @@ public:
     bool IsReadable() const override;
     std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override;
     std::size_t Write(const u8* data, std::size_t length, std::size_t offset) override;
+    const u8* GetMappedSpan(std::size_t offset, std::size_t size) const override;
     bool Rename(std::string_view name) override;
 
 private:
     RealVfsFile(RealVfsFilesystem& base, std::shared_ptr<FileUtil::IOFile> backing,
-                const std::string& path, Mode perms = Mode::Read);
+                std::shared_ptr<Common::MappedFile> mapping, const std::string& path,
+                Mode perms = Mode::Read);
 
     bool Close();
 
+    // GetMappedSpan without the prefetch hint, used for reads.
+    const u8* GetMappedRange(std::size_t offset, std::size_t size) const;
+
     RealVfsFilesystem& base;
     std::shared_ptr<FileUtil::IOFile> backing;
+    std::shared_ptr<Common::MappedFile> mapping; ///< Null unless the file is large and read-only
     std::string path;
     std::string parent_path;
     std::vector<std::string> path_components;
@@ -280,6 +280,11 @@ ResultCode HLERequestContext::WriteToOutgoingCommandBuffer(Thread& thread) {
 
 std::vector<u8> HLERequestContext::ReadBuffer(int buffer_index) const {
     std::vector<u8> buffer;
+    ReadBuffer(buffer, buffer_index);
+    return buffer;
+}
+
+void HLERequestContext::ReadBuffer(std::vector<u8>& buffer, int buffer_index) const {
     const bool is_buffer_a{BufferDescriptorA().size() && BufferDescriptorA()[buffer_index].Size()};
 
     if (is_buffer_a) {
@@ -291,8 +296,6 @@ std::vector<u8> HLERequestContext::ReadBuffer(int buffer_index) const {
         Memory::ReadBlock(BufferDescriptorX()[buffer_index].Address(), buffer.data(),
                           buffer.size());
     }
-
-    return buffer;
 }
 
 std::size_t HLERequestContext::WriteBuffer(const void* buffer, std::size_t size,
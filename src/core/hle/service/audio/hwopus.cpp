@@ -2,9 +2,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstring>
 #include <memory>
+#include <mutex>
 #include <vector>
 
 #include <opus.h>
@@ -34,6 +37,70 @@ struct OpusPacketHeader {
 };
 static_assert(sizeof(OpusPacketHeader) == 0x8, "OpusHeader is an invalid size");
 
+struct OpusMultiStreamParameters {
+    u32 sample_rate;
+    u32 channel_count;
+    u32 stream_count;
+    u32 stereo_stream_count;
+    // Maps each output channel to a decoded channel, entries past channel_count are zero.
+    std::array<u8, 0x100> channel_mappings;
+};
+static_assert(sizeof(OpusMultiStreamParameters) == 0x110,
+              "OpusMultiStreamParameters is an invalid size");
+
+bool operator==(const OpusMultiStreamParameters& lhs, const OpusMultiStreamParameters& rhs) {
+    return std::memcmp(&lhs, &rhs, sizeof(OpusMultiStreamParameters)) == 0;
+}
+} // Anonymous namespace
+
+/// Keeps the decoders of closed sessions, games opening a decoder for each sound they stream
+/// reuse an initialized decoder instead of allocating a new one.
+class OpusDecoderPool {
+public:
+    /// Returns a decoder in its initial state for the given layout, or null on failure.
+    OpusDecoderPtr Acquire(const OpusMultiStreamParameters& params, int& error) {
+        {
+            std::lock_guard lock{mutex};
+            const auto it = std::find_if(entries.begin(), entries.end(),
+                                         [&params](const Entry& entry) {
+                                             return entry.params == params;
+                                         });
+            if (it != entries.end()) {
+                OpusDecoderPtr decoder = std::move(it->decoder);
+                entries.erase(it);
+                error = opus_multistream_decoder_ctl(decoder.get(), OPUS_RESET_STATE);
+                return decoder;
+            }
+        }
+        return OpusDecoderPtr{opus_multistream_decoder_create(
+            static_cast<opus_int32>(params.sample_rate), static_cast<int>(params.channel_count),
+            static_cast<int>(params.stream_count), static_cast<int>(params.stereo_stream_count),
+            params.channel_mappings.data(), &error)};
+    }
+
+    /// Keeps a decoder for a later session with the same layout.
+    void Release(const OpusMultiStreamParameters& params, OpusDecoderPtr decoder) {
+        std::lock_guard lock{mutex};
+        if (entries.size() >= MaxPooledDecoders) {
+            // Drop the least recently released decoder
+            entries.erase(entries.begin());
+        }
+        entries.push_back({params, std::move(decoder)});
+    }
+
+private:
+    static constexpr std::size_t MaxPooledDecoders = 16;
+
+    struct Entry {
+        OpusMultiStreamParameters params;
+        OpusDecoderPtr decoder;
+    };
+
+    std::mutex mutex;
+    std::vector<Entry> entries;
+};
+
+namespace {
 class OpusDecoderState {
 public:
     /// Describes extra behavior that may be asked of the decoding context.
@@ -50,11 +117,29 @@ public:
         Enabled,
     };
 
-    explicit OpusDecoderState(OpusDecoderPtr decoder, u32 sample_rate, u32 channel_count)
-        : decoder{std::move(decoder)}, sample_rate{sample_rate}, channel_count{channel_count} {}
+    explicit OpusDecoderState(std::shared_ptr<OpusDecoderPool> pool,
+                              const OpusMultiStreamParameters& params, OpusDecoderPtr decoder)
+        : pool{std::move(pool)}, params{params}, decoder{std::move(decoder)} {}
+
+    ~OpusDecoderState() {
+        if (stats.num_calls != 0) {
+            LOG_DEBUG(Audio, "Decoded {} packets, average={}us, max={}us", stats.num_calls,
+                      stats.total_time / stats.num_calls, stats.max_time);
+        }
+        pool->Release(params, std::move(decoder));
+    }
+
+    OpusDecoderState(const OpusDecoderState&) = delete;
+    OpusDecoderState& operator=(const OpusDecoderState&) = delete;
 
     // Decodes interleaved Opus packets. Optionally allows reporting time taken to
     // perform the decoding, as well as any relevant extra behavior.
+    //
+    // Packets are decoded on the calling thread. The guest waits for the decoded samples in the
+    // reply, and each packet depends on the decoder state left by the previous one, so there is
+    // no later request to overlap a decode with. libopus only decodes multistream packets as a
+    // whole, splitting their streams across threads would mean parsing the self-delimited
+    // framing and mixing the channels here.
     void DecodeInterleaved(Kernel::HLERequestContext& ctx, PerfTime perf_time,
                            ExtraBehavior extra_behavior) {
         if (perf_time == PerfTime::Disabled) {
@@ -66,17 +151,27 @@ public:
     }
 
 private:
+    /// Decoding times of a session, in microseconds.
+    struct DecodeStats {
+        u64 num_calls = 0;
+        u64 total_time = 0;
+        u64 max_time = 0;
+    };
+
     void DecodeInterleavedHelper(Kernel::HLERequestContext& ctx, u64* performance,
                                  ExtraBehavior extra_behavior) {
         u32 consumed = 0;
         u32 sample_count = 0;
-        std::vector<opus_int16> samples(ctx.GetWriteBufferSize() / sizeof(opus_int16));
+
+        // The buffers are reused between calls, they only allocate when a larger packet comes in
+        ctx.ReadBuffer(input);
+        samples.resize(ctx.GetWriteBufferSize() / sizeof(opus_int16));
 
         if (extra_behavior == ExtraBehavior::ResetContext) {
             ResetDecoderContext();
         }
 
-        if (!DecodeOpusData(consumed, sample_count, ctx.ReadBuffer(), samples, performance)) {
+        if (!DecodeOpusData(consumed, sample_count, input, samples, performance)) {
             LOG_ERROR(Audio, "Failed to decode opus data");
             IPC::ResponseBuilder rb{ctx, 2};
             // TODO(ogniK): Use correct error code
@@ -92,11 +187,16 @@ private:
         if (performance) {
             rb.Push<u64>(*performance);
         }
+
+        // The reused buffer holds samples of previous packets past the decoded ones, clear them
+        const std::size_t decoded_count = sample_count * params.channel_count;
+        std::fill(samples.begin() + std::min(decoded_count, samples.size()), samples.end(),
+                  opus_int16{0});
         ctx.WriteBuffer(samples.data(), samples.size() * sizeof(s16));
     }
 
     bool DecodeOpusData(u32& consumed, u32& sample_count, const std::vector<u8>& input,
-                        std::vector<opus_int16>& output, u64* out_performance_time) const {
+                        std::vector<opus_int16>& output, u64* out_performance_time) {
         const auto start_time = std::chrono::high_resolution_clock::now();
         const std::size_t raw_output_sz = output.size() * sizeof(opus_int16);
         if (sizeof(OpusPacketHeader) > input.size()) {
@@ -116,16 +216,17 @@ private:
         const auto frame = input.data() + sizeof(OpusPacketHeader);
         const auto decoded_sample_count = opus_packet_get_nb_samples(
             frame, static_cast<opus_int32>(input.size() - sizeof(OpusPacketHeader)),
-            static_cast<opus_int32>(sample_rate));
-        if (decoded_sample_count * channel_count * sizeof(u16) > raw_output_sz) {
+            static_cast<opus_int32>(params.sample_rate));
+        if (decoded_sample_count * params.channel_count * sizeof(u16) > raw_output_sz) {
             LOG_ERROR(
                 Audio,
                 "Decoded data does not fit into the output data, decoded_sz={}, raw_output_sz={}",
-                decoded_sample_count * channel_count * sizeof(u16), raw_output_sz);
+                decoded_sample_count * params.channel_count * sizeof(u16), raw_output_sz);
             return false;
         }
 
-        const int frame_size = (static_cast<int>(raw_output_sz / sizeof(s16) / channel_count));
+        const int frame_size =
+            static_cast<int>(raw_output_sz / sizeof(s16) / params.channel_count);
         const auto out_sample_count =
             opus_multistream_decode(decoder.get(), frame, hdr.size, output.data(), frame_size, 0);
         if (out_sample_count < 0) {
@@ -137,6 +238,14 @@ private:
         }
 
         const auto end_time = std::chrono::high_resolution_clock::now() - start_time;
+        const auto decode_time = static_cast<u64>(
+            std::chrono::duration_cast<std::chrono::microseconds>(end_time).count());
+        ++stats.num_calls;
+        stats.total_time += decode_time;
+        stats.max_time = std::max(stats.max_time, decode_time);
+        LOG_TRACE(Audio, "Decoded {} samples from {} bytes in {}us", out_sample_count,
+                  static_cast<u32>(hdr.size), decode_time);
+
         sample_count = out_sample_count;
         consumed = static_cast<u32>(sizeof(OpusPacketHeader) + hdr.size);
         if (out_performance_time != nullptr) {
@@ -153,25 +262,32 @@ private:
         opus_multistream_decoder_ctl(decoder.get(), OPUS_RESET_STATE);
     }
 
+    std::shared_ptr<OpusDecoderPool> pool;
+    const OpusMultiStreamParameters params;
     OpusDecoderPtr decoder;
-    u32 sample_rate;
-    u32 channel_count;
+
+    std::vector<u8> input;
+    std::vector<opus_int16> samples;
+    DecodeStats stats;
 };
 
 class IHardwareOpusDecoderManager final : public ServiceFramework<IHardwareOpusDecoderManager> {
 public:
-    explicit IHardwareOpusDecoderManager(OpusDecoderState decoder_state)
-        : ServiceFramework("IHardwareOpusDecoderManager"), decoder_state{std::move(decoder_state)} {
+    explicit IHardwareOpusDecoderManager(std::shared_ptr<OpusDecoderPool> pool,
+                                         const OpusMultiStreamParameters& params,
+                                         OpusDecoderPtr decoder)
+        : ServiceFramework("IHardwareOpusDecoderManager"),
+          decoder_state{std::move(pool), params, std::move(decoder)} {
         // clang-format off
         static const FunctionInfo functions[] = {
             {0, &IHardwareOpusDecoderManager::DecodeInterleavedOld, "DecodeInterleavedOld"},
             {1, nullptr, "SetContext"},
-            {2, nullptr, "DecodeInterleavedForMultiStreamOld"},
+            {2, &IHardwareOpusDecoderManager::DecodeInterleavedOld, "DecodeInterleavedForMultiStreamOld"},
             {3, nullptr, "SetContextForMultiStream"},
             {4, &IHardwareOpusDecoderManager::DecodeInterleavedWithPerfOld, "DecodeInterleavedWithPerfOld"},
-            {5, nullptr, "DecodeInterleavedForMultiStreamWithPerfOld"},
+            {5, &IHardwareOpusDecoderManager::DecodeInterleavedWithPerfOld, "DecodeInterleavedForMultiStreamWithPerfOld"},
             {6, &IHardwareOpusDecoderManager::DecodeInterleaved, "DecodeInterleaved"},
-            {7, nullptr, "DecodeInterleavedForMultiStream"},
+            {7, &IHardwareOpusDecoderManager::DecodeInterleaved, "DecodeInterleavedForMultiStream"},
         };
         // clang-format on
 
@@ -206,27 +322,74 @@ private:
     OpusDecoderState decoder_state;
 };
 
-std::size_t WorkerBufferSize(u32 channel_count) {
-    ASSERT_MSG(channel_count == 1 || channel_count == 2, "Invalid channel count");
-    constexpr int num_streams = 1;
-    const int num_stereo_streams = channel_count == 2 ? 1 : 0;
-    return opus_multistream_decoder_get_size(num_streams, num_stereo_streams);
+bool IsValidSampleRate(u32 sample_rate) {
+    return sample_rate == 48000 || sample_rate == 24000 || sample_rate == 16000 ||
+           sample_rate == 12000 || sample_rate == 8000;
+}
+
+// Creates the parameters of a single stream decoder. In the stereo case, we map
+// the left and right input channels to the left and right output channels
+// respectively, in the monophonic case the one available channel is mapped to
+// the sole output channel.
+OpusMultiStreamParameters CreateSingleStreamParameters(u32 sample_rate, u32 channel_count) {
+    OpusMultiStreamParameters params{};
+    params.sample_rate = sample_rate;
+    params.channel_count = channel_count;
+    params.stream_count = 1;
+    params.stereo_stream_count = channel_count == 2 ? 1 : 0;
+    params.channel_mappings[0] = 0;
+    params.channel_mappings[1] = channel_count == 2 ? 1 : 0;
+    return params;
+}
+
+// Reads the multistream parameters passed by the guest. Returns false when they
+// describe an invalid layout.
+bool ReadMultiStreamParameters(Kernel::HLERequestContext& ctx, OpusMultiStreamParameters& params) {
+    const auto buffer = ctx.ReadBuffer();
+    if (buffer.size() < sizeof(OpusMultiStreamParameters)) {
+        LOG_ERROR(Audio, "Parameters buffer is too small, size={}", buffer.size());
+        return false;
+    }
+    std::memcpy(&params, buffer.data(), sizeof(OpusMultiStreamParameters));
+
+    if (!IsValidSampleRate(params.sample_rate) || params.channel_count == 0 ||
+        params.channel_count > 255 || params.stream_count == 0 ||
+        params.stereo_stream_count > params.stream_count ||
+        params.stream_count + params.stereo_stream_count > 255) {
+        LOG_ERROR(Audio,
+                  "Invalid multistream parameters, sample_rate={}, channel_count={}, "
+                  "stream_count={}, stereo_stream_count={}",
+                  params.sample_rate, params.channel_count, params.stream_count,
+                  params.stereo_stream_count);
+        return false;
+    }
+
+    // Clear the unused mappings, so equal layouts compare equal when pooling decoders
+    std::fill(params.channel_mappings.begin() + params.channel_count,
+              params.channel_mappings.end(), u8{0});
+    return true;
+}
+
+std::size_t WorkerBufferSize(const OpusMultiStreamParameters& params) {
+    return opus_multistream_decoder_get_size(static_cast<int>(params.stream_count),
+                                             static_cast<int>(params.stereo_stream_count));
 }
 
-// Creates the mapping table that maps the input channels to the particular
-// output channels. In the stereo case, we map the left and right input channels
-// to the left and right output channels respectively.
-//
-// However, in the monophonic case, we only map the one available channel
-// to the sole output channel. We specify 255 for the would-be right channel
-// as this is a special value defined by Opus to indicate to the decoder to
-// ignore that channel.
-std::array<u8, 2> CreateMappingTable(u32 channel_count) {
-    if (channel_count == 2) {
-        return {{0, 1}};
+void OpenDecoder(Kernel::HLERequestContext& ctx, const std::shared_ptr<OpusDecoderPool>& pool,
+                 const OpusMultiStreamParameters& params) {
+    int error = 0;
+    OpusDecoderPtr decoder = pool->Acquire(params, error);
+    if (error != OPUS_OK || decoder == nullptr) {
+        LOG_ERROR(Audio, "Failed to create Opus decoder (error={}).", error);
+        IPC::ResponseBuilder rb{ctx, 2};
+        // TODO(ogniK): Use correct error code
+        rb.Push(ResultCode(-1));
+        return;
     }
 
-    return {{0, 255}};
+    IPC::ResponseBuilder rb{ctx, 2, 0, 1};
+    rb.Push(RESULT_SUCCESS);
+    rb.PushIpcInterface<IHardwareOpusDecoderManager>(pool, params, std::move(decoder));
 }
 } // Anonymous namespace
 
@@ -237,12 +400,11 @@ void HwOpus::GetWorkBufferSize(Kernel::HLERequestContext& ctx) {
 
     LOG_DEBUG(Audio, "called with sample_rate={}, channel_count={}", sample_rate, channel_count);
 
-    ASSERT_MSG(sample_rate == 48000 || sample_rate == 24000 || sample_rate == 16000 ||
-                   sample_rate == 12000 || sample_rate == 8000,
-               "Invalid sample rate");
+    ASSERT_MSG(IsValidSampleRate(sample_rate), "Invalid sample rate");
     ASSERT_MSG(channel_count == 1 || channel_count == 2, "Invalid channel count");
 
-    const u32 worker_buffer_sz = static_cast<u32>(WorkerBufferSize(channel_count));
+    const auto params = CreateSingleStreamParameters(sample_rate, channel_count);
+    const u32 worker_buffer_sz = static_cast<u32>(WorkerBufferSize(params));
     LOG_DEBUG(Audio, "worker_buffer_sz={}", worker_buffer_sz);
 
     IPC::ResponseBuilder rb{ctx, 3};
@@ -259,41 +421,65 @@ void HwOpus::OpenOpusDecoder(Kernel::HLERequestContext& ctx) {
     LOG_DEBUG(Audio, "called sample_rate={}, channel_count={}, buffer_size={}", sample_rate,
               channel_count, buffer_sz);
 
-    ASSERT_MSG(sample_rate == 48000 || sample_rate == 24000 || sample_rate == 16000 ||
-                   sample_rate == 12000 || sample_rate == 8000,
-               "Invalid sample rate");
+    ASSERT_MSG(IsValidSampleRate(sample_rate), "Invalid sample rate");
     ASSERT_MSG(channel_count == 1 || channel_count == 2, "Invalid channel count");
 
-    const std::size_t worker_sz = WorkerBufferSize(channel_count);
+    const auto params = CreateSingleStreamParameters(sample_rate, channel_count);
+    const std::size_t worker_sz = WorkerBufferSize(params);
     ASSERT_MSG(buffer_sz >= worker_sz, "Worker buffer too large");
 
-    const int num_stereo_streams = channel_count == 2 ? 1 : 0;
-    const auto mapping_table = CreateMappingTable(channel_count);
+    OpenDecoder(ctx, decoder_pool, params);
+}
 
-    int error = 0;
-    OpusDecoderPtr decoder{
-        opus_multistream_decoder_create(sample_rate, static_cast<int>(channel_count), 1,
-                                        num_stereo_streams, mapping_table.data(), &error)};
-    if (error != OPUS_OK || decoder == nullptr) {
-        LOG_ERROR(Audio, "Failed to create Opus decoder (error={}).", error);
+void HwOpus::OpenOpusDecoderForMultiStream(Kernel::HLERequestContext& ctx) {
+    IPC::RequestParser rp{ctx};
+    const auto buffer_sz = rp.Pop<u32>();
+
+    OpusMultiStreamParameters params{};
+    if (!ReadMultiStreamParameters(ctx, params)) {
         IPC::ResponseBuilder rb{ctx, 2};
         // TODO(ogniK): Use correct error code
         rb.Push(ResultCode(-1));
         return;
     }
 
-    IPC::ResponseBuilder rb{ctx, 2, 0, 1};
+    LOG_DEBUG(Audio,
+              "called sample_rate={}, channel_count={}, stream_count={}, "
+              "stereo_stream_count={}, buffer_size={}",
+              params.sample_rate, params.channel_count, params.stream_count,
+              params.stereo_stream_count, buffer_sz);
+
+    const std::size_t worker_sz = WorkerBufferSize(params);
+    ASSERT_MSG(buffer_sz >= worker_sz, "Worker buffer too large");
+
+    OpenDecoder(ctx, decoder_pool, params);
+}
+
+void HwOpus::GetWorkBufferSizeForMultiStream(Kernel::HLERequestContext& ctx) {
+    OpusMultiStreamParameters params{};
+    if (!ReadMultiStreamParameters(ctx, params)) {
+        IPC::ResponseBuilder rb{ctx, 2};
+        // TODO(ogniK): Use correct error code
+        rb.Push(ResultCode(-1));
+        return;
+    }
+
+    const u32 worker_buffer_sz = static_cast<u32>(WorkerBufferSize(params));
+    LOG_DEBUG(Audio, "called stream_count={}, stereo_stream_count={}, worker_buffer_sz={}",
+              params.stream_count, params.stereo_stream_count, worker_buffer_sz);
+
+    IPC::ResponseBuilder rb{ctx, 3};
     rb.Push(RESULT_SUCCESS);
-    rb.PushIpcInterface<IHardwareOpusDecoderManager>(
-        OpusDecoderState{std::move(decoder), sample_rate, channel_count});
+    rb.Push<u32>(worker_buffer_sz);
 }
 
-HwOpus::HwOpus() : ServiceFramework("hwopus") {
+HwOpus::HwOpus()
+    : ServiceFramework("hwopus"), decoder_pool{std::make_shared<OpusDecoderPool>()} {
     static const FunctionInfo functions[] = {
         {0, &HwOpus::OpenOpusDecoder, "OpenOpusDecoder"},
         {1, &HwOpus::GetWorkBufferSize, "GetWorkBufferSize"},
-        {2, nullptr, "OpenOpusDecoderForMultiStream"},
-        {3, nullptr, "GetWorkBufferSizeForMultiStream"},
+        {2, &HwOpus::OpenOpusDecoderForMultiStream, "OpenOpusDecoderForMultiStream"},
+        {3, &HwOpus::GetWorkBufferSizeForMultiStream, "GetWorkBufferSizeForMultiStream"},
     };
     RegisterHandlers(functions);
 }
@@ -4,10 +4,14 @@
 
 #pragma once
 
+#include <memory>
+
 #include "core/hle/service/service.h"
 
 namespace Service::Audio {
 
+class OpusDecoderPool;
+
 class HwOpus final : public ServiceFramework<HwOpus> {
 public:
     explicit HwOpus();
@@ -16,6 +20,10 @@ public:
 private:
     void OpenOpusDecoder(Kernel::HLERequestContext& ctx);
     void GetWorkBufferSize(Kernel::HLERequestContext& ctx);
+    void OpenOpusDecoderForMultiStream(Kernel::HLERequestContext& ctx);
+    void GetWorkBufferSizeForMultiStream(Kernel::HLERequestContext& ctx);
+
+    std::shared_ptr<OpusDecoderPool> decoder_pool;
 };
 
 } // namespace Service::Audio
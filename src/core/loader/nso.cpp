@@ -34,10 +34,10 @@ struct MODHeader {
 };
 static_assert(sizeof(MODHeader) == 0x1c, "MODHeader has incorrect size.");
 
-std::vector<u8> DecompressSegment(const std::vector<u8>& compressed_data,
+std::vector<u8> DecompressSegment(const u8* compressed_data, std::size_t compressed_size,
                                   const NSOSegmentHeader& header) {
     const std::vector<u8> uncompressed_data =
-        Common::Compression::DecompressDataLZ4(compressed_data, header.size);
+        Common::Compression::DecompressDataLZ4(compressed_data, compressed_size, header.size);
 
     ASSERT_MSG(uncompressed_data.size() == header.size, "{} != {}", header.size,
                uncompressed_data.size());
@@ -55,6 +55,27 @@ bool NSOHeader::IsSegmentCompressed(size_t segment_num) const {
     return ((flags >> segment_num) & 1) != 0;
 }
 
+std::size_t AppLoader_NSO::LoadSegment(const FileSys::VfsFile& file, const NSOHeader& header,
+                                       std::size_t segment, Kernel::PhysicalMemory& image) {
+    // Memory backed files are decompressed or copied from without an intermediate copy
+    std::size_t size = header.segments_compressed_size[segment];
+    const u8* data = file.GetMappedSpan(header.segments[segment].offset, size);
+    std::vector<u8> buffer;
+    if (data == nullptr) {
+        buffer = file.ReadBytes(size, header.segments[segment].offset);
+        data = buffer.data();
+        size = buffer.size();
+    }
+    if (header.IsSegmentCompressed(segment)) {
+        buffer = DecompressSegment(data, size, header.segments[segment]);
+        data = buffer.data();
+        size = buffer.size();
+    }
+    image.resize(header.segments[segment].location);
+    image.insert(image.end(), data, data + size);
+    return size;
+}
+
 AppLoader_NSO::AppLoader_NSO(FileSys::VirtualFile file) : AppLoader(std::move(file)) {}
 
 FileType AppLoader_NSO::IdentifyType(const FileSys::VirtualFile& file) {
@@ -91,16 +112,10 @@ std::optional<VAddr> AppLoader_NSO::LoadModule(Kernel::Process& process,
     Kernel::CodeSet codeset;
     Kernel::PhysicalMemory program_image;
     for (std::size_t i = 0; i < nso_header.segments.size(); ++i) {
-        std::vector<u8> data =
-            file.ReadBytes(nso_header.segments_compressed_size[i], nso_header.segments[i].offset);
-        if (nso_header.IsSegmentCompressed(i)) {
-            data = DecompressSegment(data, nso_header.segments[i]);
-        }
-        program_image.resize(nso_header.segments[i].location);
-        program_image.insert(program_image.end(), data.begin(), data.end());
+        const std::size_t size = LoadSegment(file, nso_header, i, program_image);
         codeset.segments[i].addr = nso_header.segments[i].location;
         codeset.segments[i].offset = nso_header.segments[i].location;
-        codeset.segments[i].size = PageAlignSize(static_cast<u32>(data.size()));
+        codeset.segments[i].size = PageAlignSize(static_cast<u32>(size));
     }
 
     if (should_pass_arguments && !Settings::values.program_args.empty()) {
@@ -10,6 +10,7 @@
 #include "common/common_types.h"
 #include "common/swap.h"
 #include "core/file_sys/patch_manager.h"
+#include "core/hle/kernel/physical_memory.h"
 #include "core/loader/loader.h"
 
 namespace Kernel {
@@ -80,6 +81,14 @@ public:
         return IdentifyType(file);
     }
 
+    /**
+     * Resizes a program image to the location of an NSO segment and appends the segment,
+     * decompressed if needed. Memory backed files are read in place.
+     * @return Size of the segment in the image
+     */
+    static std::size_t LoadSegment(const FileSys::VfsFile& file, const NSOHeader& header,
+                                   std::size_t segment, Kernel::PhysicalMemory& image);
+
     static std::optional<VAddr> LoadModule(Kernel::Process& process, const FileSys::VfsFile& file,
                                            VAddr load_base, bool should_pass_arguments,
                                            std::optional<FileSys::PatchManager> pm = {});
@@ -74,6 +74,20 @@ void PerfStats::EndGameFrame() {
     game_frames += 1;
 }
 
+void PerfStats::AddPresentedFrame(Clock::duration latency, Clock::duration present_time) {
+    std::lock_guard lock{object_mutex};
+
+    accumulated_present_latency += latency;
+    accumulated_present_time += present_time;
+    presented_frames += 1;
+}
+
+void PerfStats::AddDroppedFrame() {
+    std::lock_guard lock{object_mutex};
+
+    dropped_frames += 1;
+}
+
 double PerfStats::GetMeanFrametime() {
     std::lock_guard lock{object_mutex};
 
@@ -100,6 +114,13 @@ PerfStatsResults PerfStats::GetAndResetStats(microseconds current_system_time_us
     results.frametime = duration_cast<DoubleSecs>(accumulated_frametime).count() /
                         static_cast<double>(system_frames);
     results.emulation_speed = system_us_per_second.count() / 1'000'000.0;
+    if (presented_frames > 0) {
+        results.present_latency = duration_cast<DoubleSecs>(accumulated_present_latency).count() /
+                                  static_cast<double>(presented_frames);
+        results.present_time = duration_cast<DoubleSecs>(accumulated_present_time).count() /
+                               static_cast<double>(presented_frames);
+    }
+    results.dropped_frames = dropped_frames;
 
     // Reset counters
     reset_point = now;
@@ -107,6 +128,10 @@ PerfStatsResults PerfStats::GetAndResetStats(microseconds current_system_time_us
     accumulated_frametime = Clock::duration::zero();
     system_frames = 0;
     game_frames = 0;
+    accumulated_present_latency = Clock::duration::zero();
+    accumulated_present_time = Clock::duration::zero();
+    presented_frames = 0;
+    dropped_frames = 0;
 
     return results;
 }
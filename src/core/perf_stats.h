@@ -21,6 +21,13 @@ struct PerfStatsResults {
     double frametime;
     /// Ratio of walltime / emulated time elapsed
     double emulation_speed;
+    /// Mean walltime from a frame being queued for presentation until the host presented it, in
+    /// seconds
+    double present_latency;
+    /// Mean walltime spent by the host presenting a frame, in seconds
+    double present_time;
+    /// Frames dropped by the present queue in favor of newer frames
+    u32 dropped_frames;
 };
 
 /**
@@ -39,6 +46,13 @@ public:
     void EndSystemFrame();
     void EndGameFrame();
 
+    /// Records a frame presented by the host. The latency is measured from the moment the frame
+    /// was queued for presentation, the present time only covers the host presentation.
+    void AddPresentedFrame(Clock::duration latency, Clock::duration present_time);
+
+    /// Records a frame the present queue dropped without presenting it.
+    void AddDroppedFrame();
+
     PerfStatsResults GetAndResetStats(std::chrono::microseconds current_system_time_us);
 
     /**
@@ -75,6 +89,15 @@ private:
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     u32 game_frames = 0;
 
+    /// Cumulative latency of the frames presented since last reset
+    Clock::duration accumulated_present_latency = Clock::duration::zero();
+    /// Cumulative host presentation time of the frames presented since last reset
+    Clock::duration accumulated_present_time = Clock::duration::zero();
+    /// Cumulative number of frames presented by the host since last reset
+    u32 presented_frames = 0;
+    /// Cumulative number of frames dropped by the present queue since last reset
+    u32 dropped_frames = 0;
+
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
     /// Point when the current system frame began
@@ -90,6 +90,7 @@ void LogSettings() {
     LogSetting("System_CurrentUser", Settings::values.current_user);
     LogSetting("System_LanguageIndex", Settings::values.language_index);
     LogSetting("Core_UseMultiCore", Settings::values.use_multi_core);
+    LogSetting("Renderer_Backend", static_cast<int>(Settings::values.renderer_backend));
     LogSetting("Renderer_UseResolutionFactor", Settings::values.resolution_factor);
     LogSetting("Renderer_UseFrameLimit", Settings::values.use_frame_limit);
     LogSetting("Renderer_FrameLimit", Settings::values.frame_limit);
@@ -97,6 +98,9 @@ void LogSettings() {
     LogSetting("Renderer_UseAccurateGpuEmulation", Settings::values.use_accurate_gpu_emulation);
     LogSetting("Renderer_UseAsynchronousGpuEmulation",
                Settings::values.use_asynchronous_gpu_emulation);
+    LogSetting("Renderer_TextureCacheBudget", Settings::values.texture_cache_budget);
+    LogSetting("Renderer_PresentQueueDepth", Settings::values.present_queue_depth);
+    LogSetting("Renderer_UsePresentMailbox", Settings::values.use_present_mailbox);
     LogSetting("Audio_OutputEngine", Settings::values.sink_id);
     LogSetting("Audio_EnableAudioStretching", Settings::values.enable_audio_stretching);
     LogSetting("Audio_OutputDevice", Settings::values.audio_device_id);
@@ -371,6 +371,11 @@ enum class SDMCSize : u64 {
     S1TB = 0x10000000000ULL,
 };
 
+enum class RendererBackend {
+    OpenGL = 0,
+    Null = 1,
+};
+
 struct Values {
     // System
     bool use_docked_mode;
@@ -416,6 +421,7 @@ struct Values {
     SDMCSize sdmc_size;
 
     // Renderer
+    RendererBackend renderer_backend;
     float resolution_factor;
     bool use_frame_limit;
     u16 frame_limit;
@@ -423,6 +429,9 @@ struct Values {
     bool use_accurate_gpu_emulation;
     bool use_asynchronous_gpu_emulation;
     bool force_30fps_mode;
+    u32 texture_cache_budget;
+    u32 present_queue_depth;
+    bool use_present_mailbox;
 
     float bg_red;
     float bg_green;
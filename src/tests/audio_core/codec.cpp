@@ -0,0 +1,73 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/codec.h"
+#include "common/common_types.h"
+
+namespace AudioCore::Codec {
+
+TEST_CASE("ADPCM: Decode without prediction", "[audio_core]") {
+    // Scale 1 and zero coefficients, samples are the signed nibbles themselves
+    const std::array<u8, ADPCM_FRAME_SIZE> frame{0x00, 0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD};
+    const ADPCM_Coeff coeffs{};
+    ADPCMState state{};
+
+    std::array<s16, ADPCM_SAMPLES_PER_FRAME> output{};
+    DecodeADPCM(frame.data(), frame.size(), coeffs, state, output.data());
+    const std::array<s16, ADPCM_SAMPLES_PER_FRAME> expected{0,  1,  2,  3,  4,  5,  6,
+                                                            7,  -8, -7, -6, -5, -4, -3};
+    REQUIRE(output == expected);
+    REQUIRE(state.yn1 == -3);
+    REQUIRE(state.yn2 == -4);
+}
+
+TEST_CASE("ADPCM: Decode with prediction", "[audio_core]") {
+    // Scale 4 and a first coefficient of 1.0 from the second pair, the output integrates the input
+    const std::array<u8, ADPCM_FRAME_SIZE> frame{0x12, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11};
+    ADPCM_Coeff coeffs{};
+    coeffs[2] = 0x800;
+    ADPCMState state{100, 0};
+
+    std::array<s16, ADPCM_SAMPLES_PER_FRAME> output{};
+    DecodeADPCM(frame.data(), frame.size(), coeffs, state, output.data());
+    for (std::size_t i = 0; i < output.size(); ++i) {
+        REQUIRE(output[i] == 100 + 4 * static_cast<s16>(i + 1));
+    }
+}
+
+TEST_CASE("ADPCM: Split decode", "[audio_core]") {
+    std::mt19937 rng(0xADC);
+    std::vector<u8> data(ADPCM_FRAME_SIZE * 64 + 5);
+    for (auto& byte : data) {
+        byte = static_cast<u8>(rng());
+    }
+    ADPCM_Coeff coeffs;
+    for (auto& coeff : coeffs) {
+        coeff = static_cast<s16>(rng() % 0x1000) - 0x800;
+    }
+
+    // A trailing partial frame is not decoded
+    REQUIRE(GetADPCMSampleCount(data.size()) == 64 * ADPCM_SAMPLES_PER_FRAME);
+
+    ADPCMState whole_state{};
+    std::vector<s16> whole(GetADPCMSampleCount(data.size()));
+    DecodeADPCM(data.data(), data.size(), coeffs, whole_state, whole.data());
+
+    ADPCMState split_state{};
+    std::vector<s16> split(whole.size());
+    constexpr std::size_t split_size = ADPCM_FRAME_SIZE * 23;
+    DecodeADPCM(data.data(), split_size, coeffs, split_state, split.data());
+    DecodeADPCM(data.data() + split_size, data.size() - split_size, coeffs, split_state,
+                split.data() + GetADPCMSampleCount(split_size));
+
+    REQUIRE(split == whole);
+    REQUIRE(split_state.yn1 == whole_state.yn1);
+    REQUIRE(split_state.yn2 == whole_state.yn2);
+}
+
+} // namespace AudioCore::Codec
@@ -0,0 +1,82 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/algorithm/mix.h"
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+namespace {
+
+std::vector<s16> RandomSamples(std::size_t count, u32 seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    std::vector<s16> samples(count);
+    std::generate(samples.begin(), samples.end(), [&] { return static_cast<s16>(dist(rng)); });
+    return samples;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Mix: Accumulate samples", "[audio_core]") {
+    // Odd sizes exercise the scalar tail after the vectorized loop
+    for (const std::size_t count : {std::size_t{1}, std::size_t{8}, std::size_t{1021}}) {
+        const auto first = RandomSamples(count, 1);
+        const auto second = RandomSamples(count, 2);
+
+        std::vector<float> bus(count);
+        MixSamples(bus.data(), first.data(), count, 0.5f);
+        MixSamples(bus.data(), second.data(), count, 0.25f);
+        for (std::size_t i = 0; i < count; ++i) {
+            REQUIRE(bus[i] == first[i] * 0.5f + second[i] * 0.25f);
+        }
+    }
+}
+
+TEST_CASE("Mix: Saturate to s16", "[audio_core]") {
+    const std::vector<float> bus{0.0f,      1.75f,     -1.75f, 32767.0f, 32768.0f,
+                                 -32768.0f, -32769.0f, 1e10f,  -1e10f,   123.5f};
+    const std::vector<s16> expected{0, 1, -1, 32767, 32767, -32768, -32768, 32767, -32768, 123};
+
+    std::vector<s16> output(bus.size());
+    SaturateToS16(output.data(), bus.data(), bus.size());
+    REQUIRE(output == expected);
+}
+
+TEST_CASE("Mix: Voices", "[.][benchmark]") {
+    // One stereo buffer of the audio renderer
+    constexpr std::size_t buffer_size = 512 * 2;
+    constexpr int iterations = 2000;
+
+    for (const std::size_t num_voices : {24, 48, 96}) {
+        std::vector<std::vector<s16>> voices;
+        for (std::size_t voice = 0; voice < num_voices; ++voice) {
+            voices.push_back(RandomSamples(buffer_size, static_cast<u32>(voice)));
+        }
+        std::vector<float> bus(buffer_size);
+        std::vector<s16> output(buffer_size);
+
+        const auto start_time = std::chrono::steady_clock::now();
+        for (int iteration = 0; iteration < iterations; ++iteration) {
+            std::fill(bus.begin(), bus.end(), 0.0f);
+            for (const auto& samples : voices) {
+                MixSamples(bus.data(), samples.data(), buffer_size, 0.1f);
+            }
+            SaturateToS16(output.data(), bus.data(), buffer_size);
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start_time;
+
+        WARN("Mixed " << num_voices << " voices in "
+                      << std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count() /
+                             iterations
+                      << " ns per buffer");
+    }
+}
+
+} // namespace AudioCore
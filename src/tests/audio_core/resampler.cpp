@@ -0,0 +1,167 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#define _USE_MATH_DEFINES
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/algorithm/interpolate.h"
+#include "audio_core/algorithm/resampler.h"
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+namespace {
+
+/// Generates an interleaved stereo sine, both channels carry the same signal
+std::vector<s16> GenerateSine(double frequency, u32 sample_rate, std::size_t num_frames,
+                              double amplitude) {
+    std::vector<s16> samples(num_frames * 2);
+    for (std::size_t i = 0; i < num_frames; ++i) {
+        const double value = amplitude * std::sin(2.0 * M_PI * frequency * i / sample_rate);
+        samples[i * 2 + 0] = static_cast<s16>(std::lround(value));
+        samples[i * 2 + 1] = static_cast<s16>(std::lround(value));
+    }
+    return samples;
+}
+
+/// Returns the ratio in dB between a sine of the given frequency, fitted to the left channel, and
+/// everything else. The first frames are skipped to ignore the filter warm up.
+double SignalToNoise(const std::vector<s16>& samples, double frequency, u32 sample_rate) {
+    constexpr std::size_t skip = 256;
+    const std::size_t num_frames = samples.size() / 2;
+    REQUIRE(num_frames > skip * 2);
+
+    // Least squares fit of a sine and a cosine, they are orthogonal over many periods
+    double sin_sum = 0.0;
+    double cos_sum = 0.0;
+    for (std::size_t i = skip; i < num_frames; ++i) {
+        const double angle = 2.0 * M_PI * frequency * i / sample_rate;
+        sin_sum += samples[i * 2] * std::sin(angle);
+        cos_sum += samples[i * 2] * std::cos(angle);
+    }
+    const double count = static_cast<double>(num_frames - skip);
+    const double a = sin_sum * 2.0 / count;
+    const double b = cos_sum * 2.0 / count;
+
+    double signal = 0.0;
+    double noise = 0.0;
+    for (std::size_t i = skip; i < num_frames; ++i) {
+        const double angle = 2.0 * M_PI * frequency * i / sample_rate;
+        const double fitted = a * std::sin(angle) + b * std::cos(angle);
+        signal += fitted * fitted;
+        noise += (samples[i * 2] - fitted) * (samples[i * 2] - fitted);
+    }
+    return 10.0 * std::log10(signal / noise);
+}
+
+/// Returns the RMS level of the left channel, skipping the filter warm up
+double RootMeanSquare(const std::vector<s16>& samples) {
+    constexpr std::size_t skip = 256;
+    double sum = 0.0;
+    for (std::size_t i = skip; i < samples.size() / 2; ++i) {
+        sum += static_cast<double>(samples[i * 2]) * samples[i * 2];
+    }
+    return std::sqrt(sum / (samples.size() / 2 - skip));
+}
+
+std::vector<s16> Resample(u32 input_rate, u32 output_rate, const std::vector<s16>& input) {
+    Resampler resampler;
+    resampler.SetRatio(static_cast<double>(input_rate) / output_rate);
+    std::vector<s16> output;
+    resampler.Process(input.data(), input.size() / 2, output);
+    return output;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Resampler: Constant signal", "[audio_core]") {
+    const std::vector<s16> input(32000 * 2, 10000);
+    const auto output = Resample(32000, 48000, input);
+
+    // The output lags by half the kernel, except for that every input frame is consumed
+    REQUIRE(std::abs(static_cast<int>(output.size() / 2) - 48000) <= Resampler::NumTaps * 2);
+    for (std::size_t i = Resampler::NumTaps * 2; i < output.size(); ++i) {
+        REQUIRE(std::abs(output[i] - 10000) <= 1);
+    }
+}
+
+TEST_CASE("Resampler: Block size independence", "[audio_core]") {
+    const auto input = GenerateSine(440.0, 22050, 22050, 12000.0);
+    const auto expected = Resample(22050, 48000, input);
+
+    Resampler resampler;
+    resampler.SetRatio(22050.0 / 48000.0);
+    std::mt19937 rng(0x5a3);
+    std::uniform_int_distribution<std::size_t> block_dist(0, 300);
+    std::vector<s16> output;
+    for (std::size_t frame = 0; frame < input.size() / 2;) {
+        const std::size_t block = std::min(block_dist(rng), input.size() / 2 - frame);
+        resampler.Process(input.data() + frame * 2, block, output);
+        frame += block;
+    }
+    REQUIRE(output == expected);
+}
+
+TEST_CASE("Resampler: Sine quality", "[audio_core]") {
+    for (const u32 input_rate : {22050U, 32000U, 44100U}) {
+        const auto input = GenerateSine(1000.0, input_rate, input_rate, 16000.0);
+        const auto output = Resample(input_rate, 48000, input);
+        REQUIRE(SignalToNoise(output, 1000.0, 48000) > 70.0);
+    }
+}
+
+TEST_CASE("Resampler: Downsampling rejects aliases", "[audio_core]") {
+    // 30 kHz can't be represented at 48 kHz, it would alias to 18 kHz
+    const auto input = GenerateSine(30000.0, 96000, 96000, 16000.0);
+    const auto output = Resample(96000, 48000, input);
+    const double attenuation = 20.0 * std::log10(RootMeanSquare(output) / (16000.0 / std::sqrt(2)));
+    REQUIRE(attenuation < -60.0);
+}
+
+TEST_CASE("Resampler: Quality and throughput against Interpolate", "[.][benchmark]") {
+    constexpr double frequency = 1000.0;
+    constexpr int iterations = 20;
+
+    for (const u32 input_rate : {22050U, 32000U, 44100U, 96000U}) {
+        const auto input = GenerateSine(frequency, input_rate, input_rate, 16000.0);
+        const double ratio = static_cast<double>(input_rate) / 48000;
+
+        std::vector<s16> interpolated;
+        const auto interpolate_start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            InterpolationState state;
+            auto copy = input;
+            Interpolate(state, copy, ratio, interpolated);
+        }
+        const auto interpolate_time = std::chrono::steady_clock::now() - interpolate_start;
+
+        std::vector<s16> resampled;
+        const auto resample_start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; ++i) {
+            Resampler resampler;
+            resampler.SetRatio(ratio);
+            resampled.clear();
+            resampler.Process(input.data(), input.size() / 2, resampled);
+        }
+        const auto resample_time = std::chrono::steady_clock::now() - resample_start;
+
+        const auto to_us = [](auto duration) {
+            return std::chrono::duration_cast<std::chrono::microseconds>(duration).count() /
+                   iterations;
+        };
+        WARN(input_rate << " Hz to 48000 Hz, one second of stereo audio:\n"
+                        << "  Interpolate: " << to_us(interpolate_time) << " us, SNR "
+                        << SignalToNoise(interpolated, frequency, 48000) << " dB\n"
+                        << "  Resampler: " << to_us(resample_time) << " us, SNR "
+                        << SignalToNoise(resampled, frequency, 48000) << " dB");
+    }
+}
+
+} // namespace AudioCore
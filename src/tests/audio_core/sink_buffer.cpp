@@ -0,0 +1,159 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "audio_core/algorithm/mix.h"
+#include "audio_core/algorithm/resampler.h"
+#include "audio_core/buffer.h"
+#include "audio_core/null_sink.h"
+#include "audio_core/sink_buffer.h"
+#include "audio_core/stream.h"
+#include "common/common_types.h"
+#include "core/core_timing.h"
+#include "core/core_timing_util.h"
+#include "core/settings.h"
+
+namespace AudioCore {
+
+namespace {
+
+constexpr u32 SampleRate = 48000;
+constexpr u32 MinLatency = 512;
+
+std::vector<s16> Ramp(std::size_t count) {
+    std::vector<s16> samples(count);
+    std::iota(samples.begin(), samples.end(), s16{0});
+    return samples;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("SinkBuffer: Pass through", "[audio_core]") {
+    SinkBuffer buffer(SampleRate, 2, MinLatency);
+    const auto samples = Ramp(4096);
+    buffer.Push(2, samples.data(), samples.size());
+    REQUIRE(buffer.QueuedFrames() == 2048);
+
+    // Without stretching the samples come out untouched
+    std::vector<s16> output(samples.size());
+    buffer.Pop(output.data(), 2048, false);
+    REQUIRE(output == samples);
+    REQUIRE(buffer.QueuedFrames() == 0);
+}
+
+TEST_CASE("SinkBuffer: Drop extra channels", "[audio_core]") {
+    SinkBuffer buffer(SampleRate, 2, MinLatency);
+    const auto samples = Ramp(6 * 1000);
+    buffer.Push(6, samples.data(), samples.size());
+    REQUIRE(buffer.QueuedFrames() == 1000);
+
+    std::vector<s16> output(2 * 1000);
+    buffer.Pop(output.data(), 1000, false);
+    for (std::size_t frame = 0; frame < 1000; ++frame) {
+        REQUIRE(output[frame * 2] == samples[frame * 6]);
+        REQUIRE(output[frame * 2 + 1] == samples[frame * 6 + 1]);
+    }
+}
+
+TEST_CASE("SinkBuffer: Repeat the last frame when dry", "[audio_core]") {
+    SinkBuffer buffer(SampleRate, 2, MinLatency);
+    const std::vector<s16> samples{1, 2, 3, 4};
+    buffer.Push(2, samples.data(), samples.size());
+
+    std::vector<s16> output(8);
+    buffer.Pop(output.data(), 4, false);
+    REQUIRE(output == std::vector<s16>{1, 2, 3, 4, 3, 4, 3, 4});
+}
+
+TEST_CASE("SinkBuffer: Underruns raise the target", "[audio_core]") {
+    SinkBuffer buffer(SampleRate, 2, MinLatency);
+    const u32 initial_target = buffer.GetStats().target_frames;
+
+    const auto samples = Ramp(2 * 256);
+    std::vector<s16> output(2 * MinLatency);
+    for (int i = 0; i < 4; ++i) {
+        buffer.Push(2, samples.data(), samples.size());
+        buffer.Pop(output.data(), MinLatency, false);
+    }
+    const SinkStats stats = buffer.GetStats();
+    REQUIRE(stats.underruns == 4);
+    REQUIRE(stats.target_frames > initial_target);
+}
+
+TEST_CASE("SinkBuffer: Flushed streams don't underrun", "[audio_core]") {
+    SinkBuffer buffer(SampleRate, 2, MinLatency);
+    std::vector<s16> output(2 * MinLatency);
+
+    // Nothing was queued yet
+    buffer.Pop(output.data(), MinLatency, false);
+    REQUIRE(buffer.GetStats().underruns == 0);
+
+    const auto samples = Ramp(2 * 256);
+    buffer.Push(2, samples.data(), samples.size());
+    buffer.Flush();
+    buffer.Pop(output.data(), MinLatency, false);
+    REQUIRE(buffer.GetStats().underruns == 0);
+}
+
+TEST_CASE("SinkBuffer: Null sink pipeline", "[.][benchmark]") {
+    // One emulated second of audio renderer output, played through a stream by the null sink
+    constexpr std::size_t buffer_frames = 512;
+    constexpr std::size_t num_buffers = SampleRate / buffer_frames;
+    constexpr std::size_t source_frames = buffer_frames * 32000 / SampleRate;
+    const s64 buffer_cycles = Core::Timing::usToCycles(
+        std::chrono::microseconds(buffer_frames * 1000000 / SampleRate));
+    Settings::values.volume = 1.0f;
+
+    for (const std::size_t num_voices : {24, 48, 96}) {
+        Core::Timing::CoreTiming core_timing;
+        core_timing.Initialize();
+        NullSink sink("");
+        SinkStream& sink_stream = sink.AcquireSinkStream(SampleRate, 2, "Benchmark");
+        std::size_t released = 0;
+        Stream stream(core_timing, SampleRate, Stream::Format::Stereo16, [&] { ++released; },
+                      sink_stream, "Benchmark");
+        stream.Play();
+
+        std::vector<Resampler> resamplers(num_voices);
+        for (auto& resampler : resamplers) {
+            resampler.SetRatio(32000.0 / SampleRate);
+        }
+        const auto source = Ramp(source_frames * 2);
+        std::vector<s16> resampled;
+        std::vector<float> bus(buffer_frames * 2);
+
+        const auto start_time = std::chrono::steady_clock::now();
+        for (std::size_t index = 0; index < num_buffers; ++index) {
+            std::fill(bus.begin(), bus.end(), 0.0f);
+            for (auto& resampler : resamplers) {
+                resampled.clear();
+                resampler.Process(source.data(), source_frames, resampled);
+                MixSamples(bus.data(), resampled.data(), std::min(resampled.size(), bus.size()),
+                           0.1f);
+            }
+            std::vector<s16> mixed(bus.size());
+            SaturateToS16(mixed.data(), bus.data(), mixed.size());
+            REQUIRE(stream.QueueBuffer(std::make_shared<Buffer>(index, std::move(mixed))));
+
+            // Play the buffer, releasing it like the emulated CPU does
+            core_timing.AddTicks(buffer_cycles);
+            core_timing.Advance();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start_time;
+        const SinkStats stats = sink_stream.GetStats();
+        core_timing.Shutdown();
+
+        REQUIRE(released == num_buffers);
+        WARN("Played " << num_voices << " voices in "
+                       << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()
+                       << " us per emulated second, " << stats.underruns << " underruns");
+    }
+}
+
+} // namespace AudioCore
@@ -0,0 +1,64 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/mapped_file.h"
+
+namespace Common {
+
+namespace {
+
+const std::string TestPath = "mapped_file_test.bin";
+
+void WriteTestFile(const std::vector<u8>& data) {
+    FileUtil::IOFile file(TestPath, "wb");
+    REQUIRE(file.WriteBytes(data.data(), data.size()) == data.size());
+}
+
+std::vector<u8> Pattern(std::size_t size) {
+    std::vector<u8> data(size);
+    std::iota(data.begin(), data.end(), u8{0});
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MappedFile: Maps the whole file", "[common]") {
+    const auto data = Pattern(0x3456);
+    WriteTestFile(data);
+    {
+        const MappedFile mapped(TestPath);
+        REQUIRE(mapped.IsOpen());
+        REQUIRE(mapped.Size() == data.size());
+        REQUIRE(std::equal(data.begin(), data.end(), mapped.Data()));
+
+        // Hints are clamped to the mapping
+        mapped.Advise(0, mapped.Size(), MappedFile::Access::Random);
+        mapped.Advise(0x1234, 0x100000, MappedFile::Access::WillNeed);
+        mapped.Advise(mapped.Size(), 1, MappedFile::Access::Sequential);
+        REQUIRE(std::equal(data.begin(), data.end(), mapped.Data()));
+    }
+    FileUtil::Delete(TestPath);
+}
+
+TEST_CASE("MappedFile: Empty and missing files", "[common]") {
+    WriteTestFile({});
+    {
+        const MappedFile mapped(TestPath);
+        REQUIRE(!mapped.IsOpen());
+        REQUIRE(mapped.Size() == 0);
+    }
+    FileUtil::Delete(TestPath);
+
+    const MappedFile missing(TestPath);
+    REQUIRE(!missing.IsOpen());
+}
+
+} // namespace Common
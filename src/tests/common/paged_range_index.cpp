@@ -0,0 +1,193 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <set>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "common/paged_range_index.h"
+
+namespace Common {
+
+namespace {
+
+struct TraceEntry {
+    enum class Kind { Register, Invalidate };
+    Kind kind;
+    u64 start;
+    u64 end;
+};
+
+/// Returns a sorted list of the values overlapping [start, end)
+template <typename Index>
+std::vector<u32> Collect(const Index& index, u64 start, u64 end) {
+    std::vector<u32> values;
+    for (const u32 value : index.Query(start, end)) {
+        values.push_back(value);
+    }
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+/**
+ * Generates a trace that mimics the invalidation pattern of a game: objects of mixed sizes are
+ * registered and small guest writes invalidate whatever they touch.
+ */
+std::vector<TraceEntry> GenerateTrace(std::size_t length, u32 seed) {
+    std::mt19937 rng{seed};
+    std::uniform_int_distribution<u64> address{0, 64ULL << 20};
+    std::uniform_int_distribution<u64> object_size{0x100, 0x40000};
+    std::uniform_int_distribution<u64> write_size{0x4, 0x1000};
+    std::bernoulli_distribution is_register{0.3};
+
+    std::vector<TraceEntry> trace;
+    trace.reserve(length);
+    for (std::size_t i = 0; i < length; ++i) {
+        const u64 start = address(rng) & ~3ULL;
+        if (is_register(rng)) {
+            trace.push_back({TraceEntry::Kind::Register, start, start + object_size(rng)});
+        } else {
+            trace.push_back({TraceEntry::Kind::Invalidate, start, start + write_size(rng)});
+        }
+    }
+    return trace;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("PagedRangeIndex: Basic Tests", "[common]") {
+    PagedRangeIndex<u32, 12> index;
+    REQUIRE(index.Empty());
+    REQUIRE(index.Query(0, 0x100000).empty());
+
+    index.Insert(0x1000, 0x1100, 1);
+    index.Insert(0x1080, 0x5000, 2); // Spans multiple pages
+    index.Insert(0x8000, 0x8010, 3);
+    index.Insert(0x8000, 0x8010, 4); // Same range as a different value
+    index.Insert(0x9000, 0x9000, 5); // Empty ranges are ignored
+    REQUIRE(index.Size() == 4);
+    REQUIRE(index.NumPages() == 5);
+
+    REQUIRE(Collect(index, 0x0, 0x1000).empty());
+    REQUIRE(Collect(index, 0x1000, 0x1001) == std::vector<u32>{1});
+    REQUIRE(Collect(index, 0x1090, 0x10a0) == std::vector<u32>{1, 2});
+    // A value spanning several pages is reported only once
+    REQUIRE(Collect(index, 0x0, 0x10000) == std::vector<u32>{1, 2, 3, 4});
+    REQUIRE(Collect(index, 0x3000, 0x4000) == std::vector<u32>{2});
+    REQUIRE(Collect(index, 0x5000, 0x8000).empty());
+    REQUIRE(Collect(index, 0x800f, 0x9000) == std::vector<u32>{3, 4});
+
+    REQUIRE(index.Erase(0x1080, 0x5000, 2));
+    REQUIRE(!index.Erase(0x1080, 0x5000, 2));
+    REQUIRE(!index.Erase(0x8000, 0x8010, 1));
+    REQUIRE(index.Size() == 3);
+    // Pages only used by the erased value are dropped
+    REQUIRE(index.NumPages() == 2);
+    REQUIRE(Collect(index, 0x0, 0x10000) == std::vector<u32>{1, 3, 4});
+    REQUIRE(Collect(index, 0x3000, 0x4000).empty());
+
+    index.Clear();
+    REQUIRE(index.Empty());
+    REQUIRE(index.NumPages() == 0);
+    REQUIRE(index.All().empty());
+}
+
+TEST_CASE("PagedRangeIndex: Query buffers", "[common]") {
+    PagedRangeIndex<u32, 12> index;
+    index.Insert(0x1000, 0x2000, 1);
+    index.Insert(0x3000, 0x4000, 2);
+
+    QueryBuffer<u32> buffer;
+    const u32* storage = nullptr;
+    {
+        auto results = index.Collect(buffer, 0x0, 0x2000);
+        REQUIRE(*results == std::vector<u32>{1});
+        storage = results->data();
+    }
+    {
+        // Later queries reuse the storage
+        auto results = index.Collect(buffer, 0x1000, 0x1001);
+        REQUIRE(*results == std::vector<u32>{1});
+        REQUIRE(results->data() == storage);
+
+        // A nested query doesn't clobber the outer results
+        auto nested = index.Collect(buffer, 0x3000, 0x3001);
+        REQUIRE(*nested == std::vector<u32>{2});
+        REQUIRE(*results == std::vector<u32>{1});
+    }
+}
+
+TEST_CASE("PagedRangeIndex: Matches brute force", "[common]") {
+    const auto trace = GenerateTrace(4000, 1234);
+
+    PagedRangeIndex<u32, 16> index;
+    std::vector<std::pair<TraceEntry, u32>> reference;
+    u32 next_value = 0;
+    for (const auto& entry : trace) {
+        if (entry.kind == TraceEntry::Kind::Register) {
+            index.Insert(entry.start, entry.end, next_value);
+            reference.emplace_back(entry, next_value);
+            ++next_value;
+            continue;
+        }
+        std::vector<u32> expected;
+        for (const auto& [registered, value] : reference) {
+            if (registered.start < entry.end && entry.start < registered.end) {
+                expected.push_back(value);
+            }
+        }
+        std::sort(expected.begin(), expected.end());
+        REQUIRE(Collect(index, entry.start, entry.end) == expected);
+
+        // Invalidate what was found, like the rasterizer caches do
+        for (const u32 value : expected) {
+            const auto it = std::find_if(reference.begin(), reference.end(),
+                                         [value](const auto& pair) { return pair.second == value; });
+            REQUIRE(index.Erase(it->first.start, it->first.end, value));
+            reference.erase(it);
+        }
+        REQUIRE(index.Size() == reference.size());
+    }
+
+    for (const auto& [registered, value] : reference) {
+        REQUIRE(index.Erase(registered.start, registered.end, value));
+    }
+    REQUIRE(index.NumPages() == 0);
+}
+
+TEST_CASE("PagedRangeIndex: Invalidate trace replay", "[.][benchmark]") {
+    const auto trace = GenerateTrace(1000000, 42);
+
+    PagedRangeIndex<u32, 16> index;
+    std::vector<std::pair<u64, u64>> ranges;
+    std::vector<u32> scratch;
+    std::size_t invalidated = 0;
+
+    const auto start_time = std::chrono::steady_clock::now();
+    for (const auto& entry : trace) {
+        if (entry.kind == TraceEntry::Kind::Register) {
+            index.Insert(entry.start, entry.end, static_cast<u32>(ranges.size()));
+            ranges.emplace_back(entry.start, entry.end);
+            continue;
+        }
+        scratch.clear();
+        for (const u32 value : index.Query(entry.start, entry.end)) {
+            scratch.push_back(value);
+        }
+        for (const u32 value : scratch) {
+            index.Erase(ranges[value].first, ranges[value].second, value);
+        }
+        invalidated += scratch.size();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start_time;
+
+    WARN("Replayed " << trace.size() << " operations (" << invalidated << " invalidations) in "
+                     << std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()
+                     << " us");
+}
+
+} // namespace Common
@@ -0,0 +1,172 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <map>
+#include <random>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "common/tlsf_allocator.h"
+
+namespace Common {
+
+namespace {
+
+constexpr u64 Granularity = TLSFAllocator::Granularity;
+
+/// Checks that the live allocations don't overlap and fit in the address space
+void CheckAllocations(const std::map<u64, u64>& live, u64 size) {
+    u64 last_end = 0;
+    for (const auto& [offset, end] : live) {
+        REQUIRE(offset >= last_end);
+        REQUIRE(end <= size);
+        last_end = end;
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("TLSFAllocator: Allocate and free", "[common]") {
+    TLSFAllocator allocator(64 * Granularity);
+
+    const auto first = allocator.Allocate(100, 1);
+    REQUIRE(first);
+    REQUIRE(first->offset == 0);
+    REQUIRE(allocator.GetUsedBytes() == Granularity);
+
+    const auto second = allocator.Allocate(Granularity * 3, 1);
+    REQUIRE(second);
+    REQUIRE(second->offset == Granularity);
+    REQUIRE(allocator.GetNumAllocations() == 2);
+
+    allocator.Free(first->handle);
+    allocator.Free(second->handle);
+    REQUIRE(allocator.IsEmpty());
+    REQUIRE(allocator.GetUsedBytes() == 0);
+
+    const auto stats = allocator.GetStats();
+    REQUIRE(stats.num_free_blocks == 1);
+    REQUIRE(stats.largest_free_block == allocator.GetSize());
+}
+
+TEST_CASE("TLSFAllocator: Whole address space", "[common]") {
+    TLSFAllocator allocator(1 << 20);
+
+    const auto whole = allocator.Allocate(1 << 20, 1);
+    REQUIRE(whole);
+    REQUIRE(whole->offset == 0);
+    REQUIRE(!allocator.Allocate(1, 1));
+
+    allocator.Free(whole->handle);
+    REQUIRE(allocator.Allocate(1 << 20, 1));
+}
+
+TEST_CASE("TLSFAllocator: Alignment", "[common]") {
+    TLSFAllocator allocator(1 << 20);
+
+    REQUIRE(allocator.Allocate(Granularity, 1));
+    for (const u64 alignment : {u64{1} << 10, u64{1} << 12, u64{1} << 16}) {
+        const auto allocation = allocator.Allocate(Granularity, alignment);
+        REQUIRE(allocation);
+        REQUIRE(allocation->offset % alignment == 0);
+    }
+
+    // The space skipped to honor alignments is still usable
+    const auto small = allocator.Allocate(Granularity, 1);
+    REQUIRE(small);
+    REQUIRE(small->offset == Granularity);
+}
+
+TEST_CASE("TLSFAllocator: Out of space", "[common]") {
+    TLSFAllocator allocator(8 * Granularity);
+
+    std::vector<TLSFAllocator::Allocation> allocations;
+    for (int i = 0; i < 8; ++i) {
+        const auto allocation = allocator.Allocate(Granularity, 1);
+        REQUIRE(allocation);
+        allocations.push_back(*allocation);
+    }
+    REQUIRE(!allocator.Allocate(1, 1));
+
+    // Freeing two neighbours gives room for an allocation twice as large
+    allocator.Free(allocations[3].handle);
+    allocator.Free(allocations[4].handle);
+    REQUIRE(!allocator.Allocate(3 * Granularity, 1));
+    const auto merged = allocator.Allocate(2 * Granularity, 1);
+    REQUIRE(merged);
+    REQUIRE(merged->offset == 3 * Granularity);
+}
+
+TEST_CASE("TLSFAllocator: Fragmentation stats", "[common]") {
+    TLSFAllocator allocator(8 * Granularity);
+
+    std::vector<TLSFAllocator::Allocation> allocations;
+    for (int i = 0; i < 8; ++i) {
+        allocations.push_back(*allocator.Allocate(Granularity, 1));
+    }
+    REQUIRE(allocator.GetStats().Fragmentation() == 0.0);
+
+    // Free every other block, no two free blocks are contiguous
+    for (std::size_t i = 0; i < allocations.size(); i += 2) {
+        allocator.Free(allocations[i].handle);
+    }
+    const auto stats = allocator.GetStats();
+    REQUIRE(stats.num_free_blocks == 4);
+    REQUIRE(stats.largest_free_block == Granularity);
+    REQUIRE(stats.Fragmentation() == 0.75);
+}
+
+TEST_CASE("TLSFAllocator: Random churn", "[common]") {
+    constexpr u64 size = 64 << 20;
+    TLSFAllocator allocator(size);
+
+    std::mt19937 rng(0x7153);
+    std::uniform_int_distribution<u64> size_dist(1, 1 << 20);
+    std::uniform_int_distribution<u32> alignment_dist(0, 16);
+
+    std::map<u64, u64> live;
+    std::vector<TLSFAllocator::Allocation> allocations;
+    u64 used_bytes = 0;
+
+    for (int step = 0; step < 20000; ++step) {
+        const bool free = !allocations.empty() && (rng() % 3 == 0 || allocations.size() > 128);
+        if (free) {
+            const std::size_t index = rng() % allocations.size();
+            const auto allocation = allocations[index];
+            allocations[index] = allocations.back();
+            allocations.pop_back();
+
+            const auto it = live.find(allocation.offset);
+            REQUIRE(it != live.end());
+            used_bytes -= it->second - it->first;
+            live.erase(it);
+            allocator.Free(allocation.handle);
+        } else {
+            const u64 alloc_size = size_dist(rng);
+            const u64 alignment = u64{1} << alignment_dist(rng);
+            const auto allocation = allocator.Allocate(alloc_size, alignment);
+            if (!allocation) {
+                continue;
+            }
+            REQUIRE(allocation->offset % alignment == 0);
+
+            const u64 rounded_size = (alloc_size + Granularity - 1) / Granularity * Granularity;
+            live.emplace(allocation->offset, allocation->offset + rounded_size);
+            allocations.push_back(*allocation);
+            used_bytes += rounded_size;
+        }
+        REQUIRE(allocator.GetUsedBytes() == used_bytes);
+        REQUIRE(allocator.GetNumAllocations() == allocations.size());
+    }
+    CheckAllocations(live, size);
+
+    for (const auto& allocation : allocations) {
+        allocator.Free(allocation.handle);
+    }
+    const auto stats = allocator.GetStats();
+    REQUIRE(stats.num_free_blocks == 1);
+    REQUIRE(stats.largest_free_block == size);
+}
+
+} // namespace Common
@@ -0,0 +1,215 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "core/crypto/aes_util.h"
+#include "core/crypto/key_manager.h"
+
+namespace Core::Crypto {
+
+namespace {
+
+std::vector<u8> FromHex(std::string_view hex) {
+    std::vector<u8> out(hex.size() / 2);
+    for (std::size_t i = 0; i < out.size(); ++i) {
+        unsigned value = 0;
+        std::sscanf(hex.data() + i * 2, "%2x", &value);
+        out[i] = static_cast<u8>(value);
+    }
+    return out;
+}
+
+template <typename Key>
+Key KeyFromHex(std::string_view hex) {
+    const auto bytes = FromHex(hex);
+    Key key{};
+    std::copy(bytes.begin(), bytes.end(), key.begin());
+    return key;
+}
+
+std::vector<u8> Pattern(std::size_t size) {
+    std::vector<u8> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<u8>(i * 7 + (i >> 8));
+    }
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("AESCipher: CTR known answer", "[core][crypto]") {
+    // NIST SP 800-38A F.5.1
+    AESCipher<Key128> cipher(KeyFromHex<Key128>("2b7e151628aed2a6abf7158809cf4f3c"), Mode::CTR);
+    const auto counter = FromHex("f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff");
+    const auto plaintext =
+        FromHex("6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+                "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710");
+    const auto ciphertext =
+        FromHex("874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+                "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee");
+
+    std::vector<u8> output(plaintext.size());
+    cipher.SetIV(counter);
+    cipher.Transcode(plaintext.data(), plaintext.size(), output.data(), Op::Encrypt);
+    REQUIRE(output == ciphertext);
+
+    // The counter carries on between calls
+    cipher.SetIV(counter);
+    cipher.Transcode(ciphertext.data(), 0x20, output.data(), Op::Decrypt);
+    cipher.Transcode(ciphertext.data() + 0x20, 0x20, output.data() + 0x20, Op::Decrypt);
+    REQUIRE(output == plaintext);
+}
+
+TEST_CASE("AESCipher: XTS known answer", "[core][crypto]") {
+    // IEEE 1619 XTS-AES-128 vectors 1 and 4, sector 0 has the same tweak in both conventions
+    AESCipher<Key256> zero_cipher(Key256{}, Mode::XTS);
+    std::vector<u8> output(0x20);
+    zero_cipher.XTSTranscode(std::vector<u8>(0x20).data(), 0x20, output.data(), 0, 0x20,
+                             Op::Encrypt);
+    REQUIRE(output == FromHex("917cf69ebd68b2ec9b9fe9a3eadda692cd43d2f59598ed858c02c2652fbf922e"));
+
+    AESCipher<Key256> cipher(KeyFromHex<Key256>("2718281828459045235360287471352631415926535897"
+                                                "932384626433832795"),
+                             Mode::XTS);
+    std::vector<u8> plaintext(0x200);
+    for (std::size_t i = 0; i < plaintext.size(); ++i) {
+        plaintext[i] = static_cast<u8>(i);
+    }
+    std::vector<u8> ciphertext(plaintext.size());
+    cipher.XTSTranscode(plaintext.data(), plaintext.size(), ciphertext.data(), 0, 0x200,
+                        Op::Encrypt);
+    REQUIRE(std::vector<u8>(ciphertext.begin(), ciphertext.begin() + 0x10) ==
+            FromHex("27a7479befa1d476489f308cd4cfa6e2"));
+    REQUIRE(std::vector<u8>(ciphertext.end() - 0x10, ciphertext.end()) ==
+            FromHex("0a282df920147beabe421ee5319d0568"));
+
+    std::vector<u8> decrypted(ciphertext.size());
+    cipher.XTSTranscode(ciphertext.data(), ciphertext.size(), decrypted.data(), 0, 0x200,
+                        Op::Decrypt);
+    REQUIRE(decrypted == plaintext);
+}
+
+TEST_CASE("AESCipher: Large transcodes match small ones", "[core][crypto]") {
+    constexpr std::size_t sector_size = 0x4000;
+    // Large enough to be split across threads, with a partial CTR block at the end
+    const auto data = Pattern(sector_size * 300 + 0x10);
+
+    AESCipher<Key256> xts(KeyFromHex<Key256>("000102030405060708090a0b0c0d0e0f"
+                                             "f0e0d0c0b0a090807060504030201000"),
+                          Mode::XTS);
+    const std::size_t xts_size = sector_size * 300;
+    std::vector<u8> large(xts_size);
+    std::vector<u8> small(xts_size);
+    xts.XTSTranscode(data.data(), xts_size, large.data(), 0x1234, sector_size, Op::Decrypt);
+    for (std::size_t offset = 0; offset < xts_size; offset += sector_size) {
+        xts.XTSTranscode(data.data() + offset, sector_size, small.data() + offset,
+                         0x1234 + offset / sector_size, sector_size, Op::Decrypt);
+    }
+    REQUIRE(large == small);
+
+    AESCipher<Key128> ctr(KeyFromHex<Key128>("00112233445566778899aabbccddeeff"), Mode::CTR);
+    const auto counter = FromHex("0000000000000000fffffffffffff000");
+    const std::size_t ctr_size = data.size() - 7;
+    large.resize(ctr_size);
+    small.resize(ctr_size);
+    ctr.SetIV(counter);
+    ctr.Transcode(data.data(), ctr_size, large.data(), Op::Decrypt);
+    ctr.SetIV(counter);
+    for (std::size_t offset = 0; offset < ctr_size; offset += 0x1000) {
+        ctr.Transcode(data.data() + offset, std::min<std::size_t>(0x1000, ctr_size - offset),
+                      small.data() + offset, Op::Decrypt);
+    }
+    REQUIRE(large == small);
+
+    // Decrypting in place gives the data back
+    ctr.SetIV(counter);
+    ctr.Transcode(large.data(), large.size(), large.data(), Op::Encrypt);
+    REQUIRE(std::equal(large.begin(), large.end(), data.begin()));
+}
+
+TEST_CASE("AESCipher: AES-NI matches mbedtls", "[core][crypto]") {
+    constexpr std::size_t sector_size = 0x200;
+    const auto data = Pattern(sector_size * 40 + 0x10);
+    const auto xts_key = KeyFromHex<Key256>("000102030405060708090a0b0c0d0e0f"
+                                            "f0e0d0c0b0a090807060504030201000");
+    const auto ctr_key = KeyFromHex<Key128>("00112233445566778899aabbccddeeff");
+    const auto counter = FromHex("0000000000000000fffffffffffffff0");
+
+    // On hosts without AES-NI both ciphers use mbedtls
+    for (const Op op : {Op::Encrypt, Op::Decrypt}) {
+        AESCipher<Key256> xts(xts_key, Mode::XTS);
+        AESCipher<Key256> mbedtls_xts(xts_key, Mode::XTS, false);
+        const std::size_t xts_size = sector_size * 40;
+        std::vector<u8> output(xts_size);
+        std::vector<u8> expected(xts_size);
+        xts.XTSTranscode(data.data(), xts_size, output.data(), 7, sector_size, op);
+        mbedtls_xts.XTSTranscode(data.data(), xts_size, expected.data(), 7, sector_size, op);
+        REQUIRE(output == expected);
+
+        AESCipher<Key128> ctr(ctr_key, Mode::CTR);
+        AESCipher<Key128> mbedtls_ctr(ctr_key, Mode::CTR, false);
+        output.resize(data.size() - 5);
+        expected.resize(data.size() - 5);
+        ctr.SetIV(counter);
+        mbedtls_ctr.SetIV(counter);
+        ctr.Transcode(data.data(), output.size(), output.data(), op);
+        mbedtls_ctr.Transcode(data.data(), expected.size(), expected.data(), op);
+        REQUIRE(output == expected);
+    }
+}
+
+TEST_CASE("AESCipher: Decryption throughput", "[.][benchmark]") {
+    constexpr std::size_t sector_size = 0x4000;
+    constexpr std::size_t size = 0x4000000;
+    const auto data = Pattern(size);
+    std::vector<u8> output(size);
+
+    const auto xts_key = KeyFromHex<Key256>("000102030405060708090a0b0c0d0e0f"
+                                            "f0e0d0c0b0a090807060504030201000");
+    const auto ctr_key = KeyFromHex<Key128>("00112233445566778899aabbccddeeff");
+
+    const auto measure = [&](const std::string& name, auto&& transcode) {
+        const auto start_time = std::chrono::steady_clock::now();
+        transcode();
+        const auto elapsed = std::chrono::steady_clock::now() - start_time;
+        const auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        WARN(name << ": " << (us > 0 ? size / us : 0) << " MB/s");
+    };
+
+    // mbedtls is what was used before AES-NI, it's also used by hosts without it
+    for (const bool allow_aes_ni : {false, true}) {
+        const std::string path = allow_aes_ni ? "AES-NI" : "mbedtls";
+        AESCipher<Key256> xts(xts_key, Mode::XTS, allow_aes_ni);
+        AESCipher<Key128> ctr(ctr_key, Mode::CTR, allow_aes_ni);
+
+        measure(path + ", XTS, one sector per call", [&] {
+            for (std::size_t offset = 0; offset < size; offset += sector_size) {
+                xts.XTSTranscode(data.data() + offset, sector_size, output.data() + offset,
+                                 offset / sector_size, sector_size, Op::Decrypt);
+            }
+        });
+        measure(path + ", XTS, one call", [&] {
+            xts.XTSTranscode(data.data(), size, output.data(), 0, sector_size, Op::Decrypt);
+        });
+        measure(path + ", CTR, 16 KiB per call", [&] {
+            ctr.SetIV(std::vector<u8>(0x10));
+            for (std::size_t offset = 0; offset < size; offset += sector_size) {
+                ctr.Transcode(data.data() + offset, sector_size, output.data() + offset,
+                              Op::Decrypt);
+            }
+        });
+        measure(path + ", CTR, one call", [&] {
+            ctr.SetIV(std::vector<u8>(0x10));
+            ctr.Transcode(data.data(), size, output.data(), Op::Decrypt);
+        });
+    }
+}
+
+} // namespace Core::Crypto
@@ -0,0 +1,246 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/alignment.h"
+#include "common/common_funcs.h"
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/lz4_compression.h"
+#include "core/file_sys/mode.h"
+#include "core/file_sys/partition_filesystem.h"
+#include "core/file_sys/romfs.h"
+#include "core/file_sys/vfs_offset.h"
+#include "core/file_sys/vfs_real.h"
+#include "core/file_sys/vfs_vector.h"
+#include "core/loader/loader.h"
+#include "core/loader/nso.h"
+
+namespace FileSys {
+
+namespace {
+
+// Memory backed file, counting the reads that don't go through its mapped span
+class MappedVfsFile : public VectorVfsFile {
+public:
+    explicit MappedVfsFile(std::vector<u8> data_)
+        : VectorVfsFile(data_), data(std::move(data_)) {}
+
+    std::size_t Read(u8* buffer, std::size_t length, std::size_t offset) const override {
+        ++num_reads;
+        return VectorVfsFile::Read(buffer, length, offset);
+    }
+
+    const u8* GetMappedSpan(std::size_t offset, std::size_t size) const override {
+        if (offset > data.size() || size > data.size() - offset) {
+            return nullptr;
+        }
+        return data.data() + offset;
+    }
+
+    const std::vector<u8> data;
+    mutable std::size_t num_reads = 0;
+};
+
+std::vector<u8> Pattern(std::size_t size, u8 first = 0) {
+    std::vector<u8> data(size);
+    std::iota(data.begin(), data.end(), first);
+    return data;
+}
+
+template <typename T>
+void Append(std::vector<u8>& data, const T& value) {
+    const auto* const bytes = reinterpret_cast<const u8*>(&value);
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+void Append(std::vector<u8>& data, const std::vector<u8>& bytes) {
+    data.insert(data.end(), bytes.begin(), bytes.end());
+}
+
+} // Anonymous namespace
+
+TEST_CASE("OffsetVfsFile: Mapped spans stay within the file", "[core][file_sys]") {
+    const auto base = std::make_shared<MappedVfsFile>(Pattern(0x100));
+    const OffsetVfsFile file(base, 0x40, 0x20);
+    constexpr std::size_t max = std::numeric_limits<std::size_t>::max();
+
+    REQUIRE(file.GetMappedSpan(0, 0x40) == base->data.data() + 0x20);
+    REQUIRE(file.GetMappedSpan(0x10, 0x30) == base->data.data() + 0x30);
+    REQUIRE(file.GetMappedSpan(0x40, 0) == base->data.data() + 0x60);
+    REQUIRE(file.GetMappedSpan(0x41, 0) == nullptr);
+    REQUIRE(file.GetMappedSpan(0x10, 0x31) == nullptr);
+    REQUIRE(file.GetMappedSpan(1, max) == nullptr);
+    REQUIRE(file.GetMappedSpan(max, 1) == nullptr);
+
+    // Offset files past the end of their base can't map more than the base has
+    const OffsetVfsFile past_end(base, 0x40, 0xF0);
+    REQUIRE(past_end.GetMappedSpan(0, 0x10) == base->data.data() + 0xF0);
+    REQUIRE(past_end.GetMappedSpan(0, 0x11) == nullptr);
+
+    const OffsetVfsFile unmapped(std::make_shared<VectorVfsFile>(Pattern(0x100)), 0x40, 0x20);
+    REQUIRE(unmapped.GetMappedSpan(0, 0x10) == nullptr);
+}
+
+TEST_CASE("PartitionFilesystem: Mapped files are parsed in place", "[core][file_sys]") {
+    const std::vector<std::pair<std::string, std::vector<u8>>> files{
+        {"a", Pattern(0x10)},
+        {"bc", Pattern(0x20, 0x80)},
+    };
+
+    std::vector<u8> strtab;
+    std::vector<u8> entries;
+    std::vector<u8> content;
+    for (const auto& [name, data] : files) {
+        Append(entries, static_cast<u64>(content.size()));
+        Append(entries, static_cast<u64>(data.size()));
+        Append(entries, static_cast<u32>(strtab.size()));
+        Append(entries, u32{0});
+        strtab.insert(strtab.end(), name.begin(), name.end());
+        strtab.push_back('\0');
+        Append(content, data);
+    }
+    strtab.resize(Common::AlignUp(strtab.size(), 0x10));
+
+    std::vector<u8> image;
+    Append(image, Common::MakeMagic('P', 'F', 'S', '0'));
+    Append(image, static_cast<u32>(files.size()));
+    Append(image, static_cast<u32>(strtab.size()));
+    Append(image, u32{0});
+    Append(image, entries);
+    Append(image, strtab);
+    Append(image, content);
+
+    const auto mapped = std::make_shared<MappedVfsFile>(image);
+    const PartitionFilesystem mapped_pfs(mapped);
+    const PartitionFilesystem read_pfs(std::make_shared<VectorVfsFile>(image));
+    REQUIRE(mapped_pfs.GetStatus() == Loader::ResultStatus::Success);
+    REQUIRE(read_pfs.GetStatus() == Loader::ResultStatus::Success);
+    // Only the header is read, the entries and names are parsed from the span
+    REQUIRE(mapped->num_reads == 1);
+    REQUIRE(mapped_pfs.GetFileOffsets() == read_pfs.GetFileOffsets());
+    REQUIRE(mapped_pfs.GetFileSizes() == read_pfs.GetFileSizes());
+
+    const auto pfs_files = mapped_pfs.GetFiles();
+    REQUIRE(pfs_files.size() == files.size());
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        REQUIRE(pfs_files[i]->GetName() == files[i].first);
+        REQUIRE(pfs_files[i]->ReadAllBytes() == files[i].second);
+    }
+
+    // Metadata past the end of the file is rejected either way
+    image.resize(sizeof(u32) * 4 + entries.size());
+    REQUIRE(PartitionFilesystem(std::make_shared<MappedVfsFile>(image)).GetStatus() ==
+            Loader::ResultStatus::ErrorIncorrectPFSFileSize);
+}
+
+TEST_CASE("RomFS: Mapped files are parsed in place", "[core][file_sys]") {
+    const auto sub = std::make_shared<VectorVfsDirectory>(
+        std::vector<VirtualFile>{std::make_shared<VectorVfsFile>(Pattern(0x30), "b.bin")},
+        std::vector<VirtualDir>{}, "sub");
+    const auto root = std::make_shared<VectorVfsDirectory>(
+        std::vector<VirtualFile>{std::make_shared<VectorVfsFile>(Pattern(0x20, 0x40), "a.bin")},
+        std::vector<VirtualDir>{sub}, "root");
+
+    const auto mapped = std::make_shared<MappedVfsFile>(CreateRomFS(root)->ReadAllBytes());
+    const auto extracted = ExtractRomFS(mapped, RomFSExtractionType::Full);
+    REQUIRE(extracted != nullptr);
+    // Only the header is read, the entries are parsed from the span
+    REQUIRE(mapped->num_reads == 1);
+
+    const auto a = extracted->GetFile("a.bin");
+    const auto b = extracted->GetFileRelative("sub/b.bin");
+    REQUIRE(a != nullptr);
+    REQUIRE(b != nullptr);
+    REQUIRE(a->ReadAllBytes() == Pattern(0x20, 0x40));
+    REQUIRE(b->ReadAllBytes() == Pattern(0x30));
+}
+
+TEST_CASE("RealVfsFile: Mapped files", "[core][file_sys]") {
+    const std::string path = "mapped_span_test.bin";
+    const auto data = Pattern(0x100000);
+    {
+        FileUtil::IOFile file(path, "wb");
+        REQUIRE(file.WriteBytes(data.data(), data.size()) == data.size());
+    }
+
+    {
+        RealVfsFilesystem filesystem;
+        const auto file = filesystem.OpenFile(path, Mode::Read);
+        REQUIRE(file != nullptr);
+        const u8* const span = file->GetMappedSpan(0x1000, 0x20000);
+        REQUIRE(span != nullptr);
+        REQUIRE(std::memcmp(span, data.data() + 0x1000, 0x20000) == 0);
+        REQUIRE(file->GetMappedSpan(data.size() - 1, 2) == nullptr);
+
+        // Reads are copied from the mapping
+        std::vector<u8> buffer(0x20);
+        REQUIRE(file->Read(buffer.data(), buffer.size(), 0x10) == buffer.size());
+        REQUIRE(std::memcmp(buffer.data(), data.data() + 0x10, buffer.size()) == 0);
+
+        // Files grown since they were mapped are mapped again when they are opened
+        REQUIRE(FileUtil::IOFile(path, "r+b").Resize(data.size() * 2));
+        const auto grown = filesystem.OpenFile(path, Mode::Read);
+        REQUIRE(grown->GetMappedSpan(data.size(), data.size()) != nullptr);
+        REQUIRE(file->GetMappedSpan(data.size(), 1) == nullptr);
+
+        // Handles which may resize the file don't map it
+        REQUIRE(filesystem.OpenFile(path, Mode::ReadWrite)->GetMappedSpan(0, 1) == nullptr);
+    }
+    FileUtil::Delete(path);
+}
+
+} // namespace FileSys
+
+namespace Loader {
+
+TEST_CASE("AppLoader_NSO: Mapped segments are loaded in place", "[core][loader]") {
+    const auto text = FileSys::Pattern(0x1000);
+    const std::vector<u8> rodata(0x800, 0x5A);
+    const auto data = FileSys::Pattern(0x100, 0x33);
+    const auto compressed = Common::Compression::CompressDataLZ4(rodata.data(), rodata.size());
+
+    NSOHeader header{};
+    header.magic = Common::MakeMagic('N', 'S', 'O', '0');
+    header.flags = 1 << 1; // Only .rodata is compressed
+    header.segments[0] = {sizeof(NSOHeader), 0, static_cast<u32>(text.size()), {}};
+    header.segments[1] = {static_cast<u32>(sizeof(NSOHeader) + text.size()), 0x1000,
+                          static_cast<u32>(rodata.size()), {}};
+    header.segments[2] = {static_cast<u32>(sizeof(NSOHeader) + text.size() + compressed.size()),
+                          0x2000, static_cast<u32>(data.size()), {}};
+    header.segments_compressed_size = {static_cast<u32>(text.size()),
+                                       static_cast<u32>(compressed.size()),
+                                       static_cast<u32>(data.size())};
+
+    std::vector<u8> image;
+    FileSys::Append(image, header);
+    FileSys::Append(image, text);
+    FileSys::Append(image, compressed);
+    FileSys::Append(image, data);
+
+    const FileSys::MappedVfsFile mapped(image);
+    const FileSys::VectorVfsFile unmapped(image);
+    Kernel::PhysicalMemory mapped_image;
+    Kernel::PhysicalMemory read_image;
+    for (std::size_t i = 0; i < header.segments.size(); ++i) {
+        const std::size_t size = AppLoader_NSO::LoadSegment(mapped, header, i, mapped_image);
+        REQUIRE(size == header.segments[i].size);
+        REQUIRE(AppLoader_NSO::LoadSegment(unmapped, header, i, read_image) == size);
+    }
+    REQUIRE(mapped.num_reads == 0);
+    REQUIRE(mapped_image == read_image);
+    REQUIRE(mapped_image.size() == 0x2000 + data.size());
+    REQUIRE(std::equal(text.begin(), text.end(), mapped_image.begin()));
+    REQUIRE(std::equal(rodata.begin(), rodata.end(), mapped_image.begin() + 0x1000));
+    REQUIRE(std::equal(data.begin(), data.end(), mapped_image.begin() + 0x2000));
+}
+
+} // namespace Loader
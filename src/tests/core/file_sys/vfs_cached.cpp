@@ -0,0 +1,120 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "core/file_sys/vfs_cached.h"
+#include "core/file_sys/vfs_vector.h"
+
+namespace FileSys {
+
+namespace {
+
+constexpr std::size_t BlockSize = 0x100;
+
+// Counts the reads reaching the wrapped file
+class CountingVfsFile : public VectorVfsFile {
+public:
+    explicit CountingVfsFile(std::vector<u8> data) : VectorVfsFile(std::move(data)) {}
+
+    std::size_t Read(u8* data, std::size_t length, std::size_t offset) const override {
+        ++num_reads;
+        return VectorVfsFile::Read(data, length, offset);
+    }
+
+    mutable std::size_t num_reads = 0;
+};
+
+std::vector<u8> Pattern(std::size_t size) {
+    std::vector<u8> data(size);
+    std::iota(data.begin(), data.end(), u8{0});
+    return data;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("CachedVfsFile: Reads match the wrapped file", "[core][file_sys]") {
+    const auto data = Pattern(BlockSize * 10 + 17);
+    const auto source = std::make_shared<CountingVfsFile>(data);
+    CachedVfsFile cached(source, BlockSize, BlockSize * 64, 0);
+
+    for (const auto& [offset, length] : {std::pair<std::size_t, std::size_t>{0, 1},
+                                         {BlockSize - 3, 7},
+                                         {BlockSize * 2, BlockSize * 3},
+                                         {BlockSize * 9 + 5, BlockSize * 4},
+                                         {3, BlockSize * 10}}) {
+        std::vector<u8> output(length);
+        const std::size_t expected = std::min(length, data.size() - offset);
+        REQUIRE(cached.Read(output.data(), length, offset) == expected);
+        REQUIRE(std::equal(output.begin(), output.begin() + expected, data.begin() + offset));
+    }
+    REQUIRE(cached.Read(nullptr, 4, data.size()) == 0);
+}
+
+TEST_CASE("CachedVfsFile: Repeated reads hit the cache", "[core][file_sys]") {
+    const auto source = std::make_shared<CountingVfsFile>(Pattern(BlockSize * 8));
+    CachedVfsFile cached(source, BlockSize, BlockSize * 64, 0);
+
+    u8 value{};
+    for (int i = 0; i < 16; ++i) {
+        REQUIRE(cached.Read(&value, 1, BlockSize + 5) == 1);
+        REQUIRE(value == static_cast<u8>(BlockSize + 5));
+    }
+    REQUIRE(source->num_reads == 1);
+
+    const auto stats = cached.GetStats();
+    REQUIRE(stats.misses == 1);
+    REQUIRE(stats.hits == 15);
+}
+
+TEST_CASE("CachedVfsFile: Sequential reads fetch ahead", "[core][file_sys]") {
+    const auto data = Pattern(BlockSize * 16);
+    const auto source = std::make_shared<CountingVfsFile>(data);
+    CachedVfsFile cached(source, BlockSize, BlockSize * 64, 3);
+
+    std::vector<u8> output(data.size());
+    for (std::size_t offset = 0; offset < data.size(); offset += 16) {
+        REQUIRE(cached.Read(output.data() + offset, 16, offset) == 16);
+    }
+    REQUIRE(output == data);
+
+    // Reading from the start counts as sequential, every miss fetches 4 blocks
+    REQUIRE(source->num_reads == 4);
+    REQUIRE(cached.GetStats().read_ahead_blocks == 12);
+}
+
+TEST_CASE("CachedVfsFile: Writes drop cached blocks", "[core][file_sys]") {
+    const auto source = std::make_shared<CountingVfsFile>(Pattern(BlockSize * 4));
+    CachedVfsFile cached(source, BlockSize, BlockSize * 64, 0);
+
+    u8 value{};
+    REQUIRE(cached.Read(&value, 1, BlockSize * 2) == 1);
+    const u8 written = 0xAB;
+    REQUIRE(cached.Write(&written, 1, BlockSize * 2) == 1);
+    REQUIRE(cached.Read(&value, 1, BlockSize * 2) == 1);
+    REQUIRE(value == written);
+}
+
+TEST_CASE("CachedVfsFile: Least recently used blocks are evicted", "[core][file_sys]") {
+    const auto source = std::make_shared<CountingVfsFile>(Pattern(BlockSize * 64));
+    // One block per shard
+    CachedVfsFile cached(source, BlockSize, BlockSize * 8, 0);
+
+    u8 value{};
+    for (std::size_t block = 0; block < 64; ++block) {
+        REQUIRE(cached.Read(&value, 1, block * BlockSize) == 1);
+    }
+    const std::size_t reads = source->num_reads;
+    REQUIRE(cached.Read(&value, 1, 63 * BlockSize) == 1);
+    REQUIRE(source->num_reads == reads);
+    REQUIRE(cached.Read(&value, 1, 0) == 1);
+    REQUIRE(source->num_reads == reads + 1);
+}
+
+} // namespace FileSys
@@ -0,0 +1,132 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/texture_cache/eviction_policy.h"
+
+namespace VideoCommon {
+
+namespace {
+
+struct FakeSurface {
+    FakeSurface(u32 id, u64 size, bool is_registered, u32 use_frequency, u64 last_use_frame)
+        : id{id}, size{size}, is_registered{is_registered}, use_frequency{use_frequency},
+          last_use_frame{last_use_frame} {}
+
+    bool IsRegistered() const {
+        return is_registered;
+    }
+
+    u32 GetUseFrequency() const {
+        return use_frequency;
+    }
+
+    u64 GetLastUseFrame() const {
+        return last_use_frame;
+    }
+
+    void DecayUseFrequency() {
+        use_frequency /= 2;
+    }
+
+    u32 id;
+    u64 size;
+    bool is_registered;
+    u32 use_frequency;
+    u64 last_use_frame;
+};
+
+using Surface = std::shared_ptr<FakeSurface>;
+
+constexpr u64 MiB = 1ULL << 20;
+
+/// Returns the ids of the evicted surfaces in eviction order
+std::vector<u32> Evict(const EvictionPolicy& policy, const std::vector<Surface>& surfaces,
+                       u64 resident_bytes) {
+    std::vector<u32> evicted;
+    policy.Evict(surfaces, resident_bytes, [&evicted](const Surface& surface) {
+        evicted.push_back(surface->id);
+        return surface->size;
+    });
+    return evicted;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("EvictionPolicy: A zero budget disables eviction", "[video_core]") {
+    const EvictionPolicy policy(0);
+    REQUIRE(!policy.IsEnabled());
+    REQUIRE(!policy.IsOverBudget(~0ULL));
+
+    const auto surface = std::make_shared<FakeSurface>(0, 64 * MiB, false, 4, 0);
+    REQUIRE(Evict(policy, {surface}, ~0ULL).empty());
+    // Passes that don't evict don't age the surfaces either
+    REQUIRE(surface->GetUseFrequency() == 4);
+}
+
+TEST_CASE("EvictionPolicy: Nothing is evicted within the budget", "[video_core]") {
+    const EvictionPolicy policy(64 * MiB);
+    REQUIRE(policy.IsEnabled());
+    REQUIRE(!policy.IsOverBudget(64 * MiB));
+    REQUIRE(policy.IsOverBudget(64 * MiB + 1));
+
+    const std::vector<Surface> surfaces{std::make_shared<FakeSurface>(0, 16 * MiB, true, 0, 0)};
+    REQUIRE(Evict(policy, surfaces, 64 * MiB).empty());
+}
+
+TEST_CASE("EvictionPolicy: Surfaces are evicted in LRU order", "[video_core]") {
+    const EvictionPolicy policy(64 * MiB);
+    const std::vector<Surface> surfaces{
+        std::make_shared<FakeSurface>(0, 8 * MiB, true, 1, 30),
+        std::make_shared<FakeSurface>(1, 8 * MiB, true, 1, 10),
+        std::make_shared<FakeSurface>(2, 8 * MiB, true, 1, 20),
+        std::make_shared<FakeSurface>(3, 8 * MiB, true, 1, 40),
+    };
+    REQUIRE(Evict(policy, surfaces, 96 * MiB) == std::vector<u32>{1, 2, 0, 3});
+}
+
+TEST_CASE("EvictionPolicy: Reserved and rarely used surfaces go first", "[video_core]") {
+    const EvictionPolicy policy(64 * MiB);
+    constexpr u32 hot = EvictionPolicy::HOT_USE_FREQUENCY + 1;
+    const std::vector<Surface> surfaces{
+        std::make_shared<FakeSurface>(0, 8 * MiB, true, hot, 1),
+        std::make_shared<FakeSurface>(1, 8 * MiB, true, 1, 50),
+        std::make_shared<FakeSurface>(2, 8 * MiB, false, hot, 90),
+        std::make_shared<FakeSurface>(3, 8 * MiB, true, 1, 40),
+        std::make_shared<FakeSurface>(4, 8 * MiB, false, 0, 80),
+    };
+    REQUIRE(Evict(policy, surfaces, 200 * MiB) == std::vector<u32>{4, 2, 3, 1, 0});
+
+    // Every candidate of an eviction pass is aged
+    REQUIRE(surfaces[0]->GetUseFrequency() == hot / 2);
+    REQUIRE(surfaces[1]->GetUseFrequency() == 0);
+}
+
+TEST_CASE("EvictionPolicy: Eviction stops below the budget", "[video_core]") {
+    const EvictionPolicy policy(64 * MiB);
+    REQUIRE(policy.GetTarget() == 56 * MiB);
+
+    std::vector<Surface> surfaces;
+    for (u32 i = 0; i < 8; ++i) {
+        surfaces.push_back(std::make_shared<FakeSurface>(i, 4 * MiB, true, 0, i));
+    }
+    // 72MiB resident, 16MiB have to go to reach 7/8 of the budget
+    REQUIRE(Evict(policy, surfaces, 72 * MiB) == std::vector<u32>{0, 1, 2, 3});
+
+    // Surfaces that can't be evicted don't count towards the target
+    std::vector<u32> attempts;
+    policy.Evict(surfaces, 72 * MiB, [&attempts](const Surface& surface) {
+        attempts.push_back(surface->id);
+        return surface->id % 2 == 0 ? surface->size : u64{0};
+    });
+    REQUIRE(attempts == std::vector<u32>{0, 1, 2, 3, 4, 5, 6});
+
+    // Running out of candidates leaves the cache over the budget
+    REQUIRE(Evict(policy, {surfaces[0]}, 1024 * MiB) == std::vector<u32>{0});
+}
+
+} // namespace VideoCommon
@@ -0,0 +1,76 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/texture_cache/exact_lookup_cache.h"
+
+namespace VideoCommon {
+
+TEST_CASE("ExactLookupCache: Lookups hit until their range is invalidated", "[video_core]") {
+    ExactLookupCache<u64, std::string> cache;
+    REQUIRE(cache.Find(0x1000) == nullptr);
+
+    cache.Insert(0x1000, 0x1000, 0x2000, "a");
+    cache.Insert(0x8000, 0x8000, 0x9000, "b");
+    REQUIRE(cache.Size() == 2);
+    REQUIRE(*cache.Find(0x1000) == "a");
+    REQUIRE(*cache.Find(0x8000) == "b");
+
+    // Registration changes outside of the range keep the lookup
+    cache.Invalidate(0x2000, 0x3000);
+    cache.Invalidate(0x0, 0x1000);
+    REQUIRE(*cache.Find(0x1000) == "a");
+
+    // Overlapping changes only drop the lookups they touch
+    cache.Invalidate(0x1FFF, 0x2000);
+    REQUIRE(cache.Find(0x1000) == nullptr);
+    REQUIRE(*cache.Find(0x8000) == "b");
+    REQUIRE(cache.Size() == 1);
+
+    // The lookup misses once, and hits again after being cached
+    cache.Insert(0x1000, 0x1000, 0x2000, "c");
+    REQUIRE(*cache.Find(0x1000) == "c");
+}
+
+TEST_CASE("ExactLookupCache: Lookups spanning many pages", "[video_core]") {
+    ExactLookupCache<u64, std::string> cache;
+    cache.Insert(1, 0x10000 - 0x10, 0x30010, "large");
+    cache.Insert(2, 0x20000, 0x20100, "small");
+
+    // Invalidations hitting any page of the range drop it, even far from its start
+    cache.Invalidate(0x30000, 0x30001);
+    REQUIRE(cache.Find(1) == nullptr);
+    REQUIRE(*cache.Find(2) == "small");
+
+    // Lookups registered in many pages are dropped from all of them
+    cache.Insert(1, 0x10000 - 0x10, 0x30010, "large");
+    cache.Invalidate(0, ~0ULL);
+    REQUIRE(cache.Size() == 0);
+    cache.Invalidate(0x10000, 0x10001);
+    REQUIRE(cache.Size() == 0);
+}
+
+TEST_CASE("ExactLookupCache: The first result of a lookup is kept", "[video_core]") {
+    ExactLookupCache<u64, std::string> cache;
+    cache.Insert(1, 0x1000, 0x2000, "first");
+    cache.Insert(1, 0x4000, 0x5000, "second");
+    REQUIRE(*cache.Find(1) == "first");
+
+    // The second range was never registered
+    cache.Invalidate(0x4000, 0x5000);
+    REQUIRE(*cache.Find(1) == "first");
+
+    // Empty ranges can't be invalidated, so they aren't cached
+    cache.Insert(2, 0x1000, 0x1000, "empty");
+    REQUIRE(cache.Find(2) == nullptr);
+
+    cache.Clear();
+    REQUIRE(cache.Find(1) == nullptr);
+    cache.Invalidate(0x1000, 0x2000);
+    REQUIRE(cache.Size() == 0);
+}
+
+} // namespace VideoCommon
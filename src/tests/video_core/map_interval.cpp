@@ -0,0 +1,134 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/buffer_cache/map_interval.h"
+
+namespace VideoCommon {
+
+namespace {
+
+using Range = std::pair<CacheAddr, CacheAddr>;
+
+constexpr CacheAddr PAGE_SIZE = CacheAddr{1} << MapIntervalBase::DIRTY_PAGE_BITS;
+
+std::vector<Range> ConsumeDirtyRanges(MapIntervalBase& map) {
+    std::vector<Range> ranges;
+    map.ConsumeDirtyRanges(
+        [&ranges](CacheAddr start, CacheAddr end) { ranges.emplace_back(start, end); });
+    return ranges;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MapIntervalBase: Dirty pages are coalesced into ranges", "[video_core]") {
+    const CacheAddr start = 0x10 * PAGE_SIZE;
+    MapIntervalBase map(start, start + 8 * PAGE_SIZE, 0);
+    REQUIRE(!map.IsDirty());
+    REQUIRE(ConsumeDirtyRanges(map).empty());
+
+    // Writes mark the whole pages they touch
+    map.MarkAsDirty(start + 0x10, start + 0x20);
+    map.MarkAsDirty(start + PAGE_SIZE - 1, start + PAGE_SIZE + 1);
+    map.MarkAsDirty(start + 5 * PAGE_SIZE, start + 6 * PAGE_SIZE);
+    REQUIRE(map.IsDirty());
+    REQUIRE(ConsumeDirtyRanges(map) == std::vector<Range>{{start, start + 2 * PAGE_SIZE},
+                                                          {start + 5 * PAGE_SIZE,
+                                                           start + 6 * PAGE_SIZE}});
+
+    // Consuming the ranges cleans the map
+    REQUIRE(!map.IsDirty());
+    REQUIRE(ConsumeDirtyRanges(map).empty());
+
+    // The last page is reported too
+    map.MarkAsDirty(start + 8 * PAGE_SIZE - 1, start + 8 * PAGE_SIZE);
+    REQUIRE(ConsumeDirtyRanges(map) ==
+            std::vector<Range>{{start + 7 * PAGE_SIZE, start + 8 * PAGE_SIZE}});
+}
+
+TEST_CASE("MapIntervalBase: Dirty ranges are clamped to the map", "[video_core]") {
+    // Maps don't have to be page aligned
+    const CacheAddr start = 0x10 * PAGE_SIZE + 0x800;
+    const CacheAddr end = start + 2 * PAGE_SIZE;
+    MapIntervalBase map(start, end, 0);
+
+    // Writes outside of the map are ignored
+    map.MarkAsDirty(start - PAGE_SIZE, start);
+    map.MarkAsDirty(end, end + PAGE_SIZE);
+    REQUIRE(!map.IsDirty());
+
+    map.MarkAsDirty(start - 0x10, start + 0x10);
+    REQUIRE(ConsumeDirtyRanges(map) == std::vector<Range>{{start, 0x11 * PAGE_SIZE}});
+
+    map.MarkAsDirty(0, ~CacheAddr{0});
+    REQUIRE(ConsumeDirtyRanges(map) == std::vector<Range>{{start, end}});
+}
+
+TEST_CASE("MapIntervalBase: Reset clears the dirty state", "[video_core]") {
+    MapIntervalBase map(PAGE_SIZE, 3 * PAGE_SIZE, 0x1000);
+    map.MarkAsDirty(PAGE_SIZE, 3 * PAGE_SIZE);
+    map.MarkAsRegistered(true);
+    map.MarkAsWritten(true);
+    map.MarkAsModified(true, 5);
+
+    // Recycled maps can be larger than they were
+    map.Reset(0x10 * PAGE_SIZE, 0x20 * PAGE_SIZE, 0x2000);
+    REQUIRE(!map.IsDirty());
+    REQUIRE(!map.IsRegistered());
+    REQUIRE(!map.IsWritten());
+    REQUIRE(!map.IsModified());
+    REQUIRE(map.GetModificationTick() == 0);
+    REQUIRE(map.GetGpuAddress() == 0x2000);
+    REQUIRE(ConsumeDirtyRanges(map).empty());
+
+    map.MarkAsDirty(0x1F * PAGE_SIZE, 0x20 * PAGE_SIZE);
+    REQUIRE(ConsumeDirtyRanges(map) ==
+            std::vector<Range>{{0x1F * PAGE_SIZE, 0x20 * PAGE_SIZE}});
+}
+
+TEST_CASE("MapIntervalPool: Unreferenced maps are recycled", "[video_core]") {
+    MapIntervalPool pool(2);
+    MapInterval first = pool.Create(0x1000, 0x2000, 0x100);
+    MapIntervalBase* const first_ptr = first.get();
+    first->MarkAsDirty(0x1000, 0x2000);
+    pool.Release(first);
+    REQUIRE(pool.Size() == 1);
+
+    // Maps still referenced by someone else are not reused
+    const MapInterval second = pool.Create(0x3000, 0x4000, 0x200);
+    REQUIRE(second.get() != first_ptr);
+    REQUIRE(pool.Size() == 1);
+
+    first.reset();
+    const MapInterval recycled = pool.Create(0x5000, 0x6000, 0x300);
+    REQUIRE(recycled.get() == first_ptr);
+    REQUIRE(pool.Size() == 0);
+    REQUIRE(recycled->GetStart() == 0x5000);
+    REQUIRE(recycled->GetEnd() == 0x6000);
+    REQUIRE(recycled->GetGpuAddress() == 0x300);
+    REQUIRE(!recycled->IsDirty());
+}
+
+TEST_CASE("MapIntervalPool: The pool is bounded", "[video_core]") {
+    MapIntervalPool pool(2);
+    for (CacheAddr i = 0; i < 4; ++i) {
+        pool.Release(std::make_shared<MapIntervalBase>(i * PAGE_SIZE, (i + 1) * PAGE_SIZE, 0));
+    }
+    REQUIRE(pool.Size() == 2);
+
+    pool.Create(0, PAGE_SIZE, 0);
+    pool.Create(0, PAGE_SIZE, 0);
+    REQUIRE(pool.Size() == 0);
+
+    // Empty pools allocate new maps
+    const MapInterval map = pool.Create(PAGE_SIZE, 2 * PAGE_SIZE, 0x400);
+    REQUIRE(map->GetStart() == PAGE_SIZE);
+    REQUIRE(map->GetGpuAddress() == 0x400);
+}
+
+} // namespace VideoCommon
@@ -0,0 +1,184 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "video_core/query_cache.h"
+
+namespace VideoCommon {
+
+namespace {
+
+class FakeCounter;
+
+/// Host GPU counting the samples of its draws in the running counters
+struct FakeHost {
+    void Draw(u64 samples);
+
+    std::vector<FakeCounter*> running;
+};
+
+class FakeCounter {
+public:
+    FakeCounter(FakeHost& host, std::shared_ptr<FakeCounter> dependency, VideoCore::QueryType)
+        : host{host}, dependency{std::move(dependency)} {
+        host.running.push_back(this);
+    }
+
+    ~FakeCounter() {
+        EndQuery();
+    }
+
+    void EndQuery() {
+        host.running.erase(std::remove(host.running.begin(), host.running.end(), this),
+                           host.running.end());
+    }
+
+    u64 Query() const {
+        return samples + (dependency ? dependency->Query() : 0);
+    }
+
+    void AddSamples(u64 count) {
+        samples += count;
+    }
+
+private:
+    FakeHost& host;
+    std::shared_ptr<FakeCounter> dependency;
+    u64 samples = 0;
+};
+
+void FakeHost::Draw(u64 samples) {
+    for (FakeCounter* const counter : running) {
+        counter->AddSamples(samples);
+    }
+}
+
+using FakeStream = CounterStreamBase<FakeHost, FakeCounter>;
+
+struct FakeQuery {
+    CacheAddr GetCacheAddr() const {
+        return addr;
+    }
+
+    std::size_t GetSizeInBytes() const {
+        return size;
+    }
+
+    CacheAddr addr;
+    std::size_t size;
+};
+
+/// Returns the addresses of the queries removed from a region and whether they were covered
+std::vector<std::pair<CacheAddr, bool>> RemoveRegion(CachedQueryIndex<FakeQuery>& index,
+                                                     CacheAddr addr, std::size_t size) {
+    std::vector<std::pair<CacheAddr, bool>> removed;
+    index.RemoveRegion(addr, size, [&removed](const FakeQuery& query, bool is_covered) {
+        removed.emplace_back(query.addr, is_covered);
+    });
+    std::sort(removed.begin(), removed.end());
+    return removed;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("CounterStreamBase: Paused streams don't count host draws", "[video_core]") {
+    FakeHost host;
+    FakeStream stream(host, VideoCore::QueryType::SamplesPassed);
+    REQUIRE(stream.Current() == nullptr);
+
+    stream.Update(true);
+    host.Draw(10);
+    const auto before_present = stream.Current();
+    REQUIRE(before_present->Query() == 10);
+
+    // The presentation draws happen between the pause and the next guest draw
+    stream.Pause();
+    REQUIRE(!stream.IsRunning());
+    host.Draw(1000);
+    REQUIRE(stream.Current()->Query() == 10);
+
+    stream.Update(true);
+    host.Draw(5);
+    REQUIRE(before_present->Query() == 10);
+    REQUIRE(stream.Current()->Query() == 15);
+
+    // Pausing a stream the guest disabled keeps it disabled
+    stream.Update(false);
+    stream.Pause();
+    host.Draw(1000);
+    REQUIRE(!stream.IsRunning());
+    REQUIRE(stream.Current()->Query() == 15);
+}
+
+TEST_CASE("CounterStreamBase: Reset discards the counted samples", "[video_core]") {
+    FakeHost host;
+    FakeStream stream(host, VideoCore::QueryType::SamplesPassed);
+    stream.Update(true);
+    host.Draw(10);
+    stream.Reset();
+    REQUIRE(stream.IsRunning());
+    host.Draw(3);
+    REQUIRE(stream.Current()->Query() == 3);
+
+    stream.Update(false);
+    stream.Reset();
+    REQUIRE(stream.Current() == nullptr);
+}
+
+TEST_CASE("CachedQueryIndex: Queries straddling pages are found from every page",
+          "[video_core]") {
+    CachedQueryIndex<FakeQuery> index;
+    index.Insert({0x1FF8, 16});
+    index.Insert({0x3000, 4});
+    REQUIRE(index.Size() == 2);
+    REQUIRE(index.NumPages() == 3);
+    REQUIRE(index.TryGet(0x1FF8) != nullptr);
+    REQUIRE(index.TryGet(0x2000) == nullptr);
+
+    // Regions in the second page of a query remove it
+    REQUIRE(RemoveRegion(index, 0x2000, 0x1000) == std::vector<std::pair<CacheAddr, bool>>{
+                                                       {0x1FF8, false}});
+    REQUIRE(index.TryGet(0x1FF8) == nullptr);
+    REQUIRE(index.NumPages() == 1);
+
+    // Regions that only touch a query's neighbours keep it
+    REQUIRE(RemoveRegion(index, 0x2FFC, 4).empty());
+    REQUIRE(RemoveRegion(index, 0x3004, 4).empty());
+    REQUIRE(RemoveRegion(index, 0x3000, 4) == std::vector<std::pair<CacheAddr, bool>>{
+                                                  {0x3000, true}});
+    REQUIRE(index.Size() == 0);
+    REQUIRE(index.NumPages() == 0);
+}
+
+TEST_CASE("CachedQueryIndex: Partially overwritten queries are reported", "[video_core]") {
+    CachedQueryIndex<FakeQuery> index;
+    index.Insert({0x1000, 16});
+    index.Insert({0x1010, 4});
+    index.Insert({0x1020, 16});
+
+    // Queries only partly inside of the region are reported as not covered
+    REQUIRE(RemoveRegion(index, 0x1008, 0x1C) == std::vector<std::pair<CacheAddr, bool>>{
+                                                     {0x1000, false},
+                                                     {0x1010, true},
+                                                     {0x1020, false}});
+    REQUIRE(index.Size() == 0);
+}
+
+TEST_CASE("CachedQueryIndex: RemoveIf drops queries from every page", "[video_core]") {
+    CachedQueryIndex<FakeQuery> index;
+    index.Insert({0xFFC, 16});
+    index.Insert({0x5000, 4});
+    index.RemoveIf([](const FakeQuery& query) { return query.addr == 0xFFC; });
+    REQUIRE(index.Size() == 1);
+    REQUIRE(index.NumPages() == 1);
+    REQUIRE(RemoveRegion(index, 0x1000, 0x10).empty());
+    REQUIRE(index.TryGet(0x5000) != nullptr);
+}
+
+} // namespace VideoCommon
@@ -0,0 +1,194 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <limits>
+#include <memory>
+#include <string>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "video_core/shader/control_flow.h"
+
+namespace VideoCommon::Shader {
+
+namespace {
+
+const std::string TestPath = "shader_flow_cache_test.bin";
+
+constexpr u64 EXIT = 0xE30000000007000FULL;
+constexpr u64 NOP = 0;
+
+// Scheduling instruction followed by a few instructions and an unconditional exit
+ProgramCode MakeProgram(u64 padding) {
+    return {NOP, padding, NOP, EXIT};
+}
+
+std::size_t ProgramSize(const ProgramCode& code) {
+    return code.size() * sizeof(u64);
+}
+
+void RequireSameCharacteristics(const ShaderCharacteristics& lhs,
+                                const ShaderCharacteristics& rhs) {
+    REQUIRE(lhs.blocks == rhs.blocks);
+    REQUIRE(lhs.labels == rhs.labels);
+    REQUIRE(lhs.start == rhs.start);
+    REQUIRE(lhs.end == rhs.end);
+    REQUIRE(lhs.settings.depth == rhs.settings.depth);
+}
+
+ShaderFlowInfo MakeFlow() {
+    ShaderFlowInfo flow;
+    flow.depth = CompileDepth::FullDecompile;
+    flow.start = 1;
+    flow.end = 12;
+    ShaderBlock block;
+    block.start = 1;
+    block.end = 11;
+    block.branch.address = exit_branch;
+    flow.blocks = {block, block};
+    flow.blocks[1].start = 12;
+    flow.labels = {1, 12};
+    return flow;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("ShaderFlowCache: Programs are only scanned once", "[video_core]") {
+    const auto code = MakeProgram(NOP);
+    const CompilerSettings settings{CompileDepth::NoFlowStack, true};
+    const auto uncached = ScanFlow(code, ProgramSize(code), 0, settings);
+
+    ShaderFlowCache cache;
+    const auto first = ScanFlow(code, ProgramSize(code), 0, settings, &cache);
+    REQUIRE(cache.GetMisses() == 1);
+    REQUIRE(cache.GetHits() == 0);
+    RequireSameCharacteristics(*first, *uncached);
+
+    // The same code at another address of guest memory hits
+    const ProgramCode copy = code;
+    const auto second = ScanFlow(copy, ProgramSize(copy), 0, settings, &cache);
+    REQUIRE(cache.GetMisses() == 1);
+    REQUIRE(cache.GetHits() == 1);
+    RequireSameCharacteristics(*second, *uncached);
+
+    // Different code, settings or entry points miss
+    const auto other = MakeProgram(0x1234);
+    ScanFlow(other, ProgramSize(other), 0, settings, &cache);
+    ScanFlow(code, ProgramSize(code), 0, {CompileDepth::FullDecompile, true}, &cache);
+    ScanFlow(code, ProgramSize(code), 0, {CompileDepth::NoFlowStack, false}, &cache);
+    REQUIRE(cache.GetMisses() == 4);
+    REQUIRE(cache.GetHits() == 1);
+
+    // Decompiled flows rebuild their AST from the cached blocks
+    const CompilerSettings decompile{CompileDepth::FullDecompile, true};
+    const auto decompiled = ScanFlow(code, ProgramSize(code), 0, decompile, &cache);
+    REQUIRE(cache.GetHits() == 2);
+    RequireSameCharacteristics(*decompiled, *ScanFlow(code, ProgramSize(code), 0, decompile));
+    REQUIRE(decompiled->manager.IsFullyDecompiled());
+
+    // Brute force doesn't analyze the flow, so it's never cached
+    ScanFlow(code, ProgramSize(code), 0, {CompileDepth::BruteForce, true}, &cache);
+    REQUIRE(cache.GetMisses() == 4);
+    REQUIRE(cache.GetHits() == 2);
+}
+
+TEST_CASE("ShaderFlowCache: Only new flows are taken", "[video_core]") {
+    const auto code = MakeProgram(NOP);
+    const CompilerSettings settings{CompileDepth::NoFlowStack, true};
+    const auto key = MakeShaderFlowKey(code, ProgramSize(code), 0, settings);
+
+    ShaderFlowCache cache;
+    ScanFlow(code, ProgramSize(code), 0, settings, &cache);
+    const auto entries = cache.TakeNewEntries();
+    REQUIRE(entries.size() == 1);
+    REQUIRE(entries[0].first == key);
+    REQUIRE(entries[0].second == cache.Find(key));
+    REQUIRE(cache.TakeNewEntries().empty());
+
+    // Loaded flows are already persisted
+    ShaderFlowCache loaded;
+    loaded.Load(key, entries[0].second);
+    REQUIRE(loaded.TakeNewEntries().empty());
+    ScanFlow(code, ProgramSize(code), 0, settings, &loaded);
+    REQUIRE(loaded.GetHits() == 1);
+    REQUIRE(loaded.GetMisses() == 0);
+}
+
+TEST_CASE("ShaderFlowCache: Flows round trip through disk", "[video_core]") {
+    const auto code = MakeProgram(NOP);
+    const auto key = MakeShaderFlowKey(code, ProgramSize(code), 0, {});
+    const auto flow = MakeFlow();
+    {
+        FileUtil::IOFile file(TestPath, "wb");
+        REQUIRE(SaveShaderFlow(file, key, flow));
+        REQUIRE(SaveShaderFlow(file, key, flow));
+    }
+    {
+        FileUtil::IOFile file(TestPath, "rb");
+        for (int i = 0; i < 2; ++i) {
+            ShaderFlowKey loaded_key{};
+            ShaderFlowInfo loaded;
+            REQUIRE(LoadShaderFlow(file, loaded_key, loaded) == flow_analysis_version);
+            REQUIRE(loaded_key == key);
+            REQUIRE(loaded.depth == flow.depth);
+            REQUIRE(loaded.start == flow.start);
+            REQUIRE(loaded.end == flow.end);
+            REQUIRE(loaded.blocks == flow.blocks);
+            REQUIRE(loaded.labels == flow.labels);
+        }
+        ShaderFlowKey loaded_key{};
+        ShaderFlowInfo loaded;
+        REQUIRE(!LoadShaderFlow(file, loaded_key, loaded));
+    }
+
+    // Flows stored by another analysis version are reported, so the caller can drop them
+    {
+        FileUtil::IOFile file(TestPath, "r+b");
+        REQUIRE(file.WriteObject(flow_analysis_version + 1) == 1);
+    }
+    {
+        FileUtil::IOFile file(TestPath, "rb");
+        ShaderFlowKey loaded_key{};
+        ShaderFlowInfo loaded;
+        REQUIRE(LoadShaderFlow(file, loaded_key, loaded) == flow_analysis_version + 1);
+    }
+    FileUtil::Delete(TestPath);
+}
+
+TEST_CASE("ShaderFlowCache: Corrupted flows are rejected", "[video_core]") {
+    const auto flow = MakeFlow();
+    const u32 huge = std::numeric_limits<u32>::max();
+    // Offset of the blocks count: version, key, depth, start and end
+    constexpr std::size_t blocks_count_offset = sizeof(u32) * 4 + sizeof(ShaderFlowKey);
+
+    for (const std::size_t offset : {blocks_count_offset, blocks_count_offset + sizeof(u32)}) {
+        {
+            FileUtil::IOFile file(TestPath, "wb");
+            REQUIRE(SaveShaderFlow(file, {}, flow));
+            REQUIRE(file.Seek(static_cast<s64>(offset), SEEK_SET));
+            REQUIRE(file.WriteObject(huge) == 1);
+        }
+        FileUtil::IOFile file(TestPath, "rb");
+        ShaderFlowKey key{};
+        ShaderFlowInfo loaded;
+        REQUIRE(!LoadShaderFlow(file, key, loaded));
+        REQUIRE(loaded.blocks.empty());
+    }
+
+    // Truncated entries are rejected too
+    {
+        FileUtil::IOFile file(TestPath, "wb");
+        REQUIRE(SaveShaderFlow(file, {}, flow));
+        REQUIRE(file.Resize(file.GetSize() - 1));
+    }
+    {
+        FileUtil::IOFile file(TestPath, "rb");
+        ShaderFlowKey key{};
+        ShaderFlowInfo loaded;
+        REQUIRE(!LoadShaderFlow(file, key, loaded));
+    }
+    FileUtil::Delete(TestPath);
+}
+
+} // namespace VideoCommon::Shader
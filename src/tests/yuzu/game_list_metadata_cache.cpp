@@ -0,0 +1,144 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <string>
+#include <vector>
+#include <catch2/catch.hpp>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "yuzu/game_list_metadata_cache.h"
+
+namespace {
+
+const std::string TestPath = "game_list_metadata_cache_test.bin";
+
+GameListMetadataCache::Entry MakeEntry(u64 size, u64 program_id, std::string name) {
+    GameListMetadataCache::Entry entry;
+    entry.size = size;
+    entry.modified_time = static_cast<s64>(size) * 1000;
+    entry.has_loader = true;
+    entry.file_type = Loader::FileType::NSP;
+    entry.has_program_id = true;
+    entry.program_id = program_id;
+    entry.has_metadata = true;
+    entry.name = std::move(name);
+    entry.icon = {0xFF, 0xD8, 0xFF, static_cast<u8>(size)};
+    return entry;
+}
+
+void RequireSameEntry(const GameListMetadataCache::Entry& lhs,
+                      const GameListMetadataCache::Entry& rhs) {
+    REQUIRE(lhs.size == rhs.size);
+    REQUIRE(lhs.modified_time == rhs.modified_time);
+    REQUIRE(lhs.has_loader == rhs.has_loader);
+    REQUIRE(lhs.file_type == rhs.file_type);
+    REQUIRE(lhs.has_program_id == rhs.has_program_id);
+    REQUIRE(lhs.program_id == rhs.program_id);
+    REQUIRE(lhs.has_metadata == rhs.has_metadata);
+    REQUIRE(lhs.name == rhs.name);
+    REQUIRE(lhs.icon == rhs.icon);
+}
+
+std::vector<u8> ReadTestFile() {
+    FileUtil::IOFile file(TestPath, "rb");
+    std::vector<u8> data(file.GetSize());
+    REQUIRE(file.ReadBytes(data.data(), data.size()) == data.size());
+    return data;
+}
+
+void WriteTestFile(const std::vector<u8>& data) {
+    FileUtil::IOFile file(TestPath, "wb");
+    REQUIRE(file.WriteBytes(data.data(), data.size()) == data.size());
+}
+
+} // Anonymous namespace
+
+TEST_CASE("GameListMetadataCache: Save and load", "[yuzu]") {
+    FileUtil::Delete(TestPath);
+    const auto first = MakeEntry(0x1000, 0x0100000000010000, "First");
+    const auto second = MakeEntry(0x2000, 0x0100000000020000, "Second");
+    {
+        GameListMetadataCache cache(TestPath);
+        REQUIRE(!cache.Find("a.nsp", first.size, first.modified_time));
+        cache.Store("a.nsp", first);
+        cache.Store("b.nsp", second);
+        cache.Save(false);
+    }
+
+    GameListMetadataCache cache(TestPath);
+    const auto found_first = cache.Find("a.nsp", first.size, first.modified_time);
+    const auto found_second = cache.Find("b.nsp", second.size, second.modified_time);
+    REQUIRE(found_first);
+    REQUIRE(found_second);
+    RequireSameEntry(*found_first, first);
+    RequireSameEntry(*found_second, second);
+
+    // Entries are only used while the file is unchanged
+    REQUIRE(!cache.Find("a.nsp", first.size + 1, first.modified_time));
+    REQUIRE(!cache.Find("a.nsp", first.size, first.modified_time + 1));
+    REQUIRE(!cache.Find("c.nsp", first.size, first.modified_time));
+    FileUtil::Delete(TestPath);
+}
+
+TEST_CASE("GameListMetadataCache: Pruning", "[yuzu]") {
+    FileUtil::Delete(TestPath);
+    const auto first = MakeEntry(0x1000, 1, "First");
+    const auto second = MakeEntry(0x2000, 2, "Second");
+    {
+        GameListMetadataCache cache(TestPath);
+        cache.Store("a.nsp", first);
+        cache.Store("b.nsp", second);
+        cache.Save(false);
+    }
+    {
+        // Unused entries are kept unless the index is pruned
+        GameListMetadataCache cache(TestPath);
+        REQUIRE(cache.Find("a.nsp", first.size, first.modified_time));
+        cache.Save(false);
+    }
+    {
+        GameListMetadataCache cache(TestPath);
+        REQUIRE(cache.Find("a.nsp", first.size, first.modified_time));
+        cache.Save(true);
+    }
+
+    GameListMetadataCache cache(TestPath);
+    REQUIRE(cache.Find("a.nsp", first.size, first.modified_time));
+    REQUIRE(!cache.Find("b.nsp", second.size, second.modified_time));
+    FileUtil::Delete(TestPath);
+}
+
+TEST_CASE("GameListMetadataCache: Invalid files are ignored", "[yuzu]") {
+    FileUtil::Delete(TestPath);
+    const auto entry = MakeEntry(0x1000, 1, "First");
+    {
+        GameListMetadataCache cache(TestPath);
+        cache.Store("a.nsp", entry);
+        cache.Save(false);
+    }
+    const auto data = ReadTestFile();
+
+    SECTION("Truncated") {
+        WriteTestFile(std::vector<u8>(data.begin(), data.end() - 1));
+    }
+    SECTION("Other version") {
+        auto other_version = data;
+        ++other_version[4];
+        WriteTestFile(other_version);
+    }
+    SECTION("Other magic") {
+        auto other_magic = data;
+        ++other_magic[0];
+        WriteTestFile(other_magic);
+    }
+
+    GameListMetadataCache cache(TestPath);
+    REQUIRE(!cache.Find("a.nsp", entry.size, entry.modified_time));
+
+    // The invalid index is replaced by the next save
+    cache.Store("a.nsp", entry);
+    cache.Save(false);
+    REQUIRE(GameListMetadataCache(TestPath).Find("a.nsp", entry.size, entry.modified_time));
+    FileUtil::Delete(TestPath);
+}
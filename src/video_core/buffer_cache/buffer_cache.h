@@ -5,6 +5,7 @@
 #pragma once
 
 #include <array>
+#include <iterator>
 #include <memory>
 #include <mutex>
 #include <unordered_map>
@@ -12,8 +13,11 @@
 #include <utility>
 #include <vector>
 
+#include <boost/icl/interval_set.hpp>
+
 #include "common/alignment.h"
 #include "common/common_types.h"
+#include "common/paged_range_index.h"
 #include "core/core.h"
 #include "video_core/buffer_cache/buffer_block.h"
 #include "video_core/buffer_cache/map_interval.h"
@@ -22,7 +26,11 @@
 
 namespace VideoCommon {
 
-using MapInterval = std::shared_ptr<MapIntervalBase>;
+/// Transfer statistics of a buffer cache during a frame
+struct BufferCacheStats {
+    u64 bytes_requested{}; ///< Bytes requested by the rasterizer
+    u64 bytes_uploaded{};  ///< Bytes copied to the host, including the stream buffer
+};
 
 template <typename TBuffer, typename TBufferType, typename StreamBuffer>
 class BufferCache {
@@ -33,6 +41,8 @@ public:
                             bool is_written = false) {
         std::lock_guard lock{mutex};
 
+        frame_stats.bytes_requested += size;
+
         auto& memory_manager = system.GPU().MemoryManager();
         const auto host_ptr = memory_manager.GetPointer(gpu_addr);
         if (!host_ptr) {
@@ -72,6 +82,7 @@ public:
     BufferInfo UploadHostMemory(const void* raw_pointer, std::size_t size,
                                 std::size_t alignment = 4) {
         std::lock_guard lock{mutex};
+        frame_stats.bytes_requested += size;
         return StreamBufferUpload(raw_pointer, size, alignment);
     }
 
@@ -91,6 +102,12 @@ public:
     }
 
     void TickFrame() {
+        std::lock_guard lock{mutex};
+
+        last_frame_stats = std::exchange(frame_stats, {});
+        LOG_TRACE(HW_GPU, "Buffer cache uploaded {} bytes out of {} requested",
+                  last_frame_stats.bytes_uploaded, last_frame_stats.bytes_requested);
+
         ++epoch;
         while (!pending_destruction.empty()) {
             if (pending_destruction.front()->GetEpoch() + 1 > epoch) {
@@ -104,7 +121,8 @@ public:
     void FlushRegion(CacheAddr addr, std::size_t size) {
         std::lock_guard lock{mutex};
 
-        std::vector<MapInterval> objects = GetMapsInRange(addr, size);
+        auto maps = GetMapsInRange(addr, size);
+        std::vector<MapInterval>& objects = *maps;
         std::sort(objects.begin(), objects.end(), [](const MapInterval& a, const MapInterval& b) {
             return a->GetModificationTick() < b->GetModificationTick();
         });
@@ -119,14 +137,58 @@ public:
     void InvalidateRegion(CacheAddr addr, u64 size) {
         std::lock_guard lock{mutex};
 
-        std::vector<MapInterval> objects = GetMapsInRange(addr, size);
-        for (auto& object : objects) {
-            if (object->IsRegistered()) {
+        const CacheAddr addr_end = addr + size;
+        auto maps = GetMapsInRange(addr, size);
+        for (auto& object : *maps) {
+            if (!object->IsRegistered()) {
+                continue;
+            }
+            if (addr <= object->GetStart() && object->GetEnd() <= addr_end) {
                 Unregister(object);
+            } else {
+                // Partially invalidated maps are kept and their dirty pages uploaded on next use
+                object->MarkAsDirty(addr, addr_end);
             }
         }
     }
 
+    /// Marks the GPU modified maps overlapping a range the guest overwrote as dirty until the range
+    /// is invalidated. Flushes upload the dirty pages first, so the new data is kept.
+    void MarkRegionOverwritten(CacheAddr addr, std::size_t size) {
+        std::lock_guard lock{mutex};
+
+        const CacheAddr addr_end = addr + size;
+        for (const auto& map : mapped_addresses.Query(addr, addr_end)) {
+            if (map->IsModified()) {
+                map->MarkAsDirty(addr, addr_end);
+            }
+        }
+    }
+
+    /// Uploads a range the guest memory was written to into the cached buffer holding it, instead
+    /// of invalidating the buffer. Returns false when the range is not inside a single buffer.
+    bool UpdateRegion(CacheAddr addr, std::size_t size) {
+        std::lock_guard lock{mutex};
+
+        const auto objects{mapped_addresses.Query(addr, addr + size)};
+        const auto it = objects.begin();
+        if (it == objects.end() || std::next(it) != objects.end()) {
+            return false;
+        }
+        const MapInterval& map = *it;
+        if (!map->IsRegistered() || !map->IsInside(addr, addr + size)) {
+            return false;
+        }
+        const TBuffer block = blocks[map->GetStart() >> block_page_bits];
+        UploadBlockRange(block, addr, addr + size);
+        return true;
+    }
+
+    /// Returns the transfer statistics of the last completed frame
+    BufferCacheStats GetLastFrameStats() const {
+        return last_frame_stats;
+    }
+
     virtual const TBufferType* GetEmptyBuffer(std::size_t size) = 0;
 
 protected:
@@ -165,8 +227,7 @@ protected:
         const std::size_t size = new_map->GetEnd() - new_map->GetStart();
         new_map->SetCpuAddress(*cpu_addr);
         new_map->MarkAsRegistered(true);
-        const IntervalType interval{new_map->GetStart(), new_map->GetEnd()};
-        mapped_addresses.insert({interval, new_map});
+        mapped_addresses.Insert(new_map->GetStart(), new_map->GetEnd(), new_map);
         rasterizer.UpdatePagesCachedCount(*cpu_addr, size, 1);
         if (inherit_written) {
             MarkRegionAsWritten(new_map->GetStart(), new_map->GetEnd() - 1);
@@ -182,24 +243,20 @@ protected:
         if (map->IsWritten()) {
             UnmarkRegionAsWritten(map->GetStart(), map->GetEnd() - 1);
         }
-        const IntervalType delete_interval{map->GetStart(), map->GetEnd()};
-        mapped_addresses.erase(delete_interval);
+        mapped_addresses.Erase(map->GetStart(), map->GetEnd(), map);
+        map_pool.Release(map);
     }
 
 private:
-    MapInterval CreateMap(const CacheAddr start, const CacheAddr end, const GPUVAddr gpu_addr) {
-        return std::make_shared<MapIntervalBase>(start, end, gpu_addr);
-    }
-
     MapInterval MapAddress(const TBuffer& block, const GPUVAddr gpu_addr,
                            const CacheAddr cache_addr, const std::size_t size) {
 
-        std::vector<MapInterval> overlaps = GetMapsInRange(cache_addr, size);
+        auto maps = GetMapsInRange(cache_addr, size);
+        std::vector<MapInterval>& overlaps = *maps;
         if (overlaps.empty()) {
             const CacheAddr cache_addr_end = cache_addr + size;
-            MapInterval new_map = CreateMap(cache_addr, cache_addr_end, gpu_addr);
-            u8* host_ptr = FromCacheAddr(cache_addr);
-            UploadBlockData(block, block->GetOffset(cache_addr), size, host_ptr);
+            MapInterval new_map = map_pool.Create(cache_addr, cache_addr_end, gpu_addr);
+            UploadBlockRange(block, cache_addr, cache_addr_end);
             Register(new_map);
             return new_map;
         }
@@ -208,6 +265,7 @@ private:
         if (overlaps.size() == 1) {
             MapInterval& current_map = overlaps[0];
             if (current_map->IsInside(cache_addr, cache_addr_end)) {
+                UploadDirtyPages(block, current_map);
                 return current_map;
             }
         }
@@ -227,7 +285,7 @@ private:
             Unregister(overlap);
         }
         UpdateBlock(block, new_start, new_end, overlaps);
-        MapInterval new_map = CreateMap(new_start, new_end, new_gpu_addr);
+        MapInterval new_map = map_pool.Create(new_start, new_end, new_gpu_addr);
         if (modified_inheritance) {
             new_map->MarkAsModified(true, GetModifiedTicks());
         }
@@ -243,28 +301,33 @@ private:
         for (auto& overlap : overlaps) {
             const IntervalType subtract{overlap->GetStart(), overlap->GetEnd()};
             interval_set.subtract(subtract);
+            UploadDirtyPages(block, overlap);
         }
         for (auto& interval : interval_set) {
-            std::size_t size = interval.upper() - interval.lower();
-            if (size > 0) {
-                u8* host_ptr = FromCacheAddr(interval.lower());
-                UploadBlockData(block, block->GetOffset(interval.lower()), size, host_ptr);
-            }
+            UploadBlockRange(block, interval.lower(), interval.upper());
         }
     }
 
-    std::vector<MapInterval> GetMapsInRange(CacheAddr addr, std::size_t size) {
-        if (size == 0) {
-            return {};
-        }
+    /// Uploads the pages of a map modified by the CPU since its last use
+    void UploadDirtyPages(const TBuffer& block, MapInterval& map) {
+        map->ConsumeDirtyRanges([this, &block](CacheAddr start, CacheAddr end) {
+            UploadBlockRange(block, start, end);
+        });
+    }
 
-        std::vector<MapInterval> objects{};
-        const IntervalType interval{addr, addr + size};
-        for (auto& pair : boost::make_iterator_range(mapped_addresses.equal_range(interval))) {
-            objects.push_back(pair.second);
+    void UploadBlockRange(const TBuffer& block, CacheAddr start, CacheAddr end) {
+        if (start >= end) {
+            return;
         }
+        const std::size_t size = end - start;
+        UploadBlockData(block, block->GetOffset(start), size, FromCacheAddr(start));
+        frame_stats.bytes_uploaded += size;
+    }
 
-        return objects;
+    /// Returns the maps overlapping a range, copied to a reused buffer
+    typename Common::QueryBuffer<MapInterval>::Results GetMapsInRange(CacheAddr addr,
+                                                                      std::size_t size) {
+        return mapped_addresses.Collect(maps_query_buffer, addr, addr + size);
     }
 
     /// Returns a ticks counter used for tracking when cached objects were last modified
@@ -275,6 +338,8 @@ private:
     void FlushMap(MapInterval map) {
         std::size_t size = map->GetEnd() - map->GetStart();
         TBuffer block = blocks[map->GetStart() >> block_page_bits];
+        // Pages written by the CPU are newer than the host copy, upload them before downloading
+        UploadDirtyPages(block, map);
         u8* host_ptr = FromCacheAddr(map->GetStart());
         DownloadBlockData(block, block->GetOffset(map->GetStart()), size, host_ptr);
         map->MarkAsModified(false, 0);
@@ -285,6 +350,7 @@ private:
         AlignBuffer(alignment);
         const std::size_t uploaded_offset = buffer_offset;
         std::memcpy(buffer_ptr, raw_pointer, size);
+        frame_stats.bytes_uploaded += size;
 
         buffer_ptr += size;
         buffer_offset += size;
@@ -426,9 +492,16 @@ private:
     u64 buffer_offset_base = 0;
 
     using IntervalSet = boost::icl::interval_set<CacheAddr>;
-    using IntervalCache = boost::icl::interval_map<CacheAddr, MapInterval>;
-    using IntervalType = typename IntervalCache::interval_type;
-    IntervalCache mapped_addresses{};
+    using IntervalType = typename IntervalSet::interval_type;
+
+    // Maps are bucketed by 64KiB pages, buffers are usually small and tightly packed
+    static constexpr u64 map_page_bits{16};
+    Common::PagedRangeIndex<MapInterval, map_page_bits> mapped_addresses{};
+    Common::QueryBuffer<MapInterval> maps_query_buffer;
+
+    // Unregistered maps are kept around to be recycled instead of reallocated
+    static constexpr std::size_t max_map_pool_size{0x400};
+    MapIntervalPool map_pool{max_map_pool_size};
 
     static constexpr u64 write_page_bit{11};
     std::unordered_map<u64, u32> written_pages{};
@@ -441,6 +514,9 @@ private:
     u64 epoch{};
     u64 modified_ticks{};
 
+    BufferCacheStats frame_stats{};
+    BufferCacheStats last_frame_stats{};
+
     std::recursive_mutex mutex;
 };
 
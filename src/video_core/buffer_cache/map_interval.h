@@ -4,6 +4,12 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+
 #include "common/common_types.h"
 #include "video_core/gpu.h"
 
@@ -11,9 +17,26 @@ namespace VideoCommon {
 
 class MapIntervalBase {
 public:
+    /// Dirty memory is tracked with the granularity of CPU pages
+    static constexpr u64 DIRTY_PAGE_BITS = 12;
+
     MapIntervalBase(const CacheAddr start, const CacheAddr end, const GPUVAddr gpu_addr)
         : start{start}, end{end}, gpu_addr{gpu_addr} {}
 
+    /// Reinitializes a recycled interval, the dirty page storage keeps its capacity
+    void Reset(const CacheAddr new_start, const CacheAddr new_end, const GPUVAddr new_gpu_addr) {
+        start = new_start;
+        end = new_end;
+        gpu_addr = new_gpu_addr;
+        cpu_addr = 0;
+        is_written = false;
+        is_modified = false;
+        is_registered = false;
+        ticks = 0;
+        dirty_pages.clear();
+        num_dirty_pages = 0;
+    }
+
     void SetCpuAddress(VAddr new_cpu_addr) {
         cpu_addr = new_cpu_addr;
     }
@@ -75,7 +98,62 @@ public:
         return is_written;
     }
 
+    /// Marks the pages overlapping [dirty_start, dirty_end) as modified by the CPU
+    void MarkAsDirty(const CacheAddr dirty_start, const CacheAddr dirty_end) {
+        const CacheAddr clamp_start = std::max(dirty_start, start);
+        const CacheAddr clamp_end = std::min(dirty_end, end);
+        if (clamp_start >= clamp_end) {
+            return;
+        }
+        if (dirty_pages.empty()) {
+            dirty_pages.resize(GetNumPages(), false);
+        }
+        const u64 base_page = start >> DIRTY_PAGE_BITS;
+        const u64 page_end = ((clamp_end - 1) >> DIRTY_PAGE_BITS) - base_page;
+        for (u64 page = (clamp_start >> DIRTY_PAGE_BITS) - base_page; page <= page_end; ++page) {
+            if (!dirty_pages[page]) {
+                dirty_pages[page] = true;
+                ++num_dirty_pages;
+            }
+        }
+    }
+
+    bool IsDirty() const {
+        return num_dirty_pages > 0;
+    }
+
+    /// Calls func(range_start, range_end) for each run of dirty pages and marks them as clean
+    template <typename Func>
+    void ConsumeDirtyRanges(Func&& func) {
+        if (num_dirty_pages == 0) {
+            return;
+        }
+        const u64 base_page = start >> DIRTY_PAGE_BITS;
+        const std::size_t num_pages = dirty_pages.size();
+        std::size_t page = 0;
+        while (page < num_pages) {
+            if (!dirty_pages[page]) {
+                ++page;
+                continue;
+            }
+            const std::size_t run_begin = page;
+            while (page < num_pages && dirty_pages[page]) {
+                dirty_pages[page] = false;
+                ++page;
+            }
+            const CacheAddr range_start = (base_page + run_begin) << DIRTY_PAGE_BITS;
+            const CacheAddr range_end = (base_page + page) << DIRTY_PAGE_BITS;
+            func(std::max(range_start, start), std::min(range_end, end));
+        }
+        num_dirty_pages = 0;
+    }
+
 private:
+    std::size_t GetNumPages() const {
+        return static_cast<std::size_t>(((end - 1) >> DIRTY_PAGE_BITS) -
+                                        (start >> DIRTY_PAGE_BITS) + 1);
+    }
+
     CacheAddr start;
     CacheAddr end;
     GPUVAddr gpu_addr;
@@ -84,6 +162,45 @@ private:
     bool is_modified{};
     bool is_registered{};
     u64 ticks{};
+    std::vector<bool> dirty_pages;
+    std::size_t num_dirty_pages{};
+};
+
+using MapInterval = std::shared_ptr<MapIntervalBase>;
+
+/// Keeps unregistered maps around to recycle them instead of reallocating them
+class MapIntervalPool {
+public:
+    explicit MapIntervalPool(const std::size_t max_size) : max_size{max_size} {}
+
+    /// Returns a recycled map nobody else holds a reference to, or a new one
+    MapInterval Create(const CacheAddr start, const CacheAddr end, const GPUVAddr gpu_addr) {
+        for (auto it = pool.rbegin(); it != pool.rend(); ++it) {
+            if (it->use_count() != 1) {
+                continue;
+            }
+            MapInterval map = std::move(*it);
+            pool.erase(std::next(it).base());
+            map->Reset(start, end, gpu_addr);
+            return map;
+        }
+        return std::make_shared<MapIntervalBase>(start, end, gpu_addr);
+    }
+
+    /// Keeps an unregistered map to be recycled, unless the pool is full
+    void Release(MapInterval map) {
+        if (pool.size() < max_size) {
+            pool.push_back(std::move(map));
+        }
+    }
+
+    std::size_t Size() const {
+        return pool.size();
+    }
+
+private:
+    std::size_t max_size;
+    std::vector<MapInterval> pool;
 };
 
 } // namespace VideoCommon
@@ -2,17 +2,22 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstring>
 
 #include "common/assert.h"
 #include "video_core/engines/engine_upload.h"
 #include "video_core/memory_manager.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/textures/decoders.h"
 
 namespace Tegra::Engines::Upload {
 
-State::State(MemoryManager& memory_manager, Registers& regs)
-    : regs{regs}, memory_manager{memory_manager} {}
+State::State(MemoryManager& memory_manager, VideoCore::RasterizerInterface& rasterizer,
+             Registers& regs)
+    : regs{regs}, memory_manager{memory_manager}, rasterizer{rasterizer} {
+    pending_ranges.reserve(MaxPendingRanges);
+}
 
 State::~State() = default;
 
@@ -32,8 +37,16 @@ void State::ProcessData(const u32 data, const bool is_last_call) {
     }
     const GPUVAddr address{regs.dest.Address()};
     if (is_linear) {
-        memory_manager.WriteBlock(address, inner_buffer.data(), copy_size);
+        // Guest memory is updated right away, but updating the host caches is deferred. Games
+        // issue many small uploads to the same buffer and they end up as a single update.
+        // Cached state over the range is dropped first, so it can't be written back over it.
+        memory_manager.MarkRegionOverwritten(address, copy_size);
+        memory_manager.WriteBlockUnsafe(address, inner_buffer.data(), copy_size);
+        StageRange(address, copy_size);
     } else {
+        // Reading the surface flushes the caches, finish the pending writes before it
+        Flush();
+
         UNIMPLEMENTED_IF(regs.dest.z != 0);
         UNIMPLEMENTED_IF(regs.dest.depth != 1);
         UNIMPLEMENTED_IF(regs.dest.BlockWidth() != 0);
@@ -49,4 +62,41 @@ void State::ProcessData(const u32 data, const bool is_last_call) {
     }
 }
 
+void State::FlushPendingRanges() {
+    for (const auto& range : pending_ranges) {
+        // Ranges inside a cached buffer are uploaded to it instead of invalidating it
+        u8* const host_ptr = memory_manager.GetPointer(range.address);
+        if (host_ptr && memory_manager.IsBlockContinuous(range.address, range.size) &&
+            rasterizer.AccelerateInlineUpload(ToCacheAddr(host_ptr), range.size)) {
+            continue;
+        }
+        memory_manager.InvalidateRegion(range.address, range.size);
+    }
+    pending_ranges.clear();
+}
+
+void State::StageRange(GPUVAddr address, std::size_t size) {
+    if (size == 0) {
+        return;
+    }
+    GPUVAddr begin = address;
+    GPUVAddr end = address + size;
+    const auto it = std::remove_if(pending_ranges.begin(), pending_ranges.end(),
+                                   [&begin, &end](const PendingRange& range) {
+                                       const GPUVAddr range_end = range.address + range.size;
+                                       if (range_end < begin || range.address > end) {
+                                           return false;
+                                       }
+                                       begin = std::min(begin, range.address);
+                                       end = std::max(end, range_end);
+                                       return true;
+                                   });
+    pending_ranges.erase(it, pending_ranges.end());
+    pending_ranges.push_back({begin, static_cast<std::size_t>(end - begin)});
+
+    if (pending_ranges.size() >= MaxPendingRanges) {
+        FlushPendingRanges();
+    }
+}
+
 } // namespace Tegra::Engines::Upload
@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <vector>
 #include "common/bit_field.h"
 #include "common/common_types.h"
@@ -12,6 +13,10 @@ namespace Tegra {
 class MemoryManager;
 }
 
+namespace VideoCore {
+class RasterizerInterface;
+}
+
 namespace Tegra::Engines::Upload {
 
 struct Registers {
@@ -54,20 +59,47 @@ struct Registers {
 
 class State {
 public:
-    State(MemoryManager& memory_manager, Registers& regs);
+    State(MemoryManager& memory_manager, VideoCore::RasterizerInterface& rasterizer,
+          Registers& regs);
     ~State();
 
     void ProcessExec(bool is_linear);
     void ProcessData(u32 data, bool is_last_call);
 
+    /// Updates the host caches over the ranges written by linear uploads since the last flush.
+    /// Called before anything other than the owning engine may observe those ranges.
+    void Flush() {
+        // Checked on every method call of the other engines, only the flush is out of line
+        if (!pending_ranges.empty()) {
+            FlushPendingRanges();
+        }
+    }
+
 private:
+    /// Maximum number of disjoint ranges held before they are flushed
+    static constexpr std::size_t MaxPendingRanges = 64;
+
+    /// Guest range written by linear uploads whose host cache update has been deferred
+    struct PendingRange {
+        GPUVAddr address;
+        std::size_t size;
+    };
+
+    /// Queues a written range to be flushed, merging it with touching ranges.
+    void StageRange(GPUVAddr address, std::size_t size);
+
+    /// Updates the host caches over the pending ranges and clears them.
+    void FlushPendingRanges();
+
     u32 write_offset = 0;
     u32 copy_size = 0;
     std::vector<u8> inner_buffer;
     std::vector<u8> tmp_buffer;
+    std::vector<PendingRange> pending_ranges;
     bool is_linear = false;
     Registers& regs;
     MemoryManager& memory_manager;
+    VideoCore::RasterizerInterface& rasterizer;
 };
 
 } // namespace Tegra::Engines::Upload
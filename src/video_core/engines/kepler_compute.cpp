@@ -17,9 +17,8 @@ namespace Tegra::Engines {
 
 KeplerCompute::KeplerCompute(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
                              MemoryManager& memory_manager)
-    : system{system}, rasterizer{rasterizer}, memory_manager{memory_manager}, upload_state{
-                                                                                  memory_manager,
-                                                                                  regs.upload} {}
+    : system{system}, rasterizer{rasterizer}, memory_manager{memory_manager},
+      upload_state{memory_manager, rasterizer, regs.upload} {}
 
 KeplerCompute::~KeplerCompute() = default;
 
@@ -78,6 +77,8 @@ u32 KeplerCompute::AccessConstBuffer32(u64 const_buffer, u64 offset) const {
 }
 
 void KeplerCompute::ProcessLaunch() {
+    upload_state.Flush();
+
     const GPUVAddr launch_desc_loc = regs.launch_desc_loc.Address();
     memory_manager.ReadBlockUnsafe(launch_desc_loc, &launch_description,
                                    LaunchParams::NUM_LAUNCH_PARAMETERS * sizeof(u32));
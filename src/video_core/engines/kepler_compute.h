@@ -195,6 +195,11 @@ public:
     /// Write the value to the register identified by method.
     void CallMethod(const GPU::MethodCall& method_call);
 
+    /// Updates the host caches over the ranges written by inline uploads since the last flush.
+    void FlushUploads() {
+        upload_state.Flush();
+    }
+
     Tegra::Texture::FullTextureInfo GetTexture(std::size_t offset) const;
 
     /// Given a Texture Handle, returns the TSC and TIC entries.
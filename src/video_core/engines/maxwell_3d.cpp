@@ -2,8 +2,10 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cinttypes>
 #include <cstring>
+#include <optional>
 #include "common/assert.h"
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -21,9 +23,10 @@ constexpr u32 MacroRegistersStart = 0xE00;
 Maxwell3D::Maxwell3D(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
                      MemoryManager& memory_manager)
     : system{system}, rasterizer{rasterizer}, memory_manager{memory_manager},
-      macro_interpreter{*this}, upload_state{memory_manager, regs.upload} {
+      macro_interpreter{*this}, upload_state{memory_manager, rasterizer, regs.upload} {
     InitDirtySettings();
     InitializeRegisterDefaults();
+    pending_cb_ranges.reserve(MaxPendingCBRanges);
 }
 
 void Maxwell3D::InitializeRegisterDefaults() {
@@ -400,6 +403,10 @@ void Maxwell3D::CallMethod(const GPU::MethodCall& method_call) {
         ProcessQueryGet();
         break;
     }
+    case MAXWELL3D_REG_INDEX(counter_reset): {
+        ProcessCounterReset();
+        break;
+    }
     case MAXWELL3D_REG_INDEX(condition.mode): {
         ProcessQueryCondition();
         break;
@@ -495,6 +502,8 @@ void Maxwell3D::FlushMMEInlineDraw() {
                "Illegal combination of instancing parameters");
 
     const bool is_indexed = mme_draw.current_mode == MMEDrawMode::Indexed;
+    FlushCBData();
+    upload_state.Flush();
     if (ShouldExecute()) {
         rasterizer.DrawMultiBatch(is_indexed);
     }
@@ -543,6 +552,21 @@ void Maxwell3D::ProcessQueryGet() {
     // Since the sequence address is given as a GPU VAddr, we have to convert it to an application
     // VAddr before writing.
 
+    const auto& query_get = regs.query.query_get;
+    if (query_get.select == Regs::QuerySelect::SamplesPassed &&
+        (query_get.mode == Regs::QueryMode::Write || query_get.mode == Regs::QueryMode::Write2)) {
+        // Samples passed counters are resolved on the host, they are written to guest memory when
+        // it's read
+        std::optional<u64> timestamp;
+        if (!query_get.short_query) {
+            timestamp = system.CoreTiming().GetTicks();
+        }
+        if (rasterizer.AccelerateQuery(sequence_address, VideoCore::QueryType::SamplesPassed,
+                                       timestamp)) {
+            return;
+        }
+    }
+
     // TODO(Subv): Support the other query units.
     ASSERT_MSG(regs.query.query_get.unit == Regs::QueryUnit::Crop,
                "Units other than CROP are unimplemented");
@@ -596,8 +620,29 @@ void Maxwell3D::ProcessQueryGet() {
     }
 }
 
+void Maxwell3D::ProcessCounterReset() {
+    switch (regs.counter_reset) {
+    case Regs::CounterReset::SampleCnt:
+        rasterizer.ResetCounter(VideoCore::QueryType::SamplesPassed);
+        break;
+    default:
+        LOG_DEBUG(HW_GPU, "Unimplemented counter reset={}",
+                  static_cast<u32>(regs.counter_reset));
+        break;
+    }
+}
+
 void Maxwell3D::ProcessQueryCondition() {
     const GPUVAddr condition_address{regs.condition.Address()};
+    if (regs.condition.mode == Regs::ConditionMode::ResNonZero &&
+        rasterizer.AccelerateConditionalRendering(condition_address)) {
+        // The host skips the draws itself when the result is zero, no need to wait for it here
+        execute_on = true;
+        return;
+    }
+    rasterizer.AccelerateConditionalRendering(0);
+
+    // Reading the condition flushes the cached query results it depends on
     switch (regs.condition.mode) {
     case Regs::ConditionMode::Always: {
         execute_on = true;
@@ -609,20 +654,20 @@ void Maxwell3D::ProcessQueryCondition() {
     }
     case Regs::ConditionMode::ResNonZero: {
         Regs::QueryCompare cmp;
-        memory_manager.ReadBlockUnsafe(condition_address, &cmp, sizeof(cmp));
+        memory_manager.ReadBlock(condition_address, &cmp, sizeof(cmp));
         execute_on = cmp.initial_sequence != 0U && cmp.initial_mode != 0U;
         break;
     }
     case Regs::ConditionMode::Equal: {
         Regs::QueryCompare cmp;
-        memory_manager.ReadBlockUnsafe(condition_address, &cmp, sizeof(cmp));
+        memory_manager.ReadBlock(condition_address, &cmp, sizeof(cmp));
         execute_on =
             cmp.initial_sequence == cmp.current_sequence && cmp.initial_mode == cmp.current_mode;
         break;
     }
     case Regs::ConditionMode::NotEqual: {
         Regs::QueryCompare cmp;
-        memory_manager.ReadBlockUnsafe(condition_address, &cmp, sizeof(cmp));
+        memory_manager.ReadBlock(condition_address, &cmp, sizeof(cmp));
         execute_on =
             cmp.initial_sequence != cmp.current_sequence || cmp.initial_mode != cmp.current_mode;
         break;
@@ -668,6 +713,8 @@ void Maxwell3D::DrawArrays() {
     }
 
     const bool is_indexed{regs.index_array.count && !regs.vertex_buffer.count};
+    FlushCBData();
+    upload_state.Flush();
     if (ShouldExecute()) {
         rasterizer.DrawBatch(is_indexed);
     }
@@ -728,14 +775,48 @@ void Maxwell3D::FinishCBData() {
     const GPUVAddr address{buffer_address + cb_data_state.start_pos};
     const std::size_t size = regs.const_buffer.cb_pos - cb_data_state.start_pos;
 
+    // Guest memory is updated right away so the CPU and other engines always read the new values,
+    // but invalidating the host caches is deferred until the next draw. Games issue many small
+    // updates to the same buffer between draws and they end up as a single invalidation.
     const u32 id = cb_data_state.id;
-    memory_manager.WriteBlock(address, cb_data_state.buffer[id].data(), size);
-    dirty.OnMemoryWrite();
+    memory_manager.WriteBlockUnsafe(address, cb_data_state.buffer[id].data(), size);
+    // Cached copies GPU modified in this range must not be flushed over the new values meanwhile
+    memory_manager.MarkRegionOverwritten(address, size);
+    StageCBDataRange(address, size);
 
     cb_data_state.id = null_cb_data;
     cb_data_state.current = null_cb_data;
 }
 
+void Maxwell3D::StageCBDataRange(GPUVAddr address, std::size_t size) {
+    GPUVAddr begin = address;
+    GPUVAddr end = address + size;
+    const auto it = std::remove_if(pending_cb_ranges.begin(), pending_cb_ranges.end(),
+                                   [&begin, &end](const CBDataRange& range) {
+                                       const GPUVAddr range_end = range.address + range.size;
+                                       if (range_end < begin || range.address > end) {
+                                           return false;
+                                       }
+                                       begin = std::min(begin, range.address);
+                                       end = std::max(end, range_end);
+                                       return true;
+                                   });
+    pending_cb_ranges.erase(it, pending_cb_ranges.end());
+    pending_cb_ranges.push_back({begin, static_cast<std::size_t>(end - begin)});
+
+    if (pending_cb_ranges.size() >= MaxPendingCBRanges) {
+        FlushPendingCBRanges();
+    }
+}
+
+void Maxwell3D::FlushPendingCBRanges() {
+    for (const auto& range : pending_cb_ranges) {
+        memory_manager.InvalidateRegion(range.address, range.size);
+    }
+    pending_cb_ranges.clear();
+    dirty.OnMemoryWrite();
+}
+
 Texture::TICEntry Maxwell3D::GetTICEntry(u32 tic_index) const {
     const GPUVAddr tic_address_gpu{regs.tic.TICAddress() + tic_index * sizeof(Texture::TICEntry)};
 
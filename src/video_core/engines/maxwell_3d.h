@@ -112,6 +112,11 @@ public:
             GreaterThan = 1,
         };
 
+        enum class CounterReset : u32 {
+            SampleCnt = 0x01,
+            // TODO: Research the values of the other counters
+        };
+
         enum class ConditionMode : u32 {
             Never = 0,
             Always = 1,
@@ -828,11 +833,15 @@ public:
                     BitField<7, 1, u32> c7;
                 } clip_distance_enabled;
 
-                INSERT_PADDING_WORDS(0x1);
+                u32 samplecnt_enable;
 
                 float point_size;
 
-                INSERT_PADDING_WORDS(0x7);
+                INSERT_PADDING_WORDS(0x5);
+
+                CounterReset counter_reset;
+
+                INSERT_PADDING_WORDS(0x1);
 
                 u32 zeta_enable;
 
@@ -1247,6 +1256,19 @@ public:
 
     void FlushMMEInlineDraw();
 
+    /// Invalidates host caches over the constant buffer ranges written by CB_DATA since the last
+    /// flush. Called before anything other than this engine may observe those ranges.
+    void FlushCBData() {
+        if (!pending_cb_ranges.empty()) {
+            FlushPendingCBRanges();
+        }
+    }
+
+    /// Updates the host caches over the ranges written by inline uploads since the last flush.
+    void FlushUploads() {
+        upload_state.Flush();
+    }
+
     /// Given a Texture Handle, returns the TSC and TIC entries.
     Texture::FullTextureInfo GetTextureInfo(const Texture::TextureHandle tex_handle,
                                             std::size_t offset) const;
@@ -1321,6 +1343,16 @@ private:
         u32 counter{};
     } cb_data_state;
 
+    /// Maximum number of disjoint CB_DATA ranges held before they are flushed
+    static constexpr std::size_t MaxPendingCBRanges = 64;
+
+    /// Guest range written by CB_DATA whose host cache invalidation has been deferred
+    struct CBDataRange {
+        GPUVAddr address;
+        std::size_t size;
+    };
+    std::vector<CBDataRange> pending_cb_ranges;
+
     Upload::State upload_state;
 
     bool execute_on{true};
@@ -1356,6 +1388,9 @@ private:
     /// Handles a write to the QUERY_GET register.
     void ProcessQueryGet();
 
+    /// Handles a write to the COUNTER_RESET register.
+    void ProcessCounterReset();
+
     // Handles Conditional Rendering
     void ProcessQueryCondition();
 
@@ -1367,6 +1402,12 @@ private:
     void ProcessCBData(u32 value);
     void FinishCBData();
 
+    /// Queues a written CB_DATA range for invalidation, merging it with touching ranges.
+    void StageCBDataRange(GPUVAddr address, std::size_t size);
+
+    /// Invalidates the host caches over the pending CB_DATA ranges and clears them.
+    void FlushPendingCBRanges();
+
     /// Handles a write to the CB_BIND register.
     void ProcessCBBind(Regs::ShaderStage stage);
 
@@ -1434,7 +1475,9 @@ ASSERT_REG_POSITION(screen_y_control, 0x4EB);
 ASSERT_REG_POSITION(vb_element_base, 0x50D);
 ASSERT_REG_POSITION(vb_base_instance, 0x50E);
 ASSERT_REG_POSITION(clip_distance_enabled, 0x544);
+ASSERT_REG_POSITION(samplecnt_enable, 0x545);
 ASSERT_REG_POSITION(point_size, 0x546);
+ASSERT_REG_POSITION(counter_reset, 0x54C);
 ASSERT_REG_POSITION(zeta_enable, 0x54E);
 ASSERT_REG_POSITION(multisample_control, 0x54F);
 ASSERT_REG_POSITION(condition, 0x554);
@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <utility>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "core/core.h"
@@ -9,13 +10,14 @@
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/engines/maxwell_dma.h"
 #include "video_core/memory_manager.h"
-#include "video_core/renderer_base.h"
+#include "video_core/rasterizer_interface.h"
 #include "video_core/textures/decoders.h"
 
 namespace Tegra::Engines {
 
-MaxwellDMA::MaxwellDMA(Core::System& system, MemoryManager& memory_manager)
-    : system{system}, memory_manager{memory_manager} {}
+MaxwellDMA::MaxwellDMA(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
+                       MemoryManager& memory_manager)
+    : system{system}, rasterizer{rasterizer}, memory_manager{memory_manager} {}
 
 void MaxwellDMA::CallMethod(const GPU::MethodCall& method_call) {
     ASSERT_MSG(method_call.method < Regs::NUM_REGS,
@@ -36,6 +38,17 @@ void MaxwellDMA::CallMethod(const GPU::MethodCall& method_call) {
 #undef MAXWELLDMA_REG_INDEX
 }
 
+void MaxwellDMA::TickFrame() {
+    last_frame_stats = std::exchange(frame_stats, {});
+    LOG_TRACE(HW_GPU,
+              "DMA copies: {} linear ({} bytes), {} accelerated ({} bytes), {} direct ({} bytes), "
+              "{} buffered ({} bytes)",
+              last_frame_stats.linear_copies, last_frame_stats.linear_bytes,
+              last_frame_stats.accelerated_copies, last_frame_stats.accelerated_bytes,
+              last_frame_stats.direct_copies, last_frame_stats.direct_bytes,
+              last_frame_stats.buffered_copies, last_frame_stats.buffered_bytes);
+}
+
 void MaxwellDMA::HandleCopy() {
     LOG_TRACE(HW_GPU, "Requested a DMA copy");
 
@@ -65,6 +78,8 @@ void MaxwellDMA::HandleCopy() {
         // y_count).
         if (!regs.exec.enable_2d) {
             memory_manager.CopyBlock(dest, source, regs.x_count);
+            ++frame_stats.linear_copies;
+            frame_stats.linear_bytes += regs.x_count;
             return;
         }
 
@@ -77,81 +92,152 @@ void MaxwellDMA::HandleCopy() {
             const GPUVAddr dest_line = dest + line * regs.dst_pitch;
             memory_manager.CopyBlock(dest_line, source_line, regs.x_count);
         }
+        ++frame_stats.linear_copies;
+        frame_stats.linear_bytes += u64{regs.x_count} * regs.y_count;
         return;
     }
 
     ASSERT(regs.exec.enable_2d == 1);
 
-    if (regs.exec.is_dst_linear && !regs.exec.is_src_linear) {
-        ASSERT(regs.src_params.BlockDepth() == 0);
-        // If the input is tiled and the output is linear, deswizzle the input and copy it over.
-        const u32 bytes_per_pixel = regs.dst_pitch / regs.x_count;
-        const std::size_t src_size = Texture::CalculateSize(
-            true, bytes_per_pixel, regs.src_params.size_x, regs.src_params.size_y,
-            regs.src_params.size_z, regs.src_params.BlockHeight(), regs.src_params.BlockDepth());
+    const u32 linear_pitch = regs.exec.is_dst_linear ? regs.dst_pitch : regs.src_pitch;
+    const u64 copy_size = u64{linear_pitch / regs.x_count} * regs.x_count * regs.y_count;
 
-        const std::size_t src_layer_size = Texture::CalculateSize(
-            true, bytes_per_pixel, regs.src_params.size_x, regs.src_params.size_y, 1,
-            regs.src_params.BlockHeight(), regs.src_params.BlockDepth());
+    // Copies between surfaces the rasterizer has cached are done on the host GPU, the guest
+    // memory is written back when it's read.
+    if (rasterizer.AccelerateDMACopy(regs)) {
+        ++frame_stats.accelerated_copies;
+        frame_stats.accelerated_bytes += copy_size;
+        return;
+    }
 
-        const std::size_t dst_size = regs.dst_pitch * regs.y_count;
+    if (regs.exec.is_dst_linear && !regs.exec.is_src_linear) {
+        CopyBlockLinearToPitch();
+    } else {
+        CopyPitchToBlockLinear();
+    }
+}
 
-        if (read_buffer.size() < src_size) {
-            read_buffer.resize(src_size);
-        }
+void MaxwellDMA::CopyBlockLinearToPitch() {
+    ASSERT(regs.src_params.BlockDepth() == 0);
 
-        if (write_buffer.size() < dst_size) {
-            write_buffer.resize(dst_size);
-        }
+    // If the input is tiled and the output is linear, deswizzle the input and copy it over.
+    const u32 bytes_per_pixel = regs.dst_pitch / regs.x_count;
+    const std::size_t src_layer_size = Texture::CalculateSize(
+        true, bytes_per_pixel, regs.src_params.size_x, regs.src_params.size_y, 1,
+        regs.src_params.BlockHeight(), regs.src_params.BlockDepth());
+    const std::size_t dst_size = regs.dst_pitch * regs.y_count;
+    const u64 copy_size = u64{bytes_per_pixel} * regs.x_count * regs.y_count;
 
-        memory_manager.ReadBlock(source, read_buffer.data(), src_size);
-        memory_manager.ReadBlock(dest, write_buffer.data(), dst_size);
+    // Only the layer the subrect is taken from is read
+    const GPUVAddr source = regs.src_address.Address() + src_layer_size * regs.src_params.pos_z;
+    const GPUVAddr dest = regs.dst_address.Address();
 
-        Texture::UnswizzleSubrect(
-            regs.x_count, regs.y_count, regs.dst_pitch, regs.src_params.size_x, bytes_per_pixel,
-            read_buffer.data() + src_layer_size * regs.src_params.pos_z, write_buffer.data(),
-            regs.src_params.BlockHeight(), regs.src_params.pos_x, regs.src_params.pos_y);
+    u8* const src_ptr = GetContinuousPointer(source, src_layer_size);
+    u8* const dst_ptr = GetContinuousPointer(dest, dst_size);
+    if (src_ptr && dst_ptr) {
+        // Deswizzle straight between the guest buffers. The destination is flushed as well, the
+        // bytes between its lines are left untouched by the copy.
+        rasterizer.FlushRegion(ToCacheAddr(src_ptr), src_layer_size);
+        rasterizer.FlushRegion(ToCacheAddr(dst_ptr), dst_size);
+
+        Texture::UnswizzleSubrect(regs.x_count, regs.y_count, regs.dst_pitch,
+                                  regs.src_params.size_x, bytes_per_pixel, src_ptr, dst_ptr,
+                                  regs.src_params.BlockHeight(), regs.src_params.pos_x,
+                                  regs.src_params.pos_y);
+
+        rasterizer.InvalidateRegion(ToCacheAddr(dst_ptr), dst_size);
+        ++frame_stats.direct_copies;
+        frame_stats.direct_bytes += copy_size;
+        return;
+    }
 
-        memory_manager.WriteBlock(dest, write_buffer.data(), dst_size);
-    } else {
-        ASSERT(regs.dst_params.BlockDepth() == 0);
+    if (read_buffer.size() < src_layer_size) {
+        read_buffer.resize(src_layer_size);
+    }
 
-        const u32 bytes_per_pixel = regs.src_pitch / regs.x_count;
+    if (write_buffer.size() < dst_size) {
+        write_buffer.resize(dst_size);
+    }
 
-        const std::size_t dst_size = Texture::CalculateSize(
-            true, bytes_per_pixel, regs.dst_params.size_x, regs.dst_params.size_y,
-            regs.dst_params.size_z, regs.dst_params.BlockHeight(), regs.dst_params.BlockDepth());
+    memory_manager.ReadBlock(source, read_buffer.data(), src_layer_size);
+    memory_manager.ReadBlock(dest, write_buffer.data(), dst_size);
 
-        const std::size_t dst_layer_size = Texture::CalculateSize(
-            true, bytes_per_pixel, regs.dst_params.size_x, regs.dst_params.size_y, 1,
-            regs.dst_params.BlockHeight(), regs.dst_params.BlockDepth());
+    Texture::UnswizzleSubrect(regs.x_count, regs.y_count, regs.dst_pitch, regs.src_params.size_x,
+                              bytes_per_pixel, read_buffer.data(), write_buffer.data(),
+                              regs.src_params.BlockHeight(), regs.src_params.pos_x,
+                              regs.src_params.pos_y);
 
-        const std::size_t src_size = regs.src_pitch * regs.y_count;
+    memory_manager.WriteBlock(dest, write_buffer.data(), dst_size);
+    ++frame_stats.buffered_copies;
+    frame_stats.buffered_bytes += copy_size;
+}
 
-        if (read_buffer.size() < src_size) {
-            read_buffer.resize(src_size);
-        }
+void MaxwellDMA::CopyPitchToBlockLinear() {
+    ASSERT(regs.dst_params.BlockDepth() == 0);
 
-        if (write_buffer.size() < dst_size) {
-            write_buffer.resize(dst_size);
-        }
+    const u32 bytes_per_pixel = regs.src_pitch / regs.x_count;
+    const std::size_t dst_layer_size = Texture::CalculateSize(
+        true, bytes_per_pixel, regs.dst_params.size_x, regs.dst_params.size_y, 1,
+        regs.dst_params.BlockHeight(), regs.dst_params.BlockDepth());
+    const std::size_t src_size = regs.src_pitch * regs.y_count;
+    const u64 copy_size = u64{bytes_per_pixel} * regs.x_count * regs.y_count;
 
+    // Only the layer the subrect is written to is touched
+    const GPUVAddr source = regs.src_address.Address();
+    const GPUVAddr dest = regs.dst_address.Address() + dst_layer_size * regs.dst_params.pos_z;
+
+    u8* const src_ptr = GetContinuousPointer(source, src_size);
+    u8* const dst_ptr = GetContinuousPointer(dest, dst_layer_size);
+    if (src_ptr && dst_ptr) {
+        // Swizzle straight between the guest buffers
         if (Settings::values.use_accurate_gpu_emulation) {
-            memory_manager.ReadBlock(source, read_buffer.data(), src_size);
-            memory_manager.ReadBlock(dest, write_buffer.data(), dst_size);
-        } else {
-            memory_manager.ReadBlockUnsafe(source, read_buffer.data(), src_size);
-            memory_manager.ReadBlockUnsafe(dest, write_buffer.data(), dst_size);
+            rasterizer.FlushRegion(ToCacheAddr(src_ptr), src_size);
+            rasterizer.FlushRegion(ToCacheAddr(dst_ptr), dst_layer_size);
         }
 
-        // If the input is linear and the output is tiled, swizzle the input and copy it over.
-        Texture::SwizzleSubrect(
-            regs.x_count, regs.y_count, regs.src_pitch, regs.dst_params.size_x, bytes_per_pixel,
-            write_buffer.data() + dst_layer_size * regs.dst_params.pos_z, read_buffer.data(),
-            regs.dst_params.BlockHeight(), regs.dst_params.pos_x, regs.dst_params.pos_y);
+        Texture::SwizzleSubrect(regs.x_count, regs.y_count, regs.src_pitch,
+                                regs.dst_params.size_x, bytes_per_pixel, dst_ptr, src_ptr,
+                                regs.dst_params.BlockHeight(), regs.dst_params.pos_x,
+                                regs.dst_params.pos_y);
+
+        rasterizer.InvalidateRegion(ToCacheAddr(dst_ptr), dst_layer_size);
+        ++frame_stats.direct_copies;
+        frame_stats.direct_bytes += copy_size;
+        return;
+    }
+
+    if (read_buffer.size() < src_size) {
+        read_buffer.resize(src_size);
+    }
+
+    if (write_buffer.size() < dst_layer_size) {
+        write_buffer.resize(dst_layer_size);
+    }
+
+    if (Settings::values.use_accurate_gpu_emulation) {
+        memory_manager.ReadBlock(source, read_buffer.data(), src_size);
+        memory_manager.ReadBlock(dest, write_buffer.data(), dst_layer_size);
+    } else {
+        memory_manager.ReadBlockUnsafe(source, read_buffer.data(), src_size);
+        memory_manager.ReadBlockUnsafe(dest, write_buffer.data(), dst_layer_size);
+    }
+
+    // If the input is linear and the output is tiled, swizzle the input and copy it over.
+    Texture::SwizzleSubrect(regs.x_count, regs.y_count, regs.src_pitch, regs.dst_params.size_x,
+                            bytes_per_pixel, write_buffer.data(), read_buffer.data(),
+                            regs.dst_params.BlockHeight(), regs.dst_params.pos_x,
+                            regs.dst_params.pos_y);
+
+    memory_manager.WriteBlock(dest, write_buffer.data(), dst_layer_size);
+    ++frame_stats.buffered_copies;
+    frame_stats.buffered_bytes += copy_size;
+}
 
-        memory_manager.WriteBlock(dest, write_buffer.data(), dst_size);
+u8* MaxwellDMA::GetContinuousPointer(GPUVAddr gpu_addr, std::size_t size) {
+    if (size == 0 || !memory_manager.IsBlockContinuous(gpu_addr, size)) {
+        return nullptr;
     }
+    return memory_manager.GetPointer(gpu_addr);
 }
 
 } // namespace Tegra::Engines
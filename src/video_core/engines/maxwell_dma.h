@@ -20,6 +20,10 @@ namespace Tegra {
 class MemoryManager;
 }
 
+namespace VideoCore {
+class RasterizerInterface;
+}
+
 namespace Tegra::Engines {
 
 /**
@@ -29,12 +33,33 @@ namespace Tegra::Engines {
 
 class MaxwellDMA final {
 public:
-    explicit MaxwellDMA(Core::System& system, MemoryManager& memory_manager);
+    explicit MaxwellDMA(Core::System& system, VideoCore::RasterizerInterface& rasterizer,
+                        MemoryManager& memory_manager);
     ~MaxwellDMA() = default;
 
     /// Write the value to the register identified by method.
     void CallMethod(const GPU::MethodCall& method_call);
 
+    /// Copy statistics of a frame, by the path the copies took
+    struct CopyStats {
+        u64 linear_copies{};      ///< Copies between pitch linear buffers
+        u64 linear_bytes{};       ///< Bytes copied between pitch linear buffers
+        u64 accelerated_copies{}; ///< Copies between cached surfaces done by the host GPU
+        u64 accelerated_bytes{};  ///< Bytes copied by the host GPU
+        u64 direct_copies{};      ///< Swizzles done in place in guest memory
+        u64 direct_bytes{};       ///< Bytes swizzled in place in guest memory
+        u64 buffered_copies{};    ///< Swizzles through staging buffers, the memory isn't contiguous
+        u64 buffered_bytes{};     ///< Bytes swizzled through staging buffers
+    };
+
+    /// Closes the copy statistics of the current frame, called once per frame by the rasterizer
+    void TickFrame();
+
+    /// Returns the copy statistics of the last completed frame
+    const CopyStats& GetLastFrameStats() const {
+        return last_frame_stats;
+    }
+
     struct Regs {
         static constexpr std::size_t NUM_REGS = 0x1D6;
 
@@ -175,14 +200,28 @@ public:
 private:
     Core::System& system;
 
+    VideoCore::RasterizerInterface& rasterizer;
+
     MemoryManager& memory_manager;
 
     std::vector<u8> read_buffer;
     std::vector<u8> write_buffer;
 
+    CopyStats frame_stats{};
+    CopyStats last_frame_stats{};
+
     /// Performs the copy from the source buffer to the destination buffer as configured in the
     /// registers.
     void HandleCopy();
+
+    /// Copies a block linear subrect to a pitch linear buffer.
+    void CopyBlockLinearToPitch();
+
+    /// Copies a pitch linear subrect to a block linear surface.
+    void CopyPitchToBlockLinear();
+
+    /// Returns a host pointer to a range of guest memory, or null when it's not contiguous.
+    u8* GetContinuousPointer(GPUVAddr gpu_addr, std::size_t size);
 };
 
 #define ASSERT_REG_POSITION(field_name, position)                                                  \
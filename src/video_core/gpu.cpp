@@ -13,6 +13,7 @@
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/engines/maxwell_dma.h"
 #include "video_core/gpu.h"
+#include "video_core/gpu_recorder.h"
 #include "video_core/memory_manager.h"
 #include "video_core/renderer_base.h"
 
@@ -28,8 +29,8 @@ GPU::GPU(Core::System& system, VideoCore::RendererBase& renderer, bool is_async)
     maxwell_3d = std::make_unique<Engines::Maxwell3D>(system, rasterizer, *memory_manager);
     fermi_2d = std::make_unique<Engines::Fermi2D>(rasterizer);
     kepler_compute = std::make_unique<Engines::KeplerCompute>(system, rasterizer, *memory_manager);
-    maxwell_dma = std::make_unique<Engines::MaxwellDMA>(system, *memory_manager);
-    kepler_memory = std::make_unique<Engines::KeplerMemory>(system, *memory_manager);
+    maxwell_dma = std::make_unique<Engines::MaxwellDMA>(system, rasterizer, *memory_manager);
+    kepler_memory = std::make_unique<Engines::KeplerMemory>(system, rasterizer, *memory_manager);
 }
 
 GPU::~GPU() = default;
@@ -42,6 +43,14 @@ const Engines::Maxwell3D& GPU::Maxwell3D() const {
     return *maxwell_3d;
 }
 
+Engines::MaxwellDMA& GPU::MaxwellDMA() {
+    return *maxwell_dma;
+}
+
+const Engines::MaxwellDMA& GPU::MaxwellDMA() const {
+    return *maxwell_dma;
+}
+
 Engines::KeplerCompute& GPU::KeplerCompute() {
     return *kepler_compute;
 }
@@ -66,6 +75,46 @@ const DmaPusher& GPU::DmaPusher() const {
     return *dma_pusher;
 }
 
+bool GPU::StartRecording(const std::string& path) {
+    if (is_async) {
+        LOG_WARNING(HW_GPU, "Recording with asynchronous GPU emulation may capture memory that "
+                            "the GPU thread is still writing");
+    }
+    auto new_recorder = std::make_unique<GPURecorder>(*memory_manager, renderer.Rasterizer());
+    if (!new_recorder->Open(path)) {
+        return false;
+    }
+    recorder = std::move(new_recorder);
+    LOG_INFO(HW_GPU, "Recording GPU command stream to file={}", path);
+    return true;
+}
+
+void GPU::StopRecording() {
+    if (recorder) {
+        LOG_INFO(HW_GPU, "Stopped GPU recording after {} frames", recorder->GetNumFrames());
+        recorder->Close();
+    }
+    recorder.reset();
+}
+
+void GPU::RecordCommandList(const Tegra::CommandList& entries) {
+    if (recorder) {
+        recorder->RecordCommandList(entries);
+    }
+}
+
+void GPU::RecordSwapBuffers(const Tegra::FramebufferConfig* framebuffer) {
+    if (recorder) {
+        recorder->RecordSwapBuffers(framebuffer);
+    }
+}
+
+void GPU::RecordGuestWrite(CacheAddr addr, u64 size) {
+    if (recorder) {
+        recorder->MarkRegionDirty(addr, size);
+    }
+}
+
 void GPU::WaitFence(u32 syncpoint_id, u32 value) const {
     // Synced GPU, is always in sync
     if (!is_async) {
@@ -122,6 +171,10 @@ bool GPU::CancelSyncptInterrupt(const u32 syncpoint_id, const u32 value) {
 }
 
 void GPU::FlushCommands() {
+    maxwell_3d->FlushCBData();
+    maxwell_3d->FlushUploads();
+    kepler_compute->FlushUploads();
+    kepler_memory->FlushUploads();
     renderer.Rasterizer().FlushCommands();
 }
 
@@ -296,6 +349,18 @@ void GPU::CallPullerMethod(const MethodCall& method_call) {
 void GPU::CallEngineMethod(const MethodCall& method_call) {
     const EngineID engine = bound_engines[method_call.subchannel];
 
+    // Other engines may read the memory written inline by an engine through the caches
+    if (engine != EngineID::MAXWELL_B) {
+        maxwell_3d->FlushCBData();
+        maxwell_3d->FlushUploads();
+    }
+    if (engine != EngineID::KEPLER_COMPUTE_B) {
+        kepler_compute->FlushUploads();
+    }
+    if (engine != EngineID::KEPLER_INLINE_TO_MEMORY_B) {
+        kepler_memory->FlushUploads();
+    }
+
     switch (engine) {
     case EngineID::FERMI_TWOD_A:
         fermi_2d->CallMethod(method_call);
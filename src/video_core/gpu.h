@@ -9,6 +9,7 @@
 #include <list>
 #include <memory>
 #include <mutex>
+#include <string>
 #include "common/common_types.h"
 #include "core/hle/service/nvdrv/nvdata.h"
 #include "core/hle/service/nvflinger/buffer_queue.h"
@@ -128,6 +129,7 @@ enum class EngineID {
     MAXWELL_DMA_COPY_A = 0xB0B5,
 };
 
+class GPURecorder;
 class MemoryManager;
 
 class GPU {
@@ -162,6 +164,12 @@ public:
     /// Returns a const reference to the Maxwell3D GPU engine.
     const Engines::Maxwell3D& Maxwell3D() const;
 
+    /// Returns a reference to the MaxwellDMA GPU engine.
+    Engines::MaxwellDMA& MaxwellDMA();
+
+    /// Returns a const reference to the MaxwellDMA GPU engine.
+    const Engines::MaxwellDMA& MaxwellDMA() const;
+
     /// Returns a reference to the KeplerCompute GPU engine.
     Engines::KeplerCompute& KeplerCompute();
 
@@ -202,6 +210,17 @@ public:
     /// Returns a const reference to the GPU DMA pusher.
     const Tegra::DmaPusher& DmaPusher() const;
 
+    /// Starts recording the command stream and the memory it references to the given file.
+    bool StartRecording(const std::string& path);
+
+    /// Stops an ongoing recording.
+    void StopRecording();
+
+    /// Returns the active command stream recorder, or nullptr when not recording.
+    Tegra::GPURecorder* Recorder() {
+        return recorder.get();
+    }
+
     struct Regs {
         static constexpr size_t NUM_REGS = 0x100;
 
@@ -270,6 +289,15 @@ public:
 protected:
     virtual void TriggerCpuInterrupt(u32 syncpoint_id, u32 value) const = 0;
 
+    /// Records a submitted command list when a recording is active
+    void RecordCommandList(const Tegra::CommandList& entries);
+
+    /// Records a presented frame when a recording is active
+    void RecordSwapBuffers(const Tegra::FramebufferConfig* framebuffer);
+
+    /// Notifies an active recording that the guest wrote to a region of recorded memory
+    void RecordGuestWrite(CacheAddr addr, u64 size);
+
 private:
     void ProcessBindMethod(const MethodCall& method_call);
     void ProcessSemaphoreTriggerMethod();
@@ -292,6 +320,7 @@ protected:
 
 private:
     std::unique_ptr<Tegra::MemoryManager> memory_manager;
+    std::unique_ptr<Tegra::GPURecorder> recorder;
 
     /// Mapping of command subchannels to their bound engine ids
     std::array<EngineID, 8> bound_engines = {};
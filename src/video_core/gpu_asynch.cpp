@@ -20,10 +20,12 @@ void GPUAsynch::Start() {
 }
 
 void GPUAsynch::PushGPUEntries(Tegra::CommandList&& entries) {
+    RecordCommandList(entries);
     gpu_thread.SubmitList(std::move(entries));
 }
 
 void GPUAsynch::SwapBuffers(const Tegra::FramebufferConfig* framebuffer) {
+    RecordSwapBuffers(framebuffer);
     gpu_thread.SwapBuffers(framebuffer);
 }
 
@@ -32,10 +34,12 @@ void GPUAsynch::FlushRegion(CacheAddr addr, u64 size) {
 }
 
 void GPUAsynch::InvalidateRegion(CacheAddr addr, u64 size) {
+    RecordGuestWrite(addr, size);
     gpu_thread.InvalidateRegion(addr, size);
 }
 
 void GPUAsynch::FlushAndInvalidateRegion(CacheAddr addr, u64 size) {
+    RecordGuestWrite(addr, size);
     gpu_thread.FlushAndInvalidateRegion(addr, size);
 }
 
@@ -0,0 +1,303 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "common/assert.h"
+#include "common/cityhash.h"
+#include "common/logging/log.h"
+#include "video_core/gpu.h"
+#include "video_core/gpu_recorder.h"
+#include "video_core/memory_manager.h"
+#include "video_core/rasterizer_interface.h"
+
+namespace Tegra {
+
+namespace {
+
+constexpr u64 RECORD_MAGIC = 0x434552555047595A; // "ZYGPUREC"
+constexpr u32 RECORD_VERSION = 1;
+
+/// Granularity used to track memory changes between submissions, the size of a CPU page
+constexpr u64 RECORD_PAGE_BITS = 12;
+constexpr u64 RECORD_PAGE_SIZE = 1ULL << RECORD_PAGE_BITS;
+
+struct RecordHeader {
+    u64 magic;
+    u32 version;
+    u32 reserved;
+};
+static_assert(sizeof(RecordHeader) == 16, "RecordHeader is incorrect size");
+
+struct RecordChunkHeader {
+    RecordChunkKind kind;
+    u32 reserved;
+    u64 size;
+};
+static_assert(sizeof(RecordChunkHeader) == 16, "RecordChunkHeader is incorrect size");
+
+static_assert(std::is_trivially_copyable_v<CommandListHeader>,
+              "CommandListHeader is not trivially copyable");
+static_assert(std::is_trivially_copyable_v<FramebufferConfig>,
+              "FramebufferConfig is not trivially copyable");
+
+/// Chunks larger than this are considered malformed
+constexpr u64 MAX_CHUNK_SIZE = 1ULL << 32;
+
+} // Anonymous namespace
+
+GPURecorder::GPURecorder(MemoryManager& memory_manager, VideoCore::RasterizerInterface& rasterizer)
+    : memory_manager{memory_manager}, rasterizer{rasterizer} {
+    const std::vector<u8> zero_page(RECORD_PAGE_SIZE);
+    zero_page_hash =
+        Common::CityHash64(reinterpret_cast<const char*>(zero_page.data()), zero_page.size());
+}
+
+GPURecorder::~GPURecorder() = default;
+
+bool GPURecorder::Open(const std::string& path) {
+    std::lock_guard lock{mutex};
+
+    if (!file.Open(path, "wb")) {
+        LOG_ERROR(HW_GPU, "Failed to create GPU recording file={}", path);
+        return false;
+    }
+    const RecordHeader header{RECORD_MAGIC, RECORD_VERSION, 0};
+    if (file.WriteObject(header) != 1) {
+        LOG_ERROR(HW_GPU, "Failed to write GPU recording header");
+        file.Close();
+        return false;
+    }
+
+    for (const auto& range : memory_manager.GetMappedRanges()) {
+        const RecordMapEntry entry{range.gpu_addr, range.cpu_addr, range.size};
+        TrackRange(entry);
+        WriteChunk(RecordChunkKind::Map, &entry, sizeof(entry));
+    }
+    return true;
+}
+
+void GPURecorder::Close() {
+    std::lock_guard lock{mutex};
+
+    for (const auto& range : mapped_ranges) {
+        rasterizer.UpdatePagesCachedCount(range.cpu_addr, range.size, -1);
+    }
+    mapped_ranges.clear();
+    pages.clear();
+    pages_by_host_addr.clear();
+    dirty_pages.clear();
+    file.Close();
+}
+
+void GPURecorder::MarkRegionDirty(CacheAddr addr, u64 size) {
+    std::lock_guard lock{mutex};
+
+    // Pages starting up to a page before the region can overlap it
+    const CacheAddr first_page = addr >= RECORD_PAGE_SIZE ? addr - RECORD_PAGE_SIZE + 1 : 0;
+    const CacheAddr end = addr + size;
+    for (auto it = pages_by_host_addr.lower_bound(first_page);
+         it != pages_by_host_addr.end() && it->first < end; ++it) {
+        dirty_pages.insert(it->second);
+    }
+}
+
+void GPURecorder::RecordMap(GPUVAddr gpu_addr, VAddr cpu_addr, u64 size) {
+    std::lock_guard lock{mutex};
+
+    const RecordMapEntry entry{gpu_addr, cpu_addr, size};
+    TrackRange(entry);
+    WriteChunk(RecordChunkKind::Map, &entry, sizeof(entry));
+}
+
+void GPURecorder::RecordUnmap(GPUVAddr gpu_addr, u64 size) {
+    std::lock_guard lock{mutex};
+
+    const GPUVAddr unmap_end = gpu_addr + size;
+    std::vector<RecordMapEntry> remaining;
+    for (const auto& range : mapped_ranges) {
+        const GPUVAddr range_end = range.gpu_addr + range.size;
+        if (range_end <= gpu_addr || range.gpu_addr >= unmap_end) {
+            remaining.push_back(range);
+            continue;
+        }
+        const GPUVAddr unmapped_begin = std::max(range.gpu_addr, gpu_addr);
+        const GPUVAddr unmapped_end = std::min(range_end, unmap_end);
+        rasterizer.UpdatePagesCachedCount(range.cpu_addr + (unmapped_begin - range.gpu_addr),
+                                          unmapped_end - unmapped_begin, -1);
+
+        // Keep the parts of the range outside of the unmapped region
+        if (range.gpu_addr < gpu_addr) {
+            remaining.push_back({range.gpu_addr, range.cpu_addr, gpu_addr - range.gpu_addr});
+        }
+        if (range_end > unmap_end) {
+            const u64 offset = unmap_end - range.gpu_addr;
+            remaining.push_back({unmap_end, range.cpu_addr + offset, range_end - unmap_end});
+        }
+    }
+    mapped_ranges = std::move(remaining);
+    UntrackPages(gpu_addr, size);
+
+    const RecordUnmapEntry entry{gpu_addr, size};
+    WriteChunk(RecordChunkKind::Unmap, &entry, sizeof(entry));
+}
+
+void GPURecorder::RecordCommandList(const CommandList& entries) {
+    std::lock_guard lock{mutex};
+
+    RecordChangedMemory();
+    WriteChunk(RecordChunkKind::CommandList, entries.data(),
+               entries.size() * sizeof(CommandListHeader));
+}
+
+void GPURecorder::RecordSwapBuffers(const FramebufferConfig* framebuffer) {
+    std::lock_guard lock{mutex};
+
+    // Presented memory may have been written after the last submission
+    RecordChangedMemory();
+    if (framebuffer) {
+        WriteChunk(RecordChunkKind::SwapBuffers, framebuffer, sizeof(FramebufferConfig));
+    } else {
+        WriteChunk(RecordChunkKind::SwapBuffers, nullptr, 0);
+    }
+    file.Flush();
+    ++num_frames;
+}
+
+void GPURecorder::TrackRange(const RecordMapEntry& range) {
+    // A range mapped over another one replaces its pages
+    UntrackPages(range.gpu_addr, range.size);
+
+    for (u64 offset = 0; offset < range.size; offset += RECORD_PAGE_SIZE) {
+        // Guest pages aren't contiguous in host memory, each one is resolved on its own
+        const GPUVAddr page_addr = range.gpu_addr + offset;
+        const CacheAddr host_addr = ToCacheAddr(memory_manager.GetPointer(page_addr));
+        if (!host_addr) {
+            continue;
+        }
+        // Replayed memory starts cleared, so untouched zero pages don't have to be recorded
+        pages.emplace(page_addr, RecordedPage{host_addr, zero_page_hash});
+        pages_by_host_addr.emplace(host_addr, page_addr);
+        dirty_pages.insert(page_addr);
+    }
+    mapped_ranges.push_back(range);
+    rasterizer.UpdatePagesCachedCount(range.cpu_addr, range.size, 1);
+}
+
+void GPURecorder::UntrackPages(GPUVAddr gpu_addr, u64 size) {
+    for (GPUVAddr page_addr = gpu_addr; page_addr < gpu_addr + size;
+         page_addr += RECORD_PAGE_SIZE) {
+        const auto it = pages.find(page_addr);
+        if (it == pages.end()) {
+            continue;
+        }
+        const auto [begin, end] = pages_by_host_addr.equal_range(it->second.host_addr);
+        const auto alias = std::find_if(
+            begin, end, [page_addr](const auto& entry) { return entry.second == page_addr; });
+        if (alias != end) {
+            pages_by_host_addr.erase(alias);
+        }
+        pages.erase(it);
+        dirty_pages.erase(page_addr);
+    }
+}
+
+void GPURecorder::RecordChangedMemory() {
+    // Changed pages are coalesced into runs when they are contiguous in both the GPU and host
+    // address spaces, to keep the number of chunks low
+    GPUVAddr run_gpu_addr = 0;
+    CacheAddr run_host_addr = 0;
+    std::size_t run_size = 0;
+    const auto write_run = [&] {
+        if (run_size != 0) {
+            WriteMemoryChunk(run_gpu_addr, reinterpret_cast<const u8*>(run_host_addr), run_size);
+            run_size = 0;
+        }
+    };
+
+    for (const GPUVAddr page_addr : dirty_pages) {
+        auto& page = pages.at(page_addr);
+        const u64 hash = Common::CityHash64(reinterpret_cast<const char*>(page.host_addr),
+                                            RECORD_PAGE_SIZE);
+        if (page.hash == hash) {
+            write_run();
+            continue;
+        }
+        page.hash = hash;
+        if (run_size != 0 && run_gpu_addr + run_size == page_addr &&
+            run_host_addr + run_size == page.host_addr) {
+            run_size += RECORD_PAGE_SIZE;
+            continue;
+        }
+        write_run();
+        run_gpu_addr = page_addr;
+        run_host_addr = page.host_addr;
+        run_size = RECORD_PAGE_SIZE;
+    }
+    write_run();
+    dirty_pages.clear();
+}
+
+void GPURecorder::WriteChunk(RecordChunkKind kind, const void* data, std::size_t size) {
+    if (!file.IsOpen()) {
+        return;
+    }
+    const RecordChunkHeader header{kind, 0, size};
+    file.WriteObject(header);
+    if (size != 0) {
+        file.WriteBytes(static_cast<const u8*>(data), size);
+    }
+}
+
+void GPURecorder::WriteMemoryChunk(GPUVAddr gpu_addr, const u8* data, std::size_t size) {
+    if (!file.IsOpen()) {
+        return;
+    }
+    const RecordChunkHeader header{RecordChunkKind::Memory, 0,
+                                   sizeof(RecordMemoryHeader) + size};
+    const RecordMemoryHeader memory_header{gpu_addr, size};
+    file.WriteObject(header);
+    file.WriteObject(memory_header);
+    file.WriteBytes(data, size);
+}
+
+bool GPURecordReader::Open(const std::string& path) {
+    if (!file.Open(path, "rb")) {
+        LOG_ERROR(HW_GPU, "Failed to open GPU recording file={}", path);
+        return false;
+    }
+    RecordHeader header{};
+    if (file.ReadArray(&header, 1) != 1 || header.magic != RECORD_MAGIC) {
+        LOG_ERROR(HW_GPU, "File={} is not a GPU recording", path);
+        return false;
+    }
+    if (header.version != RECORD_VERSION) {
+        LOG_ERROR(HW_GPU, "GPU recording version mismatch, expected={} found={}", RECORD_VERSION,
+                  header.version);
+        return false;
+    }
+    return true;
+}
+
+bool GPURecordReader::ReadChunk(Chunk& chunk) {
+    RecordChunkHeader header{};
+    if (file.ReadArray(&header, 1) != 1) {
+        return false;
+    }
+    if (header.size > MAX_CHUNK_SIZE) {
+        LOG_ERROR(HW_GPU, "Malformed GPU recording chunk of size={}", header.size);
+        return false;
+    }
+    chunk.kind = header.kind;
+    chunk.data.resize(static_cast<std::size_t>(header.size));
+    if (header.size != 0 && file.ReadBytes(chunk.data.data(), chunk.data.size()) != header.size) {
+        LOG_ERROR(HW_GPU, "Truncated GPU recording chunk");
+        return false;
+    }
+    return true;
+}
+
+} // namespace Tegra
@@ -0,0 +1,146 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "video_core/dma_pusher.h"
+#include "video_core/gpu.h"
+
+namespace VideoCore {
+class RasterizerInterface;
+}
+
+namespace Tegra {
+
+struct FramebufferConfig;
+class MemoryManager;
+
+/**
+ * A GPU recording is a sequence of chunks describing everything the GPU frontend consumed: the
+ * GPU address space mappings, the contents of mapped memory, the submitted command lists and the
+ * presented frames. Memory is recorded before each submission for the pages the guest wrote since
+ * the previous one, so a recording can be replayed without the guest application.
+ */
+enum class RecordChunkKind : u32 {
+    Map = 0,         ///< A CPU memory range was mapped in the GPU address space
+    Unmap = 1,       ///< A range of the GPU address space was unmapped
+    Memory = 2,      ///< Contents of GPU mapped memory that changed since it was last recorded
+    CommandList = 3, ///< A command list submitted to the GPU
+    SwapBuffers = 4, ///< A frame was presented
+};
+
+struct RecordMapEntry {
+    GPUVAddr gpu_addr;
+    VAddr cpu_addr;
+    u64 size;
+};
+static_assert(sizeof(RecordMapEntry) == 24, "RecordMapEntry is incorrect size");
+
+struct RecordUnmapEntry {
+    GPUVAddr gpu_addr;
+    u64 size;
+};
+static_assert(sizeof(RecordUnmapEntry) == 16, "RecordUnmapEntry is incorrect size");
+
+/// Header of a Memory chunk, followed by the memory contents
+struct RecordMemoryHeader {
+    GPUVAddr gpu_addr;
+    u64 size;
+};
+static_assert(sizeof(RecordMemoryHeader) == 16, "RecordMemoryHeader is incorrect size");
+
+/**
+ * Records the GPU command stream and the memory it references into a file.
+ * Recorded memory is marked as cached in the rasterizer, so guest writes to it go through
+ * GPU::InvalidateRegion and only the written pages are recorded again.
+ */
+class GPURecorder {
+public:
+    explicit GPURecorder(MemoryManager& memory_manager, VideoCore::RasterizerInterface& rasterizer);
+    ~GPURecorder();
+
+    /// Creates the recording file and records the current GPU address space mappings
+    bool Open(const std::string& path);
+
+    /// Stops tracking guest writes to the recorded memory, the rasterizer must still be alive
+    void Close();
+
+    /// Marks the recorded pages overlapping a host memory region as written by the guest
+    void MarkRegionDirty(CacheAddr addr, u64 size);
+
+    void RecordMap(GPUVAddr gpu_addr, VAddr cpu_addr, u64 size);
+
+    void RecordUnmap(GPUVAddr gpu_addr, u64 size);
+
+    /// Records the memory that changed since the last submission and the command list itself
+    void RecordCommandList(const CommandList& entries);
+
+    /// Records a presented frame, framebuffer can be null
+    void RecordSwapBuffers(const FramebufferConfig* framebuffer);
+
+    /// Returns the number of frames recorded so far
+    u64 GetNumFrames() const {
+        return num_frames;
+    }
+
+private:
+    struct RecordedPage {
+        CacheAddr host_addr; ///< Host address of the page, resolved when it was mapped
+        u64 hash;            ///< Hash of the contents last recorded
+    };
+
+    /// Starts tracking the pages of a mapped range, they are recorded on the next submission
+    void TrackRange(const RecordMapEntry& range);
+
+    /// Stops tracking the pages of a GPU address range
+    void UntrackPages(GPUVAddr gpu_addr, u64 size);
+
+    void RecordChangedMemory();
+
+    void WriteChunk(RecordChunkKind kind, const void* data, std::size_t size);
+
+    void WriteMemoryChunk(GPUVAddr gpu_addr, const u8* data, std::size_t size);
+
+    MemoryManager& memory_manager;
+    VideoCore::RasterizerInterface& rasterizer;
+
+    FileUtil::IOFile file;
+    std::mutex mutex;
+
+    std::vector<RecordMapEntry> mapped_ranges;
+    std::unordered_map<GPUVAddr, RecordedPage> pages;
+    std::multimap<CacheAddr, GPUVAddr> pages_by_host_addr;
+    std::set<GPUVAddr> dirty_pages;
+    u64 zero_page_hash{};
+    u64 num_frames{};
+};
+
+/// Reads back the chunks of a GPU recording
+class GPURecordReader {
+public:
+    struct Chunk {
+        RecordChunkKind kind{};
+        std::vector<u8> data;
+    };
+
+    /// Opens a recording and validates its header
+    bool Open(const std::string& path);
+
+    /// Reads the next chunk, returns false at the end of the recording or on a malformed chunk
+    bool ReadChunk(Chunk& chunk);
+
+private:
+    FileUtil::IOFile file;
+};
+
+} // namespace Tegra
@@ -2,6 +2,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include "core/core.h"
+#include "core/perf_stats.h"
 #include "video_core/gpu_synch.h"
 #include "video_core/renderer_base.h"
 
@@ -15,12 +17,19 @@ GPUSynch::~GPUSynch() = default;
 void GPUSynch::Start() {}
 
 void GPUSynch::PushGPUEntries(Tegra::CommandList&& entries) {
+    RecordCommandList(entries);
     dma_pusher->Push(std::move(entries));
     dma_pusher->DispatchCalls();
 }
 
 void GPUSynch::SwapBuffers(const Tegra::FramebufferConfig* framebuffer) {
+    RecordSwapBuffers(framebuffer);
+
+    // Frames are presented right away, the latency is the presentation itself
+    const auto present_begin = Core::PerfStats::Clock::now();
     renderer.SwapBuffers(framebuffer);
+    const auto present_time = Core::PerfStats::Clock::now() - present_begin;
+    system.GetPerfStats().AddPresentedFrame(present_time, present_time);
 }
 
 void GPUSynch::FlushRegion(CacheAddr addr, u64 size) {
@@ -28,10 +37,12 @@ void GPUSynch::FlushRegion(CacheAddr addr, u64 size) {
 }
 
 void GPUSynch::InvalidateRegion(CacheAddr addr, u64 size) {
+    RecordGuestWrite(addr, size);
     renderer.Rasterizer().InvalidateRegion(addr, size);
 }
 
 void GPUSynch::FlushAndInvalidateRegion(CacheAddr addr, u64 size) {
+    RecordGuestWrite(addr, size);
     renderer.Rasterizer().FlushAndInvalidateRegion(addr, size);
 }
 
@@ -2,10 +2,14 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+
 #include "common/assert.h"
 #include "common/microprofile.h"
 #include "core/core.h"
 #include "core/frontend/scope_acquire_window_context.h"
+#include "core/perf_stats.h"
+#include "core/settings.h"
 #include "video_core/dma_pusher.h"
 #include "video_core/gpu.h"
 #include "video_core/gpu_thread.h"
@@ -13,9 +17,38 @@
 
 namespace VideoCommon::GPUThread {
 
+/// Returns the number of frames that can wait to be presented
+static u64 GetPresentQueueDepth() {
+    return std::max(Settings::values.present_queue_depth, 1U);
+}
+
+/// Presents a queued frame, or drops it when the queue is in mailbox mode and newer frames fill it
+static void Present(Core::System& system, VideoCore::RendererBase& renderer, SynchState& state,
+                    const SwapBuffersCommand& command) {
+    auto& perf_stats = system.GetPerfStats();
+    const u64 newer_presents = state.queued_presents.load() - command.present_id;
+    if (Settings::values.use_present_mailbox && newer_presents >= GetPresentQueueDepth()) {
+        // The frame is not shown, but the caches still see the end of a frame
+        renderer.Rasterizer().TickFrame();
+        perf_stats.AddDroppedFrame();
+    } else {
+        const auto present_begin = Core::PerfStats::Clock::now();
+        renderer.SwapBuffers(command.framebuffer ? &*command.framebuffer : nullptr);
+        const auto present_end = Core::PerfStats::Clock::now();
+        perf_stats.AddPresentedFrame(present_end - command.queue_time,
+                                     present_end - present_begin);
+    }
+
+    {
+        std::lock_guard lock{state.present_mutex};
+        state.finished_presents.store(command.present_id);
+    }
+    state.present_cv.notify_all();
+}
+
 /// Runs the GPU thread
-static void RunThread(VideoCore::RendererBase& renderer, Tegra::DmaPusher& dma_pusher,
-                      SynchState& state) {
+static void RunThread(Core::System& system, VideoCore::RendererBase& renderer,
+                      Tegra::DmaPusher& dma_pusher, SynchState& state) {
     MicroProfileOnThreadCreate("GpuThread");
 
     // Wait for first GPU command before acquiring the window context
@@ -37,7 +70,7 @@ static void RunThread(VideoCore::RendererBase& renderer, Tegra::DmaPusher& dma_p
                 dma_pusher.Push(std::move(submit_list->entries));
                 dma_pusher.DispatchCalls();
             } else if (const auto data = std::get_if<SwapBuffersCommand>(&next.data)) {
-                renderer.SwapBuffers(data->framebuffer ? &*data->framebuffer : nullptr);
+                Present(system, renderer, state, *data);
             } else if (const auto data = std::get_if<FlushRegionCommand>(&next.data)) {
                 renderer.Rasterizer().FlushRegion(data->addr, data->size);
             } else if (const auto data = std::get_if<InvalidateRegionCommand>(&next.data)) {
@@ -65,7 +98,8 @@ ThreadManager::~ThreadManager() {
 }
 
 void ThreadManager::StartThread(VideoCore::RendererBase& renderer, Tegra::DmaPusher& dma_pusher) {
-    thread = std::thread{RunThread, std::ref(renderer), std::ref(dma_pusher), std::ref(state)};
+    thread = std::thread{RunThread, std::ref(system), std::ref(renderer), std::ref(dma_pusher),
+                         std::ref(state)};
 }
 
 void ThreadManager::SubmitList(Tegra::CommandList&& entries) {
@@ -73,8 +107,19 @@ void ThreadManager::SubmitList(Tegra::CommandList&& entries) {
 }
 
 void ThreadManager::SwapBuffers(const Tegra::FramebufferConfig* framebuffer) {
-    PushCommand(SwapBuffersCommand(framebuffer ? *framebuffer
-                                               : std::optional<const Tegra::FramebufferConfig>{}));
+    if (!Settings::values.use_present_mailbox) {
+        // Wait for a free slot in the present queue. This happens outside of the emulated frame
+        // time, so a slow host presentation doesn't count as emulation time.
+        const u64 depth = GetPresentQueueDepth();
+        std::unique_lock lock{state.present_mutex};
+        state.present_cv.wait(lock, [this, depth] {
+            return state.queued_presents.load() - state.finished_presents.load() < depth;
+        });
+    }
+    const u64 present_id = ++state.queued_presents;
+    PushCommand(SwapBuffersCommand(
+        framebuffer ? *framebuffer : std::optional<const Tegra::FramebufferConfig>{}, present_id,
+        Core::PerfStats::Clock::now()));
 }
 
 void ThreadManager::FlushRegion(CacheAddr addr, u64 size) {
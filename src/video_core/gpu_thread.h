@@ -12,6 +12,7 @@
 #include <variant>
 
 #include "common/threadsafe_queue.h"
+#include "core/perf_stats.h"
 #include "video_core/gpu.h"
 
 namespace Tegra {
@@ -37,10 +38,13 @@ struct SubmitListCommand final {
 
 /// Command to signal to the GPU thread that a swap buffers is pending
 struct SwapBuffersCommand final {
-    explicit SwapBuffersCommand(std::optional<const Tegra::FramebufferConfig> framebuffer)
-        : framebuffer{std::move(framebuffer)} {}
+    explicit SwapBuffersCommand(std::optional<const Tegra::FramebufferConfig> framebuffer,
+                                u64 present_id, Core::PerfStats::Clock::time_point queue_time)
+        : framebuffer{std::move(framebuffer)}, present_id{present_id}, queue_time{queue_time} {}
 
     std::optional<Tegra::FramebufferConfig> framebuffer;
+    u64 present_id;                                ///< Position in the present queue
+    Core::PerfStats::Clock::time_point queue_time; ///< Walltime when the frame was queued
 };
 
 /// Command to signal to the GPU thread to flush a region
@@ -90,6 +94,12 @@ struct SynchState final {
     CommandQueue queue;
     u64 last_fence{};
     std::atomic<u64> signaled_fence{};
+
+    /// Number of frames queued for presentation, and presented or dropped by the GPU thread
+    std::atomic<u64> queued_presents{};
+    std::atomic<u64> finished_presents{};
+    std::mutex present_mutex;
+    std::condition_variable present_cv;
 };
 
 /// Class used to manage the GPU thread
@@ -104,7 +114,11 @@ public:
     /// Push GPU command entries to be processed
     void SubmitList(Tegra::CommandList&& entries);
 
-    /// Swap buffers (render frame)
+    /**
+     * Queues a frame for presentation (render frame). At most present_queue_depth frames wait to
+     * be presented: when the queue is full, the caller waits for the host to present a frame, or
+     * with use_present_mailbox the oldest queued frame is dropped instead.
+     */
     void SwapBuffers(const Tegra::FramebufferConfig* framebuffer);
 
     /// Notify rasterizer that any caches of the specified region should be flushed to Switch memory
@@ -9,6 +9,8 @@
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/vm_manager.h"
 #include "core/memory.h"
+#include "video_core/gpu.h"
+#include "video_core/gpu_recorder.h"
 #include "video_core/memory_manager.h"
 #include "video_core/rasterizer_interface.h"
 
@@ -58,6 +60,9 @@ GPUVAddr MemoryManager::MapBufferEx(VAddr cpu_addr, u64 size) {
                .SetMemoryAttribute(cpu_addr, size, Kernel::MemoryAttribute::DeviceMapped,
                                    Kernel::MemoryAttribute::DeviceMapped)
                .IsSuccess());
+    if (auto* const recorder = system.GPU().Recorder()) {
+        recorder->RecordMap(gpu_addr, cpu_addr, aligned_size);
+    }
 
     return gpu_addr;
 }
@@ -73,6 +78,9 @@ GPUVAddr MemoryManager::MapBufferEx(VAddr cpu_addr, GPUVAddr gpu_addr, u64 size)
                .SetMemoryAttribute(cpu_addr, size, Kernel::MemoryAttribute::DeviceMapped,
                                    Kernel::MemoryAttribute::DeviceMapped)
                .IsSuccess());
+    if (auto* const recorder = system.GPU().Recorder()) {
+        recorder->RecordMap(gpu_addr, cpu_addr, aligned_size);
+    }
     return gpu_addr;
 }
 
@@ -86,6 +94,9 @@ GPUVAddr MemoryManager::UnmapBuffer(GPUVAddr gpu_addr, u64 size) {
 
     rasterizer.FlushAndInvalidateRegion(cache_addr, aligned_size);
     UnmapRange(gpu_addr, aligned_size);
+    if (auto* const recorder = system.GPU().Recorder()) {
+        recorder->RecordUnmap(gpu_addr, aligned_size);
+    }
     ASSERT(system.CurrentProcess()
                ->VMManager()
                .SetMemoryAttribute(cpu_addr.value(), size, Kernel::MemoryAttribute::DeviceMapped,
@@ -131,6 +142,20 @@ std::optional<VAddr> MemoryManager::GpuToCpuAddress(GPUVAddr addr) const {
     return {};
 }
 
+std::vector<MappedRange> MemoryManager::GetMappedRanges() const {
+    std::vector<MappedRange> ranges;
+    for (const auto& [base, vma] : vma_map) {
+        if (vma.type != VirtualMemoryArea::Type::Mapped) {
+            continue;
+        }
+        // Split VMAs don't update their backing address, the page table is always accurate
+        if (const auto cpu_addr = GpuToCpuAddress(vma.base)) {
+            ranges.push_back({vma.base, *cpu_addr, vma.size});
+        }
+    }
+    return ranges;
+}
+
 template <typename T>
 T MemoryManager::Read(GPUVAddr addr) const {
     if (!IsAddressValid(addr)) {
@@ -307,6 +332,37 @@ void MemoryManager::WriteBlock(GPUVAddr dest_addr, const void* src_buffer, const
     }
 }
 
+template <typename Func>
+void MemoryManager::ForEachHostRange(GPUVAddr addr, const std::size_t size, Func&& func) const {
+    std::size_t remaining_size{size};
+    std::size_t page_index{addr >> page_bits};
+    std::size_t page_offset{addr & page_mask};
+
+    while (remaining_size > 0) {
+        const std::size_t amount{
+            std::min(static_cast<std::size_t>(page_size) - page_offset, remaining_size)};
+        if (page_table.attributes[page_index] == Common::PageType::Memory) {
+            const u8* page_ptr{page_table.pointers[page_index] + page_offset};
+            func(ToCacheAddr(page_ptr), amount);
+        }
+        page_index++;
+        page_offset = 0;
+        remaining_size -= amount;
+    }
+}
+
+void MemoryManager::InvalidateRegion(GPUVAddr addr, const std::size_t size) {
+    ForEachHostRange(addr, size, [this](CacheAddr host_addr, std::size_t host_size) {
+        rasterizer.InvalidateRegion(host_addr, host_size);
+    });
+}
+
+void MemoryManager::MarkRegionOverwritten(GPUVAddr addr, const std::size_t size) {
+    ForEachHostRange(addr, size, [this](CacheAddr host_addr, std::size_t host_size) {
+        rasterizer.MarkRegionOverwritten(host_addr, host_size);
+    });
+}
+
 void MemoryManager::WriteBlockUnsafe(GPUVAddr dest_addr, const void* src_buffer,
                                      const std::size_t size) {
     std::size_t remaining_size{size};
@@ -6,6 +6,7 @@
 
 #include <map>
 #include <optional>
+#include <vector>
 
 #include "common/common_types.h"
 #include "common/page_table.h"
@@ -49,6 +50,13 @@ struct VirtualMemoryArea {
     bool CanBeMergedWith(const VirtualMemoryArea& next) const;
 };
 
+/// A range of the GPU address space backed by CPU memory
+struct MappedRange {
+    GPUVAddr gpu_addr{};
+    VAddr cpu_addr{};
+    u64 size{};
+};
+
 class MemoryManager final {
 public:
     explicit MemoryManager(Core::System& system, VideoCore::RasterizerInterface& rasterizer);
@@ -61,6 +69,9 @@ public:
     GPUVAddr UnmapBuffer(GPUVAddr addr, u64 size);
     std::optional<VAddr> GpuToCpuAddress(GPUVAddr addr) const;
 
+    /// Returns the ranges of the address space currently backed by CPU memory
+    std::vector<MappedRange> GetMappedRanges() const;
+
     template <typename T>
     T Read(GPUVAddr addr) const;
 
@@ -97,6 +108,18 @@ public:
     void WriteBlockUnsafe(GPUVAddr dest_addr, const void* src_buffer, std::size_t size);
     void CopyBlockUnsafe(GPUVAddr dest_addr, GPUVAddr src_addr, std::size_t size);
 
+    /**
+     * Invalidates the host caches over a range of virtual GPU memory. Used to finish a deferred
+     * WriteBlock that was done as a WriteBlockUnsafe.
+     */
+    void InvalidateRegion(GPUVAddr addr, std::size_t size);
+
+    /**
+     * Keeps the host caches from flushing over a range of virtual GPU memory written with
+     * WriteBlockUnsafe, until the range is invalidated.
+     */
+    void MarkRegionOverwritten(GPUVAddr addr, std::size_t size);
+
 private:
     using VMAMap = std::map<GPUVAddr, VirtualMemoryArea>;
     using VMAHandle = VMAMap::const_iterator;
@@ -108,6 +131,10 @@ private:
     void MapMemoryRegion(GPUVAddr base, u64 size, u8* target, VAddr backing_addr);
     void UnmapRegion(GPUVAddr base, u64 size);
 
+    /// Calls func(cache_addr, size) for each part of a range backed by host memory
+    template <typename Func>
+    void ForEachHostRange(GPUVAddr addr, std::size_t size, Func&& func) const;
+
     /// Finds the VMA in which the given address is included in, or `vma_map.end()`.
     VMAHandle FindVMA(GPUVAddr target) const;
 
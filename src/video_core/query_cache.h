@@ -0,0 +1,163 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "common/common_types.h"
+#include "common/paged_range_index.h"
+#include "video_core/gpu.h"
+#include "video_core/rasterizer_interface.h"
+
+namespace VideoCommon {
+
+/**
+ * Keeps a host counter running while the guest has a counter enabled. Host counters are created
+ * with the cache, the counter before them and the query type, and stop counting with EndQuery.
+ */
+template <class QueryCache, class HostCounter>
+class CounterStreamBase {
+public:
+    explicit CounterStreamBase(QueryCache& cache, VideoCore::QueryType type)
+        : cache{cache}, type{type} {}
+
+    /// Starts or stops counting samples to match the guest state.
+    void Update(bool enabled) {
+        if (enabled == IsRunning()) {
+            return;
+        }
+        if (enabled) {
+            Enable();
+        } else {
+            Disable();
+        }
+    }
+
+    /// Stops counting without losing the samples counted so far. The next Update call resumes the
+    /// stream, so draws issued in between are not counted.
+    void Pause() {
+        if (IsRunning()) {
+            Disable();
+        }
+    }
+
+    /// Discards the samples counted so far.
+    void Reset() {
+        const bool enabled = IsRunning();
+        if (enabled) {
+            current->EndQuery();
+            current.reset();
+        }
+        last.reset();
+        if (enabled) {
+            Enable();
+        }
+    }
+
+    /// Returns a counter holding the samples counted so far, or null when nothing was counted.
+    std::shared_ptr<HostCounter> Current() {
+        if (IsRunning()) {
+            // Split the running counter, so the samples counted so far can be resolved
+            Disable();
+            Enable();
+        }
+        return last;
+    }
+
+    bool IsRunning() const {
+        return current != nullptr;
+    }
+
+private:
+    void Enable() {
+        current = std::make_shared<HostCounter>(cache, last, type);
+    }
+
+    void Disable() {
+        current->EndQuery();
+        last = std::move(current);
+    }
+
+    QueryCache& cache;
+    const VideoCore::QueryType type;
+
+    std::shared_ptr<HostCounter> current; ///< Counter of the running host query
+    std::shared_ptr<HostCounter> last;    ///< Last counter that stopped counting
+};
+
+/**
+ * Guest queries cached by the host address their result is written at. Queries are indexed in
+ * every page they span, so a region finds the queries straddling its first page too. Queries have
+ * to provide GetCacheAddr and GetSizeInBytes.
+ */
+template <class CachedQuery>
+class CachedQueryIndex {
+public:
+    /// Returns the query written at a host address, or null when there's none.
+    CachedQuery* TryGet(CacheAddr addr) {
+        const auto it = queries.find(addr);
+        return it != queries.end() ? &it->second : nullptr;
+    }
+
+    /// Registers a query, there can't be another query at the same address.
+    void Insert(CachedQuery query) {
+        const CacheAddr addr = query.GetCacheAddr();
+        ranges.Insert(addr, addr + query.GetSizeInBytes(), addr);
+        queries.emplace(addr, std::move(query));
+    }
+
+    /**
+     * Removes the queries overlapping [addr, addr + size). Each one is passed to func before its
+     * removal, together with whether the region covers all of it.
+     */
+    template <typename Func>
+    void RemoveRegion(CacheAddr addr, std::size_t size, Func&& func) {
+        const CacheAddr addr_end = addr + size;
+        auto overlaps = ranges.Collect(query_buffer, addr, addr_end);
+        for (const CacheAddr query_addr : *overlaps) {
+            const auto it = queries.find(query_addr);
+            const CacheAddr query_end = query_addr + it->second.GetSizeInBytes();
+            func(it->second, addr <= query_addr && query_end <= addr_end);
+            ranges.Erase(query_addr, query_end, query_addr);
+            queries.erase(it);
+        }
+    }
+
+    /// Removes the queries func returns true for.
+    template <typename Func>
+    void RemoveIf(Func&& func) {
+        for (auto it = queries.begin(); it != queries.end();) {
+            if (!func(it->second)) {
+                ++it;
+                continue;
+            }
+            const CacheAddr addr = it->first;
+            ranges.Erase(addr, addr + it->second.GetSizeInBytes(), addr);
+            it = queries.erase(it);
+        }
+    }
+
+    std::size_t Size() const {
+        return queries.size();
+    }
+
+    /// Returns the number of pages holding at least one query
+    std::size_t NumPages() const {
+        return ranges.NumPages();
+    }
+
+private:
+    /// Bits of the page size the cached queries are bucketed by.
+    static constexpr std::size_t page_bits{12};
+
+    std::unordered_map<CacheAddr, CachedQuery> queries;
+    Common::PagedRangeIndex<CacheAddr, page_bits> ranges;
+    Common::QueryBuffer<CacheAddr> query_buffer;
+};
+
+} // namespace VideoCommon
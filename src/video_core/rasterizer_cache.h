@@ -4,14 +4,13 @@
 
 #pragma once
 
+#include <algorithm>
 #include <mutex>
-#include <set>
 #include <unordered_map>
-
-#include <boost/icl/interval_map.hpp>
-#include <boost/range/iterator_range_core.hpp>
+#include <vector>
 
 #include "common/common_types.h"
+#include "common/paged_range_index.h"
 #include "core/settings.h"
 #include "video_core/gpu.h"
 #include "video_core/rasterizer_interface.h"
@@ -83,17 +82,18 @@ public:
     void FlushRegion(CacheAddr addr, std::size_t size) {
         std::lock_guard lock{mutex};
 
-        const auto& objects{GetSortedObjectsFromRegion(addr, size)};
+        auto objects{GetSortedObjectsFromRegion(addr, size)};
         for (auto& object : objects) {
             FlushObject(object);
         }
+        RecycleObjectList(std::move(objects));
     }
 
     /// Mark the specified region as being invalidated
     void InvalidateRegion(CacheAddr addr, u64 size) {
         std::lock_guard lock{mutex};
 
-        const auto& objects{GetSortedObjectsFromRegion(addr, size)};
+        auto objects{GetSortedObjectsFromRegion(addr, size)};
         for (auto& object : objects) {
             if (!object->IsRegistered()) {
                 // Skip duplicates
@@ -101,15 +101,23 @@ public:
             }
             Unregister(object);
         }
+        RecycleObjectList(std::move(objects));
     }
 
     /// Invalidates everything in the cache
     void InvalidateAll() {
         std::lock_guard lock{mutex};
 
-        while (interval_cache.begin() != interval_cache.end()) {
-            Unregister(*interval_cache.begin()->second.begin());
+        auto objects{TakeObjectList()};
+        for (const auto& object : object_index.All()) {
+            objects.push_back(object);
+        }
+        for (auto& object : objects) {
+            if (object->IsRegistered()) {
+                Unregister(object);
+            }
         }
+        RecycleObjectList(std::move(objects));
     }
 
 protected:
@@ -133,7 +141,8 @@ protected:
         std::lock_guard lock{mutex};
 
         object->SetIsRegistered(true);
-        interval_cache.add({GetInterval(object), ObjectSet{object}});
+        object_index.Insert(object->GetCacheAddr(),
+                            object->GetCacheAddr() + object->GetSizeInBytes(), object);
         map_cache.insert({object->GetCacheAddr(), object});
         rasterizer.UpdatePagesCachedCount(object->GetCpuAddr(), object->GetSizeInBytes(), 1);
     }
@@ -145,7 +154,7 @@ protected:
         object->SetIsRegistered(false);
         rasterizer.UpdatePagesCachedCount(object->GetCpuAddr(), object->GetSizeInBytes(), -1);
         const CacheAddr addr = object->GetCacheAddr();
-        interval_cache.subtract({GetInterval(object), ObjectSet{object}});
+        object_index.Erase(addr, addr + object->GetSizeInBytes(), object);
         map_cache.erase(addr);
     }
 
@@ -172,21 +181,16 @@ protected:
     std::recursive_mutex mutex;
 
 private:
-    /// Returns a list of cached objects from the specified memory region, ordered by access time
+    /// Returns a list of cached objects from the specified memory region, ordered by access time.
+    /// The list should be given back with RecycleObjectList to avoid allocations on the next query.
     std::vector<T> GetSortedObjectsFromRegion(CacheAddr addr, u64 size) {
+        auto objects{TakeObjectList()};
         if (size == 0) {
-            return {};
+            return objects;
         }
 
-        std::vector<T> objects;
-        const ObjectInterval interval{addr, addr + size};
-        for (auto& pair : boost::make_iterator_range(interval_cache.equal_range(interval))) {
-            for (auto& cached_object : pair.second) {
-                if (!cached_object) {
-                    continue;
-                }
-                objects.push_back(cached_object);
-            }
+        for (const auto& cached_object : object_index.Query(addr, addr + size)) {
+            objects.push_back(cached_object);
         }
 
         std::sort(objects.begin(), objects.end(), [](const T& a, const T& b) -> bool {
@@ -196,18 +200,28 @@ private:
         return objects;
     }
 
-    using ObjectSet = std::set<T>;
-    using ObjectCache = std::unordered_map<CacheAddr, T>;
-    using IntervalCache = boost::icl::interval_map<CacheAddr, ObjectSet>;
-    using ObjectInterval = typename IntervalCache::interval_type;
+    /// Takes the reusable object list, nested queries get a new list
+    std::vector<T> TakeObjectList() {
+        std::vector<T> objects{std::move(object_list)};
+        objects.clear();
+        return objects;
+    }
 
-    static auto GetInterval(const T& object) {
-        return ObjectInterval::right_open(object->GetCacheAddr(),
-                                          object->GetCacheAddr() + object->GetSizeInBytes());
+    /// Gives back a list obtained from TakeObjectList, keeping its capacity
+    void RecycleObjectList(std::vector<T>&& objects) {
+        objects.clear();
+        object_list = std::move(objects);
     }
 
+    /// Objects are bucketed in 16KiB pages, shaders and buffers rarely span more than a few
+    static constexpr std::size_t object_page_bits = 14;
+
+    using ObjectCache = std::unordered_map<CacheAddr, T>;
+    using ObjectIndex = Common::PagedRangeIndex<T, object_page_bits>;
+
     ObjectCache map_cache;
-    IntervalCache interval_cache; ///< Cache of objects
+    ObjectIndex object_index;     ///< Cache of objects, indexed by the memory range they span
+    std::vector<T> object_list;   ///< Reusable list for region queries
     u64 modified_ticks{};         ///< Counter of cache state ticks, used for in-order flushing
     VideoCore::RasterizerInterface& rasterizer;
 };
@@ -6,8 +6,10 @@
 
 #include <atomic>
 #include <functional>
+#include <optional>
 #include "common/common_types.h"
 #include "video_core/engines/fermi_2d.h"
+#include "video_core/engines/maxwell_dma.h"
 #include "video_core/gpu.h"
 
 namespace Tegra {
@@ -24,6 +26,11 @@ enum class LoadCallbackStage {
 };
 using DiskResourceLoadCallback = std::function<void(LoadCallbackStage, std::size_t, std::size_t)>;
 
+enum class QueryType {
+    SamplesPassed,
+};
+constexpr std::size_t NumQueryTypes = 1;
+
 class RasterizerInterface {
 public:
     virtual ~RasterizerInterface() {}
@@ -53,6 +60,10 @@ public:
     /// and invalidated
     virtual void FlushAndInvalidateRegion(CacheAddr addr, u64 size) = 0;
 
+    /// Notify rasterizer that the guest memory of the specified region was overwritten and will be
+    /// invalidated later, caches must not flush their copies over the new data in between
+    virtual void MarkRegionOverwritten(CacheAddr addr, u64 size) = 0;
+
     /// Notify the rasterizer to send all written commands to the host GPU.
     virtual void FlushCommands() = 0;
 
@@ -66,12 +77,45 @@ public:
         return false;
     }
 
+    /// Attempt to perform a DMA copy between two cached surfaces on the host GPU. Returns false
+    /// when the caller has to copy the guest memory.
+    virtual bool AccelerateDMACopy(const Tegra::Engines::MaxwellDMA::Regs& regs) {
+        return false;
+    }
+
+    /// Attempt to update the cached copies of a range the guest memory was written to in place,
+    /// instead of invalidating them. Returns false when the caller has to invalidate the range.
+    /// Cached state over the range has to be dropped with MarkRegionOverwritten before the write.
+    virtual bool AccelerateInlineUpload(CacheAddr addr, std::size_t size) {
+        return false;
+    }
+
     /// Attempt to use a faster method to display the framebuffer to screen
     virtual bool AccelerateDisplay(const Tegra::FramebufferConfig& config, VAddr framebuffer_addr,
                                    u32 pixel_stride) {
         return false;
     }
 
+    /// Resets the host counter of a query type
+    virtual void ResetCounter(QueryType type) {}
+
+    /// Stops the host counters before draws that aren't issued by the guest, they are resumed by
+    /// the next guest draw
+    virtual void PauseCounters() {}
+
+    /// Attempt to resolve a query on the host, its result is written to guest memory when it's
+    /// read. A long query result with the timestamp is written when it has a value, otherwise only
+    /// the 32-bit counter. Returns false when the caller has to write the result.
+    virtual bool AccelerateQuery(GPUVAddr gpu_addr, QueryType type, std::optional<u64> timestamp) {
+        return false;
+    }
+
+    /// Attempt to skip the following draws on the host when the query result at gpu_addr is zero.
+    /// Zero disables the host predicate. Returns false when the caller has to evaluate it.
+    virtual bool AccelerateConditionalRendering(GPUVAddr gpu_addr) {
+        return false;
+    }
+
     /// Increase/decrease the number of object in pages touching the specified region
     virtual void UpdatePagesCachedCount(VAddr addr, u64 size, int delta) {}
 
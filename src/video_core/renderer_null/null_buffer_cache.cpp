@@ -0,0 +1,81 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <memory>
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_null/null_buffer_cache.h"
+
+namespace Null {
+
+NullStreamBuffer::NullStreamBuffer(std::size_t size) : buffer(size) {}
+
+NullStreamBuffer::~NullStreamBuffer() = default;
+
+std::tuple<u8*, u64, bool> NullStreamBuffer::Map(std::size_t size, u64 alignment) {
+    ASSERT(size <= buffer.size());
+    ASSERT(alignment <= buffer.size());
+    mapped_size = size;
+
+    if (alignment > 0) {
+        buffer_pos = Common::AlignUp<u64>(buffer_pos, alignment);
+    }
+
+    bool invalidate = false;
+    if (buffer_pos + size > buffer.size()) {
+        buffer_pos = 0;
+        invalidate = true;
+    }
+    return {buffer.data() + buffer_pos, buffer_pos, invalidate};
+}
+
+void NullStreamBuffer::Unmap(std::size_t size) {
+    ASSERT(size <= mapped_size);
+    buffer_pos += size;
+}
+
+CachedBufferBlock::CachedBufferBlock(CacheAddr cache_addr, std::size_t size)
+    : VideoCommon::BufferBlock{cache_addr, size}, data(size), handle{data.data()} {}
+
+CachedBufferBlock::~CachedBufferBlock() = default;
+
+NullBufferCache::NullBufferCache(VideoCore::RasterizerInterface& rasterizer, Core::System& system,
+                                 std::size_t stream_size)
+    : VideoCommon::BufferCache<Buffer, BufferHandle, NullStreamBuffer>{
+          rasterizer, system, std::make_unique<NullStreamBuffer>(stream_size)} {}
+
+NullBufferCache::~NullBufferCache() = default;
+
+const BufferHandle* NullBufferCache::GetEmptyBuffer(std::size_t) {
+    static const BufferHandle null_buffer = nullptr;
+    return &null_buffer;
+}
+
+Buffer NullBufferCache::CreateBlock(CacheAddr cache_addr, std::size_t size) {
+    return std::make_shared<CachedBufferBlock>(cache_addr, size);
+}
+
+const BufferHandle* NullBufferCache::ToHandle(const Buffer& buffer) {
+    return buffer->GetHandle();
+}
+
+void NullBufferCache::UploadBlockData(const Buffer& buffer, std::size_t offset, std::size_t size,
+                                      const u8* data) {
+    std::memcpy(buffer->GetData() + offset, data, size);
+}
+
+void NullBufferCache::DownloadBlockData(const Buffer& buffer, std::size_t offset, std::size_t size,
+                                        u8* data) {
+    std::memcpy(data, buffer->GetData() + offset, size);
+}
+
+void NullBufferCache::CopyBlock(const Buffer& src, const Buffer& dst, std::size_t src_offset,
+                                std::size_t dst_offset, std::size_t size) {
+    std::memmove(dst->GetData() + dst_offset, src->GetData() + src_offset, size);
+}
+
+} // namespace Null
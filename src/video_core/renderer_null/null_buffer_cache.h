@@ -0,0 +1,105 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/buffer_cache/buffer_cache.h"
+
+namespace Core {
+class System;
+}
+
+namespace VideoCore {
+class RasterizerInterface;
+}
+
+namespace Null {
+
+class CachedBufferBlock;
+
+using Buffer = std::shared_ptr<CachedBufferBlock>;
+
+/// Buffers are identified by the address of their host storage
+using BufferHandle = const u8*;
+
+/// Host memory backed stream buffer, uploads cost a copy like on a host API but nothing else
+class NullStreamBuffer final : NonCopyable {
+public:
+    explicit NullStreamBuffer(std::size_t size);
+    ~NullStreamBuffer();
+
+    BufferHandle GetHandle() const {
+        return buffer.data();
+    }
+
+    std::size_t GetSize() const {
+        return buffer.size();
+    }
+
+    /// Returns a chunk of at least size bytes, wrapping around and invalidating previous chunks
+    /// when the buffer is full
+    std::tuple<u8*, u64, bool> Map(std::size_t size, u64 alignment = 0);
+
+    void Unmap(std::size_t size);
+
+private:
+    std::vector<u8> buffer;
+    u64 buffer_pos = 0;
+    std::size_t mapped_size = 0;
+};
+
+class CachedBufferBlock final : public VideoCommon::BufferBlock {
+public:
+    explicit CachedBufferBlock(CacheAddr cache_addr, std::size_t size);
+    ~CachedBufferBlock();
+
+    const BufferHandle* GetHandle() const {
+        return &handle;
+    }
+
+    u8* GetData() {
+        return data.data();
+    }
+
+    const u8* GetData() const {
+        return data.data();
+    }
+
+private:
+    std::vector<u8> data;
+    BufferHandle handle{};
+};
+
+class NullBufferCache final
+    : public VideoCommon::BufferCache<Buffer, BufferHandle, NullStreamBuffer> {
+public:
+    explicit NullBufferCache(VideoCore::RasterizerInterface& rasterizer, Core::System& system,
+                             std::size_t stream_size);
+    ~NullBufferCache();
+
+    const BufferHandle* GetEmptyBuffer(std::size_t) override;
+
+protected:
+    Buffer CreateBlock(CacheAddr cache_addr, std::size_t size) override;
+
+    void WriteBarrier() override {}
+
+    const BufferHandle* ToHandle(const Buffer& buffer) override;
+
+    void UploadBlockData(const Buffer& buffer, std::size_t offset, std::size_t size,
+                         const u8* data) override;
+
+    void DownloadBlockData(const Buffer& buffer, std::size_t offset, std::size_t size,
+                           u8* data) override;
+
+    void CopyBlock(const Buffer& src, const Buffer& dst, std::size_t src_offset,
+                   std::size_t dst_offset, std::size_t size) override;
+};
+
+} // namespace Null
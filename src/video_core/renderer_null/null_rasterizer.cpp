@@ -0,0 +1,457 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <bitset>
+
+#include "common/alignment.h"
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "core/core.h"
+#include "core/memory.h"
+#include "core/settings.h"
+#include "video_core/engines/kepler_compute.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/engines/maxwell_dma.h"
+#include "video_core/memory_manager.h"
+#include "video_core/renderer_null/null_rasterizer.h"
+
+namespace Null {
+
+using Maxwell = Tegra::Engines::Maxwell3D::Regs;
+
+MICROPROFILE_DEFINE(Null_Drawing, "Null", "Drawing", MP_RGB(128, 128, 192));
+MICROPROFILE_DEFINE(Null_Compute, "Null", "Compute", MP_RGB(128, 128, 192));
+MICROPROFILE_DEFINE(Null_CacheManagement, "Null", "Cache Mgmt", MP_RGB(100, 255, 100));
+
+namespace {
+
+// Typical alignments of desktop drivers, so buffer uploads are laid out like on a host API
+constexpr std::size_t UNIFORM_BUFFER_ALIGNMENT = 256;
+constexpr std::size_t STORAGE_BUFFER_ALIGNMENT = 32;
+
+std::size_t GetConstBufferSize(const Tegra::Engines::ConstBufferInfo& buffer,
+                               const ConstBufferEntry& entry) {
+    if (!entry.IsIndirect()) {
+        return entry.GetSize();
+    }
+    if (buffer.size > Maxwell::MaxConstBufferSize) {
+        LOG_WARNING(Render_Null, "Indirect constbuffer size {} exceeds maximum {}", buffer.size,
+                    Maxwell::MaxConstBufferSize);
+        return Maxwell::MaxConstBufferSize;
+    }
+    return buffer.size;
+}
+
+} // Anonymous namespace
+
+RasterizerNull::RasterizerNull(Core::System& system)
+    : system{system}, texture_cache{system, *this}, shader_cache{*this, system},
+      buffer_cache{*this, system, STREAM_BUFFER_SIZE} {}
+
+RasterizerNull::~RasterizerNull() = default;
+
+bool RasterizerNull::DrawBatch(bool is_indexed) {
+    MICROPROFILE_SCOPE(Null_Drawing);
+    DrawPrelude(is_indexed);
+    return true;
+}
+
+bool RasterizerNull::DrawMultiBatch(bool is_indexed) {
+    MICROPROFILE_SCOPE(Null_Drawing);
+    DrawPrelude(is_indexed);
+    return true;
+}
+
+void RasterizerNull::Clear() {
+    const auto& maxwell3d = system.GPU().Maxwell3D();
+    if (!maxwell3d.ShouldExecute()) {
+        return;
+    }
+
+    const auto& regs = maxwell3d.regs;
+    const bool use_color = regs.clear_buffers.R || regs.clear_buffers.G ||
+                           regs.clear_buffers.B || regs.clear_buffers.A;
+    const bool use_depth_stencil = regs.clear_buffers.Z || regs.clear_buffers.S;
+
+    texture_cache.GuardRenderTargets(true);
+    if (use_color) {
+        texture_cache.GetColorBufferSurface(regs.clear_buffers.RT, false);
+    }
+    if (use_depth_stencil) {
+        texture_cache.GetDepthBufferSurface(false);
+    }
+    texture_cache.GuardRenderTargets(false);
+}
+
+void RasterizerNull::DispatchCompute(GPUVAddr code_addr) {
+    MICROPROFILE_SCOPE(Null_Compute);
+    const Shader kernel = shader_cache.GetComputeKernel(code_addr);
+    SetupComputeTextures(kernel);
+    SetupComputeImages(kernel);
+
+    const std::size_t buffer_size = Tegra::Engines::KeplerCompute::NumConstBuffers *
+                                    (Maxwell::MaxConstBufferSize + UNIFORM_BUFFER_ALIGNMENT);
+    buffer_cache.Map(buffer_size);
+    SetupComputeConstBuffers(kernel);
+    SetupComputeGlobalMemory(kernel);
+    buffer_cache.Unmap();
+}
+
+void RasterizerNull::FlushAll() {}
+
+void RasterizerNull::FlushRegion(CacheAddr addr, u64 size) {
+    MICROPROFILE_SCOPE(Null_CacheManagement);
+    if (!addr || !size) {
+        return;
+    }
+    texture_cache.FlushRegion(addr, size);
+    buffer_cache.FlushRegion(addr, size);
+}
+
+void RasterizerNull::InvalidateRegion(CacheAddr addr, u64 size) {
+    MICROPROFILE_SCOPE(Null_CacheManagement);
+    if (!addr || !size) {
+        return;
+    }
+    texture_cache.InvalidateRegion(addr, size);
+    shader_cache.InvalidateRegion(addr, size);
+    buffer_cache.InvalidateRegion(addr, size);
+}
+
+void RasterizerNull::FlushAndInvalidateRegion(CacheAddr addr, u64 size) {
+    if (Settings::values.use_accurate_gpu_emulation) {
+        FlushRegion(addr, size);
+    }
+    InvalidateRegion(addr, size);
+}
+
+void RasterizerNull::MarkRegionOverwritten(CacheAddr addr, u64 size) {
+    MICROPROFILE_SCOPE(Null_CacheManagement);
+    if (!addr || !size) {
+        return;
+    }
+    texture_cache.MarkRegionOverwritten(addr, size);
+    buffer_cache.MarkRegionOverwritten(addr, size);
+}
+
+void RasterizerNull::FlushCommands() {}
+
+void RasterizerNull::TickFrame() {
+    buffer_cache.TickFrame();
+    texture_cache.TickFrame();
+    system.GPU().MaxwellDMA().TickFrame();
+}
+
+bool RasterizerNull::AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Regs::Surface& src,
+                                           const Tegra::Engines::Fermi2D::Regs::Surface& dst,
+                                           const Tegra::Engines::Fermi2D::Config& copy_config) {
+    texture_cache.DoFermiCopy(src, dst, copy_config);
+    return true;
+}
+
+bool RasterizerNull::AccelerateDMACopy(const Tegra::Engines::MaxwellDMA::Regs& regs) {
+    return texture_cache.TryDMACopy(regs);
+}
+
+bool RasterizerNull::AccelerateInlineUpload(CacheAddr addr, std::size_t size) {
+    MICROPROFILE_SCOPE(Null_CacheManagement);
+    if (!addr || !size || !buffer_cache.UpdateRegion(addr, size)) {
+        return false;
+    }
+    texture_cache.InvalidateRegion(addr, size);
+    shader_cache.InvalidateRegion(addr, size);
+    return true;
+}
+
+bool RasterizerNull::AccelerateDisplay(const Tegra::FramebufferConfig& config,
+                                       VAddr framebuffer_addr, u32 pixel_stride) {
+    if (!framebuffer_addr) {
+        return false;
+    }
+    MICROPROFILE_SCOPE(Null_CacheManagement);
+    return texture_cache.TryFindFramebufferSurface(Memory::GetPointer(framebuffer_addr)) !=
+           nullptr;
+}
+
+void RasterizerNull::UpdatePagesCachedCount(VAddr addr, u64 size, int delta) {
+    std::lock_guard lock{pages_mutex};
+    const u64 page_start{addr >> Memory::PAGE_BITS};
+    const u64 page_end{(addr + size + Memory::PAGE_SIZE - 1) >> Memory::PAGE_BITS};
+
+    // Interval maps will erase segments if count reaches 0, so if delta is negative we have to
+    // subtract after iterating
+    const auto pages_interval = CachedPageMap::interval_type::right_open(page_start, page_end);
+    if (delta > 0) {
+        cached_pages.add({pages_interval, delta});
+    }
+
+    for (const auto& pair : boost::make_iterator_range(cached_pages.equal_range(pages_interval))) {
+        const auto interval = pair.first & pages_interval;
+        const int count = pair.second;
+
+        const VAddr interval_start_addr = boost::icl::first(interval) << Memory::PAGE_BITS;
+        const VAddr interval_end_addr = boost::icl::last_next(interval) << Memory::PAGE_BITS;
+        const u64 interval_size = interval_end_addr - interval_start_addr;
+
+        if (delta > 0 && count == delta) {
+            Memory::RasterizerMarkRegionCached(interval_start_addr, interval_size, true);
+        } else if (delta < 0 && count == -delta) {
+            Memory::RasterizerMarkRegionCached(interval_start_addr, interval_size, false);
+        } else {
+            ASSERT(count >= 0);
+        }
+    }
+
+    if (delta < 0) {
+        cached_pages.add({pages_interval, delta});
+    }
+}
+
+void RasterizerNull::DrawPrelude(bool is_indexed) {
+    auto& gpu = system.GPU().Maxwell3D();
+
+    std::size_t buffer_size = CalculateVertexArraysSize();
+    if (is_indexed) {
+        buffer_size = Common::AlignUp(buffer_size, 4) + CalculateIndexBufferSize();
+    }
+    // Add space for at least 18 constant buffers
+    buffer_size += Maxwell::MaxConstBuffers *
+                   (Maxwell::MaxConstBufferSize + UNIFORM_BUFFER_ALIGNMENT);
+
+    buffer_cache.Map(buffer_size);
+
+    if (gpu.dirty.vertex_attrib_format) {
+        // A host backend rebinds its vertex buffers when the vertex format changes
+        gpu.dirty.vertex_attrib_format = false;
+        gpu.dirty.ResetVertexArrays();
+    }
+    SetupVertexBuffers();
+    if (is_indexed) {
+        SetupIndexBuffer();
+    }
+
+    texture_cache.GuardSamplers(true);
+    SetupShaders();
+    texture_cache.GuardSamplers(false);
+
+    ConfigureFramebuffers();
+
+    if (buffer_cache.Unmap()) {
+        // As all cached buffers are invalidated, we need to recheck their state.
+        gpu.dirty.ResetVertexArrays();
+    }
+
+    // Fixed function state has no host counterpart to sync
+    gpu.dirty.blend_state = false;
+    gpu.dirty.color_mask = false;
+    gpu.dirty.polygon_offset = false;
+    gpu.dirty.stencil_test = false;
+    gpu.dirty.vertex_instances = false;
+    gpu.dirty.memory_general = false;
+}
+
+void RasterizerNull::SetupVertexBuffers() {
+    auto& gpu = system.GPU().Maxwell3D();
+    if (!gpu.dirty.vertex_array_buffers) {
+        return;
+    }
+    gpu.dirty.vertex_array_buffers = false;
+
+    const auto& regs = gpu.regs;
+    for (u32 index = 0; index < Maxwell::NumVertexArrays; ++index) {
+        if (!gpu.dirty.vertex_array[index]) {
+            continue;
+        }
+        gpu.dirty.vertex_array[index] = false;
+        gpu.dirty.vertex_instance[index] = false;
+
+        const auto& vertex_array = regs.vertex_array[index];
+        if (!vertex_array.IsEnabled()) {
+            continue;
+        }
+        const GPUVAddr start = vertex_array.StartAddress();
+        const GPUVAddr end = regs.vertex_array_limit[index].LimitAddress();
+        ASSERT(end > start);
+        buffer_cache.UploadMemory(start, end - start + 1);
+    }
+}
+
+void RasterizerNull::SetupIndexBuffer() {
+    const auto& regs = system.GPU().Maxwell3D().regs;
+    buffer_cache.UploadMemory(regs.index_array.IndexStart(), CalculateIndexBufferSize());
+}
+
+void RasterizerNull::SetupShaders() {
+    auto& gpu = system.GPU().Maxwell3D();
+    for (std::size_t index = 0; index < Maxwell::MaxShaderProgram; ++index) {
+        if (!gpu.regs.IsShaderConfigEnabled(index)) {
+            continue;
+        }
+        // Stage indices are 0 - 5. VertexA and VertexB are analyzed separately as there is no
+        // host program to combine them into.
+        const std::size_t stage{index == 0 ? 0 : index - 1};
+        const auto stage_enum = static_cast<Maxwell::ShaderStage>(stage);
+        const auto program = static_cast<Maxwell::ShaderProgram>(index);
+        const Shader shader{shader_cache.GetStageProgram(program)};
+
+        SetupDrawConstBuffers(stage_enum, shader);
+        SetupDrawGlobalMemory(stage_enum, shader);
+        SetupDrawTextures(stage_enum, shader);
+    }
+    gpu.dirty.shaders = false;
+}
+
+void RasterizerNull::ConfigureFramebuffers() {
+    auto& gpu = system.GPU().Maxwell3D();
+    if (!gpu.dirty.render_settings) {
+        return;
+    }
+    gpu.dirty.render_settings = false;
+
+    texture_cache.GuardRenderTargets(true);
+    if (texture_cache.GetDepthBufferSurface(true)) {
+        texture_cache.MarkDepthBufferInUse();
+    }
+    for (std::size_t index = 0; index < Maxwell::NumRenderTargets; ++index) {
+        if (texture_cache.GetColorBufferSurface(index, true)) {
+            texture_cache.MarkColorBufferInUse(index);
+        }
+    }
+    texture_cache.GuardRenderTargets(false);
+}
+
+void RasterizerNull::SetupDrawConstBuffers(Maxwell::ShaderStage stage, const Shader& shader) {
+    const auto& stages = system.GPU().Maxwell3D().state.shader_stages;
+    const auto& shader_stage = stages[static_cast<std::size_t>(stage)];
+    for (const auto& entry : shader->GetShaderEntries().const_buffers) {
+        SetupConstBuffer(shader_stage.const_buffers[entry.GetIndex()], entry);
+    }
+}
+
+void RasterizerNull::SetupComputeConstBuffers(const Shader& kernel) {
+    const auto& launch_desc = system.GPU().KeplerCompute().launch_description;
+    for (const auto& entry : kernel->GetShaderEntries().const_buffers) {
+        const auto& config = launch_desc.const_buffer_config[entry.GetIndex()];
+        const std::bitset<8> mask = launch_desc.const_buffer_enable_mask.Value();
+        Tegra::Engines::ConstBufferInfo buffer;
+        buffer.address = config.Address();
+        buffer.size = config.size;
+        buffer.enabled = mask[entry.GetIndex()];
+        SetupConstBuffer(buffer, entry);
+    }
+}
+
+void RasterizerNull::SetupConstBuffer(const Tegra::Engines::ConstBufferInfo& buffer,
+                                      const ConstBufferEntry& entry) {
+    if (!buffer.enabled) {
+        return;
+    }
+    // Align the size to a vec4 like the std140 layout of host uniform buffers
+    const std::size_t size = Common::AlignUp(GetConstBufferSize(buffer, entry), 4 * sizeof(u32));
+    buffer_cache.UploadMemory(buffer.address, size, UNIFORM_BUFFER_ALIGNMENT);
+}
+
+void RasterizerNull::SetupDrawGlobalMemory(Maxwell::ShaderStage stage, const Shader& shader) {
+    auto& gpu{system.GPU()};
+    auto& memory_manager{gpu.MemoryManager()};
+    const auto& cbufs{gpu.Maxwell3D().state.shader_stages[static_cast<std::size_t>(stage)]};
+    for (const auto& entry : shader->GetShaderEntries().global_memory_entries) {
+        const auto addr{cbufs.const_buffers[entry.GetCbufIndex()].address + entry.GetCbufOffset()};
+        const auto gpu_addr{memory_manager.Read<u64>(addr)};
+        const auto size{memory_manager.Read<u32>(addr + 8)};
+        buffer_cache.UploadMemory(gpu_addr, size, STORAGE_BUFFER_ALIGNMENT, entry.IsWritten());
+    }
+}
+
+void RasterizerNull::SetupComputeGlobalMemory(const Shader& kernel) {
+    auto& gpu{system.GPU()};
+    auto& memory_manager{gpu.MemoryManager()};
+    const auto& cbufs{gpu.KeplerCompute().launch_description.const_buffer_config};
+    for (const auto& entry : kernel->GetShaderEntries().global_memory_entries) {
+        const auto addr{cbufs[entry.GetCbufIndex()].Address() + entry.GetCbufOffset()};
+        const auto gpu_addr{memory_manager.Read<u64>(addr)};
+        const auto size{memory_manager.Read<u32>(addr + 8)};
+        buffer_cache.UploadMemory(gpu_addr, size, STORAGE_BUFFER_ALIGNMENT, entry.IsWritten());
+    }
+}
+
+void RasterizerNull::SetupDrawTextures(Maxwell::ShaderStage stage, const Shader& shader) {
+    const auto& maxwell3d = system.GPU().Maxwell3D();
+    for (const auto& entry : shader->GetShaderEntries().samplers) {
+        const auto texture = [&]() {
+            if (!entry.IsBindless()) {
+                return maxwell3d.GetStageTexture(stage, entry.GetOffset());
+            }
+            const auto cbuf = entry.GetBindlessCBuf();
+            Tegra::Texture::TextureHandle tex_handle;
+            tex_handle.raw = maxwell3d.AccessConstBuffer32(stage, cbuf.first, cbuf.second);
+            return maxwell3d.GetTextureInfo(tex_handle, entry.GetOffset());
+        }();
+        texture_cache.GetTextureSurface(texture.tic, entry);
+    }
+}
+
+void RasterizerNull::SetupComputeTextures(const Shader& kernel) {
+    const auto& compute = system.GPU().KeplerCompute();
+    for (const auto& entry : kernel->GetShaderEntries().samplers) {
+        const auto texture = [&]() {
+            if (!entry.IsBindless()) {
+                return compute.GetTexture(entry.GetOffset());
+            }
+            const auto cbuf = entry.GetBindlessCBuf();
+            Tegra::Texture::TextureHandle tex_handle;
+            tex_handle.raw = compute.AccessConstBuffer32(cbuf.first, cbuf.second);
+            return compute.GetTextureInfo(tex_handle, entry.GetOffset());
+        }();
+        texture_cache.GetTextureSurface(texture.tic, entry);
+    }
+}
+
+void RasterizerNull::SetupComputeImages(const Shader& kernel) {
+    const auto& compute = system.GPU().KeplerCompute();
+    for (const auto& entry : kernel->GetShaderEntries().images) {
+        const auto tic = [&]() {
+            if (!entry.IsBindless()) {
+                return compute.GetTexture(entry.GetOffset()).tic;
+            }
+            const auto cbuf = entry.GetBindlessCBuf();
+            Tegra::Texture::TextureHandle tex_handle;
+            tex_handle.raw = compute.AccessConstBuffer32(cbuf.first, cbuf.second);
+            return compute.GetTextureInfo(tex_handle, entry.GetOffset()).tic;
+        }();
+        SetupImage(tic, entry);
+    }
+}
+
+void RasterizerNull::SetupImage(const Tegra::Texture::TICEntry& tic, const ImageEntry& entry) {
+    const auto view = texture_cache.GetImageSurface(tic, entry);
+    if (view && entry.IsWritten()) {
+        view->MarkAsModified(texture_cache.Tick());
+    }
+}
+
+std::size_t RasterizerNull::CalculateVertexArraysSize() const {
+    const auto& regs = system.GPU().Maxwell3D().regs;
+
+    std::size_t size = 0;
+    for (u32 index = 0; index < Maxwell::NumVertexArrays; ++index) {
+        if (!regs.vertex_array[index].IsEnabled()) {
+            continue;
+        }
+        const GPUVAddr start = regs.vertex_array[index].StartAddress();
+        const GPUVAddr end = regs.vertex_array_limit[index].LimitAddress();
+        ASSERT(end > start);
+        size += end - start + 1;
+    }
+    return size;
+}
+
+std::size_t RasterizerNull::CalculateIndexBufferSize() const {
+    const auto& regs = system.GPU().Maxwell3D().regs;
+    return static_cast<std::size_t>(regs.index_array.count) *
+           static_cast<std::size_t>(regs.index_array.FormatSizeInBytes());
+}
+
+} // namespace Null
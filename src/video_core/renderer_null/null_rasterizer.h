@@ -0,0 +1,121 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+
+#include <boost/icl/interval_map.hpp>
+
+#include "common/common_types.h"
+#include "video_core/engines/const_buffer_info.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_null/null_buffer_cache.h"
+#include "video_core/renderer_null/null_shader_cache.h"
+#include "video_core/renderer_null/null_texture_cache.h"
+#include "video_core/textures/texture.h"
+
+namespace Core {
+class System;
+}
+
+namespace Null {
+
+/**
+ * Rasterizer that does all the guest state processing and cache bookkeeping of a host backend,
+ * without issuing any host graphics API call. Used to measure the cost of the GPU emulation
+ * independently from the host driver.
+ */
+class RasterizerNull final : public VideoCore::RasterizerInterface {
+public:
+    explicit RasterizerNull(Core::System& system);
+    ~RasterizerNull() override;
+
+    bool DrawBatch(bool is_indexed) override;
+    bool DrawMultiBatch(bool is_indexed) override;
+    void Clear() override;
+    void DispatchCompute(GPUVAddr code_addr) override;
+    void FlushAll() override;
+    void FlushRegion(CacheAddr addr, u64 size) override;
+    void InvalidateRegion(CacheAddr addr, u64 size) override;
+    void FlushAndInvalidateRegion(CacheAddr addr, u64 size) override;
+    void MarkRegionOverwritten(CacheAddr addr, u64 size) override;
+    void FlushCommands() override;
+    void TickFrame() override;
+    bool AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Regs::Surface& src,
+                               const Tegra::Engines::Fermi2D::Regs::Surface& dst,
+                               const Tegra::Engines::Fermi2D::Config& copy_config) override;
+    bool AccelerateDMACopy(const Tegra::Engines::MaxwellDMA::Regs& regs) override;
+    bool AccelerateInlineUpload(CacheAddr addr, std::size_t size) override;
+    bool AccelerateDisplay(const Tegra::FramebufferConfig& config, VAddr framebuffer_addr,
+                           u32 pixel_stride) override;
+    void UpdatePagesCachedCount(VAddr addr, u64 size, int delta) override;
+
+private:
+    /// Syncs the vertex and index buffers, shaders, their resources and render targets.
+    void DrawPrelude(bool is_indexed);
+
+    /// Uploads the dirty vertex arrays.
+    void SetupVertexBuffers();
+
+    /// Uploads the index buffer of an indexed draw.
+    void SetupIndexBuffer();
+
+    /// Looks up the shaders of the enabled stages and sets up their resources.
+    void SetupShaders();
+
+    /// Configures the color and depth render targets.
+    void ConfigureFramebuffers();
+
+    /// Configures the current constbuffers to use for the draw command.
+    void SetupDrawConstBuffers(Tegra::Engines::Maxwell3D::Regs::ShaderStage stage,
+                               const Shader& shader);
+
+    /// Configures the current constbuffers to use for the kernel invocation.
+    void SetupComputeConstBuffers(const Shader& kernel);
+
+    /// Configures a constant buffer.
+    void SetupConstBuffer(const Tegra::Engines::ConstBufferInfo& buffer,
+                          const ConstBufferEntry& entry);
+
+    /// Configures the current global memory entries to use for the draw command.
+    void SetupDrawGlobalMemory(Tegra::Engines::Maxwell3D::Regs::ShaderStage stage,
+                               const Shader& shader);
+
+    /// Configures the current global memory entries to use for the kernel invocation.
+    void SetupComputeGlobalMemory(const Shader& kernel);
+
+    /// Configures the current textures to use for the draw command.
+    void SetupDrawTextures(Tegra::Engines::Maxwell3D::Regs::ShaderStage stage,
+                           const Shader& shader);
+
+    /// Configures the textures used in a compute shader.
+    void SetupComputeTextures(const Shader& kernel);
+
+    /// Configures the images used in a compute shader.
+    void SetupComputeImages(const Shader& kernel);
+
+    /// Configures an image.
+    void SetupImage(const Tegra::Texture::TICEntry& tic, const ImageEntry& entry);
+
+    std::size_t CalculateVertexArraysSize() const;
+
+    std::size_t CalculateIndexBufferSize() const;
+
+    Core::System& system;
+
+    TextureCacheNull texture_cache;
+    ShaderCacheNull shader_cache;
+
+    static constexpr std::size_t STREAM_BUFFER_SIZE = 128 * 1024 * 1024;
+    NullBufferCache buffer_cache;
+
+    using CachedPageMap = boost::icl::interval_map<u64, int>;
+    CachedPageMap cached_pages;
+    std::mutex pages_mutex;
+};
+
+} // namespace Null
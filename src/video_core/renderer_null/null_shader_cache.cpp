@@ -0,0 +1,137 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "common/hash.h"
+#include "core/core.h"
+#include "video_core/memory_manager.h"
+#include "video_core/renderer_null/null_shader_cache.h"
+
+namespace Null {
+
+using VideoCommon::Shader::CompileDepth;
+using VideoCommon::Shader::CompilerSettings;
+using VideoCommon::Shader::ProgramCode;
+using VideoCommon::Shader::ShaderIR;
+
+namespace {
+
+constexpr u32 PROGRAM_OFFSET = 10;
+constexpr u32 COMPUTE_OFFSET = 0;
+
+constexpr CompilerSettings settings{CompileDepth::NoFlowStack, true};
+
+/// Gets the address for the specified shader stage program
+GPUVAddr GetShaderAddress(Core::System& system, Maxwell::ShaderProgram program) {
+    const auto& gpu{system.GPU().Maxwell3D()};
+    const auto& shader_config{gpu.regs.shader_config[static_cast<std::size_t>(program)]};
+    return gpu.regs.code_address.CodeAddress() + shader_config.offset;
+}
+
+/// Calculates the size of a program stream
+std::size_t CalculateProgramSize(const ProgramCode& program, std::size_t start_offset) {
+    // This is the encoded version of BRA that jumps to itself. All Nvidia shaders end with one.
+    constexpr u64 self_jumping_branch = 0xE2400FFFFF07000FULL;
+    constexpr u64 mask = 0xFFFFFFFFFF7FFFFFULL;
+    // Sched instructions appear once every 4 instructions.
+    constexpr std::size_t sched_period = 4;
+    std::size_t offset = start_offset;
+    std::size_t size = start_offset * sizeof(u64);
+    while (offset < program.size()) {
+        const u64 instruction = program[offset];
+        if ((offset - start_offset) % sched_period != 0) {
+            if ((instruction & mask) == self_jumping_branch) {
+                break;
+            }
+            if (instruction == 0) {
+                break;
+            }
+        }
+        size += sizeof(u64);
+        offset++;
+    }
+    // The last instruction is included in the program size
+    return std::min(size + sizeof(u64), program.size() * sizeof(u64));
+}
+
+ShaderEntries GetEntries(const ShaderIR& ir) {
+    ShaderEntries entries;
+    for (const auto& [index, cbuf] : ir.GetConstantBuffers()) {
+        entries.const_buffers.emplace_back(cbuf.GetMaxOffset(), cbuf.IsIndirect(), index);
+    }
+    for (const auto& sampler : ir.GetSamplers()) {
+        entries.samplers.emplace_back(sampler);
+    }
+    for (const auto& [offset, image] : ir.GetImages()) {
+        entries.images.emplace_back(image);
+    }
+    for (const auto& [base, usage] : ir.GetGlobalMemory()) {
+        entries.global_memory_entries.emplace_back(base.cbuf_index, base.cbuf_offset,
+                                                   usage.is_written);
+    }
+    entries.shader_length = ir.GetLength();
+    return entries;
+}
+
+} // Anonymous namespace
+
+CachedShader::CachedShader(VAddr cpu_addr, const u8* host_ptr, u64 unique_identifier,
+                           ShaderEntries entries)
+    : RasterizerCacheObject{host_ptr}, cpu_addr{cpu_addr}, unique_identifier{unique_identifier},
+      entries{std::move(entries)} {}
+
+CachedShader::~CachedShader() = default;
+
+ShaderCacheNull::ShaderCacheNull(VideoCore::RasterizerInterface& rasterizer, Core::System& system)
+    : RasterizerCache{rasterizer}, system{system} {}
+
+ShaderCacheNull::~ShaderCacheNull() = default;
+
+Shader ShaderCacheNull::GetStageProgram(Maxwell::ShaderProgram program) {
+    if (!system.GPU().Maxwell3D().dirty.shaders) {
+        return last_shaders[static_cast<std::size_t>(program)];
+    }
+    return last_shaders[static_cast<std::size_t>(program)] =
+               CreateShader(GetShaderAddress(system, program), PROGRAM_OFFSET);
+}
+
+Shader ShaderCacheNull::GetComputeKernel(GPUVAddr code_addr) {
+    return CreateShader(code_addr, COMPUTE_OFFSET);
+}
+
+Shader ShaderCacheNull::CreateShader(GPUVAddr gpu_addr, u32 main_offset) {
+    auto& memory_manager{system.GPU().MemoryManager()};
+    const auto host_ptr{memory_manager.GetPointer(gpu_addr)};
+    if (host_ptr) {
+        if (Shader shader{TryGet(host_ptr)}) {
+            return shader;
+        }
+    }
+
+    // Programs in unmapped memory are analyzed as zeroes
+    ProgramCode code(VideoCommon::Shader::MAX_PROGRAM_LENGTH);
+    if (host_ptr) {
+        memory_manager.ReadBlockUnsafe(gpu_addr, code.data(), code.size() * sizeof(u64));
+    }
+
+    const std::size_t size = CalculateProgramSize(code, main_offset);
+    const u64 unique_identifier =
+        Common::CityHash64(reinterpret_cast<const char*>(code.data()), size);
+    const ShaderIR ir(code, main_offset, size, settings, &flow_cache);
+
+    // Control flows aren't persisted by this backend
+    flow_cache.TakeNewEntries();
+
+    const auto cpu_addr{memory_manager.GpuToCpuAddress(gpu_addr).value_or(0)};
+    auto shader{std::make_shared<CachedShader>(cpu_addr, host_ptr, unique_identifier,
+                                               GetEntries(ir))};
+    // Unmapped programs all share the null address, they can't be looked up or invalidated
+    if (host_ptr) {
+        Register(shader);
+    }
+    return shader;
+}
+
+} // namespace Null
@@ -0,0 +1,128 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/rasterizer_cache.h"
+#include "video_core/shader/control_flow.h"
+#include "video_core/shader/shader_ir.h"
+
+namespace Core {
+class System;
+}
+
+namespace Null {
+
+class CachedShader;
+
+using Shader = std::shared_ptr<CachedShader>;
+using Maxwell = Tegra::Engines::Maxwell3D::Regs;
+
+using SamplerEntry = VideoCommon::Shader::Sampler;
+using ImageEntry = VideoCommon::Shader::Image;
+
+class ConstBufferEntry : public VideoCommon::Shader::ConstBuffer {
+public:
+    explicit ConstBufferEntry(u32 max_offset, bool is_indirect, u32 index)
+        : VideoCommon::Shader::ConstBuffer{max_offset, is_indirect}, index{index} {}
+
+    u32 GetIndex() const {
+        return index;
+    }
+
+private:
+    u32 index{};
+};
+
+class GlobalMemoryEntry {
+public:
+    explicit GlobalMemoryEntry(u32 cbuf_index, u32 cbuf_offset, bool is_written)
+        : cbuf_index{cbuf_index}, cbuf_offset{cbuf_offset}, is_written{is_written} {}
+
+    u32 GetCbufIndex() const {
+        return cbuf_index;
+    }
+
+    u32 GetCbufOffset() const {
+        return cbuf_offset;
+    }
+
+    bool IsWritten() const {
+        return is_written;
+    }
+
+private:
+    u32 cbuf_index{};
+    u32 cbuf_offset{};
+    bool is_written{};
+};
+
+/// Resources used by a shader, the same ones a host backend would have to bind
+struct ShaderEntries {
+    std::vector<ConstBufferEntry> const_buffers;
+    std::vector<SamplerEntry> samplers;
+    std::vector<ImageEntry> images;
+    std::vector<GlobalMemoryEntry> global_memory_entries;
+    std::size_t shader_length{};
+};
+
+/// Shader analyzed to the IR level, no host code is generated for it
+class CachedShader final : public RasterizerCacheObject {
+public:
+    explicit CachedShader(VAddr cpu_addr, const u8* host_ptr, u64 unique_identifier,
+                          ShaderEntries entries);
+    ~CachedShader();
+
+    VAddr GetCpuAddr() const override {
+        return cpu_addr;
+    }
+
+    std::size_t GetSizeInBytes() const override {
+        return entries.shader_length;
+    }
+
+    u64 GetUniqueIdentifier() const {
+        return unique_identifier;
+    }
+
+    const ShaderEntries& GetShaderEntries() const {
+        return entries;
+    }
+
+private:
+    VAddr cpu_addr{};
+    u64 unique_identifier{};
+    ShaderEntries entries;
+};
+
+class ShaderCacheNull final : public RasterizerCache<Shader> {
+public:
+    explicit ShaderCacheNull(VideoCore::RasterizerInterface& rasterizer, Core::System& system);
+    ~ShaderCacheNull();
+
+    /// Gets the current specified shader stage program
+    Shader GetStageProgram(Maxwell::ShaderProgram program);
+
+    /// Gets a compute kernel in the passed address
+    Shader GetComputeKernel(GPUVAddr code_addr);
+
+protected:
+    // We do not have to flush this cache as things in it are never modified by us.
+    void FlushObjectInner(const Shader& object) override {}
+
+private:
+    Shader CreateShader(GPUVAddr gpu_addr, u32 main_offset);
+
+    Core::System& system;
+    VideoCommon::Shader::ShaderFlowCache flow_cache;
+    std::array<Shader, Maxwell::MaxShaderProgram> last_shaders;
+};
+
+} // namespace Null
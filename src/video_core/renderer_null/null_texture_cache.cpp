@@ -0,0 +1,49 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "video_core/renderer_null/null_texture_cache.h"
+
+namespace Null {
+
+CachedSurface::CachedSurface(GPUVAddr gpu_addr, const SurfaceParams& params)
+    : VideoCommon::SurfaceBase<View>(gpu_addr, params), host_memory(GetHostSizeInBytes()) {
+    main_view = CreateView(
+        ViewParams(params.target, 0, params.is_layered ? params.depth : 1, 0, params.num_levels));
+}
+
+CachedSurface::~CachedSurface() = default;
+
+void CachedSurface::UploadTexture(const std::vector<u8>& staging_buffer) {
+    const std::size_t size = std::min(host_memory.size(), staging_buffer.size());
+    std::copy_n(staging_buffer.begin(), size, host_memory.begin());
+}
+
+void CachedSurface::DownloadTexture(std::vector<u8>& staging_buffer) {
+    const std::size_t size = std::min(host_memory.size(), staging_buffer.size());
+    std::copy_n(host_memory.begin(), size, staging_buffer.begin());
+}
+
+View CachedSurface::CreateView(const ViewParams& view_key) {
+    auto view = std::make_shared<CachedSurfaceView>(*this, view_key);
+    views[view_key] = view;
+    return view;
+}
+
+CachedSurfaceView::CachedSurfaceView(CachedSurface& surface, const ViewParams& params)
+    : VideoCommon::ViewBase(params), surface{surface} {}
+
+CachedSurfaceView::~CachedSurfaceView() = default;
+
+TextureCacheNull::TextureCacheNull(Core::System& system, VideoCore::RasterizerInterface& rasterizer)
+    : TextureCacheBase{system, rasterizer} {}
+
+TextureCacheNull::~TextureCacheNull() = default;
+
+Surface TextureCacheNull::CreateSurface(GPUVAddr gpu_addr, const SurfaceParams& params) {
+    return std::make_shared<CachedSurface>(gpu_addr, params);
+}
+
+} // namespace Null
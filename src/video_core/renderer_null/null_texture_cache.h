@@ -0,0 +1,77 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/texture_cache/texture_cache.h"
+
+namespace Null {
+
+using VideoCommon::SurfaceParams;
+using VideoCommon::ViewParams;
+
+class CachedSurfaceView;
+class CachedSurface;
+
+using Surface = std::shared_ptr<CachedSurface>;
+using View = std::shared_ptr<CachedSurfaceView>;
+using TextureCacheBase = VideoCommon::TextureCache<Surface, View>;
+
+/// Surface backed by host memory. Its contents are kept so flushes write back what was uploaded.
+class CachedSurface final : public VideoCommon::SurfaceBase<View> {
+public:
+    explicit CachedSurface(GPUVAddr gpu_addr, const SurfaceParams& params);
+    ~CachedSurface();
+
+    void UploadTexture(const std::vector<u8>& staging_buffer) override;
+    void DownloadTexture(std::vector<u8>& staging_buffer) override;
+
+protected:
+    void DecorateSurfaceName() override {}
+
+    View CreateView(const ViewParams& view_key) override;
+
+private:
+    std::vector<u8> host_memory;
+};
+
+class CachedSurfaceView final : public VideoCommon::ViewBase {
+public:
+    explicit CachedSurfaceView(CachedSurface& surface, const ViewParams& params);
+    ~CachedSurfaceView();
+
+    void MarkAsModified(u64 tick) {
+        surface.MarkAsModified(true, tick);
+    }
+
+    const SurfaceParams& GetSurfaceParams() const {
+        return surface.GetSurfaceParams();
+    }
+
+private:
+    CachedSurface& surface;
+};
+
+class TextureCacheNull final : public TextureCacheBase {
+public:
+    explicit TextureCacheNull(Core::System& system, VideoCore::RasterizerInterface& rasterizer);
+    ~TextureCacheNull();
+
+protected:
+    Surface CreateSurface(GPUVAddr gpu_addr, const SurfaceParams& params) override;
+
+    void ImageCopy(Surface& src_surface, Surface& dst_surface,
+                   const VideoCommon::CopyParams& copy_params) override {}
+
+    void ImageBlit(View& src_view, View& dst_view,
+                   const Tegra::Engines::Fermi2D::Config& copy_config) override {}
+
+    void BufferCopy(Surface& src_surface, Surface& dst_surface) override {}
+};
+
+} // namespace Null
@@ -0,0 +1,46 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+
+#include "core/core.h"
+#include "core/frontend/emu_window.h"
+#include "core/memory.h"
+#include "video_core/renderer_null/null_rasterizer.h"
+#include "video_core/renderer_null/renderer_null.h"
+#include "video_core/surface.h"
+
+namespace Null {
+
+RendererNull::RendererNull(Core::Frontend::EmuWindow& emu_window, Core::System& system)
+    : VideoCore::RendererBase{emu_window}, system{system} {}
+
+RendererNull::~RendererNull() = default;
+
+bool RendererNull::Init() {
+    rasterizer = std::make_unique<RasterizerNull>(system);
+    return true;
+}
+
+void RendererNull::ShutDown() {}
+
+void RendererNull::SwapBuffers(const Tegra::FramebufferConfig* framebuffer) {
+    if (framebuffer) {
+        // Presenting still has to flush the framebuffer when it's not found in the caches
+        const VAddr framebuffer_addr{framebuffer->address + framebuffer->offset};
+        if (!rasterizer->AccelerateDisplay(*framebuffer, framebuffer_addr, framebuffer->stride)) {
+            const auto pixel_format{
+                VideoCore::Surface::PixelFormatFromGPUPixelFormat(framebuffer->pixel_format)};
+            const u32 bytes_per_pixel{VideoCore::Surface::GetBytesPerPixel(pixel_format)};
+            const u64 size_in_bytes{framebuffer->stride * framebuffer->height * bytes_per_pixel};
+            rasterizer->FlushRegion(ToCacheAddr(Memory::GetPointer(framebuffer_addr)),
+                                    size_in_bytes);
+        }
+        rasterizer->TickFrame();
+        ++m_current_frame;
+    }
+    render_window.PollEvents();
+}
+
+} // namespace Null
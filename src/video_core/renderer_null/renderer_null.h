@@ -0,0 +1,35 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "video_core/renderer_base.h"
+
+namespace Core {
+class System;
+}
+
+namespace Core::Frontend {
+class EmuWindow;
+}
+
+namespace Null {
+
+/// Renderer that presents nothing, frames only drive the caches of the null rasterizer
+class RendererNull final : public VideoCore::RendererBase {
+public:
+    explicit RendererNull(Core::Frontend::EmuWindow& emu_window, Core::System& system);
+    ~RendererNull() override;
+
+    bool Init() override;
+
+    void ShutDown() override;
+
+    void SwapBuffers(const Tegra::FramebufferConfig* framebuffer) override;
+
+private:
+    Core::System& system;
+};
+
+} // namespace Null
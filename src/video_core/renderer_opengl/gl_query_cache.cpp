@@ -0,0 +1,218 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "common/assert.h"
+#include "core/core.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/memory_manager.h"
+#include "video_core/renderer_opengl/gl_query_cache.h"
+
+namespace OpenGL {
+
+namespace {
+
+constexpr std::array<GLenum, VideoCore::NumQueryTypes> QueryTargets = {GL_SAMPLES_PASSED};
+
+constexpr GLenum GetTarget(VideoCore::QueryType type) {
+    return QueryTargets[static_cast<std::size_t>(type)];
+}
+
+} // Anonymous namespace
+
+HostCounter::HostCounter(QueryCache& cache, std::shared_ptr<HostCounter> dependency_,
+                         VideoCore::QueryType type)
+    : cache{cache}, type{type}, dependency{std::move(dependency_)} {
+    if (dependency) {
+        if (dependency->TryResolve()) {
+            base_value = dependency->Query();
+            dependency.reset();
+        } else if (dependency->depth >= MaxDependencyDepth) {
+            // Too many unresolved counters, resolving them now keeps Query from recursing deeply
+            base_value = dependency->Query();
+            dependency.reset();
+        } else {
+            depth = dependency->depth + 1;
+        }
+    }
+    query = cache.AllocateQuery(type);
+    glBeginQuery(GetTarget(type), query.handle);
+}
+
+HostCounter::~HostCounter() {
+    cache.ReserveQuery(type, std::move(query));
+}
+
+void HostCounter::EndQuery() {
+    glEndQuery(GetTarget(type));
+}
+
+u64 HostCounter::Query() {
+    if (result) {
+        return *result;
+    }
+    GLuint64 value = 0;
+    glGetQueryObjectui64v(query.handle, GL_QUERY_RESULT, &value);
+    if (dependency) {
+        base_value += dependency->Query();
+        dependency.reset();
+    }
+    depth = 0;
+    result = base_value + value;
+    return *result;
+}
+
+bool HostCounter::TryResolve() {
+    if (result) {
+        return true;
+    }
+    if (dependency && !dependency->TryResolve()) {
+        return false;
+    }
+    GLuint available = GL_FALSE;
+    glGetQueryObjectuiv(query.handle, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (available == GL_FALSE) {
+        return false;
+    }
+    Query();
+    return true;
+}
+
+bool HostCounter::CanPredicate() {
+    if (dependency && dependency->TryResolve()) {
+        base_value += dependency->Query();
+        dependency.reset();
+    }
+    return !dependency && base_value == 0;
+}
+
+void QueryCache::CachedQuery::Flush() const {
+    const u64 value = counter ? counter->Query() : 0;
+    if (timestamp) {
+        const std::array<u64, 2> result{value, *timestamp};
+        std::memcpy(host_ptr, result.data(), sizeof(result));
+    } else {
+        const u32 result = static_cast<u32>(value);
+        std::memcpy(host_ptr, &result, sizeof(result));
+    }
+}
+
+QueryCache::QueryCache(Core::System& system, VideoCore::RasterizerInterface& rasterizer)
+    : system{system}, rasterizer{rasterizer},
+      streams{{CounterStream{*this, VideoCore::QueryType::SamplesPassed}}} {}
+
+QueryCache::~QueryCache() = default;
+
+void QueryCache::UpdateCounters() {
+    const auto& regs = system.GPU().Maxwell3D().regs;
+    GetStream(VideoCore::QueryType::SamplesPassed).Update(regs.samplecnt_enable != 0);
+}
+
+void QueryCache::PauseCounters() {
+    for (auto& stream : streams) {
+        stream.Pause();
+    }
+}
+
+void QueryCache::ResetCounter(VideoCore::QueryType type) {
+    GetStream(type).Reset();
+}
+
+void QueryCache::Query(GPUVAddr gpu_addr, VideoCore::QueryType type,
+                       std::optional<u64> timestamp) {
+    auto& memory_manager = system.GPU().MemoryManager();
+    const auto cpu_addr = memory_manager.GpuToCpuAddress(gpu_addr);
+    u8* const host_ptr = memory_manager.GetPointer(gpu_addr);
+    ASSERT_OR_EXECUTE(cpu_addr && host_ptr, { return; });
+
+    // The new result overwrites the old ones, they don't have to be written unless the new one
+    // is shorter
+    CachedQuery query{*cpu_addr, host_ptr, GetStream(type).Current(), timestamp};
+    InvalidateRegion(query.GetCacheAddr(), query.GetSizeInBytes());
+
+    rasterizer.UpdatePagesCachedCount(query.cpu_addr, query.GetSizeInBytes(), 1);
+    cached_queries.Insert(std::move(query));
+}
+
+void QueryCache::FlushRegion(CacheAddr addr, std::size_t size) {
+    RemoveRegion(addr, size, true);
+}
+
+void QueryCache::InvalidateRegion(CacheAddr addr, std::size_t size) {
+    RemoveRegion(addr, size, false);
+}
+
+void QueryCache::TickFrame() {
+    cached_queries.RemoveIf([this](const CachedQuery& query) {
+        if (query.counter && !query.counter->TryResolve()) {
+            return false;
+        }
+        query.Flush();
+        rasterizer.UpdatePagesCachedCount(query.cpu_addr, query.GetSizeInBytes(), -1);
+        return true;
+    });
+}
+
+bool QueryCache::SetRenderCondition(GPUVAddr gpu_addr) {
+    render_condition.reset();
+    if (gpu_addr == 0) {
+        return false;
+    }
+    const u8* const host_ptr = system.GPU().MemoryManager().GetPointer(gpu_addr);
+    const CachedQuery* const query =
+        host_ptr ? cached_queries.TryGet(ToCacheAddr(host_ptr)) : nullptr;
+    if (!query || !query->counter || !query->counter->CanPredicate()) {
+        return false;
+    }
+    render_condition = query->counter;
+    return true;
+}
+
+void QueryCache::BeginConditionalRender() {
+    if (render_condition) {
+        glBeginConditionalRender(render_condition->GetHandle(), GL_QUERY_NO_WAIT);
+    }
+}
+
+void QueryCache::EndConditionalRender() {
+    if (render_condition) {
+        glEndConditionalRender();
+    }
+}
+
+OGLQuery QueryCache::AllocateQuery(VideoCore::QueryType type) {
+    auto& reserve = reserved_queries[static_cast<std::size_t>(type)];
+    if (reserve.empty()) {
+        OGLQuery query;
+        query.Create(GetTarget(type));
+        return query;
+    }
+    OGLQuery query = std::move(reserve.back());
+    reserve.pop_back();
+    return query;
+}
+
+void QueryCache::ReserveQuery(VideoCore::QueryType type, OGLQuery&& query) {
+    reserved_queries[static_cast<std::size_t>(type)].push_back(std::move(query));
+}
+
+void QueryCache::RemoveRegion(CacheAddr addr, std::size_t size, bool flush) {
+    cached_queries.RemoveRegion(addr, size, [&](const CachedQuery& query, bool is_covered) {
+        // Partially overwritten queries keep the part of their result the guest doesn't write
+        if (flush || !is_covered) {
+            query.Flush();
+        }
+        rasterizer.UpdatePagesCachedCount(query.cpu_addr, query.GetSizeInBytes(), -1);
+    });
+}
+
+} // namespace OpenGL
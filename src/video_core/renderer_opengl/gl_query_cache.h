@@ -0,0 +1,161 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <glad/glad.h>
+
+#include "common/common_types.h"
+#include "video_core/gpu.h"
+#include "video_core/query_cache.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_opengl/gl_resource_manager.h"
+
+namespace Core {
+class System;
+}
+
+namespace OpenGL {
+
+class QueryCache;
+
+/**
+ * Host query counting the samples of a span of draws. The guest counter value it represents is its
+ * own result plus the value of the counter before it, since counters accumulate until they are
+ * reset.
+ */
+class HostCounter final {
+public:
+    explicit HostCounter(QueryCache& cache, std::shared_ptr<HostCounter> dependency,
+                         VideoCore::QueryType type);
+    ~HostCounter();
+
+    /// Stops counting samples.
+    void EndQuery();
+
+    /// Returns the guest counter value, waits for the host when the results are not available.
+    u64 Query();
+
+    /// Resolves the value when the host results are available without waiting. Returns true when
+    /// the value is known.
+    bool TryResolve();
+
+    /// Returns true when the host query alone tells whether the counter is zero, this is when the
+    /// counters it depends on resolved to zero.
+    bool CanPredicate();
+
+    GLuint GetHandle() const {
+        return query.handle;
+    }
+
+private:
+    /// Unresolved dependencies over this depth are resolved eagerly, bounding the chain length.
+    static constexpr u32 MaxDependencyDepth = 64;
+
+    QueryCache& cache;
+    const VideoCore::QueryType type;
+
+    std::shared_ptr<HostCounter> dependency; ///< Previous counter, null once resolved
+    u64 base_value = 0;                      ///< Value of the resolved dependencies
+    std::optional<u64> result;               ///< Guest counter value, once resolved
+    u32 depth = 0;                           ///< Number of unresolved counters before this one
+    OGLQuery query;
+};
+
+using CounterStream = VideoCommon::CounterStreamBase<QueryCache, HostCounter>;
+
+/**
+ * Caches guest queries resolved by host queries. Host queries are taken from pools and their
+ * results are not waited for: a query is written to guest memory when the guest reads it, or once
+ * its results are available at the end of a frame. Queries used as a render condition predicate
+ * the draws on the host instead of stalling the emulation until the result is known.
+ */
+class QueryCache final {
+public:
+    explicit QueryCache(Core::System& system, VideoCore::RasterizerInterface& rasterizer);
+    ~QueryCache();
+
+    /// Starts or stops the host counters to match the guest state, called before each draw.
+    void UpdateCounters();
+
+    /// Stops the host counters before draws the guest didn't issue, like the presentation. The
+    /// next UpdateCounters call resumes them.
+    void PauseCounters();
+
+    /// Discards the samples counted so far by a counter.
+    void ResetCounter(VideoCore::QueryType type);
+
+    /// Caches the current value of a counter to be written at gpu_addr.
+    void Query(GPUVAddr gpu_addr, VideoCore::QueryType type, std::optional<u64> timestamp);
+
+    /// Writes the cached queries in the region to guest memory and removes them.
+    void FlushRegion(CacheAddr addr, std::size_t size);
+
+    /// Removes the cached queries in the region, their results are overwritten by the guest. Only
+    /// the queries partially overwritten are written first, waiting for the host if needed.
+    void InvalidateRegion(CacheAddr addr, std::size_t size);
+
+    /// Writes the queries whose host results are available without waiting for the others.
+    void TickFrame();
+
+    /// Predicates the following draws on the query at gpu_addr. Returns false when the query
+    /// can't be used as a host predicate, zero disables the predicate.
+    bool SetRenderCondition(GPUVAddr gpu_addr);
+
+    /// Enables the host predicate, if any, for the guest draws issued until the matching
+    /// EndConditionalRender.
+    void BeginConditionalRender();
+
+    void EndConditionalRender();
+
+    /// Returns a host query object of the given type from the pool.
+    OGLQuery AllocateQuery(VideoCore::QueryType type);
+
+    /// Returns a host query object to the pool.
+    void ReserveQuery(VideoCore::QueryType type, OGLQuery&& query);
+
+private:
+    struct CachedQuery {
+        VAddr cpu_addr;
+        u8* host_ptr;
+        std::shared_ptr<HostCounter> counter; ///< Null when nothing was counted
+        std::optional<u64> timestamp;         ///< Written with the value for long queries
+
+        CacheAddr GetCacheAddr() const {
+            return ToCacheAddr(host_ptr);
+        }
+
+        std::size_t GetSizeInBytes() const {
+            return timestamp ? sizeof(u64) * 2 : sizeof(u32);
+        }
+
+        /// Writes the counter value to guest memory, waits for the host if needed.
+        void Flush() const;
+    };
+
+    CounterStream& GetStream(VideoCore::QueryType type) {
+        return streams[static_cast<std::size_t>(type)];
+    }
+
+    /// Removes the cached queries overlapping a region, writing them to guest memory first when
+    /// flush is true.
+    void RemoveRegion(CacheAddr addr, std::size_t size, bool flush);
+
+    Core::System& system;
+    VideoCore::RasterizerInterface& rasterizer;
+
+    std::array<std::vector<OGLQuery>, VideoCore::NumQueryTypes> reserved_queries;
+    std::array<CounterStream, VideoCore::NumQueryTypes> streams;
+    VideoCommon::CachedQueryIndex<CachedQuery> cached_queries;
+
+    std::shared_ptr<HostCounter> render_condition;
+};
+
+} // namespace OpenGL
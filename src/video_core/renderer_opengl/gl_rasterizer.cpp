@@ -22,6 +22,7 @@
 #include "core/settings.h"
 #include "video_core/engines/kepler_compute.h"
 #include "video_core/engines/maxwell_3d.h"
+#include "video_core/engines/maxwell_dma.h"
 #include "video_core/memory_manager.h"
 #include "video_core/renderer_opengl/gl_rasterizer.h"
 #include "video_core/renderer_opengl/gl_shader_cache.h"
@@ -67,7 +68,8 @@ static std::size_t GetConstBufferSize(const Tegra::Engines::ConstBufferInfo& buf
 RasterizerOpenGL::RasterizerOpenGL(Core::System& system, Core::Frontend::EmuWindow& emu_window,
                                    ScreenInfo& info)
     : texture_cache{system, *this, device}, shader_cache{*this, system, emu_window, device},
-      system{system}, screen_info{info}, buffer_cache{*this, system, STREAM_BUFFER_SIZE} {
+      query_cache{system, *this}, system{system}, screen_info{info},
+      buffer_cache{*this, system, STREAM_BUFFER_SIZE} {
     OpenGLState::ApplyDefaultState();
 
     shader_program_manager = std::make_unique<GLShader::ProgramManager>();
@@ -565,6 +567,9 @@ void RasterizerOpenGL::Clear() {
     clear_state.AllDirty();
     clear_state.Apply();
 
+    query_cache.BeginConditionalRender();
+    SCOPE_EXIT({ query_cache.EndConditionalRender(); });
+
     if (use_color) {
         glClearBufferfv(GL_COLOR, 0, regs.clear_color);
     }
@@ -581,6 +586,8 @@ void RasterizerOpenGL::Clear() {
 void RasterizerOpenGL::DrawPrelude() {
     auto& gpu = system.GPU().Maxwell3D();
 
+    query_cache.UpdateCounters();
+
     SyncColorMask();
     SyncFragmentColorClampState();
     SyncMultiSampleState();
@@ -722,7 +729,9 @@ bool RasterizerOpenGL::DrawBatch(bool is_indexed) {
         draw_call.count = static_cast<GLint>(regs.vertex_buffer.count);
         draw_call.base_vertex = static_cast<GLint>(regs.vertex_buffer.first);
     }
+    query_cache.BeginConditionalRender();
     draw_call.DispatchDraw();
+    query_cache.EndConditionalRender();
 
     maxwell3d.dirty.memory_general = false;
     accelerate_draw = AccelDraw::Disabled;
@@ -754,7 +763,9 @@ bool RasterizerOpenGL::DrawMultiBatch(bool is_indexed) {
         draw_call.count = static_cast<GLint>(regs.vertex_buffer.count);
         draw_call.base_vertex = static_cast<GLint>(regs.vertex_buffer.first);
     }
+    query_cache.BeginConditionalRender();
     draw_call.DispatchDraw();
+    query_cache.EndConditionalRender();
 
     maxwell3d.dirty.memory_general = false;
     accelerate_draw = AccelDraw::Disabled;
@@ -813,6 +824,7 @@ void RasterizerOpenGL::FlushRegion(CacheAddr addr, u64 size) {
     }
     texture_cache.FlushRegion(addr, size);
     buffer_cache.FlushRegion(addr, size);
+    query_cache.FlushRegion(addr, size);
 }
 
 void RasterizerOpenGL::InvalidateRegion(CacheAddr addr, u64 size) {
@@ -823,6 +835,7 @@ void RasterizerOpenGL::InvalidateRegion(CacheAddr addr, u64 size) {
     texture_cache.InvalidateRegion(addr, size);
     shader_cache.InvalidateRegion(addr, size);
     buffer_cache.InvalidateRegion(addr, size);
+    query_cache.InvalidateRegion(addr, size);
 }
 
 void RasterizerOpenGL::FlushAndInvalidateRegion(CacheAddr addr, u64 size) {
@@ -832,22 +845,70 @@ void RasterizerOpenGL::FlushAndInvalidateRegion(CacheAddr addr, u64 size) {
     InvalidateRegion(addr, size);
 }
 
+void RasterizerOpenGL::MarkRegionOverwritten(CacheAddr addr, u64 size) {
+    MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    if (!addr || !size) {
+        return;
+    }
+    texture_cache.MarkRegionOverwritten(addr, size);
+    buffer_cache.MarkRegionOverwritten(addr, size);
+    query_cache.InvalidateRegion(addr, size);
+}
+
 void RasterizerOpenGL::FlushCommands() {
     glFlush();
 }
 
 void RasterizerOpenGL::TickFrame() {
     buffer_cache.TickFrame();
+    texture_cache.TickFrame();
+    query_cache.TickFrame();
+    system.GPU().MaxwellDMA().TickFrame();
+}
+
+void RasterizerOpenGL::ResetCounter(VideoCore::QueryType type) {
+    query_cache.ResetCounter(type);
+}
+
+void RasterizerOpenGL::PauseCounters() {
+    query_cache.PauseCounters();
+}
+
+bool RasterizerOpenGL::AccelerateQuery(GPUVAddr gpu_addr, VideoCore::QueryType type,
+                                       std::optional<u64> timestamp) {
+    query_cache.Query(gpu_addr, type, timestamp);
+    return true;
+}
+
+bool RasterizerOpenGL::AccelerateConditionalRendering(GPUVAddr gpu_addr) {
+    return query_cache.SetRenderCondition(gpu_addr);
 }
 
 bool RasterizerOpenGL::AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Regs::Surface& src,
                                              const Tegra::Engines::Fermi2D::Regs::Surface& dst,
                                              const Tegra::Engines::Fermi2D::Config& copy_config) {
     MICROPROFILE_SCOPE(OpenGL_Blits);
+    // 2D engine blits don't count samples on the guest
+    query_cache.PauseCounters();
     texture_cache.DoFermiCopy(src, dst, copy_config);
     return true;
 }
 
+bool RasterizerOpenGL::AccelerateDMACopy(const Tegra::Engines::MaxwellDMA::Regs& regs) {
+    MICROPROFILE_SCOPE(OpenGL_Blits);
+    return texture_cache.TryDMACopy(regs);
+}
+
+bool RasterizerOpenGL::AccelerateInlineUpload(CacheAddr addr, std::size_t size) {
+    MICROPROFILE_SCOPE(OpenGL_CacheManagement);
+    if (!addr || !size || !buffer_cache.UpdateRegion(addr, size)) {
+        return false;
+    }
+    texture_cache.InvalidateRegion(addr, size);
+    shader_cache.InvalidateRegion(addr, size);
+    return true;
+}
+
 bool RasterizerOpenGL::AccelerateDisplay(const Tegra::FramebufferConfig& config,
                                          VAddr framebuffer_addr, u32 pixel_stride) {
     if (!framebuffer_addr) {
@@ -25,6 +25,7 @@
 #include "video_core/renderer_opengl/gl_buffer_cache.h"
 #include "video_core/renderer_opengl/gl_device.h"
 #include "video_core/renderer_opengl/gl_framebuffer_cache.h"
+#include "video_core/renderer_opengl/gl_query_cache.h"
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_sampler_cache.h"
 #include "video_core/renderer_opengl/gl_shader_cache.h"
@@ -66,11 +67,19 @@ public:
     void FlushRegion(CacheAddr addr, u64 size) override;
     void InvalidateRegion(CacheAddr addr, u64 size) override;
     void FlushAndInvalidateRegion(CacheAddr addr, u64 size) override;
+    void MarkRegionOverwritten(CacheAddr addr, u64 size) override;
     void FlushCommands() override;
     void TickFrame() override;
+    void ResetCounter(VideoCore::QueryType type) override;
+    void PauseCounters() override;
+    bool AccelerateQuery(GPUVAddr gpu_addr, VideoCore::QueryType type,
+                         std::optional<u64> timestamp) override;
+    bool AccelerateConditionalRendering(GPUVAddr gpu_addr) override;
     bool AccelerateSurfaceCopy(const Tegra::Engines::Fermi2D::Regs::Surface& src,
                                const Tegra::Engines::Fermi2D::Regs::Surface& dst,
                                const Tegra::Engines::Fermi2D::Config& copy_config) override;
+    bool AccelerateDMACopy(const Tegra::Engines::MaxwellDMA::Regs& regs) override;
+    bool AccelerateInlineUpload(CacheAddr addr, std::size_t size) override;
     bool AccelerateDisplay(const Tegra::FramebufferConfig& config, VAddr framebuffer_addr,
                            u32 pixel_stride) override;
     void UpdatePagesCachedCount(VAddr addr, u64 size, int delta) override;
@@ -191,6 +200,7 @@ private:
     ShaderCacheOpenGL shader_cache;
     SamplerCacheOpenGL sampler_cache;
     FramebufferCacheOpenGL framebuffer_cache;
+    QueryCache query_cache;
 
     Core::System& system;
     ScreenInfo& screen_info;
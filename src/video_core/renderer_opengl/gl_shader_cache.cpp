@@ -173,9 +173,12 @@ u64 GetUniqueIdentifier(ProgramType program_type, const ProgramCode& code,
 }
 
 /// Creates an unspecialized program from code streams
-GLShader::ProgramResult CreateProgram(const Device& device, ProgramType program_type,
-                                      ProgramCode program_code, ProgramCode program_code_b) {
+GLShader::ProgramResult CreateProgram(const Device& device,
+                                      VideoCommon::Shader::ShaderFlowCache& flow_cache,
+                                      ProgramType program_type, ProgramCode program_code,
+                                      ProgramCode program_code_b) {
     GLShader::ShaderSetup setup(program_code);
+    setup.flow_cache = &flow_cache;
     setup.program.size_a = CalculateProgramSize(program_code);
     setup.program.size_b = 0;
     if (program_type == ProgramType::VertexA) {
@@ -307,8 +310,8 @@ Shader CachedShader::CreateStageFromMemory(const ShaderParameters& params,
                                            ProgramCode&& program_code_b) {
     const auto code_size{CalculateProgramSize(program_code)};
     const auto code_size_b{CalculateProgramSize(program_code_b)};
-    auto result{
-        CreateProgram(params.device, GetProgramType(program_type), program_code, program_code_b)};
+    auto result{CreateProgram(params.device, params.flow_cache, GetProgramType(program_type),
+                              program_code, program_code_b)};
     if (result.first.empty()) {
         // TODO(Rodrigo): Unimplemented shader stages hit here, avoid using these for now
         return {};
@@ -331,7 +334,7 @@ Shader CachedShader::CreateStageFromCache(const ShaderParameters& params,
 }
 
 Shader CachedShader::CreateKernelFromMemory(const ShaderParameters& params, ProgramCode&& code) {
-    auto result{CreateProgram(params.device, ProgramType::Compute, code, {})};
+    auto result{CreateProgram(params.device, params.flow_cache, ProgramType::Compute, code, {})};
 
     const auto code_size{CalculateProgramSize(code)};
     params.disk_cache.SaveRaw(ShaderDiskCacheRaw(params.unique_identifier, ProgramType::Compute,
@@ -398,13 +401,17 @@ void ShaderCacheOpenGL::LoadDiskCache(const std::atomic_bool& stop_loading,
     if (!transferable) {
         return;
     }
-    const auto [raws, shader_usages] = *transferable;
+    const auto [raws, shader_usages, flows] = *transferable;
+    for (const auto& [key, flow] : flows) {
+        flow_cache.Load(key, flow);
+    }
 
     auto [decompiled, dumps] = disk_cache.LoadPrecompiled();
 
     const auto supported_formats{GetSupportedFormats()};
     const auto unspecialized_shaders{
         GenerateUnspecializedShaders(stop_loading, callback, raws, decompiled)};
+    SaveNewFlows();
     if (stop_loading) {
         return;
     }
@@ -532,6 +539,12 @@ CachedProgram ShaderCacheOpenGL::GeneratePrecompiledProgram(
     return shader;
 }
 
+void ShaderCacheOpenGL::SaveNewFlows() {
+    for (const auto& [key, flow] : flow_cache.TakeNewEntries()) {
+        disk_cache.SaveFlow(key, *flow);
+    }
+}
+
 std::unordered_map<u64, UnspecializedShader> ShaderCacheOpenGL::GenerateUnspecializedShaders(
     const std::atomic_bool& stop_loading, const VideoCore::DiskResourceLoadCallback& callback,
     const std::vector<ShaderDiskCacheRaw>& raws,
@@ -566,7 +579,7 @@ std::unordered_map<u64, UnspecializedShader> ShaderCacheOpenGL::GenerateUnspecia
             result = {stored_decompiled.code, stored_decompiled.entries};
         } else {
             // Otherwise decompile the shader at boot and save the result to the decompiled file
-            result = CreateProgram(device, raw.GetProgramType(), raw.GetProgramCode(),
+            result = CreateProgram(device, flow_cache, raw.GetProgramType(), raw.GetProgramCode(),
                                    raw.GetProgramCodeB());
             disk_cache.SaveDecompiled(unique_identifier, result.first, result.second);
         }
@@ -612,13 +625,14 @@ Shader ShaderCacheOpenGL::GetStageProgram(Maxwell::ShaderProgram program) {
     const auto unique_identifier =
         GetUniqueIdentifier(GetProgramType(program), program_code, program_code_b);
     const auto cpu_addr{*memory_manager.GpuToCpuAddress(program_addr)};
-    const ShaderParameters params{disk_cache, precompiled_programs, device, cpu_addr,
-                                  host_ptr,   unique_identifier};
+    const ShaderParameters params{disk_cache, flow_cache, precompiled_programs, device,
+                                  cpu_addr,   host_ptr,   unique_identifier};
 
     const auto found = precompiled_shaders.find(unique_identifier);
     if (found == precompiled_shaders.end()) {
         shader = CachedShader::CreateStageFromMemory(params, program, std::move(program_code),
                                                      std::move(program_code_b));
+        SaveNewFlows();
     } else {
         shader = CachedShader::CreateStageFromCache(params, program, found->second);
     }
@@ -639,12 +653,13 @@ Shader ShaderCacheOpenGL::GetComputeKernel(GPUVAddr code_addr) {
     auto code{GetShaderCode(memory_manager, code_addr, host_ptr)};
     const auto unique_identifier{GetUniqueIdentifier(ProgramType::Compute, code, {})};
     const auto cpu_addr{*memory_manager.GpuToCpuAddress(code_addr)};
-    const ShaderParameters params{disk_cache, precompiled_programs, device, cpu_addr,
-                                  host_ptr,   unique_identifier};
+    const ShaderParameters params{disk_cache, flow_cache, precompiled_programs, device,
+                                  cpu_addr,   host_ptr,   unique_identifier};
 
     const auto found = precompiled_shaders.find(unique_identifier);
     if (found == precompiled_shaders.end()) {
         kernel = CachedShader::CreateKernelFromMemory(params, std::move(code));
+        SaveNewFlows();
     } else {
         kernel = CachedShader::CreateKernelFromCache(params, found->second);
     }
@@ -20,6 +20,7 @@
 #include "video_core/renderer_opengl/gl_resource_manager.h"
 #include "video_core/renderer_opengl/gl_shader_decompiler.h"
 #include "video_core/renderer_opengl/gl_shader_disk_cache.h"
+#include "video_core/shader/control_flow.h"
 
 namespace Core {
 class System;
@@ -44,6 +45,7 @@ using PrecompiledShaders = std::unordered_map<u64, GLShader::ProgramResult>;
 
 struct ShaderParameters {
     ShaderDiskCacheOpenGL& disk_cache;
+    VideoCommon::Shader::ShaderFlowCache& flow_cache;
     const PrecompiledPrograms& precompiled_programs;
     const Device& device;
     VAddr cpu_addr;
@@ -131,10 +133,14 @@ private:
     CachedProgram GeneratePrecompiledProgram(const ShaderDiskCacheDump& dump,
                                              const std::set<GLenum>& supported_formats);
 
+    /// Stores the control flow analyses made since the last call in the transferable cache
+    void SaveNewFlows();
+
     Core::System& system;
     Core::Frontend::EmuWindow& emu_window;
     const Device& device;
     ShaderDiskCacheOpenGL disk_cache;
+    VideoCommon::Shader::ShaderFlowCache flow_cache;
 
     PrecompiledShaders precompiled_shaders;
     PrecompiledPrograms precompiled_programs;
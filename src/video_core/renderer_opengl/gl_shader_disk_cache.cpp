@@ -27,6 +27,7 @@ using ShaderCacheVersionHash = std::array<u8, 64>;
 enum class TransferableEntryKind : u32 {
     Raw,
     Usage,
+    Flow,
 };
 
 enum class PrecompiledEntryKind : u32 {
@@ -42,6 +43,9 @@ static_assert(sizeof(ShaderDiskCacheUsage) == 40);
 
 namespace {
 
+using VideoCommon::Shader::ShaderFlowInfo;
+using VideoCommon::Shader::ShaderFlowKey;
+
 ShaderCacheVersionHash GetShaderCacheVersionHash() {
     ShaderCacheVersionHash hash{};
     const std::size_t length = std::min(std::strlen(Common::g_shader_cache_version), hash.size());
@@ -108,7 +112,8 @@ ShaderDiskCacheOpenGL::ShaderDiskCacheOpenGL(Core::System& system) : system{syst
 
 ShaderDiskCacheOpenGL::~ShaderDiskCacheOpenGL() = default;
 
-std::optional<std::pair<std::vector<ShaderDiskCacheRaw>, std::vector<ShaderDiskCacheUsage>>>
+std::optional<std::tuple<std::vector<ShaderDiskCacheRaw>, std::vector<ShaderDiskCacheUsage>,
+                         std::vector<ShaderFlowEntry>>>
 ShaderDiskCacheOpenGL::LoadTransferable() {
     // Skip games without title id
     const bool has_title_id = system.CurrentProcess()->GetTitleID() != 0;
@@ -148,6 +153,7 @@ ShaderDiskCacheOpenGL::LoadTransferable() {
     // Version is valid, load the shaders
     std::vector<ShaderDiskCacheRaw> raws;
     std::vector<ShaderDiskCacheUsage> usages;
+    std::vector<ShaderFlowEntry> flows;
     while (file.Tell() < file.GetSize()) {
         TransferableEntryKind kind{};
         if (file.ReadBytes(&kind, sizeof(u32)) != sizeof(u32)) {
@@ -175,6 +181,22 @@ ShaderDiskCacheOpenGL::LoadTransferable() {
             usages.push_back(std::move(usage));
             break;
         }
+        case TransferableEntryKind::Flow: {
+            ShaderFlowKey key{};
+            auto flow = std::make_shared<ShaderFlowInfo>();
+            const auto version = VideoCommon::Shader::LoadShaderFlow(file, key, *flow);
+            if (!version) {
+                LOG_ERROR(Render_OpenGL, "Failed to load transferable flow entry - skipping");
+                return {};
+            }
+            if (*version != VideoCommon::Shader::flow_analysis_version) {
+                // Flows from another version of the analysis are ignored and analyzed again
+                break;
+            }
+            transferable_flows.insert(key);
+            flows.emplace_back(key, std::move(flow));
+            break;
+        }
         default:
             LOG_ERROR(Render_OpenGL, "Unknown transferable shader cache entry kind={} - skipping",
                       static_cast<u32>(kind));
@@ -183,7 +205,7 @@ ShaderDiskCacheOpenGL::LoadTransferable() {
     }
 
     is_usable = true;
-    return {{std::move(raws), std::move(usages)}};
+    return {{std::move(raws), std::move(usages), std::move(flows)}};
 }
 
 std::pair<std::unordered_map<u64, ShaderDiskCacheDecompiled>, ShaderDumpsMap>
@@ -532,6 +554,28 @@ void ShaderDiskCacheOpenGL::SaveUsage(const ShaderDiskCacheUsage& usage) {
     }
 }
 
+void ShaderDiskCacheOpenGL::SaveFlow(const ShaderFlowKey& key, const ShaderFlowInfo& flow) {
+    if (!is_usable) {
+        return;
+    }
+    if (!transferable_flows.insert(key).second) {
+        // The flow already exists
+        return;
+    }
+
+    FileUtil::IOFile file = AppendTransferableFile();
+    if (!file.IsOpen())
+        return;
+
+    if (file.WriteObject(TransferableEntryKind::Flow) != 1 ||
+        !VideoCommon::Shader::SaveShaderFlow(file, key, flow)) {
+        LOG_ERROR(Render_OpenGL, "Failed to save flow transferable cache entry - removing");
+        file.Close();
+        InvalidateTransferable();
+        return;
+    }
+}
+
 void ShaderDiskCacheOpenGL::SaveDecompiled(u64 unique_identifier, const std::string& code,
                                            const GLShader::ShaderEntries& entries) {
     if (!is_usable) {
@@ -6,6 +6,7 @@
 
 #include <bitset>
 #include <optional>
+#include <memory>
 #include <string>
 #include <tuple>
 #include <unordered_map>
@@ -19,6 +20,7 @@
 #include "common/common_types.h"
 #include "core/file_sys/vfs_vector.h"
 #include "video_core/renderer_opengl/gl_shader_gen.h"
+#include "video_core/shader/control_flow.h"
 
 namespace Core {
 class System;
@@ -36,6 +38,8 @@ struct ShaderDiskCacheDump;
 using ProgramCode = std::vector<u64>;
 using ShaderDumpsMap = std::unordered_map<ShaderDiskCacheUsage, ShaderDiskCacheDump>;
 using TextureBufferUsage = std::bitset<64>;
+using ShaderFlowEntry = std::pair<VideoCommon::Shader::ShaderFlowKey,
+                                  std::shared_ptr<const VideoCommon::Shader::ShaderFlowInfo>>;
 
 /// Allocated bindings used by an OpenGL shader program
 struct BaseBindings {
@@ -180,7 +184,8 @@ public:
     ~ShaderDiskCacheOpenGL();
 
     /// Loads transferable cache. If file has a old version or on failure, it deletes the file.
-    std::optional<std::pair<std::vector<ShaderDiskCacheRaw>, std::vector<ShaderDiskCacheUsage>>>
+    std::optional<std::tuple<std::vector<ShaderDiskCacheRaw>, std::vector<ShaderDiskCacheUsage>,
+                             std::vector<ShaderFlowEntry>>>
     LoadTransferable();
 
     /// Loads current game's precompiled cache. Invalidates on failure.
@@ -200,6 +205,10 @@ public:
     /// Saves shader usage to the transferable file. Does not check for collisions.
     void SaveUsage(const ShaderDiskCacheUsage& usage);
 
+    /// Saves a control flow analysis to the transferable file. Checks for collisions.
+    void SaveFlow(const VideoCommon::Shader::ShaderFlowKey& key,
+                  const VideoCommon::Shader::ShaderFlowInfo& flow);
+
     /// Saves a decompiled entry to the precompiled file. Does not check for collisions.
     void SaveDecompiled(u64 unique_identifier, const std::string& code,
                         const GLShader::ShaderEntries& entries);
@@ -293,6 +302,9 @@ private:
     // Stored transferable shaders
     std::unordered_map<u64, std::unordered_set<ShaderDiskCacheUsage>> transferable;
 
+    // Stored control flow analyses
+    std::unordered_set<VideoCommon::Shader::ShaderFlowKey> transferable_flows;
+
     // The cache has been loaded at boot
     bool is_usable{};
 };
@@ -10,6 +10,10 @@
 #include "video_core/renderer_opengl/gl_shader_decompiler.h"
 #include "video_core/shader/shader_ir.h"
 
+namespace VideoCommon::Shader {
+class ShaderFlowCache;
+}
+
 namespace OpenGL {
 class Device;
 }
@@ -31,6 +35,9 @@ struct ShaderSetup {
         std::size_t size_b;
     } program;
 
+    /// Control flow cache shared by all the programs, it can be null
+    VideoCommon::Shader::ShaderFlowCache* flow_cache{};
+
     /// Used in scenarios where we have a dual vertex shaders
     void SetProgramB(ProgramCode program_b) {
         program.code_b = std::move(program_b);
@@ -0,0 +1,159 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+
+#include "common/cityhash.h"
+#include "common/common_types.h"
+#include "video_core/renderer_vulkan/declarations.h"
+#include "video_core/renderer_vulkan/fixed_pipeline_state.h"
+#include "video_core/renderer_vulkan/maxwell_to_vk.h"
+
+namespace Vulkan {
+
+namespace {
+
+template <typename T>
+constexpr u32 ToRaw(T value) {
+    return static_cast<u32>(value);
+}
+
+FixedPipelineState::StencilFace GetStencilFace(Maxwell::StencilOp fail, Maxwell::StencilOp zfail,
+                                               Maxwell::StencilOp zpass,
+                                               Maxwell::ComparisonOp func) {
+    FixedPipelineState::StencilFace face{};
+    face.action_stencil_fail.Assign(ToRaw(MaxwellToVK::StencilOp(fail)));
+    face.action_depth_fail.Assign(ToRaw(MaxwellToVK::StencilOp(zfail)));
+    face.action_depth_pass.Assign(ToRaw(MaxwellToVK::StencilOp(zpass)));
+    face.test_func.Assign(ToRaw(MaxwellToVK::ComparisonOp(func)));
+    return face;
+}
+
+FixedPipelineState::BlendingAttachment GetBlendingAttachment(const Maxwell::Blend& blend,
+                                                             bool enable,
+                                                             const Maxwell::ColorMask& mask) {
+    FixedPipelineState::BlendingAttachment attachment{};
+    attachment.enable.Assign(enable ? 1 : 0);
+    if (enable) {
+        attachment.rgb_equation.Assign(ToRaw(MaxwellToVK::BlendEquation(blend.equation_rgb)));
+        attachment.src_rgb_factor.Assign(ToRaw(MaxwellToVK::BlendFactor(blend.factor_source_rgb)));
+        attachment.dst_rgb_factor.Assign(ToRaw(MaxwellToVK::BlendFactor(blend.factor_dest_rgb)));
+        attachment.a_equation.Assign(ToRaw(MaxwellToVK::BlendEquation(blend.equation_a)));
+        attachment.src_a_factor.Assign(ToRaw(MaxwellToVK::BlendFactor(blend.factor_source_a)));
+        attachment.dst_a_factor.Assign(ToRaw(MaxwellToVK::BlendFactor(blend.factor_dest_a)));
+    }
+
+    vk::ColorComponentFlags components;
+    if (mask.R != 0) {
+        components |= vk::ColorComponentFlagBits::eR;
+    }
+    if (mask.G != 0) {
+        components |= vk::ColorComponentFlagBits::eG;
+    }
+    if (mask.B != 0) {
+        components |= vk::ColorComponentFlagBits::eB;
+    }
+    if (mask.A != 0) {
+        components |= vk::ColorComponentFlagBits::eA;
+    }
+    attachment.color_write_mask.Assign(static_cast<VkColorComponentFlags>(components));
+    return attachment;
+}
+
+} // Anonymous namespace
+
+std::size_t FixedPipelineState::Hash() const {
+    const u64 hash = Common::CityHash64(reinterpret_cast<const char*>(this), sizeof(*this));
+    return static_cast<std::size_t>(hash);
+}
+
+FixedPipelineState GetFixedPipelineState(const Maxwell& regs) {
+    FixedPipelineState state{};
+
+    for (std::size_t index = 0; index < Maxwell::NumVertexArrays; ++index) {
+        const auto& vertex_array = regs.vertex_array[index];
+        if (!vertex_array.IsEnabled()) {
+            continue;
+        }
+        auto& binding = state.bindings[index];
+        binding.enabled.Assign(1);
+        binding.stride.Assign(vertex_array.stride);
+        if (regs.instanced_arrays.IsInstancingEnabled(static_cast<u32>(index))) {
+            state.binding_divisors[index] = vertex_array.divisor;
+        }
+    }
+
+    for (std::size_t index = 0; index < Maxwell::NumVertexAttributes; ++index) {
+        const auto& input = regs.vertex_attrib_format[index];
+        if (!input.IsValid() || input.constant) {
+            continue;
+        }
+        auto& attribute = state.attributes[index];
+        attribute.enabled.Assign(1);
+        attribute.buffer.Assign(input.buffer);
+        attribute.offset.Assign(input.offset);
+        attribute.type.Assign(input.type);
+        attribute.size.Assign(input.size);
+    }
+
+    auto& misc = state.misc;
+    misc.topology.Assign(ToRaw(MaxwellToVK::PrimitiveTopology(regs.draw.topology)));
+    misc.primitive_restart_enable.Assign(regs.primitive_restart.enabled != 0 ? 1 : 0);
+
+    if (regs.cull.enabled != 0) {
+        const auto cull_mode = MaxwellToVK::CullFace(regs.cull.cull_face);
+        misc.cull_mode.Assign(static_cast<VkCullModeFlags>(cull_mode));
+    }
+    misc.front_face.Assign(ToRaw(MaxwellToVK::FrontFace(regs.cull.front_face)));
+
+    const bool depth_bias_enable = regs.polygon_offset_point_enable != 0 ||
+                                   regs.polygon_offset_line_enable != 0 ||
+                                   regs.polygon_offset_fill_enable != 0;
+    misc.depth_bias_enable.Assign(depth_bias_enable ? 1 : 0);
+
+    misc.depth_test_enable.Assign(regs.depth_test_enable != 0 ? 1 : 0);
+    misc.depth_write_enable.Assign(regs.depth_write_enabled != 0 ? 1 : 0);
+    if (regs.depth_test_enable != 0) {
+        misc.depth_test_func.Assign(ToRaw(MaxwellToVK::ComparisonOp(regs.depth_test_func)));
+    }
+
+    misc.stencil_enable.Assign(regs.stencil_enable != 0 ? 1 : 0);
+    if (regs.stencil_enable != 0) {
+        state.front_stencil =
+            GetStencilFace(regs.stencil_front_op_fail, regs.stencil_front_op_zfail,
+                           regs.stencil_front_op_zpass, regs.stencil_front_func_func);
+        // Without two sided stencil the back face uses the same configuration as the front face
+        state.back_stencil =
+            regs.stencil_two_side_enable != 0
+                ? GetStencilFace(regs.stencil_back_op_fail, regs.stencil_back_op_zfail,
+                                 regs.stencil_back_op_zpass, regs.stencil_back_func_func)
+                : state.front_stencil;
+    }
+
+    const std::size_t num_attachments =
+        std::min<std::size_t>(regs.rt_control.count, Maxwell::NumRenderTargets);
+    misc.attachments_count.Assign(static_cast<u32>(num_attachments));
+    for (std::size_t index = 0; index < num_attachments; ++index) {
+        const auto& mask = regs.color_mask[regs.color_mask_common ? 0 : index];
+        const bool enable = regs.blend.enable[regs.independent_blend_enable ? index : 0] != 0;
+        if (regs.independent_blend_enable) {
+            state.attachments[index] =
+                GetBlendingAttachment(regs.independent_blend[index], enable, mask);
+        } else {
+            // Repack the common blending registers with the layout of the independent ones
+            Maxwell::Blend blend{};
+            blend.equation_rgb = regs.blend.equation_rgb;
+            blend.factor_source_rgb = regs.blend.factor_source_rgb;
+            blend.factor_dest_rgb = regs.blend.factor_dest_rgb;
+            blend.equation_a = regs.blend.equation_a;
+            blend.factor_source_a = regs.blend.factor_source_a;
+            blend.factor_dest_a = regs.blend.factor_dest_a;
+            state.attachments[index] = GetBlendingAttachment(blend, enable, mask);
+        }
+    }
+
+    return state;
+}
+
+} // namespace Vulkan
@@ -0,0 +1,117 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <cstring>
+#include <type_traits>
+
+#include "common/bit_field.h"
+#include "common/common_types.h"
+#include "video_core/engines/maxwell_3d.h"
+
+namespace Vulkan {
+
+using Maxwell = Tegra::Engines::Maxwell3D::Regs;
+
+/**
+ * Fixed function state baked into a Vulkan graphics pipeline. Maxwell enumerations are converted
+ * to their Vulkan counterparts when the state is captured, so registers written with the OpenGL or
+ * the D3D flavour of the same value share a pipeline. State handled through dynamic pipeline state
+ * (viewports, scissors, stencil references and masks, blend constants and depth bias values) is
+ * not part of it. Every member is a 32 bits word, the structure is hashed and compared as raw
+ * bytes and it's stored as such in the pipeline disk cache.
+ */
+struct FixedPipelineState {
+    union VertexBinding {
+        u32 raw;
+        BitField<0, 1, u32> enabled;
+        BitField<1, 12, u32> stride;
+    };
+
+    union VertexAttribute {
+        u32 raw;
+        BitField<0, 1, u32> enabled;
+        BitField<1, 5, u32> buffer;
+        BitField<6, 14, u32> offset;
+        BitField<20, 3, Maxwell::VertexAttribute::Type> type;
+        BitField<23, 6, Maxwell::VertexAttribute::Size> size;
+    };
+
+    union StencilFace {
+        u32 raw;
+        BitField<0, 3, u32> action_stencil_fail; ///< vk::StencilOp
+        BitField<3, 3, u32> action_depth_fail;   ///< vk::StencilOp
+        BitField<6, 3, u32> action_depth_pass;   ///< vk::StencilOp
+        BitField<9, 3, u32> test_func;           ///< vk::CompareOp
+    };
+
+    union BlendingAttachment {
+        u32 raw;
+        BitField<0, 1, u32> enable;
+        BitField<1, 3, u32> rgb_equation;      ///< vk::BlendOp
+        BitField<4, 5, u32> src_rgb_factor;    ///< vk::BlendFactor
+        BitField<9, 5, u32> dst_rgb_factor;    ///< vk::BlendFactor
+        BitField<14, 3, u32> a_equation;       ///< vk::BlendOp
+        BitField<17, 5, u32> src_a_factor;     ///< vk::BlendFactor
+        BitField<22, 5, u32> dst_a_factor;     ///< vk::BlendFactor
+        BitField<27, 4, u32> color_write_mask; ///< vk::ColorComponentFlags
+    };
+
+    std::array<VertexBinding, Maxwell::NumVertexArrays> bindings;
+    std::array<u32, Maxwell::NumVertexArrays> binding_divisors; ///< Zero when not instanced
+    std::array<VertexAttribute, Maxwell::NumVertexAttributes> attributes;
+
+    StencilFace front_stencil;
+    StencilFace back_stencil;
+
+    std::array<BlendingAttachment, Maxwell::NumRenderTargets> attachments;
+
+    union {
+        u32 raw;
+        BitField<0, 4, u32> topology; ///< vk::PrimitiveTopology
+        BitField<4, 1, u32> primitive_restart_enable;
+        BitField<5, 2, u32> cull_mode;  ///< vk::CullModeFlags, zero when culling is disabled
+        BitField<7, 1, u32> front_face; ///< vk::FrontFace
+        BitField<8, 1, u32> depth_bias_enable;
+        BitField<9, 1, u32> depth_test_enable;
+        BitField<10, 1, u32> depth_write_enable;
+        BitField<11, 3, u32> depth_test_func; ///< vk::CompareOp
+        BitField<14, 1, u32> stencil_enable;
+        BitField<15, 4, u32> attachments_count;
+    } misc;
+
+    std::size_t Hash() const;
+
+    bool operator==(const FixedPipelineState& rhs) const {
+        return std::memcmp(this, &rhs, sizeof(FixedPipelineState)) == 0;
+    }
+
+    bool operator!=(const FixedPipelineState& rhs) const {
+        return !operator==(rhs);
+    }
+};
+static_assert(std::is_trivially_copyable_v<FixedPipelineState>,
+              "FixedPipelineState is not trivially copyable");
+static_assert(sizeof(FixedPipelineState) ==
+                  sizeof(u32) * (Maxwell::NumVertexArrays * 2 + Maxwell::NumVertexAttributes + 2 +
+                                 Maxwell::NumRenderTargets + 1),
+              "FixedPipelineState has padding");
+
+/// Captures the fixed function state of the current Maxwell3D registers.
+FixedPipelineState GetFixedPipelineState(const Maxwell& regs);
+
+} // namespace Vulkan
+
+namespace std {
+
+template <>
+struct hash<Vulkan::FixedPipelineState> {
+    std::size_t operator()(const Vulkan::FixedPipelineState& k) const noexcept {
+        return k.Hash();
+    }
+};
+
+} // namespace std
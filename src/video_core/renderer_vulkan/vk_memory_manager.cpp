@@ -3,13 +3,11 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
-#include <optional>
-#include <tuple>
 #include <vector>
-#include "common/alignment.h"
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/logging/log.h"
+#include "common/tlsf_allocator.h"
 #include "video_core/renderer_vulkan/declarations.h"
 #include "video_core/renderer_vulkan/vk_device.h"
 #include "video_core/renderer_vulkan/vk_memory_manager.h"
@@ -21,11 +19,13 @@ constexpr u64 ALLOC_CHUNK_SIZE = 64 * 1024 * 1024;
 
 class VKMemoryAllocation final {
 public:
-    explicit VKMemoryAllocation(const VKDevice& device, vk::DeviceMemory memory,
-                                vk::MemoryPropertyFlags properties, u64 alloc_size, u32 type)
-        : device{device}, memory{memory}, properties{properties}, alloc_size{alloc_size},
-          shifted_type{ShiftType(type)}, is_mappable{properties &
-                                                     vk::MemoryPropertyFlagBits::eHostVisible} {
+    explicit VKMemoryAllocation(VKMemoryManager& manager, const VKDevice& device,
+                                vk::DeviceMemory memory, vk::MemoryPropertyFlags properties,
+                                u64 alloc_size, u32 type)
+        : manager{manager}, device{device}, memory{memory}, properties{properties},
+          alloc_size{alloc_size}, shifted_type{ShiftType(type)},
+          is_mappable{properties & vk::MemoryPropertyFlagBits::eHostVisible},
+          allocator{alloc_size} {
         if (is_mappable) {
             const auto dev = device.GetLogical();
             const auto& dld = device.GetDispatchLoader();
@@ -34,6 +34,7 @@ public:
     }
 
     ~VKMemoryAllocation() {
+        ASSERT_MSG(allocator.IsEmpty(), "Destroying an allocation with live commits");
         const auto dev = device.GetLogical();
         const auto& dld = device.GetDispatchLoader();
         if (is_mappable)
@@ -42,38 +43,25 @@ public:
     }
 
     VKMemoryCommit Commit(vk::DeviceSize commit_size, vk::DeviceSize alignment) {
-        auto found = TryFindFreeSection(free_iterator, alloc_size, static_cast<u64>(commit_size),
-                                        static_cast<u64>(alignment));
-        if (!found) {
-            found = TryFindFreeSection(0, free_iterator, static_cast<u64>(commit_size),
-                                       static_cast<u64>(alignment));
-            if (!found) {
-                // Signal out of memory, it'll try to do more allocations.
-                return nullptr;
-            }
+        const auto range =
+            allocator.Allocate(static_cast<u64>(commit_size), static_cast<u64>(alignment));
+        if (!range) {
+            // Signal out of memory, it'll try to do more allocations.
+            return nullptr;
         }
-        u8* address = is_mappable ? base_address + *found : nullptr;
-        auto commit = std::make_unique<VKMemoryCommitImpl>(this, memory, address, *found,
-                                                           *found + commit_size);
-        commits.push_back(commit.get());
-
-        // Last commit's address is highly probable to be free.
-        free_iterator = *found + commit_size;
-
-        return commit;
+        VKMemoryCommitImpl* const commit = manager.AcquireCommit();
+        commit->offset = range->offset;
+        commit->handle = range->handle;
+        commit->memory = memory;
+        commit->allocation = this;
+        commit->data = is_mappable ? base_address + range->offset : nullptr;
+        return VKMemoryCommit(commit);
     }
 
-    void Free(const VKMemoryCommitImpl* commit) {
-        ASSERT(commit);
-        const auto it =
-            std::find_if(commits.begin(), commits.end(),
-                         [&](const auto& stored_commit) { return stored_commit == commit; });
-        if (it == commits.end()) {
-            LOG_CRITICAL(Render_Vulkan, "Freeing unallocated commit!");
-            UNREACHABLE();
-            return;
-        }
-        commits.erase(it);
+    void Free(VKMemoryCommitImpl* commit) {
+        ASSERT(commit && commit->allocation == this);
+        allocator.Free(commit->handle);
+        manager.ReleaseCommit(commit);
     }
 
     /// Returns whether this allocation is compatible with the arguments.
@@ -82,38 +70,16 @@ public:
                (type_mask & shifted_type) != 0;
     }
 
+    Common::TLSFAllocator::Stats GetStats() const {
+        return allocator.GetStats();
+    }
+
 private:
     static constexpr u32 ShiftType(u32 type) {
         return 1U << type;
     }
 
-    /// A memory allocator, it may return a free region between "start" and "end" with the solicited
-    /// requeriments.
-    std::optional<u64> TryFindFreeSection(u64 start, u64 end, u64 size, u64 alignment) const {
-        u64 iterator = start;
-        while (iterator + size < end) {
-            const u64 try_left = Common::AlignUp(iterator, alignment);
-            const u64 try_right = try_left + size;
-
-            bool overlap = false;
-            for (const auto& commit : commits) {
-                const auto [commit_left, commit_right] = commit->interval;
-                if (try_left < commit_right && commit_left < try_right) {
-                    // There's an overlap, continue the search where the overlapping commit ends.
-                    iterator = commit_right;
-                    overlap = true;
-                    break;
-                }
-            }
-            if (!overlap) {
-                // A free address has been found.
-                return try_left;
-            }
-        }
-        // No free regions where found, return an empty optional.
-        return std::nullopt;
-    }
-
+    VKMemoryManager& manager;                 ///< Memory manager owning the commit objects.
     const VKDevice& device;                   ///< Vulkan device.
     const vk::DeviceMemory memory;            ///< Vulkan memory allocation handler.
     const vk::MemoryPropertyFlags properties; ///< Vulkan properties.
@@ -124,11 +90,8 @@ private:
     /// Base address of the mapped pointer.
     u8* base_address{};
 
-    /// Hints where the next free region is likely going to be.
-    u64 free_iterator{};
-
-    /// Stores all commits done from this allocation.
-    std::vector<const VKMemoryCommitImpl*> commits;
+    /// Sub-allocates the commits' ranges.
+    Common::TLSFAllocator allocator;
 };
 
 VKMemoryManager::VKMemoryManager(const VKDevice& device)
@@ -222,10 +185,44 @@ bool VKMemoryManager::AllocMemory(vk::MemoryPropertyFlags wanted_properties, u32
         return false;
     }
     allocs.push_back(
-        std::make_unique<VKMemoryAllocation>(device, memory, wanted_properties, size, type));
+        std::make_unique<VKMemoryAllocation>(*this, device, memory, wanted_properties, size, type));
     return true;
 }
 
+VKMemoryStats VKMemoryManager::GetStats() const {
+    VKMemoryStats stats;
+    u64 free_bytes = 0;
+    u64 largest_free_bytes = 0;
+    for (const auto& alloc : allocs) {
+        const auto alloc_stats = alloc->GetStats();
+        stats.allocated_bytes += alloc_stats.size;
+        stats.used_bytes += alloc_stats.used_bytes;
+        stats.num_commits += alloc_stats.num_allocations;
+        free_bytes += alloc_stats.size - alloc_stats.used_bytes;
+        largest_free_bytes += alloc_stats.largest_free_block;
+    }
+    stats.num_allocations = allocs.size();
+    if (free_bytes != 0) {
+        stats.fragmentation =
+            1.0 - static_cast<double>(largest_free_bytes) / static_cast<double>(free_bytes);
+    }
+    return stats;
+}
+
+VKMemoryCommitImpl* VKMemoryManager::AcquireCommit() {
+    if (free_commits.empty()) {
+        return &commit_pool.emplace_back();
+    }
+    VKMemoryCommitImpl* const commit = free_commits.back();
+    free_commits.pop_back();
+    return commit;
+}
+
+void VKMemoryManager::ReleaseCommit(VKMemoryCommitImpl* commit) {
+    // Fields are overwritten by the allocation that acquires it next
+    free_commits.push_back(commit);
+}
+
 /*static*/ bool VKMemoryManager::GetMemoryUnified(const vk::PhysicalDeviceMemoryProperties& props) {
     for (u32 heap_index = 0; heap_index < props.memoryHeapCount; ++heap_index) {
         if (!(props.memoryHeaps[heap_index].flags & vk::MemoryHeapFlagBits::eDeviceLocal)) {
@@ -236,11 +233,15 @@ bool VKMemoryManager::AllocMemory(vk::MemoryPropertyFlags wanted_properties, u32
     return true;
 }
 
-VKMemoryCommitImpl::VKMemoryCommitImpl(VKMemoryAllocation* allocation, vk::DeviceMemory memory,
-                                       u8* data, u64 begin, u64 end)
-    : interval(std::make_pair(begin, end)), memory{memory}, allocation{allocation}, data{data} {}
+void VKMemoryCommitDeleter::operator()(VKMemoryCommitImpl* commit) const {
+    commit->Release();
+}
+
+VKMemoryCommitImpl::VKMemoryCommitImpl() = default;
+
+VKMemoryCommitImpl::~VKMemoryCommitImpl() = default;
 
-VKMemoryCommitImpl::~VKMemoryCommitImpl() {
+void VKMemoryCommitImpl::Release() {
     allocation->Free(this);
 }
 
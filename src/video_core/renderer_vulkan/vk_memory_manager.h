@@ -4,8 +4,9 @@
 
 #pragma once
 
+#include <cstddef>
+#include <deque>
 #include <memory>
-#include <utility>
 #include <vector>
 #include "common/common_types.h"
 #include "video_core/renderer_vulkan/declarations.h"
@@ -16,7 +17,20 @@ class VKDevice;
 class VKMemoryAllocation;
 class VKMemoryCommitImpl;
 
-using VKMemoryCommit = std::unique_ptr<VKMemoryCommitImpl>;
+/// Returns the commit's range to its allocation and recycles the commit object.
+struct VKMemoryCommitDeleter {
+    void operator()(VKMemoryCommitImpl* commit) const;
+};
+
+using VKMemoryCommit = std::unique_ptr<VKMemoryCommitImpl, VKMemoryCommitDeleter>;
+
+struct VKMemoryStats {
+    u64 allocated_bytes{};         ///< Device memory allocated in chunks
+    u64 used_bytes{};              ///< Bytes committed from the chunks
+    double fragmentation{};        ///< Fraction of free bytes outside the largest free block
+    std::size_t num_allocations{}; ///< Number of device memory chunks
+    std::size_t num_commits{};     ///< Number of live commits
+};
 
 class VKMemoryManager final {
 public:
@@ -43,7 +57,18 @@ public:
         return is_memory_unified;
     }
 
+    /// Returns the usage statistics of the device memory chunks.
+    VKMemoryStats GetStats() const;
+
 private:
+    friend VKMemoryAllocation;
+
+    /// Returns a commit object from the pool, it's only constructed when the pool is empty.
+    VKMemoryCommitImpl* AcquireCommit();
+
+    /// Returns a commit object to the pool.
+    void ReleaseCommit(VKMemoryCommitImpl* commit);
+
     /// Allocates a chunk of memory.
     bool AllocMemory(vk::MemoryPropertyFlags wanted_properties, u32 type_mask, u64 size);
 
@@ -54,14 +79,17 @@ private:
     const vk::PhysicalDeviceMemoryProperties props;          ///< Physical device properties.
     const bool is_memory_unified;                            ///< True if memory model is unified.
     std::vector<std::unique_ptr<VKMemoryAllocation>> allocs; ///< Current allocations.
+
+    std::deque<VKMemoryCommitImpl> commit_pool;   ///< Storage of every commit object.
+    std::vector<VKMemoryCommitImpl*> free_commits; ///< Commit objects ready to be reused.
 };
 
 class VKMemoryCommitImpl final {
     friend VKMemoryAllocation;
+    friend VKMemoryCommitDeleter;
 
 public:
-    explicit VKMemoryCommitImpl(VKMemoryAllocation* allocation, vk::DeviceMemory memory, u8* data,
-                                u64 begin, u64 end);
+    VKMemoryCommitImpl();
     ~VKMemoryCommitImpl();
 
     /// Returns the writeable memory map. The commit has to be mappable.
@@ -74,11 +102,15 @@ public:
 
     /// Returns the start position of the commit relative to the allocation.
     vk::DeviceSize GetOffset() const {
-        return static_cast<vk::DeviceSize>(interval.first);
+        return static_cast<vk::DeviceSize>(offset);
     }
 
 private:
-    std::pair<u64, u64> interval{};   ///< Interval where the commit exists.
+    /// Frees the commit's range from its allocation.
+    void Release();
+
+    u64 offset{};                     ///< Start of the commit in the allocation.
+    u32 handle{};                     ///< Handle of the range in the allocation's sub-allocator.
     vk::DeviceMemory memory;          ///< Vulkan device memory handler.
     VKMemoryAllocation* allocation{}; ///< Pointer to the large memory allocation.
     u8* data{}; ///< Pointer to the host mapped memory, it has the commit offset included.
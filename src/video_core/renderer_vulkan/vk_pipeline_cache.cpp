@@ -0,0 +1,413 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "common/assert.h"
+#include "common/cityhash.h"
+#include "common/common_paths.h"
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/core.h"
+#include "core/hle/kernel/process.h"
+#include "core/settings.h"
+#include "video_core/renderer_vulkan/declarations.h"
+#include "video_core/renderer_vulkan/fixed_pipeline_state.h"
+#include "video_core/renderer_vulkan/maxwell_to_vk.h"
+#include "video_core/renderer_vulkan/vk_device.h"
+#include "video_core/renderer_vulkan/vk_pipeline_cache.h"
+
+namespace Vulkan {
+
+namespace {
+
+/// Version of the pipeline cache file, bump it when the key layout changes
+constexpr u32 NativeVersion = 1;
+
+/// Layout of the header written by the driver at the beginning of vk::PipelineCache data
+struct PipelineCacheHeader {
+    u32 header_size;
+    u32 header_version;
+    u32 vendor_id;
+    u32 device_id;
+    std::array<u8, VK_UUID_SIZE> uuid;
+};
+static_assert(sizeof(PipelineCacheHeader) == 32, "PipelineCacheHeader is incorrect size");
+
+constexpr std::array DynamicStates = {
+    vk::DynamicState::eViewport,         vk::DynamicState::eScissor,
+    vk::DynamicState::eDepthBias,        vk::DynamicState::eBlendConstants,
+    vk::DynamicState::eDepthBounds,      vk::DynamicState::eStencilCompareMask,
+    vk::DynamicState::eStencilWriteMask, vk::DynamicState::eStencilReference};
+
+vk::StencilOpState GetStencilFaceState(const FixedPipelineState::StencilFace& face) {
+    return vk::StencilOpState(static_cast<vk::StencilOp>(face.action_stencil_fail.Value()),
+                              static_cast<vk::StencilOp>(face.action_depth_pass.Value()),
+                              static_cast<vk::StencilOp>(face.action_depth_fail.Value()),
+                              static_cast<vk::CompareOp>(face.test_func.Value()), 0, 0, 0);
+}
+
+} // Anonymous namespace
+
+std::size_t GraphicsPipelineCacheKey::Hash() const {
+    const u64 hash = Common::CityHash64(reinterpret_cast<const char*>(this), sizeof(*this));
+    return static_cast<std::size_t>(hash);
+}
+
+VKPipelineCache::VKPipelineCache(Core::System& system, const VKDevice& device)
+    : system{system}, device{device}, pipeline_cache{CreatePipelineCache({})} {}
+
+VKPipelineCache::~VKPipelineCache() {
+    StopWorkers();
+    SaveDiskResources();
+}
+
+void VKPipelineCache::LoadDiskResources() {
+    title_id = system.CurrentProcess()->GetTitleID();
+
+    // Skip games without title id
+    if (!Settings::values.use_disk_shader_cache || title_id == 0) {
+        return;
+    }
+
+    FileUtil::IOFile file(GetPipelineCachePath(), "rb");
+    if (!file.IsOpen()) {
+        LOG_INFO(Render_Vulkan, "No pipeline cache found for game with title id={:016X}",
+                 title_id);
+        return;
+    }
+
+    u32 version{};
+    u64 num_keys{};
+    if (file.ReadBytes(&version, sizeof(version)) != sizeof(version) || version != NativeVersion) {
+        LOG_INFO(Render_Vulkan, "Pipeline cache is from a different version - skipping");
+        return;
+    }
+    if (file.ReadBytes(&num_keys, sizeof(num_keys)) != sizeof(num_keys) ||
+        num_keys > file.GetSize() / sizeof(GraphicsPipelineCacheKey)) {
+        LOG_ERROR(Render_Vulkan, "Failed to read pipeline cache keys - skipping");
+        return;
+    }
+    std::vector<GraphicsPipelineCacheKey> keys(static_cast<std::size_t>(num_keys));
+    if (file.ReadArray(keys.data(), keys.size()) != keys.size()) {
+        LOG_ERROR(Render_Vulkan, "Failed to read pipeline cache keys - skipping");
+        return;
+    }
+
+    u64 data_size{};
+    if (file.ReadBytes(&data_size, sizeof(data_size)) != sizeof(data_size) ||
+        data_size > file.GetSize()) {
+        LOG_ERROR(Render_Vulkan, "Failed to read pipeline cache data - skipping");
+        return;
+    }
+    std::vector<u8> data(static_cast<std::size_t>(data_size));
+    if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+        LOG_ERROR(Render_Vulkan, "Failed to read pipeline cache data - skipping");
+        return;
+    }
+
+    const bool is_compatible = IsCompatibleCacheData(data);
+    if (!is_compatible) {
+        LOG_INFO(Render_Vulkan, "Pipeline cache was built for a different device or driver - "
+                                "only keeping the pipeline keys");
+        data.clear();
+    }
+    UniquePipelineCache new_pipeline_cache = CreatePipelineCache(data);
+
+    // Workers use the driver cache outside of the lock, wait for them before replacing it
+    std::unique_lock lock{mutex};
+    job_finished.wait(lock, [this] { return stats.pending == 0; });
+    pipeline_cache = std::move(new_pipeline_cache);
+
+    known_keys.insert(keys.begin(), keys.end());
+    if (is_compatible) {
+        loaded_keys.insert(keys.begin(), keys.end());
+    }
+    LOG_INFO(Render_Vulkan, "Loaded {} pipeline keys and {} bytes of pipeline cache data",
+             known_keys.size(), data.size());
+}
+
+void VKPipelineCache::SaveDiskResources() {
+    if (!Settings::values.use_disk_shader_cache || title_id == 0) {
+        return;
+    }
+    if (!FileUtil::CreateFullPath(GetPipelineCachePath())) {
+        LOG_ERROR(Render_Vulkan, "Failed to create pipeline cache directory={}", GetBaseDir());
+        return;
+    }
+
+    const auto& dld = device.GetDispatchLoader();
+    const auto data = device.GetLogical().getPipelineCacheData(*pipeline_cache, dld);
+
+    std::lock_guard lock{mutex};
+    FileUtil::IOFile file(GetPipelineCachePath(), "wb");
+    if (!file.IsOpen()) {
+        LOG_ERROR(Render_Vulkan, "Failed to create pipeline cache file={}",
+                  GetPipelineCachePath());
+        return;
+    }
+
+    const u64 num_keys = known_keys.size();
+    const u64 data_size = data.size();
+    bool success = file.WriteObject(NativeVersion) == 1 && file.WriteObject(num_keys) == 1;
+    for (const auto& key : known_keys) {
+        success = success && file.WriteObject(key) == 1;
+    }
+    success = success && file.WriteObject(data_size) == 1 &&
+              file.WriteBytes(data.data(), data.size()) == data.size();
+    if (!success) {
+        LOG_ERROR(Render_Vulkan, "Failed to write pipeline cache - removing");
+        file.Close();
+        FileUtil::Delete(GetPipelineCachePath());
+        return;
+    }
+
+    LOG_INFO(Render_Vulkan, "Saved {} pipeline keys, loaded={} compiled={} failed={}", num_keys,
+             stats.loaded, stats.compiled, stats.failed);
+}
+
+vk::Pipeline VKPipelineCache::GetGraphicsPipeline(const GraphicsPipelineCacheKey& key,
+                                                  const GraphicsPipelineStages& stages,
+                                                  bool wait) {
+    if (last_pipeline && key == last_key) {
+        return last_pipeline;
+    }
+
+    std::unique_lock lock{mutex};
+    auto [it, is_cache_miss] = graphics_pipelines.try_emplace(key);
+    auto& entry = it->second;
+    if (is_cache_miss) {
+        entry = std::make_unique<GraphicsPipelineEntry>();
+        if (loaded_keys.find(key) != loaded_keys.end()) {
+            ++stats.loaded;
+        } else {
+            ++stats.compiled;
+        }
+        known_keys.insert(key);
+        ++stats.pending;
+        jobs.push({key, stages, entry.get()});
+        StartWorkers();
+        job_available.notify_one();
+    }
+
+    if (!entry->is_ready) {
+        if (!wait) {
+            return nullptr;
+        }
+        const GraphicsPipelineEntry* const pending_entry = entry.get();
+        job_finished.wait(lock, [pending_entry] { return pending_entry->is_ready; });
+    }
+    if (!entry->pipeline) {
+        LOG_DEBUG(Render_Vulkan, "Skipping a draw with a pipeline that failed to build");
+        return nullptr;
+    }
+
+    last_key = key;
+    last_pipeline = *entry->pipeline;
+    return last_pipeline;
+}
+
+PipelineCacheStats VKPipelineCache::GetStats() const {
+    std::lock_guard lock{mutex};
+    return stats;
+}
+
+void VKPipelineCache::WorkerThread() {
+    Common::SetCurrentThreadName("VKPipelineWorker");
+
+    while (true) {
+        PipelineJob job{};
+        {
+            std::unique_lock lock{mutex};
+            job_available.wait(lock, [this] { return stop_workers || !jobs.empty(); });
+            if (stop_workers) {
+                return;
+            }
+            job = jobs.front();
+            jobs.pop();
+        }
+
+        UniquePipeline pipeline;
+        try {
+            pipeline = CreateGraphicsPipeline(job.key, job.stages);
+        } catch (const vk::SystemError& error) {
+            // Exceptions can't leave the worker, the failure is reported by GetGraphicsPipeline
+            LOG_ERROR(Render_Vulkan, "Failed to create graphics pipeline: {}", error.what());
+        }
+        {
+            std::lock_guard lock{mutex};
+            if (!pipeline) {
+                // Don't persist keys the driver can't build
+                known_keys.erase(job.key);
+                ++stats.failed;
+            }
+            job.entry->pipeline = std::move(pipeline);
+            job.entry->is_ready = true;
+            --stats.pending;
+        }
+        job_finished.notify_all();
+    }
+}
+
+UniquePipeline VKPipelineCache::CreateGraphicsPipeline(const GraphicsPipelineCacheKey& key,
+                                                       const GraphicsPipelineStages& stages) const {
+    const auto& state = key.fixed_state;
+    const auto& misc = state.misc;
+
+    std::vector<vk::VertexInputBindingDescription> vertex_bindings;
+    for (u32 index = 0; index < static_cast<u32>(Maxwell::NumVertexArrays); ++index) {
+        const auto& binding = state.bindings[index];
+        if (binding.enabled == 0) {
+            continue;
+        }
+        const u32 divisor = state.binding_divisors[index];
+        UNIMPLEMENTED_IF_MSG(divisor > 1, "Unimplemented vertex divisor={}", divisor);
+        vertex_bindings.emplace_back(index, binding.stride,
+                                     divisor != 0 ? vk::VertexInputRate::eInstance
+                                                  : vk::VertexInputRate::eVertex);
+    }
+
+    std::vector<vk::VertexInputAttributeDescription> vertex_attributes;
+    for (u32 index = 0; index < static_cast<u32>(Maxwell::NumVertexAttributes); ++index) {
+        const auto& attribute = state.attributes[index];
+        if (attribute.enabled == 0) {
+            continue;
+        }
+        vertex_attributes.emplace_back(
+            index, attribute.buffer, MaxwellToVK::VertexFormat(attribute.type, attribute.size),
+            attribute.offset);
+    }
+
+    const vk::PipelineVertexInputStateCreateInfo vertex_input_ci(
+        {}, static_cast<u32>(vertex_bindings.size()), vertex_bindings.data(),
+        static_cast<u32>(vertex_attributes.size()), vertex_attributes.data());
+
+    const vk::PipelineInputAssemblyStateCreateInfo input_assembly_ci(
+        {}, static_cast<vk::PrimitiveTopology>(misc.topology.Value()),
+        misc.primitive_restart_enable != 0);
+
+    // Viewports and scissors are dynamic, their values are ignored
+    const vk::PipelineViewportStateCreateInfo viewport_ci({}, 1, nullptr, 1, nullptr);
+
+    const vk::PipelineRasterizationStateCreateInfo rasterizer_ci(
+        {}, false, false, vk::PolygonMode::eFill,
+        static_cast<vk::CullModeFlags>(misc.cull_mode.Value()),
+        static_cast<vk::FrontFace>(misc.front_face.Value()), misc.depth_bias_enable != 0, 0.0f,
+        0.0f, 0.0f, 1.0f);
+
+    const vk::PipelineMultisampleStateCreateInfo multisampling_ci(
+        {}, vk::SampleCountFlagBits::e1, false, 0.0f, nullptr, false, false);
+
+    const vk::PipelineDepthStencilStateCreateInfo depth_stencil_ci(
+        {}, misc.depth_test_enable != 0, misc.depth_write_enable != 0,
+        static_cast<vk::CompareOp>(misc.depth_test_func.Value()), false,
+        misc.stencil_enable != 0, GetStencilFaceState(state.front_stencil),
+        GetStencilFaceState(state.back_stencil), 0.0f, 0.0f);
+
+    std::array<vk::PipelineColorBlendAttachmentState, Maxwell::NumRenderTargets> cb_attachments;
+    const u32 num_attachments = misc.attachments_count;
+    for (u32 index = 0; index < num_attachments; ++index) {
+        const auto& blend = state.attachments[index];
+        cb_attachments[index] = vk::PipelineColorBlendAttachmentState(
+            blend.enable != 0, static_cast<vk::BlendFactor>(blend.src_rgb_factor.Value()),
+            static_cast<vk::BlendFactor>(blend.dst_rgb_factor.Value()),
+            static_cast<vk::BlendOp>(blend.rgb_equation.Value()),
+            static_cast<vk::BlendFactor>(blend.src_a_factor.Value()),
+            static_cast<vk::BlendFactor>(blend.dst_a_factor.Value()),
+            static_cast<vk::BlendOp>(blend.a_equation.Value()),
+            static_cast<vk::ColorComponentFlags>(blend.color_write_mask.Value()));
+    }
+    const vk::PipelineColorBlendStateCreateInfo color_blending_ci(
+        {}, false, vk::LogicOp::eCopy, num_attachments, cb_attachments.data(), {});
+
+    const vk::PipelineDynamicStateCreateInfo dynamic_state_ci(
+        {}, static_cast<u32>(DynamicStates.size()), DynamicStates.data());
+
+    std::vector<vk::PipelineShaderStageCreateInfo> shader_stages;
+    for (std::size_t stage = 0; stage < Maxwell::MaxShaderStage; ++stage) {
+        const vk::ShaderModule module = stages.modules[stage];
+        if (!module) {
+            continue;
+        }
+        const auto vk_stage = MaxwellToVK::ShaderStage(static_cast<Maxwell::ShaderStage>(stage));
+        shader_stages.emplace_back(vk::PipelineShaderStageCreateFlags{}, vk_stage, module, "main",
+                                   nullptr);
+    }
+
+    const vk::GraphicsPipelineCreateInfo create_info(
+        {}, static_cast<u32>(shader_stages.size()), shader_stages.data(), &vertex_input_ci,
+        &input_assembly_ci, nullptr, &viewport_ci, &rasterizer_ci, &multisampling_ci,
+        &depth_stencil_ci, &color_blending_ci, &dynamic_state_ci, stages.layout,
+        stages.renderpass, 0, nullptr, 0);
+
+    const auto& dld = device.GetDispatchLoader();
+    return device.GetLogical().createGraphicsPipelineUnique(*pipeline_cache, create_info, nullptr,
+                                                            dld);
+}
+
+UniquePipelineCache VKPipelineCache::CreatePipelineCache(
+    const std::vector<u8>& initial_data) const {
+    const vk::PipelineCacheCreateInfo cache_ci({}, initial_data.size(), initial_data.data());
+    const auto& dld = device.GetDispatchLoader();
+    return device.GetLogical().createPipelineCacheUnique(cache_ci, nullptr, dld);
+}
+
+bool VKPipelineCache::IsCompatibleCacheData(const std::vector<u8>& data) const {
+    PipelineCacheHeader header;
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+
+    const auto& dld = device.GetDispatchLoader();
+    const auto properties = device.GetPhysical().getProperties(dld);
+    return header.header_size >= sizeof(header) &&
+           header.header_version == static_cast<u32>(vk::PipelineCacheHeaderVersion::eOne) &&
+           header.vendor_id == properties.vendorID && header.device_id == properties.deviceID &&
+           std::memcmp(header.uuid.data(), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+void VKPipelineCache::StartWorkers() {
+    if (!workers.empty() || stop_workers) {
+        return;
+    }
+    // A few workers are enough to hide the compilation of new pipelines, leave the remaining
+    // cores to the emulated CPU and the GPU thread
+    const u32 num_workers = std::clamp(std::thread::hardware_concurrency() / 4, 1U, 4U);
+    for (u32 i = 0; i < num_workers; ++i) {
+        workers.emplace_back(&VKPipelineCache::WorkerThread, this);
+    }
+}
+
+void VKPipelineCache::StopWorkers() {
+    {
+        std::lock_guard lock{mutex};
+        stop_workers = true;
+    }
+    job_available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+std::string VKPipelineCache::GetPipelineCachePath() const {
+    return FileUtil::SanitizePath(GetBaseDir() + DIR_SEP_CHR + fmt::format("{:016X}", title_id) +
+                                  ".bin");
+}
+
+std::string VKPipelineCache::GetBaseDir() const {
+    return FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir) + DIR_SEP "vulkan";
+}
+
+} // namespace Vulkan
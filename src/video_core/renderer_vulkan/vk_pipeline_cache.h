@@ -0,0 +1,181 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/renderer_vulkan/declarations.h"
+#include "video_core/renderer_vulkan/fixed_pipeline_state.h"
+
+namespace Core {
+class System;
+}
+
+namespace Vulkan {
+
+class VKDevice;
+
+/// Attachment formats of the render pass a graphics pipeline has to be compatible with.
+struct RenderPassParams {
+    std::array<u32, Maxwell::NumRenderTargets> color_formats; ///< vk::Format of each attachment
+    u32 depth_format; ///< vk::Format, undefined when there's no depth attachment
+};
+
+struct GraphicsPipelineCacheKey {
+    std::array<u64, Maxwell::MaxShaderProgram> shaders; ///< Hashes of the guest shader programs
+    RenderPassParams renderpass_params;
+    FixedPipelineState fixed_state;
+
+    std::size_t Hash() const;
+
+    bool operator==(const GraphicsPipelineCacheKey& rhs) const {
+        return std::memcmp(this, &rhs, sizeof(GraphicsPipelineCacheKey)) == 0;
+    }
+
+    bool operator!=(const GraphicsPipelineCacheKey& rhs) const {
+        return !operator==(rhs);
+    }
+};
+static_assert(std::is_trivially_copyable_v<GraphicsPipelineCacheKey>,
+              "GraphicsPipelineCacheKey is not trivially copyable");
+static_assert(sizeof(GraphicsPipelineCacheKey) == sizeof(u64) * Maxwell::MaxShaderProgram +
+                                                      sizeof(RenderPassParams) +
+                                                      sizeof(FixedPipelineState),
+              "GraphicsPipelineCacheKey has padding");
+
+} // namespace Vulkan
+
+namespace std {
+
+template <>
+struct hash<Vulkan::GraphicsPipelineCacheKey> {
+    std::size_t operator()(const Vulkan::GraphicsPipelineCacheKey& k) const noexcept {
+        return k.Hash();
+    }
+};
+
+} // namespace std
+
+namespace Vulkan {
+
+/// Host objects a graphics pipeline is built from. They have to outlive the pipeline creation.
+struct GraphicsPipelineStages {
+    std::array<vk::ShaderModule, Maxwell::MaxShaderStage> modules; ///< Null on disabled stages
+    vk::PipelineLayout layout;
+    vk::RenderPass renderpass;
+};
+
+struct PipelineCacheStats {
+    std::size_t loaded{};   ///< Pipelines created from the driver data of a previous session
+    std::size_t compiled{}; ///< Pipelines without compatible driver data stored on disk
+    std::size_t pending{};  ///< Pipelines being created on a worker thread
+    std::size_t failed{};   ///< Pipelines the driver failed to create
+};
+
+/**
+ * Caches graphics pipelines by their fixed function state, shaders and render pass formats.
+ * Pipelines are created on worker threads through a vk::PipelineCache that is persisted per title
+ * together with the keys that were requested, so the driver can skip the compilation of pipelines
+ * seen in previous sessions.
+ * The Vulkan backend doesn't have a rasterizer yet, so nothing drives this cache and it hasn't been
+ * exercised against a driver.
+ */
+class VKPipelineCache final {
+public:
+    explicit VKPipelineCache(Core::System& system, const VKDevice& device);
+    ~VKPipelineCache();
+
+    /// Loads the pipeline cache of the running title. Has to be called before any pipeline is
+    /// requested.
+    void LoadDiskResources();
+
+    /// Writes the pipeline cache of the running title to disk.
+    void SaveDiskResources();
+
+    /**
+     * Returns the graphics pipeline of a key. When it doesn't exist its creation is queued on a
+     * worker thread and a null handle is returned until it's ready, callers are expected to skip
+     * the draw meanwhile. When wait is true the call blocks until the pipeline is ready instead.
+     * Pipelines the driver failed to create are never retried and always return a null handle.
+     */
+    vk::Pipeline GetGraphicsPipeline(const GraphicsPipelineCacheKey& key,
+                                     const GraphicsPipelineStages& stages, bool wait);
+
+    /// Returns how many pipelines were loaded and compiled for the running title.
+    PipelineCacheStats GetStats() const;
+
+private:
+    struct GraphicsPipelineEntry {
+        UniquePipeline pipeline; ///< Null when the creation failed
+        bool is_ready{};
+    };
+
+    struct PipelineJob {
+        GraphicsPipelineCacheKey key;
+        GraphicsPipelineStages stages;
+        GraphicsPipelineEntry* entry;
+    };
+
+    void WorkerThread();
+
+    UniquePipeline CreateGraphicsPipeline(const GraphicsPipelineCacheKey& key,
+                                          const GraphicsPipelineStages& stages) const;
+
+    /// Creates a driver pipeline cache, with initial data when it's compatible with the device.
+    UniquePipelineCache CreatePipelineCache(const std::vector<u8>& initial_data) const;
+
+    /// Returns true when the header of driver pipeline cache data matches the current device.
+    bool IsCompatibleCacheData(const std::vector<u8>& data) const;
+
+    /// Starts the worker threads on the first queued job. Has to be called with the mutex held.
+    void StartWorkers();
+
+    /// Stops the worker threads, pending jobs are discarded.
+    void StopWorkers();
+
+    std::string GetPipelineCachePath() const;
+
+    std::string GetBaseDir() const;
+
+    Core::System& system;
+    const VKDevice& device;
+
+    UniquePipelineCache pipeline_cache;
+    u64 title_id{};
+
+    /// The last requested pipeline, to skip the lookup on consecutive draws
+    GraphicsPipelineCacheKey last_key{};
+    vk::Pipeline last_pipeline;
+
+    mutable std::mutex mutex;
+    std::condition_variable job_available;
+    std::condition_variable job_finished;
+    std::queue<PipelineJob> jobs;
+    bool stop_workers{};
+    std::vector<std::thread> workers;
+
+    std::unordered_map<GraphicsPipelineCacheKey, std::unique_ptr<GraphicsPipelineEntry>>
+        graphics_pipelines;
+    std::unordered_set<GraphicsPipelineCacheKey> known_keys;
+    /// Keys stored on disk together with driver data that is compatible with the device
+    std::unordered_set<GraphicsPipelineCacheKey> loaded_keys;
+    PipelineCacheStats stats;
+};
+
+} // namespace Vulkan
@@ -2,8 +2,13 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <memory>
+#include <mutex>
+#include <utility>
+
 #include "common/assert.h"
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "video_core/renderer_vulkan/declarations.h"
 #include "video_core/renderer_vulkan/vk_device.h"
 #include "video_core/renderer_vulkan/vk_resource_manager.h"
@@ -14,13 +19,28 @@ namespace Vulkan {
 VKScheduler::VKScheduler(const VKDevice& device, VKResourceManager& resource_manager)
     : device{device}, resource_manager{resource_manager} {
     next_fence = &resource_manager.CommitFence();
+    AcquireNewChunk();
     AllocateNewContext();
+    worker_thread = std::thread(&VKScheduler::WorkerThread, this);
 }
 
-VKScheduler::~VKScheduler() = default;
+VKScheduler::~VKScheduler() {
+    {
+        std::lock_guard lock{work_mutex};
+        quit = true;
+    }
+    work_available.notify_all();
+    worker_thread.join();
+
+    // The worker has executed every dispatched chunk, the current one is destroyed unexecuted
+    chunk.reset();
+}
 
 void VKScheduler::Flush(bool release_fence, vk::Semaphore semaphore) {
     SubmitExecution(semaphore);
+    if (semaphore) {
+        WaitWorker();
+    }
     if (release_fence)
         current_fence->Release();
     AllocateNewContext();
@@ -28,20 +48,96 @@ void VKScheduler::Flush(bool release_fence, vk::Semaphore semaphore) {
 
 void VKScheduler::Finish(bool release_fence, vk::Semaphore semaphore) {
     SubmitExecution(semaphore);
+    // The fence can't be waited until the worker has submitted it
+    WaitWorker();
     current_fence->Wait();
     if (release_fence)
         current_fence->Release();
     AllocateNewContext();
 }
 
-void VKScheduler::SubmitExecution(vk::Semaphore semaphore) {
+void VKScheduler::DispatchWork() {
+    if (chunk->Empty()) {
+        return;
+    }
+    {
+        // Push under the lock, the worker checks the queue before sleeping
+        std::lock_guard lock{work_mutex};
+        chunk_queue.Push(std::move(chunk));
+    }
+    ++dispatched_chunks;
+    work_available.notify_one();
+    AcquireNewChunk();
+}
+
+void VKScheduler::WaitWorker() {
+    DispatchWork();
+
+    std::unique_lock lock{work_mutex};
+    work_done.wait(lock, [this] { return executed_chunks == dispatched_chunks; });
+}
+
+VKScheduler::CommandChunk::~CommandChunk() {
+    Command* command = first;
+    while (command != nullptr) {
+        Command* const next = command->GetNext();
+        command->~Command();
+        command = next;
+    }
+}
+
+void VKScheduler::CommandChunk::ExecuteAll(const vk::DispatchLoaderDynamic& dld) {
+    Command* command = first;
+    while (command != nullptr) {
+        Command* const next = command->GetNext();
+        command->Execute(cmdbuf, dld);
+        command->~Command();
+        command = next;
+    }
+    first = nullptr;
+    last = nullptr;
+    command_offset = 0;
+}
+
+void VKScheduler::WorkerThread() {
+    Common::SetCurrentThreadName("yuzu:VulkanWorker");
     const auto& dld = device.GetDispatchLoader();
-    current_cmdbuf.end(dld);
 
-    const auto queue = device.GetGraphicsQueue();
-    const vk::SubmitInfo submit_info(0, nullptr, nullptr, 1, &current_cmdbuf, semaphore ? 1u : 0u,
-                                     &semaphore);
-    queue.submit({submit_info}, *current_fence, dld);
+    while (true) {
+        {
+            std::unique_lock lock{work_mutex};
+            work_available.wait(lock, [this] { return !chunk_queue.Empty() || quit; });
+            if (chunk_queue.Empty()) {
+                // Quitting with no pending work
+                return;
+            }
+        }
+        std::unique_ptr<CommandChunk> work;
+        chunk_queue.Pop(work);
+        work->ExecuteAll(dld);
+        {
+            std::lock_guard lock{reserve_mutex};
+            chunk_reserve.push_back(std::move(work));
+        }
+        {
+            std::lock_guard lock{work_mutex};
+            ++executed_chunks;
+        }
+        work_done.notify_all();
+    }
+}
+
+void VKScheduler::SubmitExecution(vk::Semaphore semaphore) {
+    const vk::Fence fence = *current_fence;
+    const vk::Queue queue = device.GetGraphicsQueue();
+    Record([semaphore, fence, queue](vk::CommandBuffer cmdbuf, const auto& dld) {
+        cmdbuf.end(dld);
+
+        const vk::SubmitInfo submit_info(0, nullptr, nullptr, 1, &cmdbuf, semaphore ? 1u : 0u,
+                                         &semaphore);
+        queue.submit({submit_info}, fence, dld);
+    });
+    DispatchWork();
 }
 
 void VKScheduler::AllocateNewContext() {
@@ -49,8 +145,25 @@ void VKScheduler::AllocateNewContext() {
     current_cmdbuf = resource_manager.CommitCommandBuffer(*current_fence);
     next_fence = &resource_manager.CommitFence();
 
-    const auto& dld = device.GetDispatchLoader();
-    current_cmdbuf.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit}, dld);
+    // Commands recorded from now on are replayed into the new command buffer
+    chunk->SetCommandBuffer(current_cmdbuf);
+    Record([](vk::CommandBuffer cmdbuf, const auto& dld) {
+        cmdbuf.begin({vk::CommandBufferUsageFlagBits::eOneTimeSubmit}, dld);
+    });
+}
+
+void VKScheduler::AcquireNewChunk() {
+    {
+        std::lock_guard lock{reserve_mutex};
+        if (!chunk_reserve.empty()) {
+            chunk = std::move(chunk_reserve.back());
+            chunk_reserve.pop_back();
+        }
+    }
+    if (!chunk) {
+        chunk = std::make_unique<CommandChunk>();
+    }
+    chunk->SetCommandBuffer(current_cmdbuf);
 }
 
 } // namespace Vulkan
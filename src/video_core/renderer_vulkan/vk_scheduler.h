@@ -4,7 +4,20 @@
 
 #pragma once
 
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "common/alignment.h"
+#include "common/assert.h"
 #include "common/common_types.h"
+#include "common/threadsafe_queue.h"
 #include "video_core/renderer_vulkan/declarations.h"
 
 namespace Vulkan {
@@ -30,25 +43,15 @@ private:
     VKFence* const& fence;
 };
 
-class VKCommandBufferView {
-public:
-    VKCommandBufferView() = default;
-    VKCommandBufferView(const vk::CommandBuffer& cmdbuf) : cmdbuf{cmdbuf} {}
-
-    const vk::CommandBuffer* operator->() const noexcept {
-        return &cmdbuf;
-    }
-
-    operator vk::CommandBuffer() const noexcept {
-        return cmdbuf;
-    }
-
-private:
-    const vk::CommandBuffer& cmdbuf;
-};
-
-/// The scheduler abstracts command buffer and fence management with an interface that's able to do
-/// OpenGL-like operations on Vulkan command buffers.
+/**
+ * The scheduler abstracts command buffer and fence management with an interface that's able to do
+ * OpenGL-like operations on Vulkan command buffers.
+ *
+ * Commands are not recorded into Vulkan command buffers by the caller. They are stored as closures
+ * in fixed size chunks that are handed to a worker thread, which replays them into the command
+ * buffer of their execution context and submits it. This moves the driver's recording cost off
+ * the GPU thread. Chunks are recycled, so recording doesn't allocate in the steady state.
+ */
 class VKScheduler {
 public:
     explicit VKScheduler(const VKDevice& device, VKResourceManager& resource_manager);
@@ -59,27 +62,151 @@ public:
         return current_fence;
     }
 
-    /// Gets a reference to the current command buffer.
-    VKCommandBufferView GetCommandBuffer() const {
-        return current_cmdbuf;
-    }
-
-    /// Sends the current execution context to the GPU.
+    /**
+     * Sends the current execution context to the GPU. When a semaphore is signaled, waits for the
+     * worker thread to submit it, so it can be waited on by presentation right after.
+     */
     void Flush(bool release_fence = true, vk::Semaphore semaphore = nullptr);
 
     /// Sends the current execution context to the GPU and waits for it to complete.
     void Finish(bool release_fence = true, vk::Semaphore semaphore = nullptr);
 
+    /// Sends the recorded commands to the worker thread without ending the execution context.
+    void DispatchWork();
+
+    /// Waits for the worker thread to replay and submit every dispatched command. Has to be called
+    /// before using the graphics queue outside of the scheduler.
+    void WaitWorker();
+
+    /**
+     * Records a command to be executed on the worker thread. The command is a callable taking the
+     * command buffer of the current execution context and the dispatch loader. Captured state is
+     * copied, so it must not reference state that changes before the command is executed.
+     */
+    template <typename T>
+    void Record(T&& command) {
+        if (chunk->Record(command)) {
+            return;
+        }
+        DispatchWork();
+        const bool recorded = chunk->Record(command);
+        ASSERT_MSG(recorded, "Command doesn't fit in an empty chunk");
+    }
+
 private:
+    class Command {
+    public:
+        virtual ~Command() = default;
+
+        virtual void Execute(vk::CommandBuffer cmdbuf,
+                             const vk::DispatchLoaderDynamic& dld) const = 0;
+
+        Command* GetNext() const {
+            return next;
+        }
+
+        void SetNext(Command* next_) {
+            next = next_;
+        }
+
+    private:
+        Command* next = nullptr;
+    };
+
+    template <typename T>
+    class TypedCommand final : public Command {
+    public:
+        explicit TypedCommand(T&& command) : command{std::move(command)} {}
+        ~TypedCommand() override = default;
+
+        TypedCommand(TypedCommand&&) = delete;
+        TypedCommand& operator=(TypedCommand&&) = delete;
+
+        void Execute(vk::CommandBuffer cmdbuf,
+                     const vk::DispatchLoaderDynamic& dld) const override {
+            command(cmdbuf, dld);
+        }
+
+    private:
+        T command;
+    };
+
+    /// Linear arena of commands recorded for a single command buffer.
+    class CommandChunk final {
+    public:
+        ~CommandChunk();
+
+        /// Replays and destroys the recorded commands.
+        void ExecuteAll(const vk::DispatchLoaderDynamic& dld);
+
+        /// Returns false when the command doesn't fit in the remaining space of the chunk.
+        template <typename T>
+        bool Record(T& command) {
+            using FuncType = TypedCommand<std::decay_t<T>>;
+            static_assert(sizeof(FuncType) < ChunkSize, "Command is too large");
+            static_assert(alignof(FuncType) <= alignof(std::max_align_t),
+                          "Command is overaligned");
+
+            const std::size_t offset = Common::AlignUp(command_offset, alignof(FuncType));
+            if (offset + sizeof(FuncType) > ChunkSize) {
+                return false;
+            }
+            Command* const current_last = last;
+            last = new (data.data() + offset) FuncType(std::decay_t<T>(std::move(command)));
+            if (current_last) {
+                current_last->SetNext(last);
+            } else {
+                first = last;
+            }
+            command_offset = offset + sizeof(FuncType);
+            return true;
+        }
+
+        void SetCommandBuffer(vk::CommandBuffer cmdbuf_) {
+            cmdbuf = cmdbuf_;
+        }
+
+        bool Empty() const {
+            return command_offset == 0;
+        }
+
+    private:
+        static constexpr std::size_t ChunkSize = 0x8000;
+
+        vk::CommandBuffer cmdbuf;
+        Command* first = nullptr;
+        Command* last = nullptr;
+        std::size_t command_offset = 0;
+        alignas(std::max_align_t) std::array<u8, ChunkSize> data{};
+    };
+
+    void WorkerThread();
+
     void SubmitExecution(vk::Semaphore semaphore);
 
     void AllocateNewContext();
 
+    /// Takes a chunk from the reserve or creates a new one when the reserve is empty.
+    void AcquireNewChunk();
+
     const VKDevice& device;
     VKResourceManager& resource_manager;
     vk::CommandBuffer current_cmdbuf;
     VKFence* current_fence = nullptr;
     VKFence* next_fence = nullptr;
+
+    std::unique_ptr<CommandChunk> chunk;
+
+    std::thread worker_thread;
+    Common::SPSCQueue<std::unique_ptr<CommandChunk>> chunk_queue;
+    std::mutex reserve_mutex;
+    std::vector<std::unique_ptr<CommandChunk>> chunk_reserve;
+    std::mutex work_mutex;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+    std::size_t dispatched_chunks = 0; ///< Chunks dispatched to the worker, GPU thread only
+    std::size_t executed_chunks = 0;   ///< Chunks executed by the worker, under work_mutex
+    bool quit = false;
 };
 
 } // namespace Vulkan
@@ -30,7 +30,8 @@ public:
     void AcquireNextImage();
 
     /// Presents the rendered image to the swapchain. Returns true when the swapchains had to be
-    /// recreated. Takes responsability for the ownership of fence.
+    /// recreated. Takes responsability for the ownership of fence. render_semaphore has to be
+    /// submitted already, see VKScheduler::Flush.
     bool Present(vk::Semaphore render_semaphore, VKFence& fence);
 
     /// Returns true when the framebuffer layout has changed.
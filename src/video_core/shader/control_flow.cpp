@@ -2,20 +2,30 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <list>
 #include <map>
 #include <set>
 #include <stack>
+#include <type_traits>
 #include <unordered_map>
 #include <vector>
 
 #include "common/assert.h"
 #include "common/common_types.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
 #include "video_core/shader/ast.h"
 #include "video_core/shader/control_flow.h"
 #include "video_core/shader/shader_ir.h"
 
 namespace VideoCommon::Shader {
+
+// Blocks are stored as they are in memory, making sure their layout doesn't change by accident
+static_assert(sizeof(ShaderBlock) == 40);
+static_assert(std::is_trivially_copyable_v<ShaderBlock>);
+
 namespace {
 using Tegra::Shader::Instruction;
 using Tegra::Shader::OpCode;
@@ -415,9 +425,8 @@ bool TryQuery(CFGRebuildState& state) {
     state.queries.push_back(std::move(conditional_query));
     return true;
 }
-} // Anonymous namespace
 
-void InsertBranch(ASTManager& mm, const BlockBranchInfo& branch) {
+void InsertBranch(ASTManager& mm, const ShaderBlock::Branch& branch) {
     const auto get_expr = ([&](const Condition& cond) -> Expr {
         Expr result{};
         if (cond.cc != ConditionCode::T) {
@@ -445,42 +454,45 @@ void InsertBranch(ASTManager& mm, const BlockBranchInfo& branch) {
         return MakeExpr<ExprBoolean>(true);
     });
     if (branch.address < 0) {
-        if (branch.kill) {
-            mm.InsertReturn(get_expr(branch.condition), true);
+        if (branch.kills) {
+            mm.InsertReturn(get_expr(branch.cond), true);
             return;
         }
-        mm.InsertReturn(get_expr(branch.condition), false);
+        mm.InsertReturn(get_expr(branch.cond), false);
         return;
     }
-    mm.InsertGoto(get_expr(branch.condition), branch.address);
+    mm.InsertGoto(get_expr(branch.cond), branch.address);
 }
 
-void DecompileShader(CFGRebuildState& state) {
-    state.manager->Init();
-    for (auto label : state.labels) {
-        state.manager->DeclareLabel(label);
+void DecompileShader(ASTManager& manager, const std::vector<ShaderBlock>& blocks,
+                     const std::set<u32>& labels) {
+    manager.Init();
+    for (auto label : labels) {
+        manager.DeclareLabel(label);
     }
-    for (auto& block : state.block_info) {
-        if (state.labels.count(block.start) != 0) {
-            state.manager->InsertLabel(block.start);
+    for (const auto& block : blocks) {
+        if (labels.count(block.start) != 0) {
+            manager.InsertLabel(block.start);
         }
-        u32 end = block.branch.ignore ? block.end + 1 : block.end;
-        state.manager->InsertBlock(block.start, end);
-        if (!block.branch.ignore) {
-            InsertBranch(*state.manager, block.branch);
+        const u32 end = block.ignore_branch ? block.end + 1 : block.end;
+        manager.InsertBlock(block.start, end);
+        if (!block.ignore_branch) {
+            InsertBranch(manager, block.branch);
         }
     }
-    state.manager->Decompile();
+    manager.Decompile();
 }
 
-std::unique_ptr<ShaderCharacteristics> ScanFlow(const ProgramCode& program_code,
-                                                std::size_t program_size, u32 start_address,
-                                                const CompilerSettings& settings) {
-    auto result_out = std::make_unique<ShaderCharacteristics>();
-    if (settings.depth == CompileDepth::BruteForce) {
-        result_out->settings.depth = CompileDepth::BruteForce;
-        return result_out;
-    }
+constexpr bool IsDecompiledDepth(CompileDepth depth) {
+    return depth == CompileDepth::DecompileBackwards || depth == CompileDepth::FullDecompile;
+}
+
+/// Runs the control flow analysis of a program. When the program could be structured, the
+/// resulting AST is stored in the passed manager.
+ShaderFlowInfo AnalyzeFlow(const ProgramCode& program_code, std::size_t program_size,
+                           u32 start_address, const CompilerSettings& settings,
+                           ASTManager& manager) {
+    ShaderFlowInfo flow;
 
     CFGRebuildState state{program_code, program_size, start_address};
     // Inspect Code and generate blocks
@@ -489,8 +501,8 @@ std::unique_ptr<ShaderCharacteristics> ScanFlow(const ProgramCode& program_code,
     state.inspect_queries.push_back(state.start);
     while (!state.inspect_queries.empty()) {
         if (!TryInspectAddress(state)) {
-            result_out->settings.depth = CompileDepth::BruteForce;
-            return result_out;
+            flow.depth = CompileDepth::BruteForce;
+            return flow;
         }
     }
 
@@ -515,35 +527,10 @@ std::unique_ptr<ShaderCharacteristics> ScanFlow(const ProgramCode& program_code,
     // Sort and organize results
     std::sort(state.block_info.begin(), state.block_info.end(),
               [](const BlockInfo& a, const BlockInfo& b) -> bool { return a.start < b.start; });
-    if (decompiled && settings.depth != CompileDepth::NoFlowStack) {
-        ASTManager manager{settings.depth != CompileDepth::DecompileBackwards,
-                           settings.disable_else_derivation};
-        state.manager = &manager;
-        DecompileShader(state);
-        decompiled = state.manager->IsFullyDecompiled();
-        if (!decompiled) {
-            if (settings.depth == CompileDepth::FullDecompile) {
-                LOG_CRITICAL(HW_GPU, "Failed to remove all the gotos!:");
-            } else {
-                LOG_CRITICAL(HW_GPU, "Failed to remove all backward gotos!:");
-            }
-            state.manager->ShowCurrentState("Of Shader");
-            state.manager->Clear();
-        } else {
-            auto characteristics = std::make_unique<ShaderCharacteristics>();
-            characteristics->start = start_address;
-            characteristics->settings.depth = settings.depth;
-            characteristics->manager = std::move(manager);
-            characteristics->end = state.block_info.back().end + 1;
-            return characteristics;
-        }
-    }
 
-    result_out->start = start_address;
-    result_out->settings.depth =
-        use_flow_stack ? CompileDepth::FlowStack : CompileDepth::NoFlowStack;
-    result_out->blocks.clear();
-    for (auto& block : state.block_info) {
+    flow.start = start_address;
+    flow.blocks.reserve(state.block_info.size());
+    for (const auto& block : state.block_info) {
         ShaderBlock new_block{};
         new_block.start = block.start;
         new_block.end = block.end;
@@ -553,26 +540,207 @@ std::unique_ptr<ShaderCharacteristics> ScanFlow(const ProgramCode& program_code,
             new_block.branch.kills = block.branch.kill;
             new_block.branch.address = block.branch.address;
         }
-        result_out->end = std::max(result_out->end, block.end);
-        result_out->blocks.push_back(new_block);
+        flow.end = std::max(flow.end, block.end);
+        flow.blocks.push_back(new_block);
     }
+
+    if (decompiled && settings.depth != CompileDepth::NoFlowStack) {
+        ASTManager candidate{settings.depth != CompileDepth::DecompileBackwards,
+                             settings.disable_else_derivation};
+        DecompileShader(candidate, flow.blocks, state.labels);
+        if (!candidate.IsFullyDecompiled()) {
+            if (settings.depth == CompileDepth::FullDecompile) {
+                LOG_CRITICAL(HW_GPU, "Failed to remove all the gotos!:");
+            } else {
+                LOG_CRITICAL(HW_GPU, "Failed to remove all backward gotos!:");
+            }
+            candidate.ShowCurrentState("Of Shader");
+            candidate.Clear();
+        } else {
+            flow.depth = settings.depth;
+            flow.end = state.block_info.back().end + 1;
+            flow.labels = std::move(state.labels);
+            manager = std::move(candidate);
+            return flow;
+        }
+    }
+
+    flow.depth = use_flow_stack ? CompileDepth::FlowStack : CompileDepth::NoFlowStack;
     if (!use_flow_stack) {
-        result_out->labels = std::move(state.labels);
-        return result_out;
+        flow.labels = std::move(state.labels);
+        return flow;
     }
 
-    auto back = result_out->blocks.begin();
-    auto next = std::next(back);
-    while (next != result_out->blocks.end()) {
-        if (state.labels.count(next->start) == 0 && next->start == back->end + 1) {
-            back->end = next->end;
-            next = result_out->blocks.erase(next);
+    // Merge contiguous blocks that are not the target of any branch
+    auto& blocks = flow.blocks;
+    std::size_t back = 0;
+    for (std::size_t next = 1; next < blocks.size(); ++next) {
+        if (state.labels.count(blocks[next].start) == 0 &&
+            blocks[next].start == blocks[back].end + 1) {
+            blocks[back].end = blocks[next].end;
             continue;
         }
-        back = next;
-        ++next;
+        blocks[++back] = blocks[next];
+    }
+    if (!blocks.empty()) {
+        blocks.resize(back + 1);
+    }
+
+    return flow;
+}
+
+void FillCharacteristics(ShaderCharacteristics& characteristics, const ShaderFlowInfo& flow) {
+    characteristics.start = flow.start;
+    characteristics.end = flow.end;
+    characteristics.settings.depth = flow.depth;
+    switch (flow.depth) {
+    case CompileDepth::NoFlowStack:
+        characteristics.labels = flow.labels;
+        [[fallthrough]];
+    case CompileDepth::FlowStack:
+        characteristics.blocks.assign(flow.blocks.begin(), flow.blocks.end());
+        break;
+    default:
+        break;
+    }
+}
+
+} // Anonymous namespace
+
+ShaderFlowCache::ShaderFlowCache() = default;
+
+ShaderFlowCache::~ShaderFlowCache() = default;
+
+std::shared_ptr<const ShaderFlowInfo> ShaderFlowCache::Find(const ShaderFlowKey& key) const {
+    std::scoped_lock lock{mutex};
+    const auto it = entries.find(key);
+    if (it == entries.end()) {
+        ++misses;
+        return nullptr;
+    }
+    ++hits;
+    return it->second;
+}
+
+void ShaderFlowCache::Insert(const ShaderFlowKey& key, std::shared_ptr<const ShaderFlowInfo> flow) {
+    std::scoped_lock lock{mutex};
+    if (entries.insert_or_assign(key, std::move(flow)).second) {
+        new_entries.push_back(key);
+    }
+}
+
+void ShaderFlowCache::Load(const ShaderFlowKey& key, std::shared_ptr<const ShaderFlowInfo> flow) {
+    std::scoped_lock lock{mutex};
+    entries.insert_or_assign(key, std::move(flow));
+}
+
+std::vector<ShaderFlowCache::Entry> ShaderFlowCache::TakeNewEntries() {
+    std::scoped_lock lock{mutex};
+    std::vector<Entry> result;
+    result.reserve(new_entries.size());
+    for (const auto& key : new_entries) {
+        result.emplace_back(key, entries.at(key));
+    }
+    new_entries.clear();
+    return result;
+}
+
+ShaderFlowKey MakeShaderFlowKey(const ProgramCode& program_code, std::size_t program_size,
+                                u32 start_address, const CompilerSettings& settings) {
+    const std::size_t code_size = std::min(program_size, program_code.size() * sizeof(u64));
+    ShaderFlowKey key;
+    key.code_hash = Common::CityHash64(reinterpret_cast<const char*>(program_code.data()),
+                                       code_size);
+    key.code_size = static_cast<u32>(code_size);
+    key.start_address = start_address;
+    key.depth = settings.depth;
+    key.disable_else_derivation = settings.disable_else_derivation ? 1 : 0;
+    return key;
+}
+
+std::optional<u32> LoadShaderFlow(FileUtil::IOFile& file, ShaderFlowKey& key,
+                                  ShaderFlowInfo& flow) {
+    u32 version{};
+    u32 depth{};
+    u32 blocks_count{};
+    u32 labels_count{};
+    if (file.ReadBytes(&version, sizeof(u32)) != sizeof(u32) ||
+        file.ReadBytes(&key, sizeof(key)) != sizeof(key) ||
+        file.ReadBytes(&depth, sizeof(u32)) != sizeof(u32) ||
+        file.ReadBytes(&flow.start, sizeof(u32)) != sizeof(u32) ||
+        file.ReadBytes(&flow.end, sizeof(u32)) != sizeof(u32) ||
+        file.ReadBytes(&blocks_count, sizeof(u32)) != sizeof(u32) ||
+        file.ReadBytes(&labels_count, sizeof(u32)) != sizeof(u32)) {
+        return {};
+    }
+    flow.depth = static_cast<CompileDepth>(depth);
+
+    // Don't trust the counts of a corrupted file to size the allocations
+    const u64 remaining = file.GetSize() - file.Tell();
+    if (u64{blocks_count} * sizeof(ShaderBlock) + u64{labels_count} * sizeof(u32) > remaining) {
+        return {};
+    }
+
+    flow.blocks.resize(blocks_count);
+    if (file.ReadArray(flow.blocks.data(), blocks_count) != blocks_count) {
+        return {};
+    }
+
+    std::vector<u32> labels(labels_count);
+    if (file.ReadArray(labels.data(), labels_count) != labels_count) {
+        return {};
+    }
+    flow.labels.insert(labels.begin(), labels.end());
+    return version;
+}
+
+bool SaveShaderFlow(FileUtil::IOFile& file, const ShaderFlowKey& key, const ShaderFlowInfo& flow) {
+    const std::vector<u32> labels(flow.labels.begin(), flow.labels.end());
+    const auto blocks_count = static_cast<u32>(flow.blocks.size());
+    const auto labels_count = static_cast<u32>(labels.size());
+    return file.WriteObject(flow_analysis_version) == 1 && file.WriteObject(key) == 1 &&
+           file.WriteObject(static_cast<u32>(flow.depth)) == 1 &&
+           file.WriteObject(flow.start) == 1 && file.WriteObject(flow.end) == 1 &&
+           file.WriteObject(blocks_count) == 1 && file.WriteObject(labels_count) == 1 &&
+           file.WriteArray(flow.blocks.data(), blocks_count) == blocks_count &&
+           file.WriteArray(labels.data(), labels_count) == labels_count;
+}
+
+std::unique_ptr<ShaderCharacteristics> ScanFlow(const ProgramCode& program_code,
+                                                std::size_t program_size, u32 start_address,
+                                                const CompilerSettings& settings,
+                                                ShaderFlowCache* flow_cache) {
+    auto result_out = std::make_unique<ShaderCharacteristics>();
+    if (settings.depth == CompileDepth::BruteForce) {
+        result_out->settings.depth = CompileDepth::BruteForce;
+        return result_out;
+    }
+
+    if (!flow_cache) {
+        FillCharacteristics(*result_out, AnalyzeFlow(program_code, program_size, start_address,
+                                                     settings, result_out->manager));
+        return result_out;
+    }
+
+    const auto key = MakeShaderFlowKey(program_code, program_size, start_address, settings);
+    if (const auto flow = flow_cache->Find(key)) {
+        if (IsDecompiledDepth(flow->depth)) {
+            // The AST is consumed by the IR, so it's rebuilt from the cached blocks. The stored
+            // depth guarantees this will succeed.
+            ASTManager manager{flow->depth != CompileDepth::DecompileBackwards,
+                               settings.disable_else_derivation};
+            DecompileShader(manager, flow->blocks, flow->labels);
+            result_out->manager = std::move(manager);
+        }
+        FillCharacteristics(*result_out, *flow);
+        return result_out;
     }
 
+    auto flow = std::make_shared<ShaderFlowInfo>(
+        AnalyzeFlow(program_code, program_size, start_address, settings, result_out->manager));
+    FillCharacteristics(*result_out, *flow);
+    flow_cache->Insert(key, std::move(flow));
     return result_out;
 }
+
 } // namespace VideoCommon::Shader
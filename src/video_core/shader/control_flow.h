@@ -4,15 +4,27 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <list>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <set>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "video_core/engines/shader_bytecode.h"
 #include "video_core/shader/ast.h"
 #include "video_core/shader/compiler_settings.h"
 #include "video_core/shader/shader_ir.h"
 
+namespace FileUtil {
+class IOFile;
+}
+
 namespace VideoCommon::Shader {
 
 using Tegra::Shader::ConditionCode;
@@ -20,6 +32,9 @@ using Tegra::Shader::Pred;
 
 constexpr s32 exit_branch = -1;
 
+/// Bump this whenever the output of the control flow analysis changes, it invalidates stored flows
+constexpr u32 flow_analysis_version = 1;
+
 struct Condition {
     Pred predicate{Pred::UnusedIndex};
     ConditionCode cc{ConditionCode::T};
@@ -76,8 +91,114 @@ struct ShaderCharacteristics {
     CompilerSettings settings{};
 };
 
+/// Identifies a control flow analysis by the contents of the program and how it was analyzed
+struct ShaderFlowKey {
+    u64 code_hash{};
+    u32 code_size{};
+    u32 start_address{};
+    CompileDepth depth{};
+    u32 disable_else_derivation{};
+
+    bool operator==(const ShaderFlowKey& rhs) const {
+        return std::tie(code_hash, code_size, start_address, depth, disable_else_derivation) ==
+               std::tie(rhs.code_hash, rhs.code_size, rhs.start_address, rhs.depth,
+                        rhs.disable_else_derivation);
+    }
+
+    bool operator!=(const ShaderFlowKey& rhs) const {
+        return !operator==(rhs);
+    }
+};
+static_assert(sizeof(ShaderFlowKey) == 24, "ShaderFlowKey has an invalid size");
+
+} // namespace VideoCommon::Shader
+
+namespace std {
+
+template <>
+struct hash<VideoCommon::Shader::ShaderFlowKey> {
+    std::size_t operator()(const VideoCommon::Shader::ShaderFlowKey& key) const noexcept {
+        return static_cast<std::size_t>(key.code_hash) ^
+               (static_cast<std::size_t>(key.start_address) << 16) ^
+               (static_cast<std::size_t>(key.depth) << 8) ^
+               static_cast<std::size_t>(key.disable_else_derivation);
+    }
+};
+
+} // namespace std
+
+namespace VideoCommon::Shader {
+
+/// Result of the control flow analysis of a program, enough to rebuild its characteristics
+/// (including the structured AST) without scanning the program again.
+struct ShaderFlowInfo {
+    CompileDepth depth{CompileDepth::BruteForce}; ///< Depth the analysis was able to reach
+    u32 start{};
+    u32 end{};
+    std::vector<ShaderBlock> blocks;
+    std::set<u32> labels;
+};
+
+/// Caches control flow analyses keyed by the hash of the analyzed code. It's shared by all the
+/// ShaderIR instances of a renderer, so the same program found at a different address or used by
+/// a different variant is only scanned once.
+class ShaderFlowCache final {
+public:
+    using Entry = std::pair<ShaderFlowKey, std::shared_ptr<const ShaderFlowInfo>>;
+
+    ShaderFlowCache();
+    ~ShaderFlowCache();
+
+    /// Returns the cached flow for the given key, or nullptr when it's not cached.
+    std::shared_ptr<const ShaderFlowInfo> Find(const ShaderFlowKey& key) const;
+
+    /// Registers a freshly analyzed flow. It will be returned by the next TakeNewEntries call.
+    void Insert(const ShaderFlowKey& key, std::shared_ptr<const ShaderFlowInfo> flow);
+
+    /// Registers a flow loaded from a persistent cache.
+    void Load(const ShaderFlowKey& key, std::shared_ptr<const ShaderFlowInfo> flow);
+
+    /// Returns the flows inserted since the last call, so they can be persisted.
+    std::vector<Entry> TakeNewEntries();
+
+    std::size_t GetHits() const {
+        return hits;
+    }
+
+    std::size_t GetMisses() const {
+        return misses;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::unordered_map<ShaderFlowKey, std::shared_ptr<const ShaderFlowInfo>> entries;
+    std::vector<ShaderFlowKey> new_entries;
+    // Updated under the mutex, atomic so the getters can read them without taking it
+    mutable std::atomic<std::size_t> hits{};
+    mutable std::atomic<std::size_t> misses{};
+};
+
+/// Builds the key used to cache the control flow analysis of a program.
+ShaderFlowKey MakeShaderFlowKey(const ProgramCode& program_code, std::size_t program_size,
+                                u32 start_address, const CompilerSettings& settings);
+
+/**
+ * Loads a control flow stored with SaveShaderFlow.
+ * @returns The analysis version the flow was stored with, or nullopt when the entry is invalid
+ */
+std::optional<u32> LoadShaderFlow(FileUtil::IOFile& file, ShaderFlowKey& key,
+                                  ShaderFlowInfo& flow);
+
+/// Stores a control flow tagged with the current analysis version.
+bool SaveShaderFlow(FileUtil::IOFile& file, const ShaderFlowKey& key, const ShaderFlowInfo& flow);
+
+/**
+ * Analyzes the control flow of a program.
+ * @param flow_cache Optional cache used to skip the analysis of already seen programs
+ */
 std::unique_ptr<ShaderCharacteristics> ScanFlow(const ProgramCode& program_code,
                                                 std::size_t program_size, u32 start_address,
-                                                const CompilerSettings& settings);
+                                                const CompilerSettings& settings,
+                                                ShaderFlowCache* flow_cache = nullptr);
 
 } // namespace VideoCommon::Shader
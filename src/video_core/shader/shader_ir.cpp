@@ -24,9 +24,9 @@ using Tegra::Shader::PredOperation;
 using Tegra::Shader::Register;
 
 ShaderIR::ShaderIR(const ProgramCode& program_code, u32 main_offset, const std::size_t size,
-                   CompilerSettings settings)
+                   CompilerSettings settings, ShaderFlowCache* flow_cache)
     : program_code{program_code}, main_offset{main_offset}, program_size{size}, basic_blocks{},
-      program_manager{true, true}, settings{settings} {
+      program_manager{true, true}, settings{settings}, flow_cache{flow_cache} {
     Decode();
 }
 
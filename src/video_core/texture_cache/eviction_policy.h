@@ -0,0 +1,75 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace VideoCommon {
+
+/// Decides which surfaces a texture cache drops to keep its host memory within a budget
+class EvictionPolicy {
+public:
+    /// Surfaces used in more frames than this are only evicted after the rarely used ones
+    static constexpr u32 HOT_USE_FREQUENCY = 8;
+
+    /// @param budget Host memory budget in bytes, zero disables eviction
+    explicit EvictionPolicy(u64 budget) : budget{budget} {}
+
+    bool IsEnabled() const {
+        return budget != 0;
+    }
+
+    bool IsOverBudget(u64 resident_bytes) const {
+        return IsEnabled() && resident_bytes > budget;
+    }
+
+    /// Returns the resident memory evictions stop at. It's a bit below the budget so the next
+    /// frames don't have to evict again.
+    u64 GetTarget() const {
+        return budget - budget / 8;
+    }
+
+    /**
+     * Evicts candidates until the resident memory is below the target. Unregistered surfaces go
+     * first, then registered surfaces that are rarely used, then the rest in LRU order.
+     * @param evict Called with each surface to evict, returns the resident bytes it freed
+     */
+    template <typename TSurface, typename Func>
+    void Evict(std::vector<TSurface> candidates, u64 resident_bytes, Func&& evict) const {
+        if (!IsOverBudget(resident_bytes)) {
+            return;
+        }
+        const auto eviction_key = [](const TSurface& surface) {
+            return std::make_tuple(surface->IsRegistered(),
+                                   surface->GetUseFrequency() > HOT_USE_FREQUENCY,
+                                   surface->GetLastUseFrame());
+        };
+        std::sort(candidates.begin(), candidates.end(),
+                  [&eviction_key](const TSurface& a, const TSurface& b) {
+                      return eviction_key(a) < eviction_key(b);
+                  });
+
+        const u64 target = GetTarget();
+        for (const auto& surface : candidates) {
+            if (resident_bytes <= target) {
+                break;
+            }
+            resident_bytes -= std::min(evict(surface), resident_bytes);
+        }
+
+        for (const auto& surface : candidates) {
+            surface->DecayUseFrequency();
+        }
+    }
+
+private:
+    u64 budget;
+};
+
+} // namespace VideoCommon
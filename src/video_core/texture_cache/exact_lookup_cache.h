@@ -0,0 +1,75 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+
+#include "common/common_types.h"
+#include "common/paged_range_index.h"
+
+namespace VideoCommon {
+
+/**
+ * Remembers the results of lookups keyed by their exact arguments. Each result is associated to
+ * the range of guest memory the lookup depended on, and it's dropped when the cached objects in
+ * that range change.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class ExactLookupCache {
+public:
+    /// Returns the cached result of a lookup, or nullptr when it's not cached.
+    const Value* Find(const Key& key) const {
+        const auto it = entries.find(key);
+        return it != entries.end() ? &it->second.value : nullptr;
+    }
+
+    /// Caches the result of a lookup that depended on the [start, end) range.
+    void Insert(const Key& key, u64 start, u64 end, Value value) {
+        if (start >= end) {
+            return;
+        }
+        if (entries.try_emplace(key, Entry{std::move(value), start, end}).second) {
+            ranges.Insert(start, end, key);
+        }
+    }
+
+    /// Drops the results of the lookups that depended on memory overlapping [start, end).
+    void Invalidate(u64 start, u64 end) {
+        auto keys = ranges.Collect(query_buffer, start, end);
+        for (const Key& key : *keys) {
+            const auto it = entries.find(key);
+            ranges.Erase(it->second.start, it->second.end, key);
+            entries.erase(it);
+        }
+    }
+
+    void Clear() {
+        entries.clear();
+        ranges.Clear();
+    }
+
+    std::size_t Size() const {
+        return entries.size();
+    }
+
+private:
+    struct Entry {
+        Value value;
+        u64 start;
+        u64 end;
+    };
+
+    // Lookups are usually for small textures, bucket them by 64KiB pages
+    static constexpr std::size_t page_bits{16};
+
+    std::unordered_map<Key, Entry, Hash> entries;
+    Common::PagedRangeIndex<Key, page_bits> ranges;
+    Common::QueryBuffer<Key> query_buffer;
+};
+
+} // namespace VideoCommon
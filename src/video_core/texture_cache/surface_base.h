@@ -204,10 +204,6 @@ public:
         index = index_;
     }
 
-    void MarkAsPicked(bool is_picked_) {
-        is_picked = is_picked_;
-    }
-
     bool IsModified() const {
         return is_modified;
     }
@@ -229,10 +225,6 @@ public:
         return is_registered;
     }
 
-    bool IsPicked() const {
-        return is_picked;
-    }
-
     void MarkAsRegistered(bool is_reg) {
         is_registered = is_reg;
     }
@@ -241,6 +233,40 @@ public:
         return modification_tick;
     }
 
+    /// Records an access to the surface during a frame, used to pick eviction candidates. The
+    /// use frequency counts the frames the surface was used in.
+    void MarkAsUsed(u64 frame) {
+        if (last_use_frame == frame) {
+            return;
+        }
+        last_use_frame = frame;
+        if (use_frequency < MAX_USE_FREQUENCY) {
+            ++use_frequency;
+        }
+    }
+
+    u64 GetLastUseFrame() const {
+        return last_use_frame;
+    }
+
+    u32 GetUseFrequency() const {
+        return use_frequency;
+    }
+
+    /// Ages the access frequency so surfaces that stopped being used can be evicted
+    void DecayUseFrequency() {
+        use_frequency /= 2;
+    }
+
+    /// Returns true when the cache owns the surface and counts it in its resident memory
+    bool IsResident() const {
+        return is_resident;
+    }
+
+    void MarkAsResident(bool is_resident_) {
+        is_resident = is_resident_;
+    }
+
     TView EmplaceOverview(const SurfaceParams& overview_params) {
         const u32 num_layers{(params.is_layered && !overview_params.is_layered) ? 1 : params.depth};
         return GetView(ViewParams(overview_params.target, 0, num_layers, 0, params.num_levels));
@@ -312,13 +338,16 @@ private:
     }
 
     static constexpr u32 NO_RT = 0xFFFFFFFF;
+    static constexpr u32 MAX_USE_FREQUENCY = 0xFF;
 
     bool is_modified{};
     bool is_target{};
     bool is_registered{};
-    bool is_picked{};
+    bool is_resident{};
     u32 index{NO_RT};
     u64 modification_tick{};
+    u64 last_use_frame{};
+    u32 use_frequency{};
 };
 
 } // namespace VideoCommon
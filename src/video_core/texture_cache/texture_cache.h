@@ -13,22 +13,27 @@
 #include <unordered_map>
 #include <vector>
 
+#include <boost/functional/hash.hpp>
 #include <boost/icl/interval_map.hpp>
 #include <boost/range/iterator_range.hpp>
 
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/math_util.h"
+#include "common/paged_range_index.h"
 #include "core/core.h"
 #include "core/memory.h"
 #include "core/settings.h"
 #include "video_core/engines/fermi_2d.h"
 #include "video_core/engines/maxwell_3d.h"
+#include "video_core/engines/maxwell_dma.h"
 #include "video_core/gpu.h"
 #include "video_core/memory_manager.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/surface.h"
 #include "video_core/texture_cache/copy_params.h"
+#include "video_core/texture_cache/eviction_policy.h"
+#include "video_core/texture_cache/exact_lookup_cache.h"
 #include "video_core/texture_cache/surface_base.h"
 #include "video_core/texture_cache/surface_params.h"
 #include "video_core/texture_cache/surface_view.h"
@@ -48,6 +53,14 @@ using VideoCore::Surface::PixelFormat;
 using VideoCore::Surface::SurfaceTarget;
 using RenderTargetConfig = Tegra::Engines::Maxwell3D::Regs::RenderTargetConfig;
 
+/// Surface lookup statistics of a texture cache during a frame
+struct TextureCacheStats {
+    u64 exact_hits{};      ///< Lookups resolved by the exact match cache
+    u64 lookups{};         ///< Lookups that had to inspect the registered surfaces
+    u64 reconstructions{}; ///< Surfaces rebuilt from one or more overlaps
+    u64 recycles{};        ///< Lookups that discarded their overlaps
+};
+
 template <typename TSurface, typename TView>
 class TextureCache {
     using IntervalMap = boost::icl::interval_map<CacheAddr, std::set<TSurface>>;
@@ -57,7 +70,8 @@ public:
     void InvalidateRegion(CacheAddr addr, std::size_t size) {
         std::lock_guard lock{mutex};
 
-        for (const auto& surface : GetSurfacesInRegion(addr, size)) {
+        auto surfaces = GetSurfacesInRegion(addr, size);
+        for (const auto& surface : *surfaces) {
             Unregister(surface);
         }
     }
@@ -74,10 +88,23 @@ public:
         guard_samplers = new_guard;
     }
 
+    /// Drops the GPU modifications of the surfaces overlapping a range the guest memory was
+    /// overwritten in, invalidating the range later unregisters them without a flush anyway
+    void MarkRegionOverwritten(CacheAddr addr, std::size_t size) {
+        std::lock_guard lock{mutex};
+
+        for (const auto& surface : registry.Query(addr, addr + size)) {
+            if (surface->IsModified()) {
+                surface->MarkAsModified(false, Tick());
+            }
+        }
+    }
+
     void FlushRegion(CacheAddr addr, std::size_t size) {
         std::lock_guard lock{mutex};
 
-        auto surfaces = GetSurfacesInRegion(addr, size);
+        auto results = GetSurfacesInRegion(addr, size);
+        std::vector<TSurface>& surfaces = *results;
         if (surfaces.empty()) {
             return;
         }
@@ -98,6 +125,7 @@ public:
         }
         const auto params{SurfaceParams::CreateForTexture(tic, entry)};
         const auto [surface, view] = GetSurface(gpu_addr, params, true, false);
+        MarkAsUsed(surface);
         if (guard_samplers) {
             sampled_textures.push_back(surface);
         }
@@ -113,6 +141,7 @@ public:
         }
         const auto params{SurfaceParams::CreateForImage(tic, entry)};
         const auto [surface, view] = GetSurface(gpu_addr, params, true, false);
+        MarkAsUsed(surface);
         if (guard_samplers) {
             sampled_textures.push_back(surface);
         }
@@ -147,6 +176,7 @@ public:
             regs.zeta.memory_layout.block_width, regs.zeta.memory_layout.block_height,
             regs.zeta.memory_layout.block_depth, regs.zeta.memory_layout.type)};
         auto surface_view = GetSurface(gpu_addr, depth_params, preserve_contents, true);
+        MarkAsUsed(surface_view.first);
         if (depth_buffer.target)
             depth_buffer.target->MarkAsRenderTarget(false, NO_RT);
         depth_buffer.target = surface_view.first;
@@ -181,6 +211,7 @@ public:
 
         auto surface_view = GetSurface(gpu_addr, SurfaceParams::CreateForFramebuffer(system, index),
                                        preserve_contents, true);
+        MarkAsUsed(surface_view.first);
         if (render_targets[index].target)
             render_targets[index].target->MarkAsRenderTarget(false, NO_RT);
         render_targets[index].target = surface_view.first;
@@ -231,32 +262,110 @@ public:
         DeduceBestBlit(src_params, dst_params, src_gpu_addr, dst_gpu_addr);
         std::pair<TSurface, TView> dst_surface = GetSurface(dst_gpu_addr, dst_params, true, false);
         std::pair<TSurface, TView> src_surface = GetSurface(src_gpu_addr, src_params, true, false);
+        MarkAsUsed(dst_surface.first);
+        MarkAsUsed(src_surface.first);
         ImageBlit(src_surface.second, dst_surface.second, copy_config);
         dst_surface.first->MarkAsModified(true, Tick());
     }
 
+    /**
+     * Copies the subrect of a DMA copy on the host when both the pitch linear and the block linear
+     * sides are surfaces starting at the copy addresses, with the layout described by the copy.
+     * Returns false when the guest memory has to be copied instead.
+     */
+    bool TryDMACopy(const Tegra::Engines::MaxwellDMA::Regs& regs) {
+        std::lock_guard lock{mutex};
+        const bool src_linear = regs.exec.is_src_linear != 0;
+        const auto& tiled_params = src_linear ? regs.dst_params : regs.src_params;
+        const u32 pitch = src_linear ? regs.src_pitch : regs.dst_pitch;
+        if (tiled_params.pos_z != 0 || tiled_params.BlockDepth() != 0 || regs.x_count == 0) {
+            return false;
+        }
+        const u32 bytes_per_pixel = pitch / regs.x_count;
+
+        auto& memory_manager = system.GPU().MemoryManager();
+        TSurface src_surface =
+            FindSurfaceAt(ToCacheAddr(memory_manager.GetPointer(regs.src_address.Address())));
+        TSurface dst_surface =
+            FindSurfaceAt(ToCacheAddr(memory_manager.GetPointer(regs.dst_address.Address())));
+        if (!src_surface || !dst_surface || src_surface == dst_surface) {
+            return false;
+        }
+        TSurface& linear_surface = src_linear ? src_surface : dst_surface;
+        TSurface& tiled_surface = src_linear ? dst_surface : src_surface;
+
+        const SurfaceParams& linear = linear_surface->GetSurfaceParams();
+        const SurfaceParams& tiled = tiled_surface->GetSurfaceParams();
+        const u32 end_x = tiled_params.pos_x + regs.x_count;
+        const u32 end_y = tiled_params.pos_y + regs.y_count;
+        if (linear.is_tiled || linear.pitch != pitch || linear.height < regs.y_count ||
+            linear.width < regs.x_count || linear.GetBytesPerPixel() != bytes_per_pixel ||
+            !tiled.is_tiled || tiled.target != SurfaceTarget::Texture2D ||
+            tiled.width != tiled_params.size_x || tiled.height < end_y || tiled.width < end_x ||
+            tiled.block_height != tiled_params.BlockHeight() ||
+            tiled.GetBytesPerPixel() != bytes_per_pixel || tiled.IsCompressed()) {
+            return false;
+        }
+
+        const u32 pos_x = tiled_params.pos_x;
+        const u32 pos_y = tiled_params.pos_y;
+        const u32 src_x = src_linear ? 0 : pos_x;
+        const u32 src_y = src_linear ? 0 : pos_y;
+        const u32 dst_x = src_linear ? pos_x : 0;
+        const u32 dst_y = src_linear ? pos_y : 0;
+        MarkAsUsed(src_surface);
+        MarkAsUsed(dst_surface);
+        ImageCopy(src_surface, dst_surface,
+                  CopyParams(src_x, src_y, 0, dst_x, dst_y, 0, 0, 0, regs.x_count, regs.y_count,
+                             1));
+        dst_surface->MarkAsModified(true, Tick());
+        return true;
+    }
+
     TSurface TryFindFramebufferSurface(const u8* host_ptr) {
-        const CacheAddr cache_addr = ToCacheAddr(host_ptr);
-        if (!cache_addr) {
-            return nullptr;
-        }
-        const CacheAddr page = cache_addr >> registry_page_bits;
-        std::vector<TSurface>& list = registry[page];
-        for (auto& surface : list) {
-            if (surface->GetCacheAddr() == cache_addr) {
-                return surface;
-            }
-        }
-        return nullptr;
+        TSurface surface = FindSurfaceAt(ToCacheAddr(host_ptr));
+        MarkAsUsed(surface);
+        return surface;
     }
 
     u64 Tick() {
         return ++ticks;
     }
 
+    /// Evicts the least recently used surfaces when the cache is above its memory budget
+    void TickFrame() {
+        std::lock_guard lock{mutex};
+
+        last_frame_stats = std::exchange(frame_stats, {});
+        LOG_TRACE(HW_GPU, "Texture cache: {} exact hits, {} lookups, {} reconstructions, {} recycles",
+                  last_frame_stats.exact_hits, last_frame_stats.lookups,
+                  last_frame_stats.reconstructions, last_frame_stats.recycles);
+
+        if (eviction_policy.IsOverBudget(resident_bytes)) {
+            EvictSurfaces();
+        }
+        ++current_frame;
+    }
+
+    /// Returns the surface lookup statistics of the last completed frame
+    TextureCacheStats GetLastFrameStats() const {
+        return last_frame_stats;
+    }
+
+    /// Returns the host memory used by all the surfaces owned by the cache
+    u64 GetResidentBytes() const {
+        return resident_bytes;
+    }
+
+    /// Returns the host memory used by the surfaces of the given format
+    u64 GetResidentBytes(PixelFormat format) const {
+        return resident_bytes_per_format[static_cast<std::size_t>(format)];
+    }
+
 protected:
     TextureCache(Core::System& system, VideoCore::RasterizerInterface& rasterizer)
-        : system{system}, rasterizer{rasterizer} {
+        : system{system}, rasterizer{rasterizer},
+          eviction_policy{static_cast<u64>(Settings::values.texture_cache_budget) << 20} {
         for (std::size_t i = 0; i < Tegra::Engines::Maxwell3D::Regs::NumRenderTargets; i++) {
             SetEmptyColorBuffer(i);
         }
@@ -312,12 +421,14 @@ protected:
                          gpu_addr);
             return;
         }
+        MarkAsResident(surface);
         const bool continuous = system.GPU().MemoryManager().IsBlockContinuous(gpu_addr, size);
         surface->MarkAsContinuous(continuous);
         surface->SetCacheAddr(cache_ptr);
         surface->SetCpuAddr(*cpu_addr);
         RegisterInnerCache(surface);
         surface->MarkAsRegistered(true);
+        exact_cache.Invalidate(surface->GetCacheAddr(), surface->GetCacheAddrEnd());
         rasterizer.UpdatePagesCachedCount(*cpu_addr, size, 1);
     }
 
@@ -333,6 +444,7 @@ protected:
         rasterizer.UpdatePagesCachedCount(cpu_addr, size, -1);
         UnregisterInnerCache(surface);
         surface->MarkAsRegistered(false);
+        exact_cache.Invalidate(surface->GetCacheAddr(), surface->GetCacheAddrEnd());
         ReserveSurface(surface->GetSurfaceParams(), surface);
     }
 
@@ -438,6 +550,7 @@ private:
                                               const SurfaceParams& params, const GPUVAddr gpu_addr,
                                               const bool preserve_contents,
                                               const MatchTopologyResult untopological) {
+        ++frame_stats.recycles;
         const bool do_load = preserve_contents && Settings::values.use_accurate_gpu_emulation;
         for (auto& surface : overlaps) {
             Unregister(surface);
@@ -478,6 +591,7 @@ private:
      **/
     std::pair<TSurface, TView> RebuildSurface(TSurface current_surface, const SurfaceParams& params,
                                               bool is_render) {
+        ++frame_stats.reconstructions;
         const auto gpu_addr = current_surface->GetGpuAddr();
         const auto& cr_params = current_surface->GetSurfaceParams();
         TSurface new_surface;
@@ -559,6 +673,7 @@ private:
             const SurfaceParams& src_params = surface->GetSurfaceParams();
             if (src_params.is_layered || src_params.num_levels > 1) {
                 // We send this cases to recycle as they are more complex to handle
+                ReserveSurface(params, new_surface);
                 return {};
             }
             const std::size_t candidate_size = surface->GetSizeInBytes();
@@ -578,10 +693,11 @@ private:
             passed_tests++;
             ImageCopy(surface, new_surface, copy_params);
         }
-        if (passed_tests == 0) {
-            return {};
+        if (passed_tests == 0 ||
             // In Accurate GPU all tests should pass, else we recycle
-        } else if (Settings::values.use_accurate_gpu_emulation && passed_tests != overlaps.size()) {
+            (Settings::values.use_accurate_gpu_emulation && passed_tests != overlaps.size())) {
+            // Keep the new surface around so it can be reused and evicted
+            ReserveSurface(params, new_surface);
             return {};
         }
         for (const auto& surface : overlaps) {
@@ -589,6 +705,7 @@ private:
         }
         new_surface->MarkAsModified(modified, Tick());
         Register(new_surface);
+        ++frame_stats.reconstructions;
         return {{new_surface, new_surface->GetMainView()}};
     }
 
@@ -632,6 +749,15 @@ private:
             return InitializeSurface(gpu_addr, new_params, false);
         }
 
+        // Step 0.5
+        // Lookups identical to a previous one return the same surface and view until the
+        // registered surfaces they overlap change.
+        if (const auto result = exact_cache.Find({gpu_addr, cache_addr, is_render, params})) {
+            ++frame_stats.exact_hits;
+            return *result;
+        }
+        ++frame_stats.lookups;
+
         // Step 1
         // Check Level 1 Cache for a fast structural match. If candidate surface
         // matches at certain level we are pretty much done.
@@ -648,7 +774,11 @@ private:
                 (params.target != SurfaceTarget::Texture3D ||
                  current_surface->MatchTarget(params.target))) {
                 if (struct_result == MatchStructureResult::FullMatch) {
-                    return ManageStructuralMatch(current_surface, params, is_render);
+                    auto pair = ManageStructuralMatch(current_surface, params, is_render);
+                    if (pair.first == current_surface) {
+                        CacheExactLookup(gpu_addr, cache_addr, is_render, params, pair);
+                    }
+                    return pair;
                 } else {
                     return RebuildSurface(current_surface, params, is_render);
                 }
@@ -658,7 +788,8 @@ private:
         // Step 2
         // Obtain all possible overlaps in the memory region
         const std::size_t candidate_size = params.GetGuestSizeInBytes();
-        auto overlaps{GetSurfacesInRegion(cache_addr, candidate_size)};
+        auto results = GetSurfacesInRegion(cache_addr, candidate_size);
+        std::vector<TSurface>& overlaps = *results;
 
         // If none are found, we are done. we just load the surface and create it.
         if (overlaps.empty()) {
@@ -719,6 +850,8 @@ private:
                     return RecycleSurface(overlaps, params, gpu_addr, preserve_contents,
                                           MatchTopologyResult::FullMatch);
                 }
+                CacheExactLookup(gpu_addr, cache_addr, is_render, params,
+                                 {current_surface, *view});
                 return {current_surface, *view};
             }
         } else {
@@ -736,6 +869,18 @@ private:
                               MatchTopologyResult::FullMatch);
     }
 
+    /// Remembers a lookup that resolved to a registered surface. It stays valid until a surface
+    /// overlapping the looked up memory or the resolved surface is registered or unregistered.
+    void CacheExactLookup(GPUVAddr gpu_addr, CacheAddr cache_addr, bool is_render,
+                          const SurfaceParams& params, std::pair<TSurface, TView> result) {
+        const TSurface& surface = result.first;
+        const CacheAddr start = std::min(cache_addr, surface->GetCacheAddr());
+        const CacheAddr end = std::max<CacheAddr>(cache_addr + params.GetGuestSizeInBytes(),
+                                                  surface->GetCacheAddrEnd());
+        exact_cache.Insert({gpu_addr, cache_addr, is_render, params}, start, end,
+                           std::move(result));
+    }
+
     /**
      * Gets the starting address and parameters of a candidate surface and tries to find a
      * matching surface within the cache that's similar to it. If there are many textures
@@ -774,7 +919,8 @@ private:
         }
 
         const std::size_t candidate_size = params.GetGuestSizeInBytes();
-        auto overlaps{GetSurfacesInRegion(cache_addr, candidate_size)};
+        auto results = GetSurfacesInRegion(cache_addr, candidate_size);
+        std::vector<TSurface>& overlaps = *results;
 
         if (overlaps.empty()) {
             Deduction result{};
@@ -883,53 +1029,122 @@ private:
 
     void RegisterInnerCache(TSurface& surface) {
         const CacheAddr cache_addr = surface->GetCacheAddr();
-        CacheAddr start = cache_addr >> registry_page_bits;
-        const CacheAddr end = (surface->GetCacheAddrEnd() - 1) >> registry_page_bits;
         l1_cache[cache_addr] = surface;
-        while (start <= end) {
-            registry[start].push_back(surface);
-            start++;
-        }
+        registry.Insert(cache_addr, surface->GetCacheAddrEnd(), surface);
     }
 
     void UnregisterInnerCache(TSurface& surface) {
         const CacheAddr cache_addr = surface->GetCacheAddr();
-        CacheAddr start = cache_addr >> registry_page_bits;
-        const CacheAddr end = (surface->GetCacheAddrEnd() - 1) >> registry_page_bits;
         l1_cache.erase(cache_addr);
-        while (start <= end) {
-            auto& reg{registry[start]};
-            reg.erase(std::find(reg.begin(), reg.end(), surface));
-            start++;
+        registry.Erase(cache_addr, surface->GetCacheAddrEnd(), surface);
+    }
+
+    /// Returns the surfaces overlapping a region, copied to a reused buffer
+    typename Common::QueryBuffer<TSurface>::Results GetSurfacesInRegion(const CacheAddr cache_addr,
+                                                                        const std::size_t size) {
+        return registry.Collect(surfaces_query_buffer, cache_addr, cache_addr + size);
+    }
+
+    void ReserveSurface(const SurfaceParams& params, TSurface surface) {
+        auto& reserve{surface_reserve[params]};
+        // Surfaces taken from the reserve are still in it
+        if (std::find(reserve.begin(), reserve.end(), surface) == reserve.end()) {
+            MarkAsResident(surface);
+            reserve.push_back(std::move(surface));
         }
     }
 
-    std::vector<TSurface> GetSurfacesInRegion(const CacheAddr cache_addr, const std::size_t size) {
-        if (size == 0) {
-            return {};
+    /// Returns the registered surface starting at a host address, or null when there's none
+    TSurface FindSurfaceAt(CacheAddr cache_addr) {
+        if (!cache_addr) {
+            return nullptr;
+        }
+        for (const auto& surface : registry.Query(cache_addr, cache_addr + 1)) {
+            if (surface->GetCacheAddr() == cache_addr) {
+                return surface;
+            }
+        }
+        return nullptr;
+    }
+
+    void MarkAsUsed(const TSurface& surface) {
+        if (surface) {
+            surface->MarkAsUsed(current_frame);
         }
-        const CacheAddr cache_addr_end = cache_addr + size;
-        CacheAddr start = cache_addr >> registry_page_bits;
-        const CacheAddr end = (cache_addr_end - 1) >> registry_page_bits;
-        std::vector<TSurface> surfaces;
-        while (start <= end) {
-            std::vector<TSurface>& list = registry[start];
-            for (auto& surface : list) {
-                if (!surface->IsPicked() && surface->Overlaps(cache_addr, cache_addr_end)) {
-                    surface->MarkAsPicked(true);
-                    surfaces.push_back(surface);
+    }
+
+    /// Counts a surface in the resident memory once the cache holds it, either registered or
+    /// reserved. Surfaces that are neither are freed with their last user and never counted.
+    void MarkAsResident(const TSurface& surface) {
+        if (surface->IsResident()) {
+            return;
+        }
+        surface->MarkAsResident(true);
+        UpdateResidentBytes(surface, 1);
+    }
+
+    void UpdateResidentBytes(const TSurface& surface, int delta) {
+        const u64 size = surface->GetHostSizeInBytes();
+        const auto format = static_cast<std::size_t>(surface->GetSurfaceParams().pixel_format);
+        if (delta > 0) {
+            resident_bytes += size;
+            resident_bytes_per_format[format] += size;
+        } else {
+            resident_bytes -= size;
+            resident_bytes_per_format[format] -= size;
+        }
+    }
+
+    /// Drops surfaces until the resident memory is within the budget. Surfaces used during the
+    /// last frame and render targets are never evicted.
+    void EvictSurfaces() {
+        std::vector<TSurface> candidates;
+        for (const auto& [params, reserve] : surface_reserve) {
+            for (const auto& surface : reserve) {
+                if (!surface->IsRegistered()) {
+                    candidates.push_back(surface);
                 }
             }
-            start++;
         }
-        for (auto& surface : surfaces) {
-            surface->MarkAsPicked(false);
+        for (const auto& surface : registry.All()) {
+            if (surface->IsRenderTarget() || surface->GetLastUseFrame() == current_frame) {
+                continue;
+            }
+            candidates.push_back(surface);
         }
-        return surfaces;
+
+        eviction_policy.Evict(std::move(candidates), resident_bytes, [this](TSurface surface) {
+            const u64 resident_before = resident_bytes;
+            if (surface->IsRegistered()) {
+                // Write back what the GPU rendered before dropping the host copy
+                FlushSurface(surface);
+                Unregister(surface);
+                if (surface->IsRegistered()) {
+                    return u64{0};
+                }
+            }
+            ReleaseSurface(surface);
+            return resident_before - resident_bytes;
+        });
     }
 
-    void ReserveSurface(const SurfaceParams& params, TSurface surface) {
-        surface_reserve[params].push_back(std::move(surface));
+    /// Removes an unregistered surface from the reserve, destroying it once unreferenced
+    void ReleaseSurface(const TSurface& surface) {
+        const auto search{surface_reserve.find(surface->GetSurfaceParams())};
+        if (search == surface_reserve.end()) {
+            return;
+        }
+        auto& reserve{search->second};
+        const auto it{std::find(reserve.begin(), reserve.end(), surface)};
+        if (it == reserve.end()) {
+            return;
+        }
+        reserve.erase(it);
+        if (reserve.empty()) {
+            surface_reserve.erase(search);
+        }
+        surface->MarkAsResident(false);
+        UpdateResidentBytes(surface, -1);
     }
 
     TSurface TryGetReservedSurface(const SurfaceParams& params) {
@@ -958,6 +1173,15 @@ private:
 
     u64 ticks{};
 
+    // Eviction state
+    EvictionPolicy eviction_policy;
+    u64 current_frame{};
+    u64 resident_bytes{};
+    std::array<u64, static_cast<std::size_t>(PixelFormat::Max)> resident_bytes_per_format{};
+
+    TextureCacheStats frame_stats{};
+    TextureCacheStats last_frame_stats{};
+
     // Guards the cache for protection conflicts.
     bool guard_render_targets{};
     bool guard_samplers{};
@@ -969,10 +1193,10 @@ private:
 
     // The internal Cache is different for the Texture Cache. It's based on buckets
     // of 1MB. This fits better for the purpose of this cache as textures are normaly
-    // large in size.
+    // large in size. Each overlapping surface is reported once per query.
     static constexpr u64 registry_page_bits{20};
-    static constexpr u64 registry_page_size{1 << registry_page_bits};
-    std::unordered_map<CacheAddr, std::vector<TSurface>> registry;
+    Common::PagedRangeIndex<TSurface, registry_page_bits> registry;
+    Common::QueryBuffer<TSurface> surfaces_query_buffer;
 
     static constexpr u32 DEPTH_RT = 8;
     static constexpr u32 NO_RT = 0xFFFFFFFF;
@@ -981,6 +1205,33 @@ private:
     // This avoids calculating size and other stuffs.
     std::unordered_map<CacheAddr, TSurface> l1_cache;
 
+    struct ExactSurfaceKey {
+        GPUVAddr gpu_addr;
+        CacheAddr cache_addr;
+        bool is_render;
+        SurfaceParams params;
+
+        bool operator==(const ExactSurfaceKey& rhs) const {
+            return std::tie(gpu_addr, cache_addr, is_render) ==
+                       std::tie(rhs.gpu_addr, rhs.cache_addr, rhs.is_render) &&
+                   params == rhs.params;
+        }
+    };
+
+    struct ExactSurfaceKeyHash {
+        std::size_t operator()(const ExactSurfaceKey& key) const noexcept {
+            std::size_t seed = std::hash<SurfaceParams>{}(key.params);
+            boost::hash_combine(seed, key.gpu_addr);
+            boost::hash_combine(seed, key.is_render);
+            return seed;
+        }
+    };
+
+    // The exact cache remembers the result of lookups that resolved to a registered surface
+    // without modifying it. Registration changes drop the lookups they overlap.
+    ExactLookupCache<ExactSurfaceKey, std::pair<TSurface, TView>, ExactSurfaceKeyHash>
+        exact_cache;
+
     /// The surface reserve is a "backup" cache, this is where we put unique surfaces that have
     /// previously been used. This is to prevent surfaces from being constantly created and
     /// destroyed when used with different surface parameters.
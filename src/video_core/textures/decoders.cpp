@@ -2,6 +2,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include "common/alignment.h"
@@ -255,50 +256,63 @@ std::vector<u8> UnswizzleTexture(u8* address, u32 tile_size_x, u32 tile_size_y,
     return unswizzled_data;
 }
 
-void SwizzleSubrect(u32 subrect_width, u32 subrect_height, u32 source_pitch, u32 swizzled_width,
-                    u32 bytes_per_pixel, u8* swizzled_data, u8* unswizzled_data,
-                    u32 block_height_bit, u32 offset_x, u32 offset_y) {
+/**
+ * Copies a line of a subrect between linear and block linear memory. The bytes of a 16 byte
+ * sector of a GOB line are contiguous in both layouts, so the line is copied a sector at a time
+ * instead of a pixel at a time.
+ */
+template <bool swizzle>
+void CopySubrectLine(u8* swizzled_data, u8* linear_line, u32 gob_address_y, u32 block_height,
+                     u32 y, u32 x_start, u32 line_size) {
+    const auto& table = legacy_swizzle_table[y % gob_size_y];
+    for (u32 x = 0; x < line_size;) {
+        const u32 swizzled_x = x_start + x;
+        const u32 copy_size =
+            std::min(fast_swizzle_align - swizzled_x % fast_swizzle_align, line_size - x);
+        const u32 gob_address = gob_address_y + (swizzled_x / gob_size_x) * gob_size * block_height;
+        u8* const swizzled_addr = swizzled_data + gob_address + table[swizzled_x % gob_size_x];
+        if constexpr (swizzle) {
+            std::memcpy(swizzled_addr, linear_line + x, copy_size);
+        } else {
+            std::memcpy(linear_line + x, swizzled_addr, copy_size);
+        }
+        x += copy_size;
+    }
+}
+
+template <bool swizzle>
+void CopySubrect(u32 subrect_width, u32 subrect_height, u32 pitch, u32 swizzled_width,
+                 u32 bytes_per_pixel, u8* swizzled_data, u8* unswizzled_data, u32 block_height_bit,
+                 u32 offset_x, u32 offset_y) {
     const u32 block_height = 1U << block_height_bit;
     const u32 image_width_in_gobs{(swizzled_width * bytes_per_pixel + (gob_size_x - 1)) /
                                   gob_size_x};
+    const u32 line_size = subrect_width * bytes_per_pixel;
+    const u32 x_start = offset_x * bytes_per_pixel;
     for (u32 line = 0; line < subrect_height; ++line) {
-        const u32 dst_y = line + offset_y;
+        const u32 y = line + offset_y;
         const u32 gob_address_y =
-            (dst_y / (gob_size_y * block_height)) * gob_size * block_height * image_width_in_gobs +
-            ((dst_y % (gob_size_y * block_height)) / gob_size_y) * gob_size;
-        const auto& table = legacy_swizzle_table[dst_y % gob_size_y];
-        for (u32 x = 0; x < subrect_width; ++x) {
-            const u32 dst_x = x + offset_x;
-            const u32 gob_address =
-                gob_address_y + (dst_x * bytes_per_pixel / gob_size_x) * gob_size * block_height;
-            const u32 swizzled_offset = gob_address + table[(dst_x * bytes_per_pixel) % gob_size_x];
-            u8* source_line = unswizzled_data + line * source_pitch + x * bytes_per_pixel;
-            u8* dest_addr = swizzled_data + swizzled_offset;
-
-            std::memcpy(dest_addr, source_line, bytes_per_pixel);
-        }
+            (y / (gob_size_y * block_height)) * gob_size * block_height * image_width_in_gobs +
+            ((y % (gob_size_y * block_height)) / gob_size_y) * gob_size;
+        CopySubrectLine<swizzle>(swizzled_data, unswizzled_data + line * pitch, gob_address_y,
+                                 block_height, y, x_start, line_size);
     }
 }
 
+void SwizzleSubrect(u32 subrect_width, u32 subrect_height, u32 source_pitch, u32 swizzled_width,
+                    u32 bytes_per_pixel, u8* swizzled_data, u8* unswizzled_data,
+                    u32 block_height_bit, u32 offset_x, u32 offset_y) {
+    CopySubrect<true>(subrect_width, subrect_height, source_pitch, swizzled_width,
+                      bytes_per_pixel, swizzled_data, unswizzled_data, block_height_bit,
+                      offset_x, offset_y);
+}
+
 void UnswizzleSubrect(u32 subrect_width, u32 subrect_height, u32 dest_pitch, u32 swizzled_width,
                       u32 bytes_per_pixel, u8* swizzled_data, u8* unswizzled_data,
                       u32 block_height_bit, u32 offset_x, u32 offset_y) {
-    const u32 block_height = 1U << block_height_bit;
-    for (u32 line = 0; line < subrect_height; ++line) {
-        const u32 y2 = line + offset_y;
-        const u32 gob_address_y = (y2 / (gob_size_y * block_height)) * gob_size * block_height +
-                                  ((y2 % (gob_size_y * block_height)) / gob_size_y) * gob_size;
-        const auto& table = legacy_swizzle_table[y2 % gob_size_y];
-        for (u32 x = 0; x < subrect_width; ++x) {
-            const u32 x2 = (x + offset_x) * bytes_per_pixel;
-            const u32 gob_address = gob_address_y + (x2 / gob_size_x) * gob_size * block_height;
-            const u32 swizzled_offset = gob_address + table[x2 % gob_size_x];
-            u8* dest_line = unswizzled_data + line * dest_pitch + x * bytes_per_pixel;
-            u8* source_addr = swizzled_data + swizzled_offset;
-
-            std::memcpy(dest_line, source_addr, bytes_per_pixel);
-        }
-    }
+    CopySubrect<false>(subrect_width, subrect_height, dest_pitch, swizzled_width,
+                       bytes_per_pixel, swizzled_data, unswizzled_data, block_height_bit,
+                       offset_x, offset_y);
 }
 
 void SwizzleKepler(const u32 width, const u32 height, const u32 dst_x, const u32 dst_y,
@@ -8,6 +8,7 @@
 #include "video_core/gpu_asynch.h"
 #include "video_core/gpu_synch.h"
 #include "video_core/renderer_base.h"
+#include "video_core/renderer_null/renderer_null.h"
 #include "video_core/renderer_opengl/renderer_opengl.h"
 #include "video_core/video_core.h"
 
@@ -15,7 +16,13 @@ namespace VideoCore {
 
 std::unique_ptr<RendererBase> CreateRenderer(Core::Frontend::EmuWindow& emu_window,
                                              Core::System& system) {
-    return std::make_unique<OpenGL::RendererOpenGL>(emu_window, system);
+    switch (Settings::values.renderer_backend) {
+    case Settings::RendererBackend::Null:
+        return std::make_unique<Null::RendererNull>(emu_window, system);
+    case Settings::RendererBackend::OpenGL:
+    default:
+        return std::make_unique<OpenGL::RendererOpenGL>(emu_window, system);
+    }
 }
 
 std::unique_ptr<Tegra::GPU> CreateGPU(Core::System& system) {
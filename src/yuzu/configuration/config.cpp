@@ -613,6 +613,8 @@ void Config::ReadPathValues() {
 void Config::ReadRendererValues() {
     qt_config->beginGroup(QStringLiteral("Renderer"));
 
+    Settings::values.renderer_backend = static_cast<Settings::RendererBackend>(
+        ReadSetting(QStringLiteral("backend"), 0).toInt());
     Settings::values.resolution_factor =
         ReadSetting(QStringLiteral("resolution_factor"), 1.0).toFloat();
     Settings::values.use_frame_limit =
@@ -626,6 +628,12 @@ void Config::ReadRendererValues() {
         ReadSetting(QStringLiteral("use_asynchronous_gpu_emulation"), false).toBool();
     Settings::values.force_30fps_mode =
         ReadSetting(QStringLiteral("force_30fps_mode"), false).toBool();
+    Settings::values.texture_cache_budget =
+        ReadSetting(QStringLiteral("texture_cache_budget"), 0).toUInt();
+    Settings::values.present_queue_depth =
+        ReadSetting(QStringLiteral("present_queue_depth"), 3).toUInt();
+    Settings::values.use_present_mailbox =
+        ReadSetting(QStringLiteral("use_present_mailbox"), false).toBool();
 
     Settings::values.bg_red = ReadSetting(QStringLiteral("bg_red"), 0.0).toFloat();
     Settings::values.bg_green = ReadSetting(QStringLiteral("bg_green"), 0.0).toFloat();
@@ -1039,6 +1047,7 @@ void Config::SavePathValues() {
 void Config::SaveRendererValues() {
     qt_config->beginGroup(QStringLiteral("Renderer"));
 
+    WriteSetting(QStringLiteral("backend"), static_cast<int>(Settings::values.renderer_backend), 0);
     WriteSetting(QStringLiteral("resolution_factor"),
                  static_cast<double>(Settings::values.resolution_factor), 1.0);
     WriteSetting(QStringLiteral("use_frame_limit"), Settings::values.use_frame_limit, true);
@@ -1050,6 +1059,10 @@ void Config::SaveRendererValues() {
     WriteSetting(QStringLiteral("use_asynchronous_gpu_emulation"),
                  Settings::values.use_asynchronous_gpu_emulation, false);
     WriteSetting(QStringLiteral("force_30fps_mode"), Settings::values.force_30fps_mode, false);
+    WriteSetting(QStringLiteral("texture_cache_budget"), Settings::values.texture_cache_budget, 0);
+    WriteSetting(QStringLiteral("present_queue_depth"), Settings::values.present_queue_depth, 3);
+    WriteSetting(QStringLiteral("use_present_mailbox"), Settings::values.use_present_mailbox,
+                 false);
 
     // Cast to double because Qt's written float values are not human-readable
     WriteSetting(QStringLiteral("bg_red"), static_cast<double>(Settings::values.bg_red), 0.0);
@@ -0,0 +1,192 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "common/file_util.h"
+#include "common/logging/log.h"
+#include "yuzu/game_list_metadata_cache.h"
+
+namespace {
+
+constexpr u32 IndexMagic = 0x434C4759; // "YGLC"
+constexpr u32 IndexVersion = 1;
+
+constexpr u8 FlagHasLoader = 1 << 0;
+constexpr u8 FlagHasProgramId = 1 << 1;
+constexpr u8 FlagHasMetadata = 1 << 2;
+
+class IndexWriter {
+public:
+    template <typename T>
+    void Write(const T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        const auto* const bytes = reinterpret_cast<const u8*>(&value);
+        data.insert(data.end(), bytes, bytes + sizeof(T));
+    }
+
+    void WriteBytes(const void* bytes, std::size_t size) {
+        Write(static_cast<u32>(size));
+        data.insert(data.end(), static_cast<const u8*>(bytes),
+                    static_cast<const u8*>(bytes) + size);
+    }
+
+    std::vector<u8> data;
+};
+
+class IndexReader {
+public:
+    explicit IndexReader(const std::vector<u8>& data) : data{data} {}
+
+    template <typename T>
+    bool Read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (data.size() - position < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data.data() + position, sizeof(T));
+        position += sizeof(T);
+        return true;
+    }
+
+    template <typename Container>
+    bool ReadBytes(Container& container) {
+        u32 size = 0;
+        if (!Read(size) || data.size() - position < size) {
+            return false;
+        }
+        const auto* const begin = data.data() + position;
+        container.assign(begin, begin + size);
+        position += size;
+        return true;
+    }
+
+private:
+    const std::vector<u8>& data;
+    std::size_t position = 0;
+};
+
+} // Anonymous namespace
+
+GameListMetadataCache::GameListMetadataCache(std::string path) : path{std::move(path)} {
+    Load();
+}
+
+GameListMetadataCache::~GameListMetadataCache() = default;
+
+std::optional<GameListMetadataCache::Entry> GameListMetadataCache::Find(
+    const std::string& file_path, u64 size, s64 modified_time) const {
+    std::lock_guard lock{mutex};
+    const auto it = entries.find(file_path);
+    if (it == entries.end() || it->second.size != size ||
+        it->second.modified_time != modified_time) {
+        return std::nullopt;
+    }
+    used.insert(file_path);
+    return it->second;
+}
+
+void GameListMetadataCache::Store(const std::string& file_path, Entry entry) {
+    std::lock_guard lock{mutex};
+    entries.insert_or_assign(file_path, std::move(entry));
+    used.insert(file_path);
+    dirty = true;
+}
+
+void GameListMetadataCache::Save(bool prune) {
+    std::lock_guard lock{mutex};
+    if (prune) {
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (used.count(it->first) == 0) {
+                it = entries.erase(it);
+                dirty = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (!dirty) {
+        return;
+    }
+
+    IndexWriter writer;
+    writer.Write(IndexMagic);
+    writer.Write(IndexVersion);
+    writer.Write(static_cast<u32>(entries.size()));
+    for (const auto& [file_path, entry] : entries) {
+        u8 flags = 0;
+        flags |= entry.has_loader ? FlagHasLoader : 0;
+        flags |= entry.has_program_id ? FlagHasProgramId : 0;
+        flags |= entry.has_metadata ? FlagHasMetadata : 0;
+
+        writer.WriteBytes(file_path.data(), file_path.size());
+        writer.Write(entry.size);
+        writer.Write(entry.modified_time);
+        writer.Write(flags);
+        writer.Write(static_cast<u32>(entry.file_type));
+        writer.Write(entry.program_id);
+        writer.WriteBytes(entry.name.data(), entry.name.size());
+        writer.WriteBytes(entry.icon.data(), entry.icon.size());
+    }
+
+    // Write a new file and swap it in, so an interrupted write doesn't leave a broken index
+    const std::string temporary_path = path + ".tmp";
+    FileUtil::CreateFullPath(path);
+    {
+        FileUtil::IOFile file(temporary_path, "wb");
+        if (file.WriteBytes(writer.data.data(), writer.data.size()) != writer.data.size()) {
+            LOG_ERROR(Frontend, "Failed to write game list metadata cache to {}", temporary_path);
+            return;
+        }
+    }
+    FileUtil::Delete(path);
+    if (!FileUtil::Rename(temporary_path, path)) {
+        LOG_ERROR(Frontend, "Failed to replace game list metadata cache {}", path);
+        return;
+    }
+    dirty = false;
+}
+
+void GameListMetadataCache::Load() {
+    FileUtil::IOFile file(path, "rb");
+    if (!file.IsOpen()) {
+        return;
+    }
+    std::vector<u8> data(file.GetSize());
+    if (file.ReadBytes(data.data(), data.size()) != data.size()) {
+        return;
+    }
+
+    IndexReader reader(data);
+    u32 magic = 0;
+    u32 version = 0;
+    u32 num_entries = 0;
+    if (!reader.Read(magic) || !reader.Read(version) || !reader.Read(num_entries) ||
+        magic != IndexMagic || version != IndexVersion) {
+        LOG_WARNING(Frontend, "Ignoring invalid game list metadata cache {}", path);
+        return;
+    }
+
+    for (u32 index = 0; index < num_entries; ++index) {
+        std::string file_path;
+        Entry entry;
+        u8 flags = 0;
+        u32 file_type = 0;
+        if (!reader.ReadBytes(file_path) || !reader.Read(entry.size) ||
+            !reader.Read(entry.modified_time) || !reader.Read(flags) || !reader.Read(file_type) ||
+            !reader.Read(entry.program_id) || !reader.ReadBytes(entry.name) ||
+            !reader.ReadBytes(entry.icon)) {
+            LOG_WARNING(Frontend, "Game list metadata cache {} is truncated", path);
+            entries.clear();
+            return;
+        }
+        entry.has_loader = (flags & FlagHasLoader) != 0;
+        entry.has_program_id = (flags & FlagHasProgramId) != 0;
+        entry.has_metadata = (flags & FlagHasMetadata) != 0;
+        entry.file_type = static_cast<Loader::FileType>(file_type);
+        entries.insert_or_assign(std::move(file_path), std::move(entry));
+    }
+}
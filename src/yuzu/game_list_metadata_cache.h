@@ -0,0 +1,64 @@
+// Copyright 2019 yuzu emulator team
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/common_types.h"
+#include "core/loader/loader.h"
+
+/**
+ * Index of the metadata the game list reads from game files, stored in a single file.
+ * Entries are keyed by the path of the file and only used while its size and modification time
+ * are unchanged, so only new or modified files have to be parsed again. Thread-safe.
+ */
+class GameListMetadataCache {
+public:
+    struct Entry {
+        u64 size = 0;
+        s64 modified_time = 0;
+
+        bool has_loader = false;
+        Loader::FileType file_type = Loader::FileType::Unknown;
+        bool has_program_id = false;
+        u64 program_id = 0;
+
+        /// Whether name and icon were read, they are only read for files shown in the list
+        bool has_metadata = false;
+        std::string name;
+        std::vector<u8> icon;
+    };
+
+    /// Loads the index stored at path, starting empty when it's missing or invalid.
+    explicit GameListMetadataCache(std::string path);
+    ~GameListMetadataCache();
+
+    /// Returns the entry of a file, if it was stored with the same size and modification time.
+    std::optional<Entry> Find(const std::string& file_path, u64 size, s64 modified_time) const;
+
+    /// Stores or replaces the entry of a file.
+    void Store(const std::string& file_path, Entry entry);
+
+    /**
+     * Writes the index back to disk if it changed.
+     * @param prune Drops the entries of the files not looked up or stored since it was loaded.
+     */
+    void Save(bool prune);
+
+private:
+    void Load();
+
+    std::string path;
+
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Entry> entries;
+    mutable std::unordered_set<std::string> used;
+    bool dirty = false;
+};
@@ -2,11 +2,18 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include <QDateTime>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
@@ -27,17 +34,35 @@
 #include "core/loader/loader.h"
 #include "yuzu/compatibility_list.h"
 #include "yuzu/game_list.h"
+#include "yuzu/game_list_metadata_cache.h"
 #include "yuzu/game_list_p.h"
 #include "yuzu/game_list_worker.h"
 #include "yuzu/uisettings.h"
 
+/**
+ * Mutexes serializing the accesses to the cached objects of each title during a scan. Entries are
+ * made on several threads, and a title can be found in several files (e.g. an XCI and an NSP dump).
+ */
+class GameListCachedObjectLocks {
+public:
+    std::mutex& Get(const std::string& filename) {
+        std::lock_guard lock{mutex};
+        return mutexes[filename];
+    }
+
+private:
+    std::mutex mutex;
+    std::unordered_map<std::string, std::mutex> mutexes;
+};
+
 namespace {
 
-QString GetGameListCachedObject(const std::string& filename, const std::string& ext,
-                                const std::function<QString()>& generator) {
+QString GetGameListCachedObject(GameListCachedObjectLocks& locks, const std::string& filename,
+                                const std::string& ext, const std::function<QString()>& generator) {
     if (!UISettings::values.cache_game_list || filename == "0000000000000000") {
         return generator();
     }
+    std::lock_guard lock{locks.Get(filename)};
 
     const auto path = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + DIR_SEP + "game_list" +
                       DIR_SEP + filename + '.' + ext;
@@ -64,11 +89,12 @@ QString GetGameListCachedObject(const std::string& filename, const std::string&
 }
 
 std::pair<std::vector<u8>, std::string> GetGameListCachedObject(
-    const std::string& filename, const std::string& ext,
+    GameListCachedObjectLocks& locks, const std::string& filename, const std::string& ext,
     const std::function<std::pair<std::vector<u8>, std::string>()>& generator) {
     if (!UISettings::values.cache_game_list || filename == "0000000000000000") {
         return generator();
     }
+    std::lock_guard lock{locks.Get(filename)};
 
     const auto path1 = FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + DIR_SEP + "game_list" +
                        DIR_SEP + filename + ".jpeg";
@@ -127,10 +153,11 @@ std::pair<std::vector<u8>, std::string> GetGameListCachedObject(
     return std::make_pair(vec, data.toStdString());
 }
 
-void GetMetadataFromControlNCA(const FileSys::PatchManager& patch_manager, const FileSys::NCA& nca,
+void GetMetadataFromControlNCA(GameListCachedObjectLocks& locks,
+                               const FileSys::PatchManager& patch_manager, const FileSys::NCA& nca,
                                std::vector<u8>& icon, std::string& name) {
     std::tie(icon, name) = GetGameListCachedObject(
-        fmt::format("{:016X}", patch_manager.GetTitleID()), {}, [&patch_manager, &nca] {
+        locks, fmt::format("{:016X}", patch_manager.GetTitleID()), {}, [&patch_manager, &nca] {
             const auto [nacp, icon_f] = patch_manager.ParseControlNCA(nca);
             return std::make_pair(icon_f->ReadAllBytes(), nacp->GetApplicationName());
         });
@@ -156,6 +183,69 @@ QString FormatGameName(const std::string& physical_name) {
     return physical_name_as_qstring;
 }
 
+std::string GetMetadataCachePath() {
+    return FileUtil::GetUserPath(FileUtil::UserPath::CacheDir) + DIR_SEP + "game_list" + DIR_SEP +
+           "metadata.bin";
+}
+
+/**
+ * Reads the type and program ID of a game file, and also its name and icon when read_metadata is
+ * set. Unchanged files are read from the metadata cache, otherwise loader is left holding the
+ * loader that was used.
+ */
+GameListMetadataCache::Entry ReadGameFile(GameListMetadataCache* cache, FileSys::VfsFilesystem& vfs,
+                                          const std::string& physical_name, bool read_metadata,
+                                          std::unique_ptr<Loader::AppLoader>& loader) {
+    if (IsExtractedNCAMain(physical_name)) {
+        // Their metadata is read from the files next to them, which change on their own
+        cache = nullptr;
+    }
+
+    const u64 size = FileUtil::GetSize(physical_name);
+    const s64 modified_time =
+        QFileInfo(QString::fromStdString(physical_name)).lastModified().toMSecsSinceEpoch();
+    if (cache != nullptr) {
+        auto cached = cache->Find(physical_name, size, modified_time);
+        if (cached && (cached->has_metadata || !cached->has_loader || !read_metadata)) {
+            return std::move(*cached);
+        }
+    }
+
+    GameListMetadataCache::Entry entry;
+    entry.size = size;
+    entry.modified_time = modified_time;
+    loader = Loader::GetLoader(vfs.OpenFile(physical_name, FileSys::Mode::Read));
+    bool is_complete = true;
+    if (loader) {
+        entry.has_loader = true;
+        entry.file_type = loader->GetFileType();
+        entry.has_program_id =
+            loader->ReadProgramId(entry.program_id) == Loader::ResultStatus::Success;
+        is_complete = entry.has_program_id;
+        if (read_metadata) {
+            entry.has_metadata = true;
+            [[maybe_unused]] const auto icon_result = loader->ReadIcon(entry.icon);
+            entry.name = " ";
+            const auto title_result = loader->ReadTitle(entry.name);
+            is_complete = is_complete && title_result == Loader::ResultStatus::Success;
+        }
+    }
+    // Files that couldn't be fully read, e.g. while keys are missing, are read again next time
+    if (cache != nullptr && is_complete) {
+        cache->Store(physical_name, entry);
+    }
+    return entry;
+}
+
+bool IsListedGameFile(const GameListMetadataCache::Entry& entry) {
+    if (!entry.has_loader) {
+        return false;
+    }
+    const bool is_unknown = entry.file_type == Loader::FileType::Unknown ||
+                            entry.file_type == Loader::FileType::Error;
+    return !is_unknown || UISettings::values.show_unknown;
+}
+
 QString FormatPatchNameVersions(const FileSys::PatchManager& patch_manager,
                                 Loader::AppLoader& loader, bool updatable = true) {
     QString out;
@@ -187,10 +277,14 @@ QString FormatPatchNameVersions(const FileSys::PatchManager& patch_manager,
     return out;
 }
 
+/// get_loader is only called when the add-ons of the game are not cached, so unchanged files
+/// don't have to be opened.
 QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::string& name,
-                                        const std::vector<u8>& icon, Loader::AppLoader& loader,
+                                        const std::vector<u8>& icon, Loader::FileType file_type,
                                         u64 program_id, const CompatibilityList& compatibility_list,
-                                        const FileSys::PatchManager& patch) {
+                                        const FileSys::PatchManager& patch,
+                                        GameListCachedObjectLocks& locks,
+                                        const std::function<Loader::AppLoader*()>& get_loader) {
     const auto it = FindMatchingCompatibilityEntry(compatibility_list, program_id);
 
     // The game list uses this as compatibility number for untested games
@@ -199,7 +293,6 @@ QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::stri
         compatibility = it->second.first;
     }
 
-    const auto file_type = loader.GetFileType();
     const auto file_type_string = QString::fromStdString(Loader::GetFileTypeString(file_type));
 
     QList<QStandardItem*> list{
@@ -212,8 +305,12 @@ QList<QStandardItem*> MakeGameListEntry(const std::string& path, const std::stri
 
     if (UISettings::values.show_add_ons) {
         const auto patch_versions = GetGameListCachedObject(
-            fmt::format("{:016X}", patch.GetTitleID()), "pv.txt", [&patch, &loader] {
-                return FormatPatchNameVersions(patch, loader, loader.IsRomFSUpdatable());
+            locks, fmt::format("{:016X}", patch.GetTitleID()), "pv.txt", [&patch, &get_loader] {
+                Loader::AppLoader* const loader = get_loader();
+                if (loader == nullptr) {
+                    return QString{};
+                }
+                return FormatPatchNameVersions(patch, *loader, loader->IsRomFSUpdatable());
             });
         list.insert(2, new GameListItem(patch_versions));
     }
@@ -252,14 +349,15 @@ void GameListWorker::AddTitlesToGameList(GameListDir* parent_dir) {
             ContentProviderUnionSlot::SysNAND, TitleType::Application, ContentRecordType::Program);
     }
 
-    for (const auto& [slot, game] : installed_games) {
+    const auto make_entry = [&](std::size_t index) -> QList<QStandardItem*> {
+        const auto& [slot, game] = installed_games[index];
         if (slot == ContentProviderUnionSlot::FrontendManual)
-            continue;
+            return {};
 
         const auto file = cache.GetEntryUnparsed(game.title_id, game.type);
         std::unique_ptr<Loader::AppLoader> loader = Loader::GetLoader(file);
         if (!loader)
-            continue;
+            return {};
 
         std::vector<u8> icon;
         std::string name;
@@ -269,19 +367,42 @@ void GameListWorker::AddTitlesToGameList(GameListDir* parent_dir) {
         const PatchManager patch{program_id};
         const auto control = cache.GetEntry(game.title_id, ContentRecordType::Control);
         if (control != nullptr)
-            GetMetadataFromControlNCA(patch, *control, icon, name);
+            GetMetadataFromControlNCA(*cached_object_locks, patch, *control, icon, name);
 
-        emit EntryReady(MakeGameListEntry(file->GetFullPath(), name, icon, *loader, program_id,
-                                          compatibility_list, patch),
-                        parent_dir);
-    }
+        return MakeGameListEntry(file->GetFullPath(), name, icon, loader->GetFileType(), program_id,
+                                 compatibility_list, patch, *cached_object_locks,
+                                 [&loader] { return loader.get(); });
+    };
+    EmitEntriesInParallel(installed_games.size(), make_entry, parent_dir);
 }
 
 void GameListWorker::ScanFileSystem(ScanTarget target, const std::string& dir_path,
                                     unsigned int recursion, GameListDir* parent_dir) {
-    const auto callback = [this, target, recursion,
-                           parent_dir](u64* num_entries_out, const std::string& directory,
-                                       const std::string& virtual_name) -> bool {
+    std::vector<std::string> files;
+    CollectGameFiles(dir_path, recursion, files);
+
+    if (target == ScanTarget::FillManualContentProvider) {
+        // The content provider isn't thread-safe, unchanged files are not opened anyway unless
+        // they have to be added to it
+        for (const std::string& physical_name : files) {
+            if (stop_processing) {
+                return;
+            }
+            AddToContentProvider(physical_name);
+        }
+        return;
+    }
+
+    EmitEntriesInParallel(
+        files.size(), [this, &files](std::size_t index) { return MakeFileEntry(files[index]); },
+        parent_dir);
+}
+
+void GameListWorker::CollectGameFiles(const std::string& dir_path, unsigned int recursion,
+                                      std::vector<std::string>& files) {
+    const auto callback = [this, recursion, &files](u64* num_entries_out,
+                                                    const std::string& directory,
+                                                    const std::string& virtual_name) -> bool {
         if (stop_processing) {
             // Breaks the callback loop.
             return false;
@@ -291,65 +412,113 @@ void GameListWorker::ScanFileSystem(ScanTarget target, const std::string& dir_pa
         const bool is_dir = FileUtil::IsDirectory(physical_name);
         if (!is_dir &&
             (HasSupportedFileExtension(physical_name) || IsExtractedNCAMain(physical_name))) {
-            const auto file = vfs->OpenFile(physical_name, FileSys::Mode::Read);
-            auto loader = Loader::GetLoader(file);
-            if (!loader) {
-                return true;
-            }
-
-            const auto file_type = loader->GetFileType();
-            if ((file_type == Loader::FileType::Unknown || file_type == Loader::FileType::Error) &&
-                !UISettings::values.show_unknown) {
-                return true;
-            }
+            files.push_back(physical_name);
+        } else if (is_dir && recursion > 0) {
+            watch_list.append(QString::fromStdString(physical_name));
+            CollectGameFiles(physical_name, recursion - 1, files);
+        }
 
-            u64 program_id = 0;
-            const auto res2 = loader->ReadProgramId(program_id);
-
-            if (target == ScanTarget::FillManualContentProvider) {
-                if (res2 == Loader::ResultStatus::Success && file_type == Loader::FileType::NCA) {
-                    provider->AddEntry(FileSys::TitleType::Application,
-                                       FileSys::GetCRTypeFromNCAType(FileSys::NCA{file}.GetType()),
-                                       program_id, file);
-                } else if (res2 == Loader::ResultStatus::Success &&
-                           (file_type == Loader::FileType::XCI ||
-                            file_type == Loader::FileType::NSP)) {
-                    const auto nsp = file_type == Loader::FileType::NSP
-                                         ? std::make_shared<FileSys::NSP>(file)
-                                         : FileSys::XCI{file}.GetSecurePartitionNSP();
-                    for (const auto& title : nsp->GetNCAs()) {
-                        for (const auto& entry : title.second) {
-                            provider->AddEntry(entry.first.first, entry.first.second, title.first,
-                                               entry.second->GetBaseFile());
-                        }
-                    }
-                }
-            } else {
-                std::vector<u8> icon;
-                [[maybe_unused]] const auto res1 = loader->ReadIcon(icon);
+        return true;
+    };
 
-                std::string name = " ";
-                [[maybe_unused]] const auto res3 = loader->ReadTitle(name);
+    FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
+}
 
-                const FileSys::PatchManager patch{program_id};
+void GameListWorker::AddToContentProvider(const std::string& physical_name) {
+    std::unique_ptr<Loader::AppLoader> loader;
+    const auto entry = ReadGameFile(metadata_cache.get(), *vfs, physical_name, false, loader);
+    if (!IsListedGameFile(entry) || !entry.has_program_id) {
+        return;
+    }
 
-                emit EntryReady(MakeGameListEntry(physical_name, name, icon, *loader, program_id,
-                                                  compatibility_list, patch),
-                                parent_dir);
+    const auto file_type = entry.file_type;
+    if (file_type == Loader::FileType::NCA) {
+        const auto file = vfs->OpenFile(physical_name, FileSys::Mode::Read);
+        provider->AddEntry(FileSys::TitleType::Application,
+                           FileSys::GetCRTypeFromNCAType(FileSys::NCA{file}.GetType()),
+                           entry.program_id, file);
+    } else if (file_type == Loader::FileType::XCI || file_type == Loader::FileType::NSP) {
+        const auto file = vfs->OpenFile(physical_name, FileSys::Mode::Read);
+        const auto nsp = file_type == Loader::FileType::NSP
+                             ? std::make_shared<FileSys::NSP>(file)
+                             : FileSys::XCI{file}.GetSecurePartitionNSP();
+        for (const auto& title : nsp->GetNCAs()) {
+            for (const auto& nca_entry : title.second) {
+                provider->AddEntry(nca_entry.first.first, nca_entry.first.second, title.first,
+                                   nca_entry.second->GetBaseFile());
             }
-        } else if (is_dir && recursion > 0) {
-            watch_list.append(QString::fromStdString(physical_name));
-            ScanFileSystem(target, physical_name, recursion - 1, parent_dir);
         }
+    }
+}
 
-        return true;
+QList<QStandardItem*> GameListWorker::MakeFileEntry(const std::string& physical_name) {
+    std::unique_ptr<Loader::AppLoader> loader;
+    const auto entry = ReadGameFile(metadata_cache.get(), *vfs, physical_name, true, loader);
+    if (!IsListedGameFile(entry)) {
+        return {};
+    }
+
+    const FileSys::PatchManager patch{entry.program_id};
+    return MakeGameListEntry(physical_name, entry.name, entry.icon, entry.file_type,
+                             entry.program_id, compatibility_list, patch, *cached_object_locks,
+                             [&]() {
+                                 if (!loader) {
+                                     loader = Loader::GetLoader(
+                                         vfs->OpenFile(physical_name, FileSys::Mode::Read));
+                                 }
+                                 return loader.get();
+                             });
+}
+
+void GameListWorker::EmitEntriesInParallel(
+    std::size_t count, const std::function<QList<QStandardItem*>(std::size_t)>& make_entry,
+    GameListDir* parent_dir) {
+    std::vector<std::optional<QList<QStandardItem*>>> entries(count);
+    std::size_t next_emitted = 0;
+    std::mutex mutex;
+    std::atomic<std::size_t> next_index{0};
+
+    const auto work = [&] {
+        for (std::size_t index = next_index++; index < count && !stop_processing;
+             index = next_index++) {
+            auto entry = make_entry(index);
+
+            std::lock_guard lock{mutex};
+            entries[index] = std::move(entry);
+            // Emit the entries following the ones already emitted, so they keep the scan order
+            for (; next_emitted < count && entries[next_emitted]; ++next_emitted) {
+                if (!entries[next_emitted]->isEmpty()) {
+                    emit EntryReady(std::move(*entries[next_emitted]), parent_dir);
+                }
+            }
+        }
     };
 
-    FileUtil::ForeachDirectoryEntry(nullptr, dir_path, callback);
+    const std::size_t num_threads =
+        std::min<std::size_t>(std::max(std::thread::hardware_concurrency(), 1U), count);
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < num_threads; ++i) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Entries finished after an earlier one was cancelled are never shown
+    for (; next_emitted < count; ++next_emitted) {
+        if (entries[next_emitted]) {
+            qDeleteAll(*entries[next_emitted]);
+        }
+    }
 }
 
 void GameListWorker::run() {
     stop_processing = false;
+    cached_object_locks = std::make_unique<GameListCachedObjectLocks>();
+    if (UISettings::values.cache_game_list) {
+        metadata_cache = std::make_unique<GameListMetadataCache>(GetMetadataCachePath());
+    }
 
     for (UISettings::GameDir& game_dir : game_dirs) {
         if (game_dir.path == QStringLiteral("SDMC")) {
@@ -376,6 +545,13 @@ void GameListWorker::run() {
         }
     };
 
+    if (metadata_cache) {
+        // A cancelled scan didn't look at every file, keep the entries of the ones it missed
+        metadata_cache->Save(!stop_processing);
+        metadata_cache.reset();
+    }
+    cached_object_locks.reset();
+
     emit Finished(watch_list);
 }
 
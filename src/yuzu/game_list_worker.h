@@ -5,10 +5,12 @@
 #pragma once
 
 #include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include <QList>
 #include <QObject>
@@ -19,6 +21,8 @@
 #include "common/common_types.h"
 #include "yuzu/compatibility_list.h"
 
+class GameListCachedObjectLocks;
+class GameListMetadataCache;
 class QStandardItem;
 
 namespace FileSys {
@@ -73,10 +77,30 @@ private:
     void ScanFileSystem(ScanTarget target, const std::string& dir_path, unsigned int recursion,
                         GameListDir* parent_dir);
 
+    /// Collects the game files in dir_path and in recursion levels of its subdirectories.
+    void CollectGameFiles(const std::string& dir_path, unsigned int recursion,
+                          std::vector<std::string>& files);
+
+    /// Adds the contents of a game file to the manual content provider.
+    void AddToContentProvider(const std::string& physical_name);
+
+    /// Returns the game list entry of a game file, or an empty list when it's not listed.
+    QList<QStandardItem*> MakeFileEntry(const std::string& physical_name);
+
+    /**
+     * Calls make_entry for every index below count on several threads and emits the entries it
+     * returns, in index order, as they become available.
+     */
+    void EmitEntriesInParallel(std::size_t count,
+                               const std::function<QList<QStandardItem*>(std::size_t)>& make_entry,
+                               GameListDir* parent_dir);
+
     std::shared_ptr<FileSys::VfsFilesystem> vfs;
     FileSys::ManualContentProvider* provider;
     QVector<UISettings::GameDir>& game_dirs;
     const CompatibilityList& compatibility_list;
+    std::unique_ptr<GameListMetadataCache> metadata_cache;
+    std::unique_ptr<GameListCachedObjectLocks> cached_object_locks; ///< Only alive during run
 
     QStringList watch_list;
     std::atomic_bool stop_processing;
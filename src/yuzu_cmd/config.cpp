@@ -366,6 +366,8 @@ void Config::ReadValues() {
     Settings::values.use_multi_core = sdl2_config->GetBoolean("Core", "use_multi_core", false);
 
     // Renderer
+    Settings::values.renderer_backend = static_cast<Settings::RendererBackend>(
+        sdl2_config->GetInteger("Renderer", "backend", 0));
     Settings::values.resolution_factor =
         static_cast<float>(sdl2_config->GetReal("Renderer", "resolution_factor", 1.0));
     Settings::values.use_frame_limit = sdl2_config->GetBoolean("Renderer", "use_frame_limit", true);
@@ -377,6 +379,12 @@ void Config::ReadValues() {
         sdl2_config->GetBoolean("Renderer", "use_accurate_gpu_emulation", false);
     Settings::values.use_asynchronous_gpu_emulation =
         sdl2_config->GetBoolean("Renderer", "use_asynchronous_gpu_emulation", false);
+    Settings::values.texture_cache_budget =
+        static_cast<u32>(sdl2_config->GetInteger("Renderer", "texture_cache_budget", 0));
+    Settings::values.present_queue_depth =
+        static_cast<u32>(sdl2_config->GetInteger("Renderer", "present_queue_depth", 3));
+    Settings::values.use_present_mailbox =
+        sdl2_config->GetBoolean("Renderer", "use_present_mailbox", false);
 
     Settings::values.bg_red = static_cast<float>(sdl2_config->GetReal("Renderer", "bg_red", 0.0));
     Settings::values.bg_green =
@@ -81,6 +81,10 @@ touch_device=
 use_multi_core=
 
 [Renderer]
+# Which backend API to use.
+# 0 (default): OpenGL, 1: Null (no host rendering, for measuring the emulation overhead)
+backend =
+
 # Whether to use software or hardware rendering.
 # 0: Software, 1 (default): Hardware
 use_hw_renderer =
@@ -118,6 +122,18 @@ use_accurate_gpu_emulation =
 # 0 : Off (slow), 1 (default): On (fast)
 use_asynchronous_gpu_emulation =
 
+# Host memory budget of the texture cache in MiB, least recently used textures are evicted above it
+# 0 (default): Unlimited, e.g. 2048 on hosts with little video memory
+texture_cache_budget =
+
+# Number of frames that can wait to be presented by the host with asynchronous GPU emulation
+# 1 - 8: 3 (default)
+present_queue_depth =
+
+# What happens when the present queue is full
+# 0 (default): The emulation waits for the host, 1: The oldest queued frame is dropped
+use_present_mailbox =
+
 # The clear color for the renderer. What shows up on the sides of the bottom screen.
 # Must be in range of 0.0-1.0. Defaults to 1.0 for all.
 bg_red =
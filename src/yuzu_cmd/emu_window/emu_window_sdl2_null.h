@@ -0,0 +1,21 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "core/frontend/emu_window.h"
+#include "yuzu_cmd/emu_window/emu_window_sdl2.h"
+
+/// Window without a graphics context, used with the null renderer
+class EmuWindow_SDL2_Null final : public EmuWindow_SDL2 {
+public:
+    explicit EmuWindow_SDL2_Null(bool fullscreen);
+    ~EmuWindow_SDL2_Null();
+
+    void SwapBuffers() override {}
+
+    void MakeCurrent() override {}
+
+    void DoneCurrent() override {}
+};
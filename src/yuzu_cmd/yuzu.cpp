@@ -28,10 +28,12 @@
 #include "core/loader/loader.h"
 #include "core/settings.h"
 #include "core/telemetry_session.h"
+#include "video_core/gpu.h"
 #include "video_core/renderer_base.h"
 #include "yuzu_cmd/config.h"
 #include "yuzu_cmd/emu_window/emu_window_sdl2.h"
 #include "yuzu_cmd/emu_window/emu_window_sdl2_gl.h"
+#include "yuzu_cmd/emu_window/emu_window_sdl2_null.h"
 
 #include "core/file_sys/registered_cache.h"
 
@@ -64,7 +66,8 @@ static void PrintHelp(const char* argv0) {
                  "-f, --fullscreen      Start in fullscreen mode\n"
                  "-h, --help            Display this help and exit\n"
                  "-v, --version         Output version information and exit\n"
-                 "-p, --program         Pass following string as arguments to executable\n";
+                 "-p, --program         Pass following string as arguments to executable\n"
+                 "-r, --record-gpu=FILE Record the GPU command stream to FILE for yuzu-gpu-replay\n";
 }
 
 static void PrintVersion() {
@@ -110,15 +113,17 @@ int main(int argc, char** argv) {
     std::string filepath;
 
     bool fullscreen = false;
+    std::string gpu_record_path;
 
     static struct option long_options[] = {
         {"gdbport", required_argument, 0, 'g'}, {"fullscreen", no_argument, 0, 'f'},
         {"help", no_argument, 0, 'h'},          {"version", no_argument, 0, 'v'},
-        {"program", optional_argument, 0, 'p'}, {0, 0, 0, 0},
+        {"program", optional_argument, 0, 'p'}, {"record-gpu", required_argument, 0, 'r'},
+        {0, 0, 0, 0},
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:fhvp::", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "g:fhvp::r:", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
             case 'g':
@@ -146,6 +151,9 @@ int main(int argc, char** argv) {
                 Settings::values.program_args = argv[optind];
                 ++optind;
                 break;
+            case 'r':
+                gpu_record_path = optarg;
+                break;
             }
         } else {
 #ifdef _WIN32
@@ -174,7 +182,12 @@ int main(int argc, char** argv) {
     Settings::values.use_gdbstub = use_gdbstub;
     Settings::Apply();
 
-    std::unique_ptr<EmuWindow_SDL2> emu_window{std::make_unique<EmuWindow_SDL2_GL>(fullscreen)};
+    std::unique_ptr<EmuWindow_SDL2> emu_window;
+    if (Settings::values.renderer_backend == Settings::RendererBackend::Null) {
+        emu_window = std::make_unique<EmuWindow_SDL2_Null>(fullscreen);
+    } else {
+        emu_window = std::make_unique<EmuWindow_SDL2_GL>(fullscreen);
+    }
 
     if (!Settings::values.use_multi_core) {
         // Single core mode must acquire OpenGL context for entire emulation session
@@ -221,6 +234,11 @@ int main(int argc, char** argv) {
     emu_window->MakeCurrent();
     system.Renderer().Rasterizer().LoadDiskResources();
 
+    if (!gpu_record_path.empty() && !system.GPU().StartRecording(gpu_record_path)) {
+        LOG_CRITICAL(Frontend, "Failed to start GPU recording to {}", gpu_record_path);
+        return -1;
+    }
+
     while (emu_window->IsOpen()) {
         system.RunLoop();
     }
@@ -0,0 +1,18 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "core/frontend/framebuffer_layout.h"
+#include "core/settings.h"
+#include "yuzu_gpu_replay/emu_window/emu_window_null.h"
+
+EmuWindow_Null::EmuWindow_Null() {
+    UpdateCurrentFramebufferLayout(Layout::ScreenUndocked::Width, Layout::ScreenUndocked::Height);
+    LOG_INFO(Frontend, "yuzu-gpu-replay Version: {} | {}-{}", Common::g_build_fullname,
+             Common::g_scm_branch, Common::g_scm_desc);
+    Settings::LogSettings();
+}
+
+EmuWindow_Null::~EmuWindow_Null() = default;
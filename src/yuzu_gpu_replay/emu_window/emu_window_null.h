@@ -0,0 +1,22 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include "core/frontend/emu_window.h"
+
+/// Window without any host window or graphics context, used with the null renderer
+class EmuWindow_Null : public Core::Frontend::EmuWindow {
+public:
+    explicit EmuWindow_Null();
+    ~EmuWindow_Null();
+
+    void SwapBuffers() override {}
+
+    void PollEvents() override {}
+
+    void MakeCurrent() override {}
+
+    void DoneCurrent() override {}
+};
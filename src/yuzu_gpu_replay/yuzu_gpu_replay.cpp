@@ -0,0 +1,408 @@
+// Copyright 2019 yuzu Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/logging/backend.h"
+#include "common/logging/filter.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/scm_rev.h"
+#include "common/scope_exit.h"
+#include "common/string_util.h"
+#include "core/core.h"
+#include "core/file_sys/registered_cache.h"
+#include "core/file_sys/vfs_real.h"
+#include "core/hle/kernel/physical_memory.h"
+#include "core/hle/kernel/process.h"
+#include "core/hle/kernel/vm_manager.h"
+#include "core/hle/service/filesystem/filesystem.h"
+#include "core/settings.h"
+#include "video_core/gpu.h"
+#include "video_core/gpu_recorder.h"
+#include "video_core/memory_manager.h"
+#include "yuzu_gpu_replay/emu_window/emu_window_null.h"
+#include "yuzu_gpu_replay/emu_window/emu_window_sdl2_hide.h"
+
+#ifdef _WIN32
+// windows.h needs to be included before shellapi.h
+#include <windows.h>
+
+#include <shellapi.h>
+#else
+#include <time.h>
+#endif
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+extern "C" {
+// tells Nvidia and AMD drivers to use the dedicated GPU by default on laptops with switchable
+// graphics
+__declspec(dllexport) unsigned long NvOptimusEnablement = 0x00000001;
+__declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
+}
+#endif
+
+namespace {
+
+/// Granularity of the guest memory allocated to back the recorded mappings
+constexpr VAddr REPLAY_PAGE_BITS = 12;
+
+void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <recording>\n"
+                 "-h, --help            Display this help and exit\n"
+                 "-v, --version         Output version information and exit\n"
+                 "-n, --frames=NUMBER   Stop after replaying NUMBER frames\n"
+                 "-N, --null-renderer   Replay without host rendering, measures the GPU "
+                 "emulation alone\n"
+                 "-l, --log             Log to console in addition to file (will log to file only "
+                 "by default)\n";
+}
+
+void PrintVersion() {
+    std::cout << "yuzu [GPU Replay] " << Common::g_scm_branch << " " << Common::g_scm_desc
+              << std::endl;
+}
+
+void InitializeLogging(bool console) {
+    Log::Filter log_filter(Log::Level::Info);
+    log_filter.ParseFilterString(Settings::values.log_filter);
+    Log::SetGlobalFilter(log_filter);
+
+    if (console)
+        Log::AddBackend(std::make_unique<Log::ColorConsoleBackend>());
+
+    const std::string& log_dir = FileUtil::GetUserPath(FileUtil::UserPath::LogDir);
+    FileUtil::CreateFullPath(log_dir);
+    Log::AddBackend(std::make_unique<Log::FileBackend>(log_dir + LOG_FILE));
+#ifdef _WIN32
+    Log::AddBackend(std::make_unique<Log::DebuggerBackend>());
+#endif
+}
+
+/**
+ * Returns the CPU time consumed by the calling thread. With synchronous GPU emulation the replay
+ * thread does all the GPU emulation and driver work, unlike wall time this excludes the time spent
+ * waiting on the host GPU and the presentation.
+ */
+std::chrono::nanoseconds GetThreadCPUTime() {
+#ifdef _WIN32
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    GetThreadTimes(GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time);
+    const auto to_ticks = [](const FILETIME& time) {
+        return (static_cast<u64>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    // FILETIME counts in 100 nanosecond units
+    return std::chrono::nanoseconds((to_ticks(kernel_time) + to_ticks(user_time)) * 100);
+#else
+    timespec time{};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+#endif
+}
+
+/// Feeds a GPU recording back to the GPU of a system without a guest application
+class Replayer {
+public:
+    explicit Replayer(Core::System& system) : system{system} {}
+
+    /// Applies a chunk, returns false if it's malformed or can't be applied
+    bool Apply(const Tegra::GPURecordReader::Chunk& chunk) {
+        switch (chunk.kind) {
+        case Tegra::RecordChunkKind::Map: {
+            Tegra::RecordMapEntry entry;
+            if (!ReadEntry(chunk, entry) || !AllocateGuestMemory(entry.cpu_addr, entry.size)) {
+                return false;
+            }
+            system.GPU().MemoryManager().MapBufferEx(entry.cpu_addr, entry.gpu_addr, entry.size);
+            return true;
+        }
+        case Tegra::RecordChunkKind::Unmap: {
+            Tegra::RecordUnmapEntry entry;
+            if (!ReadEntry(chunk, entry)) {
+                return false;
+            }
+            system.GPU().MemoryManager().UnmapBuffer(entry.gpu_addr, entry.size);
+            return true;
+        }
+        case Tegra::RecordChunkKind::Memory: {
+            Tegra::RecordMemoryHeader header;
+            if (!ReadEntry(chunk, header) ||
+                chunk.data.size() - sizeof(header) != header.size) {
+                return false;
+            }
+            // Writes through the memory manager invalidate the caches like a guest write would
+            system.GPU().MemoryManager().WriteBlock(
+                header.gpu_addr, chunk.data.data() + sizeof(header), header.size);
+            return true;
+        }
+        case Tegra::RecordChunkKind::CommandList: {
+            if (chunk.data.size() % sizeof(Tegra::CommandListHeader) != 0) {
+                return false;
+            }
+            Tegra::CommandList entries(chunk.data.size() / sizeof(Tegra::CommandListHeader));
+            std::memcpy(entries.data(), chunk.data.data(), chunk.data.size());
+            system.GPU().PushGPUEntries(std::move(entries));
+            return true;
+        }
+        case Tegra::RecordChunkKind::SwapBuffers: {
+            if (chunk.data.empty()) {
+                system.GPU().SwapBuffers(nullptr);
+                return true;
+            }
+            Tegra::FramebufferConfig framebuffer;
+            if (!ReadEntry(chunk, framebuffer)) {
+                return false;
+            }
+            system.GPU().SwapBuffers(&framebuffer);
+            return true;
+        }
+        }
+        LOG_ERROR(Frontend, "Unknown GPU recording chunk kind={}", static_cast<u32>(chunk.kind));
+        return false;
+    }
+
+private:
+    template <typename T>
+    static bool ReadEntry(const Tegra::GPURecordReader::Chunk& chunk, T& entry) {
+        if (chunk.data.size() < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&entry, chunk.data.data(), sizeof(T));
+        return true;
+    }
+
+    /// Backs the pages of the given range that aren't backed yet with zeroed guest memory
+    bool AllocateGuestMemory(VAddr cpu_addr, u64 size) {
+        const VAddr first_page = cpu_addr >> REPLAY_PAGE_BITS;
+        const VAddr last_page = (cpu_addr + size - 1) >> REPLAY_PAGE_BITS;
+        VAddr page = first_page;
+        while (page <= last_page) {
+            if (allocated_pages.count(page) != 0) {
+                ++page;
+                continue;
+            }
+            const VAddr run_begin = page;
+            while (page <= last_page && allocated_pages.count(page) == 0) {
+                allocated_pages.insert(page);
+                ++page;
+            }
+            const VAddr run_addr = run_begin << REPLAY_PAGE_BITS;
+            const u64 run_size = (page - run_begin) << REPLAY_PAGE_BITS;
+            const auto result = system.CurrentProcess()->VMManager().MapMemoryBlock(
+                run_addr, std::make_shared<Kernel::PhysicalMemory>(run_size), 0, run_size,
+                Kernel::MemoryState::Heap);
+            if (result.Failed()) {
+                LOG_ERROR(Frontend, "Failed to map guest memory at 0x{:016X} of size 0x{:X}",
+                          run_addr, run_size);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Core::System& system;
+    std::set<VAddr> allocated_pages;
+};
+
+} // Anonymous namespace
+
+/// Application entry point
+int main(int argc, char** argv) {
+    int option_index = 0;
+
+#ifdef _WIN32
+    int argc_w;
+    auto argv_w = CommandLineToArgvW(GetCommandLineW(), &argc_w);
+
+    if (argv_w == nullptr) {
+        std::cout << "Failed to get command line arguments" << std::endl;
+        return -1;
+    }
+#endif
+    std::string filepath;
+
+    static struct option long_options[] = {
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {"frames", required_argument, 0, 'n'},
+        {"null-renderer", no_argument, 0, 'N'},
+        {"log", no_argument, 0, 'l'},
+        {0, 0, 0, 0},
+    };
+
+    bool console_log = false;
+    bool use_null_renderer = false;
+    u64 max_frames = 0;
+
+    while (optind < argc) {
+        int arg = getopt_long(argc, argv, "hvn:Nl", long_options, &option_index);
+        if (arg != -1) {
+            switch (static_cast<char>(arg)) {
+            case 'h':
+                PrintHelp(argv[0]);
+                return 0;
+            case 'v':
+                PrintVersion();
+                return 0;
+            case 'n':
+                max_frames = std::strtoull(optarg, nullptr, 0);
+                break;
+            case 'N':
+                use_null_renderer = true;
+                break;
+            case 'l':
+                console_log = true;
+                break;
+            }
+        } else {
+#ifdef _WIN32
+            filepath = Common::UTF16ToUTF8(argv_w[optind]);
+#else
+            filepath = argv[optind];
+#endif
+            optind++;
+        }
+    }
+
+    // Replays must be deterministic and independent from the host state
+    Settings::values.renderer_backend = use_null_renderer ? Settings::RendererBackend::Null
+                                                          : Settings::RendererBackend::OpenGL;
+    Settings::values.log_filter = "*:Info";
+    Settings::values.resolution_factor = 1.0f;
+    Settings::values.use_disk_shader_cache = false;
+    Settings::values.use_accurate_gpu_emulation = false;
+    Settings::values.use_asynchronous_gpu_emulation = false;
+    Settings::values.texture_cache_budget = 0;
+    Settings::values.use_gdbstub = false;
+    Settings::Apply();
+
+    InitializeLogging(console_log);
+
+#ifdef _WIN32
+    LocalFree(argv_w);
+#endif
+
+    MicroProfileOnThreadCreate("EmuThread");
+    SCOPE_EXIT({ MicroProfileShutdown(); });
+
+    if (filepath.empty()) {
+        std::cout << "No GPU recording specified" << std::endl;
+        PrintHelp(argv[0]);
+        return -1;
+    }
+
+    Tegra::GPURecordReader reader;
+    if (!reader.Open(filepath)) {
+        std::cout << "Failed to open GPU recording " << filepath << std::endl;
+        return -1;
+    }
+
+    std::unique_ptr<EmuWindow_Null> null_window;
+    std::unique_ptr<EmuWindow_SDL2_Hide> sdl_window;
+    Core::Frontend::EmuWindow* emu_window;
+    if (use_null_renderer) {
+        null_window = std::make_unique<EmuWindow_Null>();
+        emu_window = null_window.get();
+    } else {
+        sdl_window = std::make_unique<EmuWindow_SDL2_Hide>();
+        emu_window = sdl_window.get();
+    }
+    emu_window->MakeCurrent();
+
+    Core::System& system{Core::System::GetInstance()};
+    system.SetContentProvider(std::make_unique<FileSys::ContentProviderUnion>());
+    system.SetFilesystem(std::make_shared<FileSys::RealVfsFilesystem>());
+    system.GetFileSystemController().CreateFactories(*system.GetFilesystem());
+
+    SCOPE_EXIT({ system.Shutdown(); });
+
+    if (system.LoadGPUReplay(*emu_window) != Core::System::ResultStatus::Success) {
+        std::cout << "Failed to initialize the emulated system" << std::endl;
+        return -1;
+    }
+
+    Replayer replayer{system};
+    std::vector<double> frame_times;
+
+    // Frames are timed on the command lists and the presentation alone. Reading the recording and
+    // replaying its mappings and memory uploads is guest work, it's accounted separately.
+    std::chrono::nanoseconds frame_time{};
+    std::chrono::nanoseconds load_time{};
+    Tegra::GPURecordReader::Chunk chunk;
+    while (true) {
+        const auto read_start = GetThreadCPUTime();
+        if (!reader.ReadChunk(chunk)) {
+            break;
+        }
+        const auto apply_start = GetThreadCPUTime();
+        load_time += apply_start - read_start;
+        const bool applied = replayer.Apply(chunk);
+        const auto apply_time = GetThreadCPUTime() - apply_start;
+        if (!applied) {
+            std::cout << "Malformed GPU recording chunk, stopping the replay" << std::endl;
+            break;
+        }
+        if (chunk.kind != Tegra::RecordChunkKind::CommandList &&
+            chunk.kind != Tegra::RecordChunkKind::SwapBuffers) {
+            load_time += apply_time;
+            continue;
+        }
+        frame_time += apply_time;
+        if (chunk.kind != Tegra::RecordChunkKind::SwapBuffers) {
+            continue;
+        }
+        const double frame_ms = std::chrono::duration<double, std::milli>(frame_time).count();
+        frame_times.push_back(frame_ms);
+        std::cout << fmt::format("Frame {:6d}: {:8.3f} ms", frame_times.size(), frame_ms)
+                  << std::endl;
+        if (max_frames != 0 && frame_times.size() >= max_frames) {
+            break;
+        }
+        frame_time = {};
+    }
+
+    if (frame_times.empty()) {
+        std::cout << "The GPU recording has no frames" << std::endl;
+        return 0;
+    }
+
+    std::vector<double> sorted_times = frame_times;
+    std::sort(sorted_times.begin(), sorted_times.end());
+    const double total = std::accumulate(frame_times.begin(), frame_times.end(), 0.0);
+    const auto percentile = [&sorted_times](double p) {
+        const auto index = static_cast<std::size_t>(p * (sorted_times.size() - 1));
+        return sorted_times[index];
+    };
+    std::cout << std::endl
+              << fmt::format("{} frames (CPU time) | total {:.3f} ms | mean {:.3f} ms | "
+                             "median {:.3f} ms | p99 {:.3f} ms | min {:.3f} ms | max {:.3f} ms",
+                             frame_times.size(), total, total / frame_times.size(),
+                             percentile(0.5), percentile(0.99), sorted_times.front(),
+                             sorted_times.back())
+              << std::endl;
+    std::cout << fmt::format("Not included: {:.3f} ms (CPU time) reading the recording and "
+                             "replaying its memory uploads",
+                             std::chrono::duration<double, std::milli>(load_time).count())
+              << std::endl;
+    return 0;
+}